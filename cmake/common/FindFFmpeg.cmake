@@ -0,0 +1,89 @@
+# CMake FFmpeg find module
+#
+# Finds the FFmpeg libraries of the prebuilt obs-deps (on Windows and macOS, where
+# pkg-config isn't available), as obs-studio's own FindFFmpeg module does for its plugins.
+#
+# Components: avcodec, avutil (or any other FFmpeg library)
+#
+# Imported targets:
+#   FFmpeg::<component>
+#
+# Result variables:
+#   FFmpeg_FOUND
+#   FFmpeg_<component>_FOUND
+#   FFmpeg_<component>_VERSION
+
+include_guard(GLOBAL)
+
+include(FindPackageHandleStandardArgs)
+
+# _ffmpeg_read_version: Reads the version of an FFmpeg library from its headers
+function(_ffmpeg_read_version component include_dir)
+  string(TOUPPER "${component}" _component_u)
+
+  # FFmpeg 5.1 moved the major version to version_major.h
+  set(_version_headers "${include_dir}/lib${component}/version.h")
+  if(EXISTS "${include_dir}/lib${component}/version_major.h")
+    list(APPEND _version_headers "${include_dir}/lib${component}/version_major.h")
+  endif()
+
+  set(_version_parts)
+  foreach(_part IN ITEMS MAJOR MINOR MICRO)
+    foreach(_header IN LISTS _version_headers)
+      file(STRINGS "${_header}" _define REGEX "^#define[ \t]+LIB${_component_u}_VERSION_${_part}[ \t]+[0-9]+")
+      if(_define)
+        string(REGEX REPLACE ".*[ \t]([0-9]+).*" "\\1" _value "${_define}")
+        list(APPEND _version_parts ${_value})
+        break()
+      endif()
+    endforeach()
+  endforeach()
+
+  list(JOIN _version_parts "." _version)
+  set(FFmpeg_${component}_VERSION "${_version}" PARENT_SCOPE)
+endfunction()
+
+set(_ffmpeg_required_vars)
+foreach(_component IN LISTS FFmpeg_FIND_COMPONENTS)
+  find_path(
+    FFmpeg_${_component}_INCLUDE_DIR
+    NAMES lib${_component}/${_component}.h
+    PATH_SUFFIXES include
+    DOC "FFmpeg ${_component} include directory"
+  )
+  find_library(
+    FFmpeg_${_component}_LIBRARY
+    NAMES ${_component} lib${_component}
+    PATH_SUFFIXES lib
+    DOC "FFmpeg ${_component} location"
+  )
+  mark_as_advanced(FFmpeg_${_component}_INCLUDE_DIR FFmpeg_${_component}_LIBRARY)
+
+  if(FFmpeg_${_component}_INCLUDE_DIR AND FFmpeg_${_component}_LIBRARY)
+    set(FFmpeg_${_component}_FOUND TRUE)
+    _ffmpeg_read_version(${_component} "${FFmpeg_${_component}_INCLUDE_DIR}")
+
+    if(NOT TARGET FFmpeg::${_component})
+      add_library(FFmpeg::${_component} UNKNOWN IMPORTED)
+      set_target_properties(
+        FFmpeg::${_component}
+        PROPERTIES
+          IMPORTED_LOCATION "${FFmpeg_${_component}_LIBRARY}"
+          INTERFACE_INCLUDE_DIRECTORIES "${FFmpeg_${_component}_INCLUDE_DIR}"
+          VERSION "${FFmpeg_${_component}_VERSION}"
+      )
+    endif()
+  else()
+    set(FFmpeg_${_component}_FOUND FALSE)
+  endif()
+
+  list(APPEND _ffmpeg_required_vars FFmpeg_${_component}_LIBRARY FFmpeg_${_component}_INCLUDE_DIR)
+endforeach()
+
+find_package_handle_standard_args(
+  FFmpeg
+  REQUIRED_VARS ${_ffmpeg_required_vars}
+  HANDLE_COMPONENTS
+  REASON_FAILURE_MESSAGE "Ensure the prebuilt obs-deps are in CMAKE_PREFIX_PATH."
+)
+unset(_ffmpeg_required_vars)
@@ -1,27 +1,683 @@
 #include "Address.hpp"
 
 // STL includes
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
+#include <tuple>
+
+// Socket includes
+// (NOMINMAX is defined first, so the Windows headers don't define min and max as macros)
+#if defined(_WIN32) || defined(_WIN64)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <winsock2.h>
+  #include <ws2tcpip.h>
+#else
+  #include <netinet/in.h>
+  #include <sys/socket.h>
+#endif
 
 using namespace MoonlightOBS;
 
+namespace
+{
+    // Size of an IPv4 address in bytes
+    constexpr uint8_t IPv4Size = 4;
+    // Size of an IPv6 address in bytes
+    constexpr uint8_t IPv6Size = 16;
+
+    // Lowercase hexadecimal digits, used for formatting IPv6 addresses
+    constexpr char HexDigits[] = "0123456789abcdef";
+
+    // Gets the value of a hexadecimal digit, or -1 if the character isn't one
+    int HexValue(char character)
+    {
+        if (character >= '0' && character <= '9')
+        {
+            return character - '0';
+        }
+        if (character >= 'a' && character <= 'f')
+        {
+            return character - 'a' + 10;
+        }
+        if (character >= 'A' && character <= 'F')
+        {
+            return character - 'A' + 10;
+        }
+
+        return -1;
+    }
+
+    // Parses an unsigned decimal number, failing if it's empty, or greater than the maximum
+    bool ParseDecimal(std::string_view text, uint32_t maximum, uint32_t& value)
+    {
+        if (text.empty() || text.size() > 10)
+        {
+            return false;
+        }
+
+        uint64_t result = 0;
+        for (char character : text)
+        {
+            if (character < '0' || character > '9')
+            {
+                return false;
+            }
+
+            result = result * 10 + static_cast<uint64_t>(character - '0');
+        }
+
+        if (result > maximum)
+        {
+            return false;
+        }
+
+        value = static_cast<uint32_t>(result);
+        return true;
+    }
+
+    // Writes text into the buffer used for formatting, tracking the position
+    class FormatWriter
+    {
+    public:
+        FormatWriter(char* buffer, size_t size)
+            : m_buffer(buffer), m_size(size), m_position(0) {}
+
+        void Put(char character)
+        {
+            if (m_position < m_size)
+            {
+                m_buffer[m_position] = character;
+            }
+            m_position++;
+        }
+
+        void Put(std::string_view text)
+        {
+            for (char character : text)
+            {
+                Put(character);
+            }
+        }
+
+        void PutDecimal(uint32_t value)
+        {
+            char digits[10];
+            size_t count = 0;
+            do
+            {
+                digits[count++] = static_cast<char>('0' + value % 10);
+                value /= 10;
+            } while (value != 0);
+
+            while (count > 0)
+            {
+                Put(digits[--count]);
+            }
+        }
+
+        void PutHex(uint16_t value)
+        {
+            // Leading zeros are omitted (RFC 5952, section 4.1)
+            bool started = false;
+            for (int shift = 12; shift >= 0; shift -= 4)
+            {
+                int digit = (value >> shift) & 0xF;
+                if (digit != 0 || started || shift == 0)
+                {
+                    Put(HexDigits[digit]);
+                    started = true;
+                }
+            }
+        }
+
+        // Null-terminates the text, returning its length, or 0 if it didn't fit
+        size_t Finish()
+        {
+            if (m_position >= m_size)
+            {
+                if (m_size > 0)
+                {
+                    m_buffer[0] = '\0';
+                }
+                return 0;
+            }
+
+            m_buffer[m_position] = '\0';
+            return m_position;
+        }
+
+    private:
+        char* m_buffer;
+        size_t m_size;
+        size_t m_position;
+    };
+
+    // Writes an IPv4 address in dotted-decimal form
+    void FormatIPv4(FormatWriter& writer, const uint8_t* bytes)
+    {
+        for (uint8_t i = 0; i < IPv4Size; i++)
+        {
+            if (i > 0)
+            {
+                writer.Put('.');
+            }
+            writer.PutDecimal(bytes[i]);
+        }
+    }
+
+    // Writes an IPv6 address in its canonical text form (RFC 5952)
+    void FormatIPv6(FormatWriter& writer, const uint8_t* bytes)
+    {
+        uint16_t groups[8];
+        for (int i = 0; i < 8; i++)
+        {
+            groups[i] = static_cast<uint16_t>((bytes[i * 2] << 8) | bytes[i * 2 + 1]);
+        }
+
+        // IPv4-mapped addresses are written with the IPv4 address in dotted-decimal form
+        static constexpr uint8_t MappedPrefix[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF };
+        if (std::memcmp(bytes, MappedPrefix, sizeof(MappedPrefix)) == 0)
+        {
+            writer.Put("::ffff:");
+            FormatIPv4(writer, bytes + 12);
+            return;
+        }
+
+        // Find the longest run of zero groups, which is compressed to "::"
+        // (the first is used if there's a tie, and a single zero group isn't compressed)
+        int bestStart = -1;
+        int bestLength = 1;
+        for (int i = 0; i < 8;)
+        {
+            if (groups[i] != 0)
+            {
+                i++;
+                continue;
+            }
+
+            int start = i;
+            while (i < 8 && groups[i] == 0)
+            {
+                i++;
+            }
+
+            if (i - start > bestLength)
+            {
+                bestStart = start;
+                bestLength = i - start;
+            }
+        }
+
+        for (int i = 0; i < 8; i++)
+        {
+            if (i == bestStart)
+            {
+                writer.Put("::");
+                i += bestLength - 1;
+                continue;
+            }
+
+            if (i > 0 && i != bestStart + bestLength)
+            {
+                writer.Put(':');
+            }
+            writer.PutHex(groups[i]);
+        }
+    }
+}
+
+Address::Address()
+    : m_type(Type::Empty), m_length(0), m_port(0), m_scopeID(0), m_hostname{} {}
+
 Address::Address(std::string_view address, uint16_t port)
-    : m_address(address), m_port(port)
+    : Address()
+{
+    m_port = port;
+
+    // An empty address only holds a port number
+    if (address.empty())
+    {
+        return;
+    }
+
+    if (!SetHost(address))
+    {
+        throw std::invalid_argument("Invalid IP address or hostname: " + std::string(address));
+    }
+}
+
+Address Address::FromSockaddr(const sockaddr* socketAddress, size_t addressLength)
 {
-    // Ensure the port number is valid
-    if (port > 65535 || port < 0)
+    Address address;
+
+    if (socketAddress != nullptr && socketAddress->sa_family == AF_INET && addressLength >= sizeof(sockaddr_in))
     {
-        throw std::out_of_range("Port number must be between 0 and 65535");
+        const sockaddr_in* ipv4 = reinterpret_cast<const sockaddr_in*>(socketAddress);
+
+        address.m_type = Type::IPv4;
+        address.m_length = IPv4Size;
+        address.m_port = ntohs(ipv4->sin_port);
+        std::memcpy(address.m_ip.data(), &ipv4->sin_addr, IPv4Size);
+        return address;
     }
+    if (socketAddress != nullptr && socketAddress->sa_family == AF_INET6 && addressLength >= sizeof(sockaddr_in6))
+    {
+        const sockaddr_in6* ipv6 = reinterpret_cast<const sockaddr_in6*>(socketAddress);
+
+        address.m_type = Type::IPv6;
+        address.m_length = IPv6Size;
+        address.m_port = ntohs(ipv6->sin6_port);
+        address.m_scopeID = ipv6->sin6_scope_id;
+        std::memcpy(address.m_ip.data(), &ipv6->sin6_addr, IPv6Size);
+        return address;
+    }
+
+    throw std::invalid_argument("Socket address is not an IPv4 or IPv6 address");
 }
 
-void Address::SetPortNumber(uint16_t port)
+bool Address::TryParse(std::string_view text, Address& address)
 {
-    // Ensure the port number is valid
-    if (port > 65535 || port < 0)
+    Address parsed;
+
+    if (!text.empty() && text.front() == '[')
+    {
+        // Bracketed IPv6 address, with an optional port ("[ipv6%scope]:port")
+        size_t closingBracket = text.find(']');
+        if (closingBracket == std::string_view::npos)
+        {
+            return false;
+        }
+
+        std::string_view host = text.substr(1, closingBracket - 1);
+        std::string_view remainder = text.substr(closingBracket + 1);
+
+        parsed.m_type = Type::IPv6;
+        parsed.m_length = IPv6Size;
+        if (!ParseIPv6(host, parsed.m_ip.data(), parsed.m_scopeID))
+        {
+            return false;
+        }
+
+        if (!remainder.empty() && (remainder.front() != ':' || !ParsePort(remainder.substr(1), parsed.m_port)))
+        {
+            return false;
+        }
+    }
+    else
     {
-        throw std::out_of_range("Port number must be between 0 and 65535");
+        size_t firstColon = text.find(':');
+        if (firstColon != std::string_view::npos && text.find(':', firstColon + 1) == std::string_view::npos)
+        {
+            // Hostname or IPv4 address with a port ("host:port")
+            if (!ParsePort(text.substr(firstColon + 1), parsed.m_port))
+            {
+                return false;
+            }
+            text = text.substr(0, firstColon);
+        }
+
+        // Hostname, IPv4 address or bare IPv6 address
+        if (!parsed.SetHost(text))
+        {
+            return false;
+        }
     }
-    
-    m_port = port;
+
+    address = parsed;
+    return true;
+}
+
+size_t Address::ToSockaddr(sockaddr_storage& socketAddress) const
+{
+    std::memset(&socketAddress, 0, sizeof(socketAddress));
+
+    if (m_type == Type::IPv4)
+    {
+        sockaddr_in* ipv4 = reinterpret_cast<sockaddr_in*>(&socketAddress);
+        ipv4->sin_family = AF_INET;
+        ipv4->sin_port = htons(m_port);
+        std::memcpy(&ipv4->sin_addr, m_ip.data(), IPv4Size);
+        return sizeof(sockaddr_in);
+    }
+    if (m_type == Type::IPv6)
+    {
+        sockaddr_in6* ipv6 = reinterpret_cast<sockaddr_in6*>(&socketAddress);
+        ipv6->sin6_family = AF_INET6;
+        ipv6->sin6_port = htons(m_port);
+        ipv6->sin6_scope_id = m_scopeID;
+        std::memcpy(&ipv6->sin6_addr, m_ip.data(), IPv6Size);
+        return sizeof(sockaddr_in6);
+    }
+
+    return 0;
+}
+
+size_t Address::Format(char* buffer, size_t bufferSize, FormatOptions options) const
+{
+    FormatWriter writer(buffer, bufferSize);
+    bool includePort = (options & FormatOmitPort) == 0;
+
+    switch (m_type)
+    {
+    case Type::Empty:
+        // An empty address has no text, even if it has a port number
+        return writer.Finish();
+    case Type::IPv4:
+        FormatIPv4(writer, m_ip.data());
+        break;
+    case Type::IPv6:
+        if (includePort)
+        {
+            writer.Put('[');
+        }
+        FormatIPv6(writer, m_ip.data());
+        if (m_scopeID != 0 && (options & FormatOmitScopeID) == 0)
+        {
+            writer.Put('%');
+            writer.PutDecimal(m_scopeID);
+        }
+        if (includePort)
+        {
+            writer.Put(']');
+        }
+        break;
+    case Type::Hostname:
+        writer.Put(GetHostname());
+        break;
+    }
+
+    if (includePort)
+    {
+        writer.Put(':');
+        writer.PutDecimal(m_port);
+    }
+
+    return writer.Finish();
+}
+
+std::string Address::GetString() const
+{
+    std::array<char, MaxStringSize> buffer;
+    size_t length = Format(buffer.data(), buffer.size());
+
+    return std::string(buffer.data(), length);
+}
+
+size_t Address::Hash() const
+{
+    // FNV-1a over the fields which take part in equality
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint8_t byte)
+    {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    };
+
+    mix(static_cast<uint8_t>(m_type));
+    mix(static_cast<uint8_t>(m_port));
+    mix(static_cast<uint8_t>(m_port >> 8));
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        mix(static_cast<uint8_t>(m_scopeID >> shift));
+    }
+    for (char byte : GetBytes())
+    {
+        mix(static_cast<uint8_t>(byte));
+    }
+
+    return static_cast<size_t>(hash);
+}
+
+bool Address::operator==(const Address& other) const
+{
+    return m_type == other.m_type && m_port == other.m_port && m_scopeID == other.m_scopeID &&
+           GetBytes() == other.GetBytes();
+}
+
+bool Address::operator<(const Address& other) const
+{
+    return std::make_tuple(m_type, GetBytes(), m_scopeID, m_port) <
+           std::make_tuple(other.m_type, other.GetBytes(), other.m_scopeID, other.m_port);
+}
+
+bool Address::ParseIPv4(std::string_view text, uint8_t* bytes)
+{
+    uint8_t parsed[IPv4Size];
+
+    for (uint8_t i = 0; i < IPv4Size; i++)
+    {
+        size_t dot = text.find('.');
+        std::string_view part = text.substr(0, dot);
+
+        // Each part must be a decimal number without leading zeros (which some parsers treat as octal)
+        uint32_t value = 0;
+        if ((part.size() > 1 && part.front() == '0') || !ParseDecimal(part, 255, value))
+        {
+            return false;
+        }
+        parsed[i] = static_cast<uint8_t>(value);
+
+        // The last part must not be followed by anything else
+        if ((i == IPv4Size - 1) != (dot == std::string_view::npos))
+        {
+            return false;
+        }
+        text = text.substr(dot + 1);
+    }
+
+    std::memcpy(bytes, parsed, IPv4Size);
+    return true;
+}
+
+bool Address::ParseIPv6(std::string_view text, uint8_t* bytes, uint32_t& scopeID)
+{
+    // Split off the scope ID (only numeric scope IDs are accepted)
+    uint32_t parsedScopeID = 0;
+    size_t percent = text.find('%');
+    if (percent != std::string_view::npos)
+    {
+        if (!ParseDecimal(text.substr(percent + 1), UINT32_MAX, parsedScopeID))
+        {
+            return false;
+        }
+        text = text.substr(0, percent);
+    }
+
+    uint8_t parsed[IPv6Size] = {};
+    size_t byteCount = 0;
+    int compressAt = -1;
+
+    // A leading "::" is handled here, as the loop only expects "::" after a group
+    if (text.size() >= 2 && text[0] == ':' && text[1] == ':')
+    {
+        compressAt = 0;
+        text.remove_prefix(2);
+    }
+
+    while (!text.empty())
+    {
+        size_t colon = text.find(':');
+        std::string_view group = text.substr(0, colon);
+
+        if (group.find('.') != std::string_view::npos)
+        {
+            // An embedded IPv4 address may only appear as the last 32 bits
+            if (colon != std::string_view::npos || byteCount + IPv4Size > IPv6Size ||
+                !ParseIPv4(group, parsed + byteCount))
+            {
+                return false;
+            }
+            byteCount += IPv4Size;
+            break;
+        }
+
+        if (group.empty() || group.size() > 4 || byteCount + 2 > IPv6Size)
+        {
+            return false;
+        }
+
+        uint32_t value = 0;
+        for (char character : group)
+        {
+            int digit = HexValue(character);
+            if (digit < 0)
+            {
+                return false;
+            }
+            value = (value << 4) | static_cast<uint32_t>(digit);
+        }
+        parsed[byteCount++] = static_cast<uint8_t>(value >> 8);
+        parsed[byteCount++] = static_cast<uint8_t>(value);
+
+        if (colon == std::string_view::npos)
+        {
+            break;
+        }
+        text = text.substr(colon + 1);
+
+        // "::" may appear once, and must not be followed by another colon
+        if (!text.empty() && text.front() == ':')
+        {
+            if (compressAt >= 0)
+            {
+                return false;
+            }
+            compressAt = static_cast<int>(byteCount);
+            text.remove_prefix(1);
+        }
+        else if (text.empty())
+        {
+            // A single trailing colon
+            return false;
+        }
+    }
+
+    if (compressAt >= 0)
+    {
+        // "::" must stand for at least one zero group
+        if (byteCount > IPv6Size - 2)
+        {
+            return false;
+        }
+
+        // Move the groups after "::" to the end, leaving zeros in between
+        size_t tailLength = byteCount - static_cast<size_t>(compressAt);
+        std::memmove(parsed + IPv6Size - tailLength, parsed + compressAt, tailLength);
+        std::fill(parsed + compressAt, parsed + IPv6Size - tailLength, static_cast<uint8_t>(0));
+    }
+    else if (byteCount != IPv6Size)
+    {
+        return false;
+    }
+
+    std::memcpy(bytes, parsed, IPv6Size);
+    scopeID = parsedScopeID;
+    return true;
+}
+
+bool Address::ParsePort(std::string_view text, uint16_t& port)
+{
+    uint32_t value = 0;
+    if (!ParseDecimal(text, UINT16_MAX, value))
+    {
+        return false;
+    }
+
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+bool Address::IsValidHostname(std::string_view text)
+{
+    // A single trailing dot denotes a fully qualified name
+    if (!text.empty() && text.back() == '.')
+    {
+        text.remove_suffix(1);
+    }
+
+    if (text.empty() || text.size() > MaxHostnameLength)
+    {
+        return false;
+    }
+
+    // Each label must be 1 to 63 characters, and must not start or end with a hyphen
+    // (underscores are accepted, as some hosts use them in their computer names)
+    size_t labelLength = 0;
+    bool labelIsNumeric = true;
+    char previous = '.';
+    for (char character : text)
+    {
+        if (character == '.')
+        {
+            if (labelLength == 0 || previous == '-')
+            {
+                return false;
+            }
+            labelLength = 0;
+            labelIsNumeric = true;
+        }
+        else
+        {
+            bool isAlphanumeric = (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') ||
+                                  (character >= '0' && character <= '9');
+            if (!isAlphanumeric && character != '-' && character != '_')
+            {
+                return false;
+            }
+            if (character == '-' && labelLength == 0)
+            {
+                return false;
+            }
+            if (++labelLength > 63)
+            {
+                return false;
+            }
+            labelIsNumeric = labelIsNumeric && character >= '0' && character <= '9';
+        }
+        previous = character;
+    }
+
+    // The last label must not be numeric, so malformed IPv4 addresses (e.g. "1.2.3") aren't treated as hostnames
+    return previous != '-' && !labelIsNumeric;
+}
+
+bool Address::SetHost(std::string_view text)
+{
+    if (ParseIPv4(text, m_ip.data()))
+    {
+        m_type = Type::IPv4;
+        m_length = IPv4Size;
+        m_scopeID = 0;
+        return true;
+    }
+    if (text.find(':') != std::string_view::npos)
+    {
+        if (!ParseIPv6(text, m_ip.data(), m_scopeID))
+        {
+            return false;
+        }
+
+        m_type = Type::IPv6;
+        m_length = IPv6Size;
+        return true;
+    }
+    if (!IsValidHostname(text))
+    {
+        return false;
+    }
+
+    // Hostnames are stored without the trailing dot, so equal names compare equal
+    if (text.back() == '.')
+    {
+        text.remove_suffix(1);
+    }
+
+    m_type = Type::Hostname;
+    m_length = static_cast<uint8_t>(text.size());
+    m_scopeID = 0;
+    std::memcpy(m_hostname.data(), text.data(), text.size());
+    return true;
 }
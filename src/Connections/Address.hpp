@@ -1,62 +1,220 @@
 #pragma once
 
 // STL includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <ostream>
 #include <string>
-#include <cstdint>
+#include <string_view>
+
+// Forward declarations
+struct sockaddr;
+struct sockaddr_storage;
 
 namespace MoonlightOBS
 {
     /**
      * @brief Represents an address for a connection.
-     * 
+     *
+     * IP addresses are stored in binary form (including the scope ID of IPv6 addresses), and
+     * hostnames are stored inline, so an Address never allocates, and can be hashed, compared
+     * and formatted without touching the heap.
+     *
      */
     class Address
     {
     public:
+        /**
+         * @brief The type of address held by an Address object.
+         *
+         */
+        enum class Type : uint8_t
+        {
+            /**
+             * @brief No address. (Only a port number may be set)
+             *
+             */
+            Empty,
+            /**
+             * @brief An IPv4 address.
+             *
+             */
+            IPv4,
+            /**
+             * @brief An IPv6 address.
+             *
+             */
+            IPv6,
+            /**
+             * @brief A hostname, which has yet to be resolved.
+             *
+             */
+            Hostname
+        };
+
+        /**
+         * @brief Options for formatting an Address as text.
+         *
+         */
+        enum FormatOptions : uint8_t
+        {
+            /**
+             * @brief Format as "host:port", "ipv4:port" or "[ipv6%scope]:port".
+             *
+             */
+            FormatDefault       = 0,
+            /**
+             * @brief Omit the port number, and the brackets around IPv6 addresses.
+             *
+             */
+            FormatOmitPort      = 1 << 0,
+            /**
+             * @brief Omit the scope ID of IPv6 addresses.
+             *
+             */
+            FormatOmitScopeID   = 1 << 1
+        };
+
+        /**
+         * @brief The longest hostname which can be stored.
+         *
+         */
+        static constexpr size_t MaxHostnameLength = 253;
+
+        /**
+         * @brief The size of a buffer large enough to format any Address into, including the null terminator.
+         *
+         */
+        static constexpr size_t MaxStringSize = MaxHostnameLength + sizeof(":65535");
+
+        /**
+         * @brief Construct an empty Address object.
+         *
+         */
+        Address();
+
         /**
          * @brief Construct a new Address object
-         * 
-         * @param address The IP address or hostname of the connection.
-         * @param port The port number of the connection. (Must be between 0 and 65535)
-         * 
-         * @exception std::out_of_range If the port number is not between 0 and 65535.
+         *
+         * @param address The IP address or hostname of the connection, or an empty string for no address.
+         * @param port The port number of the connection.
+         *
+         * @exception std::invalid_argument If the address is neither an IP address nor a valid hostname.
          */
         Address(std::string_view address, uint16_t port);
 
         /**
          * @brief Gets an empty Address object.
-         * 
+         *
          * @return Address The created Address object.
          */
         inline static Address GetEmpty()
         {
-            return Address("", 0);
+            return Address();
+        }
+
+        /**
+         * @brief Creates an Address object from a socket address.
+         *
+         * @param socketAddress The IPv4 (sockaddr_in) or IPv6 (sockaddr_in6) socket address.
+         * @param addressLength The length of the socket address.
+         * @return Address The created Address object.
+         *
+         * @exception std::invalid_argument If the socket address isn't an IPv4 or IPv6 address.
+         */
+        static Address FromSockaddr(const sockaddr* socketAddress, size_t addressLength);
+
+        /**
+         * @brief Parses an address from text, without allocating.
+         * @note Accepts "host", "host:port", "ipv4", "ipv4:port", "ipv6", "ipv6%scope" and
+         *       "[ipv6%scope]:port", where the port number is 0 if it's omitted.
+         *
+         * @param text The text to parse.
+         * @param address The parsed address, left unchanged if parsing fails.
+         * @return true If the text was parsed.
+         * @return false If the text isn't a valid address.
+         */
+        static bool TryParse(std::string_view text, Address& address);
+
+        /**
+         * @brief Gets the type of address held.
+         *
+         * @return Type The type of address held.
+         */
+        inline Type GetType() const
+        {
+            return m_type;
+        }
+
+        /**
+         * @brief Checks if no address is held.
+         *
+         * @return true If no address is held.
+         * @return false If an IP address or hostname is held.
+         */
+        inline bool IsEmpty() const
+        {
+            return m_type == Type::Empty;
+        }
+
+        /**
+         * @brief Checks if an IPv4 address is held.
+         *
+         * @return true If an IPv4 address is held.
+         * @return false If any other type of address is held.
+         */
+        inline bool IsIPv4() const
+        {
+            return m_type == Type::IPv4;
+        }
+
+        /**
+         * @brief Checks if an IPv6 address is held.
+         *
+         * @return true If an IPv6 address is held.
+         * @return false If any other type of address is held.
+         */
+        inline bool IsIPv6() const
+        {
+            return m_type == Type::IPv6;
+        }
+
+        /**
+         * @brief Checks if a hostname is held.
+         *
+         * @return true If a hostname is held.
+         * @return false If any other type of address is held.
+         */
+        inline bool IsHostname() const
+        {
+            return m_type == Type::Hostname;
         }
 
         /**
-         * @brief Get the IP address or hostname of the connection.
-         * 
-         * @return std::string_view The address of the connection.
+         * @brief Gets the hostname held.
+         *
+         * @return std::string_view The hostname, or an empty string if a hostname isn't held.
          */
-        inline std::string_view GetAddress() const
+        inline std::string_view GetHostname() const
         {
-            return m_address;
+            return m_type == Type::Hostname ? std::string_view(m_hostname.data(), m_length) : std::string_view();
         }
 
         /**
-         * @brief Set the IP address or hostname of the connection.
-         * 
-         * @param address The address of the connection.
+         * @brief Gets the scope ID of an IPv6 address.
+         *
+         * @return uint32_t The scope ID, or 0 if the address isn't scoped.
          */
-        inline void SetAddress(std::string_view address)
+        inline uint32_t GetScopeID() const
         {
-            m_address = address;
+            return m_scopeID;
         }
 
         /**
          * @brief Gets the port number of the connection.
-         * 
+         *
          * @return uint16_t The port number of the connection.
          */
         inline uint16_t GetPortNumber() const
@@ -66,64 +224,81 @@ namespace MoonlightOBS
 
         /**
          * @brief Sets the port number of the connection.
-         * 
-         * @param port The port number of the connection. (Must be between 0 and 65535)
-         * 
-         * @exception std::out_of_range If the port number is not between 0 and 65535.
+         *
+         * @param port The port number of the connection.
+         */
+        inline void SetPortNumber(uint16_t port)
+        {
+            m_port = port;
+        }
+
+        /**
+         * @brief Converts an IP address to a socket address.
+         *
+         * @param socketAddress The socket address to write to.
+         * @return size_t The length of the socket address, or 0 if an IP address isn't held.
+         */
+        size_t ToSockaddr(sockaddr_storage& socketAddress) const;
+
+        /**
+         * @brief Formats the Address into a buffer, without allocating.
+         *
+         * @param buffer The buffer to write the null-terminated text to.
+         * @param bufferSize The size of the buffer. (MaxStringSize is always large enough)
+         * @param options Options controlling how the address is formatted.
+         * @return size_t The length of the formatted text, or 0 if the buffer was too small
+         *         or the Address is empty.
          */
-        void SetPortNumber(uint16_t port);
+        size_t Format(char* buffer, size_t bufferSize, FormatOptions options = FormatDefault) const;
 
         /**
          * @brief Converts the Address object to a string representation.
-         * 
+         *
          * @return std::string The string representation of the Address object.
          */
-        inline std::string GetString() const
-        {
-            // Return an empty string if the address is empty
-            if (m_address.empty())
-            {
-                return "";
-            }
-
-            return m_address + ":" + std::to_string(m_port);
-        }
+        std::string GetString() const;
 
         /**
          * @brief Checks if the Address object is valid.
-         * 
+         *
          * @return true If the address is not empty and the port is valid.
          * @return false If the address is empty or the port is invalid.
          */
         inline bool IsValid() const
         {
-            return !m_address.empty() && m_port > 0 && m_port <= 65535;
+            return m_type != Type::Empty && m_port > 0;
         }
 
+        /**
+         * @brief Calculates the hash of the Address object.
+         *
+         * @return size_t The hash of the Address object.
+         */
+        size_t Hash() const;
+
         /**
          * @brief Converts the Address object to a string representation.
          */
         inline friend std::ostream& operator<<(std::ostream& os, const Address& address)
         {
-            os << address.GetString();
+            std::array<char, MaxStringSize> buffer;
+            size_t length = address.Format(buffer.data(), buffer.size());
+            os.write(buffer.data(), static_cast<std::streamsize>(length));
             return os;
         }
 
         /**
          * @brief Compares two Address objects for equality.
-         * 
+         *
          * @param other The other Address object to compare with.
          * @return true If the addresses are equal.
          * @return false If the addresses are not equal.
          */
-        inline bool operator==(const Address& other) const
-        {
-            return m_address == other.m_address && m_port == other.m_port;
-        }
+        bool operator==(const Address& other) const;
 
         /**
          * @brief Compares two Address objects for inequality.
-         * 
+         *
          * @param other The other Address object to compare with.
          * @return true If the addresses are not equal.
          * @return false If the addresses are equal.
@@ -133,10 +308,59 @@ namespace MoonlightOBS
             return !(*this == other);
         }
 
+        /**
+         * @brief Orders two Address objects, by type, then address, then scope ID, then port number.
+         *
+         * @param other The other Address object to compare with.
+         * @return true If this address orders before the other address.
+         * @return false If this address doesn't order before the other address.
+         */
+        bool operator<(const Address& other) const;
+
     private:
-        // Hostname or IP address of the connection
-        std::string m_address;
+        // Type of address held
+        Type m_type;
+        // Length of the held hostname, or the IP address in bytes
+        uint8_t m_length;
         // Port number for the connection
         uint16_t m_port;
+        // Scope ID of an IPv6 address
+        uint32_t m_scopeID;
+        // Binary IP address (in network byte order), or hostname
+        union
+        {
+            std::array<uint8_t, 16> m_ip;
+            std::array<char, MaxHostnameLength> m_hostname;
+        };
+
+        // Gets the bytes of the held address
+        inline std::string_view GetBytes() const
+        {
+            return std::string_view(m_hostname.data(), m_length);
+        }
+
+        // Parses an IPv4 address (e.g. "192.168.0.1")
+        static bool ParseIPv4(std::string_view text, uint8_t* bytes);
+        // Parses an IPv6 address, with an optional scope ID (e.g. "fe80::1%3")
+        static bool ParseIPv6(std::string_view text, uint8_t* bytes, uint32_t& scopeID);
+        // Parses a port number
+        static bool ParsePort(std::string_view text, uint16_t& port);
+        // Checks if text is a valid hostname
+        static bool IsValidHostname(std::string_view text);
+        // Sets the held address from text (an IP address or hostname)
+        bool SetHost(std::string_view text);
     };
 } // namespace MoonlightOBS
+
+/**
+ * @brief Hash of an Address, allowing it to be used as the key of unordered containers.
+ *
+ */
+template <>
+struct std::hash<MoonlightOBS::Address>
+{
+    inline size_t operator()(const MoonlightOBS::Address& address) const noexcept
+    {
+        return address.Hash();
+    }
+};
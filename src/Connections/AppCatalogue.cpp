@@ -0,0 +1,389 @@
+#include "AppCatalogue.hpp"
+
+// STL includes
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+// Qt includes
+#include <QBuffer>
+#include <QByteArray>
+#include <QImage>
+#include <QImageReader>
+
+// OBS Studio includes
+#include <util/base.h>
+#include <util/platform.h>
+
+// Project includes
+#include "../plugin-support.h"
+#include "../Utilities/AssetCache.hpp"
+#include "../Utilities/FileIO.hpp"
+#include "Address.hpp"
+#include "HTTPClient.hpp"
+#include "PairedHost.hpp"
+#include "PairedHostStore.hpp"
+#include "ResponseBuffer.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Name of the box art cache in the configuration directory of the module
+    constexpr const char* BoxArtCacheDirectoryName = "boxart";
+
+    // Maximum number of box art thumbnails kept in memory
+    // (a thumbnail is at most 150x200 pixels, so this is at most about 15 MB)
+    constexpr size_t MaxThumbnails = 128;
+
+    // How long the box art of a host isn't fetched for after it couldn't be reached,
+    // so a host which is offline doesn't hold up the box art of the other hosts
+    constexpr uint64_t UnreachableBackoffNs = 30ull * 1000 * 1000 * 1000;
+
+    // State of the catalogue
+    struct Catalogue
+    {
+        // Guards the members below
+        std::mutex mutex;
+
+        // Apps of each host, keyed by unique ID
+        std::unordered_map<std::string, std::shared_ptr<const AppList>> apps;
+
+        // Box art thumbnails, from most to least recently used, and their positions keyed by "<unique ID>/<app ID>"
+        std::list<std::pair<std::string, QImage>> thumbnails;
+        std::unordered_map<std::string, std::list<std::pair<std::string, QImage>>::iterator> thumbnailIndex;
+
+        // Time until which the box art of each host isn't fetched, keyed by unique ID
+        std::unordered_map<std::string, uint64_t> unreachableUntil;
+
+        // Work for the background thread, the thread itself, and whether it's stopping
+        std::deque<std::function<void()>> tasks;
+        std::condition_variable tasksAvailable;
+        std::thread thread;
+        bool stopping = false;
+
+        // On-disk box art cache (only used by the background thread, which opens it on first use)
+        std::unique_ptr<AssetCache> boxArtCache;
+    };
+
+    Catalogue& GetCatalogue()
+    {
+        static Catalogue catalogue;
+        return catalogue;
+    }
+
+    // Gets the key of an app's box art
+    std::string GetBoxArtKey(std::string_view uniqueID, int appID)
+    {
+        return std::string(uniqueID) + "/" + std::to_string(appID);
+    }
+
+    // Gets the address to reach a paired host at
+    Address GetHostAddress(const PairedHost& host)
+    {
+        Address ipv4Address = host.GetHost().GetIPv4Address();
+        return !ipv4Address.IsEmpty() ? ipv4Address : host.GetHost().GetIPv6Address();
+    }
+
+    // Runs the tasks of the background thread until it's stopped
+    void RunTasks()
+    {
+        os_set_thread_name("moonlight-obs: app catalogue");
+
+        Catalogue& catalogue = GetCatalogue();
+        std::unique_lock<std::mutex> lock(catalogue.mutex);
+        while (true)
+        {
+            catalogue.tasksAvailable.wait(lock, [&catalogue]()
+            {
+                return catalogue.stopping || !catalogue.tasks.empty();
+            });
+            if (catalogue.stopping)
+            {
+                return;
+            }
+
+            std::function<void()> task = std::move(catalogue.tasks.front());
+            catalogue.tasks.pop_front();
+
+            lock.unlock();
+            try
+            {
+                task();
+            }
+            catch (const std::exception& exception)
+            {
+                obs_log(LOG_WARNING, "App catalogue task failed: %s", exception.what());
+            }
+            lock.lock();
+        }
+    }
+
+    // Queues a task for the background thread, starting it if necessary
+    void QueueTask(std::function<void()> task)
+    {
+        Catalogue& catalogue = GetCatalogue();
+        std::lock_guard<std::mutex> lock(catalogue.mutex);
+
+        if (catalogue.stopping)
+        {
+            return;
+        }
+
+        catalogue.tasks.push_back(std::move(task));
+        if (!catalogue.thread.joinable())
+        {
+            catalogue.thread = std::thread(RunTasks);
+        }
+        catalogue.tasksAvailable.notify_one();
+    }
+
+    // Decodes box art into a thumbnail
+    QImage DecodeBoxArt(std::string_view data)
+    {
+        // The image is read straight from the (memory-mapped) data, without copying it
+        QByteArray bytes = QByteArray::fromRawData(data.data(), static_cast<int>(data.size()));
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::ReadOnly);
+
+        // Decode straight to the size of the thumbnail
+        QImageReader reader(&buffer, "png");
+        QSize size = reader.size();
+        if (size.isValid())
+        {
+            reader.setScaledSize(size.scaled(AppCatalogue::BoxArtWidth, AppCatalogue::BoxArtHeight, Qt::KeepAspectRatio));
+        }
+
+        // Premultiplied images are drawn without converting them first
+        return reader.read().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+
+    // Finds a thumbnail in memory, marking it as the most recently used
+    std::optional<QImage> FindThumbnail(Catalogue& catalogue, const std::string& key)
+    {
+        auto position = catalogue.thumbnailIndex.find(key);
+        if (position == catalogue.thumbnailIndex.end())
+        {
+            return std::nullopt;
+        }
+
+        catalogue.thumbnails.splice(catalogue.thumbnails.begin(), catalogue.thumbnails, position->second);
+        return position->second->second;
+    }
+
+    // Adds a thumbnail to memory, dropping the least recently used thumbnail if there are too many
+    void AddThumbnail(Catalogue& catalogue, const std::string& key, const QImage& image)
+    {
+        if (catalogue.thumbnailIndex.count(key) != 0)
+        {
+            return;
+        }
+
+        catalogue.thumbnails.emplace_front(key, image);
+        catalogue.thumbnailIndex.emplace(key, catalogue.thumbnails.begin());
+
+        if (catalogue.thumbnails.size() > MaxThumbnails)
+        {
+            catalogue.thumbnailIndex.erase(catalogue.thumbnails.back().first);
+            catalogue.thumbnails.pop_back();
+        }
+    }
+
+    // Decodes the box art of an app from the disk cache, or fetches it from the host,
+    // returning a null image if the host has no box art for the app or can't be reached
+    QImage LoadBoxArtImage(Catalogue& catalogue, const std::string& uniqueID, int appID, const std::string& key)
+    {
+        if (catalogue.boxArtCache == nullptr)
+        {
+            catalogue.boxArtCache = std::make_unique<AssetCache>(FileIO::GetConfigPath(BoxArtCacheDirectoryName),
+                AppCatalogue::MaxBoxArtCacheSize);
+        }
+
+        std::unique_ptr<MappedFile> cachedFile = catalogue.boxArtCache->Get(key);
+        if (cachedFile != nullptr)
+        {
+            return DecodeBoxArt(cachedFile->GetView());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(catalogue.mutex);
+            auto unreachableUntil = catalogue.unreachableUntil.find(uniqueID);
+            if (unreachableUntil != catalogue.unreachableUntil.end() && os_gettime_ns() < unreachableUntil->second)
+            {
+                return QImage();
+            }
+        }
+
+        std::optional<PairedHost> host = PairedHostStore::Find(uniqueID);
+        if (!host.has_value())
+        {
+            return QImage();
+        }
+
+        // Only failing to reach the host holds up the box art of its other apps
+        HTTPClient client(GetHostAddress(*host), *host);
+        ResponseBuffer::Pointer boxArt;
+        try
+        {
+            boxArt = client.GetAppAsset(appID);
+        }
+        catch (const std::exception& exception)
+        {
+            obs_log(LOG_WARNING, "Failed to fetch box art of app %d: %s", appID, exception.what());
+
+            std::lock_guard<std::mutex> lock(catalogue.mutex);
+            catalogue.unreachableUntil[uniqueID] = os_gettime_ns() + UnreachableBackoffNs;
+            return QImage();
+        }
+
+        if (boxArt == nullptr)
+        {
+            obs_log(LOG_INFO, "Host has no box art for app %d", appID);
+            return QImage();
+        }
+
+        try
+        {
+            catalogue.boxArtCache->Put(key, boxArt->GetView());
+        }
+        catch (const std::exception& exception)
+        {
+            obs_log(LOG_WARNING, "Failed to cache box art of app %d: %s", appID, exception.what());
+        }
+
+        return DecodeBoxArt(boxArt->GetView());
+    }
+
+    // Loads the box art of an app on the background thread, calling back with a null image if it fails
+    void LoadBoxArtTask(const std::string& uniqueID, int appID, const AppCatalogue::BoxArtCallback& callback)
+    {
+        Catalogue& catalogue = GetCatalogue();
+        std::string key = GetBoxArtKey(uniqueID, appID);
+
+        // The thumbnail may have been loaded by an earlier request since this one was queued
+        std::optional<QImage> thumbnail;
+        {
+            std::lock_guard<std::mutex> lock(catalogue.mutex);
+            thumbnail = FindThumbnail(catalogue, key);
+        }
+        if (thumbnail.has_value())
+        {
+            callback(appID, *thumbnail);
+            return;
+        }
+
+        QImage image;
+        try
+        {
+            image = LoadBoxArtImage(catalogue, uniqueID, appID, key);
+        }
+        catch (const std::exception& exception)
+        {
+            obs_log(LOG_WARNING, "Failed to load box art of app %d: %s", appID, exception.what());
+        }
+
+        if (!image.isNull())
+        {
+            std::lock_guard<std::mutex> lock(catalogue.mutex);
+            AddThumbnail(catalogue, key, image);
+        }
+
+        callback(appID, image);
+    }
+
+    // Fetches the apps of a host on the background thread
+    void RefreshTask(const std::string& uniqueID, const AppCatalogue::AppsCallback& onChanged)
+    {
+        std::optional<PairedHost> host = PairedHostStore::Find(uniqueID);
+        if (!host.has_value())
+        {
+            return;
+        }
+
+        std::shared_ptr<const AppList> apps = std::make_shared<const AppList>(
+            HTTPClient(GetHostAddress(*host), *host).GetAppList());
+
+        // Only publish the apps if they've changed, so the callers don't rebuild their lists needlessly
+        Catalogue& catalogue = GetCatalogue();
+        {
+            std::lock_guard<std::mutex> lock(catalogue.mutex);
+
+            std::shared_ptr<const AppList>& cachedApps = catalogue.apps[uniqueID];
+            if (cachedApps != nullptr && *cachedApps == *apps)
+            {
+                return;
+            }
+            cachedApps = apps;
+        }
+
+        onChanged(apps);
+    }
+}
+
+std::shared_ptr<const AppList> AppCatalogue::GetApps(std::string_view uniqueID)
+{
+    Catalogue& catalogue = GetCatalogue();
+    std::lock_guard<std::mutex> lock(catalogue.mutex);
+
+    auto apps = catalogue.apps.find(std::string(uniqueID));
+    return apps != catalogue.apps.end() ? apps->second : nullptr;
+}
+
+void AppCatalogue::Refresh(std::string_view uniqueID, AppsCallback onChanged)
+{
+    QueueTask([uniqueID = std::string(uniqueID), onChanged = std::move(onChanged)]()
+    {
+        RefreshTask(uniqueID, onChanged);
+    });
+}
+
+void AppCatalogue::LoadBoxArt(std::string_view uniqueID, int appID, BoxArtCallback callback)
+{
+    // Thumbnails in memory are returned immediately, without waiting for the background thread
+    std::optional<QImage> thumbnail;
+    {
+        Catalogue& catalogue = GetCatalogue();
+        std::lock_guard<std::mutex> lock(catalogue.mutex);
+        thumbnail = FindThumbnail(catalogue, GetBoxArtKey(uniqueID, appID));
+    }
+    if (thumbnail.has_value())
+    {
+        callback(appID, *thumbnail);
+        return;
+    }
+
+    QueueTask([uniqueID = std::string(uniqueID), appID, callback = std::move(callback)]()
+    {
+        LoadBoxArtTask(uniqueID, appID, callback);
+    });
+}
+
+void AppCatalogue::Shutdown()
+{
+    Catalogue& catalogue = GetCatalogue();
+    {
+        std::lock_guard<std::mutex> lock(catalogue.mutex);
+        catalogue.stopping = true;
+        catalogue.tasks.clear();
+    }
+    catalogue.tasksAvailable.notify_all();
+
+    if (catalogue.thread.joinable())
+    {
+        catalogue.thread.join();
+    }
+
+    // Saves the index of the cache
+    catalogue.boxArtCache.reset();
+}
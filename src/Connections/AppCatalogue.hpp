@@ -0,0 +1,102 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+// Project includes
+#include "AppInfo.hpp"
+
+// Forward declarations
+class QImage;
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Static helper class which caches the apps of the paired GameStream hosts and their box art.
+     *
+     * The app list of each host is kept in memory, so it can be shown instantly while it's
+     * refreshed in the background, and only reported again if it has changed. Box art is kept
+     * in a size-bounded on-disk cache (so it's never fetched again once it has been seen),
+     * and decoded by a background thread into thumbnails which are kept in memory, so each
+     * image can be shown as soon as it's ready, and instantly the next time it's needed.
+     *
+     */
+    class AppCatalogue
+    {
+    public:
+        /**
+         * @brief Called with the apps of a host.
+         *
+         */
+        using AppsCallback = std::function<void(std::shared_ptr<const AppList> apps)>;
+
+        /**
+         * @brief Called with the box art thumbnail of an app, or a null image if it couldn't be loaded.
+         *
+         */
+        using BoxArtCallback = std::function<void(int appID, const QImage& image)>;
+
+        /**
+         * @brief The size box art thumbnails are scaled to fit within.
+         *
+         */
+        static constexpr int BoxArtWidth    = 150;
+        static constexpr int BoxArtHeight   = 200;
+
+        /**
+         * @brief The maximum size of the on-disk box art cache, in bytes.
+         *
+         */
+        static constexpr uint64_t MaxBoxArtCacheSize = 64 * 1024 * 1024;
+
+        /**
+         * @brief Gets the cached apps of a host.
+         * @note Never blocks on the network.
+         *
+         * @param uniqueID The unique ID of the paired host.
+         * @return std::shared_ptr<const AppList> The apps of the host, or null if they haven't been fetched yet.
+         */
+        static std::shared_ptr<const AppList> GetApps(std::string_view uniqueID);
+
+        /**
+         * @brief Fetches the apps of a host in the background.
+         * @note The callback is called on the background thread, and only if the apps have changed
+         *       (including if they hadn't been fetched before).
+         *
+         * @param uniqueID The unique ID of the paired host.
+         * @param onChanged Called with the apps of the host if they've changed.
+         */
+        static void Refresh(std::string_view uniqueID, AppsCallback onChanged);
+
+        /**
+         * @brief Loads the box art of an app, from memory, disk or the host.
+         * @note If the thumbnail is in memory, the callback is called immediately on the calling thread.
+         *       Otherwise it's called on the background thread once the image has been decoded, or
+         *       with a null image if the host has no box art for the app or can't be reached.
+         *
+         * @param uniqueID The unique ID of the paired host.
+         * @param appID The ID of the app.
+         * @param callback Called with the box art thumbnail.
+         */
+        static void LoadBoxArt(std::string_view uniqueID, int appID, BoxArtCallback callback);
+
+        /**
+         * @brief Stops the background thread, discarding any pending work, and saves the box art cache.
+         * @note Should be called before the module is unloaded.
+         *
+         */
+        static void Shutdown();
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        AppCatalogue()                                  = delete;
+        AppCatalogue(const AppCatalogue&)               = delete;
+        AppCatalogue& operator=(const AppCatalogue&)    = delete;
+        ~AppCatalogue()                                 = delete;
+    };
+} // namespace MoonlightOBS
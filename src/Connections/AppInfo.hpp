@@ -0,0 +1,35 @@
+#pragma once
+
+// STL includes
+#include <string>
+#include <vector>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief An app which can be launched on a GameStream host, as listed by its /applist.
+     *
+     */
+    struct AppInfo
+    {
+        int id                  = 0;        // ID of the app, used to launch it and fetch its box art
+        std::string title;                  // Title of the app
+        bool hdrSupported       = false;    // Can the app be streamed in HDR?
+
+        inline bool operator==(const AppInfo& other) const
+        {
+            return id == other.id && hdrSupported == other.hdrSupported && title == other.title;
+        }
+
+        inline bool operator!=(const AppInfo& other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    /**
+     * @brief The apps of a GameStream host, in the order the host lists them.
+     *
+     */
+    using AppList = std::vector<AppInfo>;
+} // namespace MoonlightOBS
@@ -0,0 +1,122 @@
+#include "AppListParser.hpp"
+
+// STL includes
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using namespace MoonlightOBS;
+
+AppListParser::AppListParser()
+    : m_apps(), m_currentField(Field::None), m_hasID(false), m_hasTitle(false), m_value(), m_valueLength(0) {}
+
+AppList AppListParser::Finish()
+{
+    FinishResponse();
+
+    return std::move(m_apps);
+}
+
+void AppListParser::OnStartElement(std::string_view name, size_t depth)
+{
+    // Each app is an "App" element within the root element
+    if (depth == 1)
+    {
+        if (name == "App")
+        {
+            m_apps.emplace_back();
+            m_hasID     = false;
+            m_hasTitle  = false;
+        }
+        return;
+    }
+
+    // The fields of an app are the elements within it
+    m_currentField = Field::None;
+    m_valueLength  = 0;
+    if (depth != 2 || m_apps.empty())
+    {
+        return;
+    }
+
+    if (name == "ID")
+    {
+        m_currentField = Field::ID;
+    }
+    else if (name == "AppTitle")
+    {
+        m_currentField = Field::Title;
+        m_apps.back().title.clear();
+    }
+    else if (name == "IsHdrSupported")
+    {
+        m_currentField = Field::HDRSupported;
+    }
+}
+
+void AppListParser::OnText(std::string_view text, size_t depth)
+{
+    if (depth != 2 || m_currentField == Field::None)
+    {
+        return;
+    }
+
+    if (m_currentField == Field::Title)
+    {
+        m_apps.back().title.append(text);
+    }
+    else if (text.size() <= m_value.size() - m_valueLength)
+    {
+        text.copy(m_value.data() + m_valueLength, text.size());
+        m_valueLength += text.size();
+    }
+    else
+    {
+        throw std::invalid_argument("XML parsing error: Element value is too long");
+    }
+}
+
+void AppListParser::OnEndElement(std::string_view name, size_t depth)
+{
+    // Ensure each app can be launched and displayed
+    if (depth == 1 && name == "App" && (!m_hasID || !m_hasTitle))
+    {
+        throw std::invalid_argument("XML parsing error: App is missing its ID or title");
+    }
+    else if (depth != 2 || m_currentField == Field::None)
+    {
+        return;
+    }
+
+    AppInfo& app = m_apps.back();
+    std::string_view value(m_value.data(), m_valueLength);
+    switch (m_currentField)
+    {
+        case Field::ID:
+        {
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), app.id);
+            if (error != std::errc() || end != value.data() + value.size())
+            {
+                throw std::invalid_argument("XML parsing error: Invalid app ID '" + std::string(value) + "'");
+            }
+
+            m_hasID = true;
+            break;
+        }
+
+        case Field::Title:
+            m_hasTitle = !app.title.empty();
+            break;
+
+        case Field::HDRSupported:
+            app.hdrSupported = value == "1";
+            break;
+
+        default:
+            break;
+    }
+
+    m_currentField = Field::None;
+}
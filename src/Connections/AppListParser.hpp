@@ -0,0 +1,68 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Project includes
+#include "AppInfo.hpp"
+#include "ResponseParser.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Streaming parser for the /applist response of a GameStream host.
+     *
+     * Each "App" element within the root element is parsed into an AppInfo
+     * as it's received, without building a document tree.
+     *
+     */
+    class AppListParser final : public ResponseParser
+    {
+    public:
+        /**
+         * @brief Construct a new AppListParser object.
+         *
+         */
+        AppListParser();
+
+        /**
+         * @brief Completes parsing of the response.
+         * @exception std::invalid_argument If the response is incomplete, or an app is missing its ID or title.
+         * @exception std::runtime_error If the host reported that the request failed.
+         *
+         * @return AppList The apps parsed from the response.
+         */
+        AppList Finish();
+
+    private:
+        // Elements of an app which are parsed
+        enum class Field : uint8_t
+        {
+            None,
+            ID,
+            Title,
+            HDRSupported
+        };
+
+        // Apps parsed so far
+        AppList m_apps;
+
+        // Element of the current app being parsed
+        Field m_currentField;
+        // Have the ID and title of the current app been parsed?
+        bool m_hasID;
+        bool m_hasTitle;
+
+        // Text of the current element, for elements which aren't parsed directly into a string
+        std::array<char, 16> m_value;
+        size_t m_valueLength;
+
+        // XMLStreamReader::Handler implementation
+        void OnStartElement(std::string_view name, size_t depth) override;
+        void OnText(std::string_view text, size_t depth) override;
+        void OnEndElement(std::string_view name, size_t depth) override;
+    };
+} // namespace MoonlightOBS
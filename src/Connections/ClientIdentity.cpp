@@ -0,0 +1,259 @@
+#include "ClientIdentity.hpp"
+
+// STL includes
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+// OpenSSL includes
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+
+// Platform includes
+// (NOMINMAX is defined first, so the Windows headers don't define min and max as macros)
+#if defined(_WIN32) || defined(_WIN64)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#elif defined(__APPLE__)
+  #include <pthread.h>
+#else
+  #include <sys/resource.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+// OBS Studio includes
+#include <util/base.h>
+#include <util/platform.h>
+
+// Project includes
+#include "../plugin-support.h"
+#include "../Utilities/FileIO.hpp"
+#include "../Utilities/OpenSSLPointer.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Names of the identity files in the configuration directory of the module
+    constexpr const char* CertificateFileName   = "client.pem";
+    constexpr const char* PrivateKeyFileName    = "client.key";
+
+    // Parameters of the generated identity (matching those used by other Moonlight clients)
+    constexpr int KeyBits                       = 2048;
+    constexpr long CertificateLifetimeSeconds   = 20L * 365 * 24 * 60 * 60;
+    constexpr const char* CertificateCommonName = "NVIDIA GameStream Client";
+
+    // Background thread loading the identity, and the identity it produces
+    std::mutex g_mutex;
+    std::thread g_thread;
+    std::shared_future<std::shared_ptr<const ClientIdentity>> g_identity;
+
+    // Lowers the priority of the calling thread, so it doesn't compete with OBS
+    void LowerCurrentThreadPriority()
+    {
+#if defined(_WIN32) || defined(_WIN64)
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__APPLE__)
+        pthread_set_qos_class_self_np(QOS_CLASS_UTILITY, 0);
+#else
+        // On Linux, the nice value applies to the thread rather than the whole process
+        setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+    }
+
+    // Writes a PEM-encoded object to a string
+    template <typename Writer>
+    std::string WritePEM(Writer writer)
+    {
+        OpenSSLPointer<BIO> bio(BIO_new(BIO_s_mem()));
+        if (bio == nullptr || writer(bio.get()) != 1)
+        {
+            throw std::runtime_error("Failed to encode the client identity");
+        }
+
+        char* data = nullptr;
+        long length = BIO_get_mem_data(bio.get(), &data);
+        return std::string(data, static_cast<size_t>(length));
+    }
+
+    // Creates a read-only memory BIO over a string
+    OpenSSLPointer<BIO> ReadBIO(std::string_view data)
+    {
+        return OpenSSLPointer<BIO>(BIO_new_mem_buf(data.data(), static_cast<int>(data.size())));
+    }
+}
+
+ClientIdentity::ClientIdentity(std::string certificate, std::string privateKey)
+    : m_certificate(std::move(certificate)), m_privateKey(std::move(privateKey)) {}
+
+void ClientIdentity::LoadInBackground()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    if (g_identity.valid())
+    {
+        return;
+    }
+
+    std::packaged_task<std::shared_ptr<const ClientIdentity>()> task([]()
+    {
+        os_set_thread_name("moonlight-obs: client identity");
+        LowerCurrentThreadPriority();
+
+        return LoadOrGenerate();
+    });
+    g_identity = task.get_future().share();
+    g_thread = std::thread(std::move(task));
+}
+
+void ClientIdentity::WaitForBackgroundThread()
+{
+    std::lock_guard<std::mutex> lock(g_mutex);
+
+    if (g_thread.joinable())
+    {
+        g_thread.join();
+    }
+}
+
+std::shared_ptr<const ClientIdentity> ClientIdentity::Get()
+{
+    LoadInBackground();
+
+    std::shared_future<std::shared_ptr<const ClientIdentity>> identity;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        identity = g_identity;
+    }
+
+    // Rethrows the exception if the identity could not be loaded
+    return identity.get();
+}
+
+std::shared_ptr<const ClientIdentity> ClientIdentity::LoadOrGenerate()
+{
+    std::string certificatePath = FileIO::GetConfigPath(CertificateFileName);
+    std::string privateKeyPath = FileIO::GetConfigPath(PrivateKeyFileName);
+
+    try
+    {
+        std::shared_ptr<const ClientIdentity> identity = Load(certificatePath, privateKeyPath);
+        if (identity != nullptr)
+        {
+            obs_log(LOG_INFO, "Loaded client identity");
+            return identity;
+        }
+    }
+    catch (const std::exception& exception)
+    {
+        obs_log(LOG_WARNING, "Failed to load client identity, generating a new one: %s", exception.what());
+    }
+
+    uint64_t startTime = os_gettime_ns();
+    std::shared_ptr<const ClientIdentity> identity = Generate();
+    obs_log(LOG_INFO, "Generated client identity in %llu ms",
+        static_cast<unsigned long long>((os_gettime_ns() - startTime) / 1000000));
+
+    // Save the private key first, as a certificate without its key is useless
+    // (if saving fails, the identity is still used for the rest of this session)
+    try
+    {
+        FileIO::WriteAtomically(privateKeyPath, identity->GetPrivateKey());
+        FileIO::WriteAtomically(certificatePath, identity->GetCertificate());
+    }
+    catch (const std::exception& exception)
+    {
+        obs_log(LOG_ERROR, "Failed to save client identity: %s", exception.what());
+    }
+
+    return identity;
+}
+
+std::shared_ptr<const ClientIdentity> ClientIdentity::Load(const std::string& certificatePath,
+    const std::string& privateKeyPath)
+{
+    MappedFile certificateFile(certificatePath);
+    MappedFile privateKeyFile(privateKeyPath);
+    if (!certificateFile.Exists() || !privateKeyFile.Exists())
+    {
+        return nullptr;
+    }
+
+    // Ensure the files hold a certificate and its private key
+    OpenSSLPointer<BIO> certificateBIO = ReadBIO(certificateFile.GetView());
+    OpenSSLPointer<BIO> privateKeyBIO = ReadBIO(privateKeyFile.GetView());
+    if (certificateBIO == nullptr || privateKeyBIO == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    OpenSSLPointer<X509> certificate(PEM_read_bio_X509(certificateBIO.get(), nullptr, nullptr, nullptr));
+    OpenSSLPointer<EVP_PKEY> privateKey(PEM_read_bio_PrivateKey(privateKeyBIO.get(), nullptr, nullptr, nullptr));
+    if (certificate == nullptr || privateKey == nullptr || X509_check_private_key(certificate.get(), privateKey.get()) != 1)
+    {
+        throw std::runtime_error("Identity files are invalid");
+    }
+
+    return std::shared_ptr<const ClientIdentity>(new ClientIdentity(
+        std::string(certificateFile.GetView()), std::string(privateKeyFile.GetView())));
+}
+
+std::shared_ptr<const ClientIdentity> ClientIdentity::Generate()
+{
+    // Generate the RSA keypair
+    OpenSSLPointer<EVP_PKEY_CTX> context(EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, nullptr));
+    EVP_PKEY* generatedKey = nullptr;
+    if (context == nullptr || EVP_PKEY_keygen_init(context.get()) != 1 ||
+        EVP_PKEY_CTX_set_rsa_keygen_bits(context.get(), KeyBits) != 1 ||
+        EVP_PKEY_keygen(context.get(), &generatedKey) != 1)
+    {
+        throw std::runtime_error("Failed to generate the client keypair");
+    }
+    OpenSSLPointer<EVP_PKEY> key(generatedKey);
+
+    // Create the self-signed certificate
+    OpenSSLPointer<X509> certificate(X509_new());
+    if (certificate == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    X509_NAME* name = X509_get_subject_name(certificate.get());
+    bool succeeded =
+        X509_set_version(certificate.get(), 2) == 1 &&
+        ASN1_INTEGER_set(X509_get_serialNumber(certificate.get()), 0) == 1 &&
+        X509_gmtime_adj(X509_getm_notBefore(certificate.get()), 0) != nullptr &&
+        X509_gmtime_adj(X509_getm_notAfter(certificate.get()), CertificateLifetimeSeconds) != nullptr &&
+        X509_set_pubkey(certificate.get(), key.get()) == 1 &&
+        X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+            reinterpret_cast<const unsigned char*>(CertificateCommonName), -1, -1, 0) == 1 &&
+        X509_set_issuer_name(certificate.get(), name) == 1 &&
+        X509_sign(certificate.get(), key.get(), EVP_sha256()) > 0;
+    if (!succeeded)
+    {
+        throw std::runtime_error("Failed to create the client certificate");
+    }
+
+    std::string certificatePEM = WritePEM([&certificate](BIO* bio)
+    {
+        return PEM_write_bio_X509(bio, certificate.get());
+    });
+    std::string privateKeyPEM = WritePEM([&key](BIO* bio)
+    {
+        return PEM_write_bio_PrivateKey(bio, key.get(), nullptr, nullptr, 0, nullptr, nullptr);
+    });
+
+    return std::shared_ptr<const ClientIdentity>(new ClientIdentity(std::move(certificatePEM), std::move(privateKeyPEM)));
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+// STL includes
+#include <memory>
+#include <string>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief The RSA keypair and self-signed certificate which identify this
+     *        installation to GameStream hosts when pairing.
+     *
+     * The identity is generated once per installation and kept in the configuration
+     * directory of the module. Generating an RSA key takes long enough to be noticed,
+     * so it's loaded (or generated) by a low-priority background thread started when
+     * the module loads, and pairing only waits for it if it hasn't finished yet.
+     *
+     */
+    class ClientIdentity
+    {
+    public:
+        /**
+         * @brief Starts loading (or generating) the identity on a low-priority background thread.
+         * @note Does nothing if the identity has already started loading.
+         *
+         */
+        static void LoadInBackground();
+
+        /**
+         * @brief Waits for the background thread to finish, so the module can be unloaded.
+         *
+         */
+        static void WaitForBackgroundThread();
+
+        /**
+         * @brief Gets the identity, waiting for it to be loaded if necessary.
+         * @note Starts loading the identity if LoadInBackground hasn't been called.
+         *
+         * @return std::shared_ptr<const ClientIdentity> The identity.
+         *
+         * @exception std::runtime_error If the identity could not be loaded or generated.
+         */
+        static std::shared_ptr<const ClientIdentity> Get();
+
+        /**
+         * @brief Gets the certificate of the client.
+         *
+         * @return const std::string& The PEM-encoded X.509 certificate.
+         */
+        inline const std::string& GetCertificate() const
+        {
+            return m_certificate;
+        }
+
+        /**
+         * @brief Gets the private key of the client.
+         *
+         * @return const std::string& The PEM-encoded (PKCS #8) RSA private key.
+         */
+        inline const std::string& GetPrivateKey() const
+        {
+            return m_privateKey;
+        }
+
+    private:
+        // PEM-encoded certificate and private key
+        std::string m_certificate;
+        std::string m_privateKey;
+
+        ClientIdentity(std::string certificate, std::string privateKey);
+
+        // Loads the identity from the configuration directory, generating and saving it if necessary
+        static std::shared_ptr<const ClientIdentity> LoadOrGenerate();
+        // Loads the identity from files, returning null if they don't hold a valid identity
+        static std::shared_ptr<const ClientIdentity> Load(const std::string& certificatePath,
+            const std::string& privateKeyPath);
+        // Generates a new identity
+        static std::shared_ptr<const ClientIdentity> Generate();
+    };
+} // namespace MoonlightOBS
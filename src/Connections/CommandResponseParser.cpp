@@ -0,0 +1,49 @@
+#include "CommandResponseParser.hpp"
+
+// STL includes
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using namespace MoonlightOBS;
+
+void CommandResponseParser::Finish()
+{
+    FinishResponse();
+}
+
+std::optional<std::string_view> CommandResponseParser::GetValue(std::string_view name) const
+{
+    for (const std::pair<std::string, std::string>& value : m_values)
+    {
+        if (value.first == name)
+        {
+            return std::string_view(value.second);
+        }
+    }
+
+    return std::nullopt;
+}
+
+void CommandResponseParser::OnStartElement(std::string_view name, size_t depth)
+{
+    if (depth == 1)
+    {
+        m_values.emplace_back(std::string(name), std::string());
+    }
+}
+
+void CommandResponseParser::OnText(std::string_view text, size_t depth)
+{
+    if (depth == 1)
+    {
+        m_values.back().second.append(text);
+    }
+}
+
+void CommandResponseParser::OnEndElement(std::string_view name, size_t depth)
+{
+    (void)name;
+    (void)depth;
+}
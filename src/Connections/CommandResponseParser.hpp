@@ -0,0 +1,59 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Project includes
+#include "ResponseParser.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Streaming parser for the responses of the commands sent to a GameStream host
+     *        (such as /launch, /resume and /cancel).
+     *
+     * These responses only hold a few elements directly within the root element
+     * (e.g. "<gamesession>1</gamesession>"), whose text is collected by name.
+     *
+     */
+    class CommandResponseParser final : public ResponseParser
+    {
+    public:
+        /**
+         * @brief Construct a new CommandResponseParser object.
+         *
+         */
+        CommandResponseParser() = default;
+
+        /**
+         * @brief Completes parsing of the response.
+         * @exception std::invalid_argument If the response is incomplete.
+         * @exception std::runtime_error If the host reported that the command failed.
+         *
+         */
+        void Finish();
+
+        /**
+         * @brief Gets the text of an element within the root element.
+         *
+         * @param name The name of the element.
+         * @return std::optional<std::string_view> The text of the first element with the name,
+         *         or nothing if the response doesn't contain it.
+         */
+        std::optional<std::string_view> GetValue(std::string_view name) const;
+
+    private:
+        // Names and text of the elements within the root element, in the order they were read
+        std::vector<std::pair<std::string, std::string>> m_values;
+
+        // XMLStreamReader::Handler implementation
+        void OnStartElement(std::string_view name, size_t depth) override;
+        void OnText(std::string_view text, size_t depth) override;
+        void OnEndElement(std::string_view name, size_t depth) override;
+    };
+} // namespace MoonlightOBS
@@ -46,7 +46,7 @@ namespace MoonlightOBS
          */
         inline static GameStreamHost FromIPv4(std::string_view hostname, Address ipv4Address)
         {
-            return GameStreamHost(hostname, ipv4Address, Address("", 0));
+            return GameStreamHost(hostname, ipv4Address, Address::GetEmpty());
         }
 
         /**
@@ -58,7 +58,7 @@ namespace MoonlightOBS
          */
         inline static GameStreamHost FromIPv6(std::string_view hostname, Address ipv6Address)
         {
-            return GameStreamHost(hostname, Address("", 0), ipv6Address);
+            return GameStreamHost(hostname, Address::GetEmpty(), ipv6Address);
         }
         
         /**
@@ -69,7 +69,7 @@ namespace MoonlightOBS
          */
         inline static GameStreamHost FromHostname(std::string_view hostname)
         {
-            return GameStreamHost(hostname, Address("", 0), Address("", 0));
+            return GameStreamHost(hostname, Address::GetEmpty(), Address::GetEmpty());
         }
 
         /**
@@ -120,7 +120,7 @@ namespace MoonlightOBS
          */
         inline bool HasIPv6Address() const
         {
-            return m_ipv6Address.GetPortNumber() != 0;
+            return m_ipv6Address.IsIPv6();
         }
 
         /**
@@ -151,8 +151,7 @@ namespace MoonlightOBS
          */
         inline bool IsValid() const
         {
-            return !m_hostname.empty() && (m_ipv4Address.GetPortNumber() != 0 
-                || m_ipv6Address.GetPortNumber() != 0);
+            return !m_hostname.empty() && (m_ipv4Address.IsValid() || m_ipv6Address.IsValid());
         }
         
         /**
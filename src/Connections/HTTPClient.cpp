@@ -1,8 +1,18 @@
 #include "HTTPClient.hpp"
 
 // STL includes
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 // libcurl includes
 #include <curl/curl.h>
@@ -28,18 +38,219 @@
   #endif
 #endif
 
+// OpenSSL includes
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/rand.h>
+#include <openssl/x509.h>
+
 // OBS Studio includes
 #include <util/base.h>
 
 // Project includes
 #include "../plugin-support.h"
+#include "../Utilities/OpenSSLPointer.hpp"
 #include "Address.hpp"
+#include "AppListParser.hpp"
+#include "ClientIdentity.hpp"
+#include "CommandResponseParser.hpp"
 #include "HostSettings.hpp"
+#include "PairedHost.hpp"
+#include "ResponseBuffer.hpp"
+#include "ServerInfoParser.hpp"
 
 using namespace MoonlightOBS;
 
+/**
+ * @brief TLS sessions and DNS results shared by the clients of a paired host.
+ *
+ * Sharing the TLS session cache lets every request after the first resume the session
+ * with an abbreviated handshake (skipping the certificate exchange and RSA operations).
+ * The connection cache isn't shared, as libcurl doesn't support sharing connections
+ * between handles used on different threads at the same time, which the clients of
+ * a host are (such as the app list refreshing while a stream starts).
+ *
+ */
+struct HTTPClient::HostSession
+{
+    // libcurl share handle
+    CURLSH* share;
+    // PEM certificate of the host which the session is pinned to
+    std::string certificate;
+    // Pinned public key of the host, in the format of CURLOPT_PINNEDPUBLICKEY
+    std::string pinnedPublicKey;
+    // Locks for each kind of data shared between the clients
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> locks;
+
+    explicit HostSession(std::string_view serverCertificate);
+    ~HostSession();
+
+    HostSession(const HostSession&)             = delete;
+    HostSession& operator=(const HostSession&)  = delete;
+};
+
+namespace
+{
+    // Unique ID sent by Moonlight clients
+    // (hosts identify paired clients by their certificates, so every client sends the same ID)
+    constexpr std::string_view ClientUniqueID = "0123456789ABCDEF";
+
+    // Default HTTPS port of GameStream hosts, for settings which don't provide one
+    constexpr uint16_t DefaultHTTPSPort = 47984;
+
+    // How long to wait for a connection to a host to be established
+    // (an unreachable address otherwise holds up requests for the system's TCP timeout)
+    constexpr long ConnectTimeoutMs = 3000;
+
+    // Sessions of the paired hosts, keyed by their unique IDs
+    // (type-erased, as the session type is private to the client)
+    struct SessionTable
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<void>> sessions;
+    };
+
+    SessionTable& GetSessionTable()
+    {
+        static SessionTable table;
+        return table;
+    }
+
+    // Sets an option of a libcurl handle
+    template <typename T>
+    void SetOption(CURL* curl, CURLoption option, T value, const char* description)
+    {
+        CURLcode statusCode = curl_easy_setopt(curl, option, value);
+        if (statusCode != CURLE_OK)
+        {
+            throw std::runtime_error("Failed to set " + std::string(description) + ": " +
+                std::string(curl_easy_strerror(statusCode)));
+        }
+    }
+
+    // Aborts a transfer once its cancel flag is set
+    // (libcurl calls this at least once a second, even while waiting for the host)
+    int CURLProgressCallback(void* clientp, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+    {
+        const std::atomic<bool>* cancelled = static_cast<const std::atomic<bool>*>(clientp);
+        return cancelled->load() ? 1 : 0;
+    }
+
+    // Appends bytes to a string as lowercase hexadecimal
+    void AppendHex(std::string& string, const uint8_t* data, size_t size)
+    {
+        constexpr std::string_view digits = "0123456789abcdef";
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            string.push_back(digits[data[i] >> 4]);
+            string.push_back(digits[data[i] & 0x0F]);
+        }
+    }
+
+    // Appends the query parameters asking the host to stream in HDR, if it's requested
+    // (the client's display capabilities are left for the host to fill in, as OBS has no display)
+    void AppendHDRMode(std::string& path, const LaunchParameters& parameters)
+    {
+        if (parameters.hdr)
+        {
+            path.append("&hdrMode=1&clientHdrCapVersion=0&clientHdrCapSupportedFlagsInUsecs=0"
+                "&clientHdrCapMetaDataId=NV_STATIC_METADATA_TYPE_1&clientHdrCapDisplayData=0x0x0x0x0x0x0x0x0x0x0");
+        }
+    }
+
+    // Builds the path of a request, with the query parameters identifying the client
+    std::string BuildPath(std::string_view endpoint)
+    {
+        std::array<uint8_t, 16> uuid = {};
+        RAND_bytes(uuid.data(), static_cast<int>(uuid.size()));
+
+        std::string path;
+        path.reserve(endpoint.size() + 96);
+        path.append(endpoint).append("?uniqueid=").append(ClientUniqueID).append("&uuid=");
+        AppendHex(path, uuid.data(), uuid.size());
+
+        return path;
+    }
+
+    // Calculates the pinned public key of a PEM certificate, as the
+    // Base64 SHA-256 hash of its DER-encoded SubjectPublicKeyInfo
+    std::string GetPinnedPublicKey(std::string_view certificatePEM)
+    {
+        OpenSSLPointer<BIO> bio(BIO_new_mem_buf(certificatePEM.data(), static_cast<int>(certificatePEM.size())));
+        if (bio == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+
+        OpenSSLPointer<X509> certificate(PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr));
+        if (certificate == nullptr)
+        {
+            throw std::invalid_argument("The pinned certificate of the host is invalid");
+        }
+
+        unsigned char* publicKey = nullptr;
+        int publicKeyLength = i2d_X509_PUBKEY(X509_get_X509_PUBKEY(certificate.get()), &publicKey);
+        if (publicKeyLength <= 0)
+        {
+            throw std::invalid_argument("The pinned certificate of the host has no public key");
+        }
+
+        std::array<unsigned char, EVP_MAX_MD_SIZE> hash;
+        unsigned int hashLength = 0;
+        int result = EVP_Digest(publicKey, static_cast<size_t>(publicKeyLength), hash.data(), &hashLength, EVP_sha256(), nullptr);
+        OPENSSL_free(publicKey);
+        if (result != 1)
+        {
+            throw std::runtime_error("Failed to hash the public key of the host");
+        }
+
+        // Base64 encoding produces 4 characters for every 3 bytes, plus a null terminator
+        std::array<unsigned char, (EVP_MAX_MD_SIZE + 2) / 3 * 4 + 1> encoded;
+        int encodedLength = EVP_EncodeBlock(encoded.data(), hash.data(), static_cast<int>(hashLength));
+
+        return "sha256//" + std::string(reinterpret_cast<const char*>(encoded.data()), static_cast<size_t>(encodedLength));
+    }
+}
+
+HTTPClient::HostSession::HostSession(std::string_view serverCertificate)
+    : share(curl_share_init()), certificate(serverCertificate), pinnedPublicKey(GetPinnedPublicKey(serverCertificate))
+{
+    if (share == nullptr)
+    {
+        throw std::runtime_error("Failed to initialize libcurl share");
+    }
+
+    // The clients of a host may perform requests from different threads at the same time
+    curl_lock_function lock = [](CURL*, curl_lock_data data, curl_lock_access, void* userptr)
+    {
+        static_cast<HostSession*>(userptr)->locks[data].lock();
+    };
+    curl_unlock_function unlock = [](CURL*, curl_lock_data data, void* userptr)
+    {
+        static_cast<HostSession*>(userptr)->locks[data].unlock();
+    };
+
+    bool succeeded =
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lock) == CURLSHE_OK &&
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlock) == CURLSHE_OK &&
+        curl_share_setopt(share, CURLSHOPT_USERDATA, this) == CURLSHE_OK &&
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION) == CURLSHE_OK &&
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS) == CURLSHE_OK;
+    if (!succeeded)
+    {
+        curl_share_cleanup(share);
+        throw std::runtime_error("Failed to set up libcurl share");
+    }
+}
+
+HTTPClient::HostSession::~HostSession()
+{
+    curl_share_cleanup(share);
+}
+
 HTTPClient::HTTPClient(const Address& address)
-    : m_curl(static_cast<void*>(curl_easy_init())), m_address(address)
+    : m_curl(static_cast<void*>(curl_easy_init())), m_address(address), m_timeoutMs(0), m_cancelled(nullptr)
 {
     // Check if libcurl was initialized successfully
     if (m_curl == nullptr)
@@ -48,9 +259,53 @@ HTTPClient::HTTPClient(const Address& address)
     }
 }
 
+HTTPClient::HTTPClient(const Address& address, const PairedHost& host)
+    : HTTPClient(address)
+{
+    CURL* curl = static_cast<CURL*>(m_curl);
+
+    // Connect to the HTTPS port of the host
+    uint16_t httpsPort = host.GetSettings().GetHTTPSPort();
+    m_address.SetPortNumber(httpsPort != 0 ? httpsPort : DefaultHTTPSPort);
+
+    // Get the session of the host, replacing it if the host has been paired again with a new certificate
+    {
+        SessionTable& table = GetSessionTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+
+        std::shared_ptr<void>& session = table.sessions[std::string(host.GetUniqueID())];
+        m_session = std::static_pointer_cast<HostSession>(session);
+        if (m_session == nullptr || m_session->certificate != host.GetServerCertificate())
+        {
+            m_session = std::make_shared<HostSession>(host.GetServerCertificate());
+            session = m_session;
+        }
+    }
+    SetOption(curl, CURLOPT_SHARE, m_session->share, "shared session");
+
+    // Authenticate with the client certificate
+    // (libcurl copies the blobs, so the identity doesn't need to outlive the client)
+    std::shared_ptr<const ClientIdentity> identity = ClientIdentity::Get();
+    curl_blob certificate = { const_cast<char*>(identity->GetCertificate().data()), identity->GetCertificate().size(),
+        CURL_BLOB_COPY };
+    curl_blob privateKey = { const_cast<char*>(identity->GetPrivateKey().data()), identity->GetPrivateKey().size(),
+        CURL_BLOB_COPY };
+    SetOption(curl, CURLOPT_SSLCERT_BLOB, &certificate, "client certificate");
+    SetOption(curl, CURLOPT_SSLCERTTYPE, "PEM", "client certificate type");
+    SetOption(curl, CURLOPT_SSLKEY_BLOB, &privateKey, "client private key");
+    SetOption(curl, CURLOPT_SSLKEYTYPE, "PEM", "client private key type");
+
+    // Hosts use self-signed certificates which aren't issued for their hostnames,
+    // so the host is verified by the public key pinned when pairing instead of a CA
+    SetOption(curl, CURLOPT_PINNEDPUBLICKEY, m_session->pinnedPublicKey.c_str(), "pinned public key");
+    SetOption(curl, CURLOPT_SSL_VERIFYPEER, 0L, "peer verification");
+    SetOption(curl, CURLOPT_SSL_VERIFYHOST, 0L, "host verification");
+}
+
 HTTPClient::~HTTPClient()
 {
     // Clean up the libcurl handle
+    // (before the shared session is released, as it can't be cleaned up while in use)
     if (m_curl != nullptr)
     {
         curl_easy_cleanup(static_cast<CURL*>(m_curl));
@@ -58,46 +313,193 @@ HTTPClient::~HTTPClient()
     }
 }
 
+void HTTPClient::SetTimeout(long timeoutMs)
+{
+    m_timeoutMs = timeoutMs;
+}
+
+void HTTPClient::SetCancelFlag(const std::atomic<bool>* cancelled)
+{
+    m_cancelled = cancelled;
+}
+
 HostSettings HTTPClient::GetServerInfo() const
 {
-    CURL* curl = static_cast<CURL*>(m_curl);
+    // Request the server info from the host,
+    // parsing the response as it's received instead of buffering it
+    ServerInfoParser parser;
+    ResponseData responseData = { m_curl, nullptr, &parser, nullptr, nullptr, false };
+    PerformRequest(BuildPath("/serverinfo"), responseData);
 
-    // Calculate the URL for the request
-    std::string url = "http://" + m_address.GetString() + "/serverinfo";
+    // Complete parsing the response and return the settings
+    return parser.Finish();
+}
 
-    // Set the URL for the request
-    CURLcode statusCode = curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    if (statusCode != CURLE_OK)
+AppList HTTPClient::GetAppList() const
+{
+    // Parse the app list as it's received, as it can be large for hosts with many apps
+    AppListParser parser;
+    ResponseData responseData = { m_curl, nullptr, &parser, nullptr, nullptr, false };
+    PerformRequest(BuildPath("/applist"), responseData);
+
+    return parser.Finish();
+}
+
+ResponseBuffer::Pointer HTTPClient::GetAppAsset(int appID) const
+{
+    std::string path = BuildPath("/appasset");
+    path.append("&appid=").append(std::to_string(appID)).append("&AssetType=2&AssetIdx=0");
+
+    ResponseBuffer::Pointer buffer = PerformRequest(path);
+
+    // Hosts respond with an XML error instead of an image if the app has no box art
+    constexpr std::string_view pngSignature = "\x89PNG\r\n\x1a\n";
+    if (buffer->GetView().substr(0, pngSignature.size()) != pngSignature)
+    {
+        return nullptr;
+    }
+
+    return buffer;
+}
+
+std::string HTTPClient::Launch(const LaunchParameters& parameters) const
+{
+    std::string path = BuildPath("/launch");
+    path.append("&appid=").append(std::to_string(parameters.appID))
+        .append("&mode=").append(std::to_string(parameters.width))
+        .append("x").append(std::to_string(parameters.height))
+        .append("x").append(std::to_string(parameters.fps))
+        .append("&additionalStates=1&sops=0&rikey=");
+    AppendHex(path, parameters.remoteInputKey.data(), parameters.remoteInputKey.size());
+    path.append("&rikeyid=").append(std::to_string(parameters.remoteInputKeyID))
+        .append("&localAudioPlayMode=").append(parameters.playAudioOnHost ? "1" : "0")
+        .append("&surroundAudioInfo=").append(std::to_string(parameters.surroundAudioInfo))
+        .append("&remoteControllersBitmap=0&gcmap=0");
+    AppendHDRMode(path, parameters);
+
+    return PerformCommand(path, "gamesession");
+}
+
+std::string HTTPClient::Resume(const LaunchParameters& parameters) const
+{
+    std::string path = BuildPath("/resume");
+    path.append("&rikey=");
+    AppendHex(path, parameters.remoteInputKey.data(), parameters.remoteInputKey.size());
+    path.append("&rikeyid=").append(std::to_string(parameters.remoteInputKeyID))
+        .append("&surroundAudioInfo=").append(std::to_string(parameters.surroundAudioInfo));
+    AppendHDRMode(path, parameters);
+
+    return PerformCommand(path, "resume");
+}
+
+void HTTPClient::Cancel() const
+{
+    PerformCommand(BuildPath("/cancel"), "cancel");
+}
+
+void HTTPClient::ReleaseSessions()
+{
+    // Clients still holding a session keep it alive until they're destroyed
+    SessionTable& table = GetSessionTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    table.sessions.clear();
+}
+
+std::string HTTPClient::PerformCommand(std::string_view path, std::string_view resultName) const
+{
+    CommandResponseParser parser;
+    ResponseData responseData = { m_curl, nullptr, &parser, nullptr, nullptr, false };
+    PerformRequest(path, responseData);
+    parser.Finish();
+
+    // Hosts report a failed command with a result of 0
+    std::optional<std::string_view> result = parser.GetValue(resultName);
+    if (!result.has_value() || *result == "0")
     {
-        throw std::runtime_error("Failed to set URL: " + std::string(curl_easy_strerror(statusCode)));
+        throw std::runtime_error("Host failed to complete the '" + std::string(resultName) + "' command");
     }
 
-    // Set the write function to capture the response
-    statusCode = curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, CURLWriteCallback);
-    if (statusCode != CURLE_OK)
+    return std::string(parser.GetValue("sessionUrl0").value_or(std::string_view()));
+}
+
+ResponseBuffer::Pointer HTTPClient::PerformRequest(std::string_view path) const
+{
+    // Capture the response into a pooled buffer
+    ResponseBuffer::Pointer buffer = ResponseBuffer::Acquire();
+    ResponseData responseData = { m_curl, buffer.get(), nullptr, nullptr, nullptr, false };
+    PerformRequest(path, responseData);
+
+    return buffer;
+}
+
+void HTTPClient::PerformRequest(std::string_view path, ResponseData& responseData) const
+{
+    CURL* curl = static_cast<CURL*>(m_curl);
+
+    // Calculate the URL for the request
+    // (the scope ID of a link-local IPv6 address is passed to libcurl separately,
+    // as it would otherwise need to be percent-encoded in the URL)
+    std::array<char, Address::MaxStringSize> host;
+    size_t hostLength = m_address.Format(host.data(), host.size(), Address::FormatOmitScopeID);
+    if (hostLength == 0)
     {
-        throw std::runtime_error("Failed to set write function: " + std::string(curl_easy_strerror(statusCode)));
+        throw std::invalid_argument("Cannot perform a request without an address");
     }
 
-    // Set the write data to capture the response
-    ResponseData readBuffer;
-    statusCode = curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-    if (statusCode != CURLE_OK)
+    std::string_view scheme = m_session != nullptr ? "https://" : "http://";
+
+    std::string url;
+    url.reserve(scheme.size() + hostLength + path.size());
+    url.append(scheme).append(host.data(), hostLength).append(path);
+
+    // Set the URL for the request
+    SetOption(curl, CURLOPT_URL, url.c_str(), "URL");
+
+    // Set the scope ID of the address (0 if the address isn't scoped)
+    SetOption(curl, CURLOPT_ADDRESS_SCOPE, static_cast<long>(m_address.GetScopeID()), "address scope");
+
+    // Give up on hosts which can't be reached quickly
+    SetOption(curl, CURLOPT_CONNECTTIMEOUT_MS, ConnectTimeoutMs, "connect timeout");
+    SetOption(curl, CURLOPT_TIMEOUT_MS, m_timeoutMs, "timeout");
+
+    // Check the cancel flag while the request is in progress
+    if (m_cancelled != nullptr)
     {
-        throw std::runtime_error("Failed to set write data: " + std::string(curl_easy_strerror(statusCode)));
+        SetOption(curl, CURLOPT_XFERINFOFUNCTION, CURLProgressCallback, "progress function");
+        SetOption(curl, CURLOPT_XFERINFODATA, const_cast<std::atomic<bool>*>(m_cancelled), "progress data");
+        SetOption(curl, CURLOPT_NOPROGRESS, 0L, "progress");
     }
 
+    // Reject responses which advertise a body larger than we're willing to buffer
+    SetOption(curl, CURLOPT_MAXFILESIZE_LARGE, static_cast<curl_off_t>(ResponseBuffer::MaxSize), "maximum response size");
+
+    // Set the write function and data to capture the response
+    SetOption(curl, CURLOPT_WRITEFUNCTION, CURLWriteCallback, "write function");
+    SetOption(curl, CURLOPT_WRITEDATA, &responseData, "write data");
+
     // Perform the request
-    statusCode = curl_easy_perform(curl);
+    CURLcode statusCode = curl_easy_perform(curl);
 
+    // Check if the transfer was aborted by the parser
+    if (responseData.exception != nullptr)
+    {
+        std::rethrow_exception(responseData.exception);
+    }
+    // Check if the transfer was aborted by the write callback
+    else if (responseData.error != nullptr)
+    {
+        throw std::runtime_error("Failed to perform request: " + std::string(responseData.error));
+    }
+    // Check if the request was cancelled
+    else if (statusCode == CURLE_ABORTED_BY_CALLBACK)
+    {
+        throw std::runtime_error("Request was cancelled");
+    }
     // Check if the request was successful
-    if (statusCode != CURLE_OK)
+    else if (statusCode != CURLE_OK)
     {
         throw std::runtime_error("Failed to perform request: " + std::string(curl_easy_strerror(statusCode)));
     }
-    
-    // Parse the response into HostSettings and return it
-    return HostSettings(readBuffer.data);
 }
 
 size_t HTTPClient::CURLWriteCallback(char* data, size_t size, size_t nmemb, void *clientp)
@@ -105,14 +507,53 @@ size_t HTTPClient::CURLWriteCallback(char* data, size_t size, size_t nmemb, void
     size_t newLength = size * nmemb;
     ResponseData* responseData = static_cast<ResponseData*>(clientp);
 
-    try
+    // Parse the data as it arrives if the response is being streamed
+    if (responseData->parser != nullptr)
+    {
+        try
+        {
+            responseData->parser->Feed(std::string_view(data, newLength));
+        }
+        catch (...)
+        {
+            // Exceptions can't propagate through libcurl, so abort the transfer
+            // and rethrow the exception once curl_easy_perform has returned
+            responseData->exception = std::current_exception();
+            return 0;
+        }
+
+        return newLength;
+    }
+
+    // Size the buffer from the Content-Length header before the first write,
+    // so the body is received without reallocating
+    if (!responseData->reserved)
     {
-        responseData->data.append(data, newLength);
+        responseData->reserved = true;
+
+        curl_off_t contentLength = -1;
+        if (curl_easy_getinfo(static_cast<CURL*>(responseData->curl), CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, 
+                &contentLength) == CURLE_OK && contentLength > 0)
+        {
+            if (static_cast<uint64_t>(contentLength) > ResponseBuffer::MaxSize)
+            {
+                responseData->error = "Response exceeds the maximum size";
+                return 0;
+            }
+
+            // A failure here isn't fatal, the buffer will grow as data arrives instead
+            responseData->buffer->Reserve(static_cast<size_t>(contentLength));
+        }
     }
-    catch (const std::exception& exception)
+
+    if (!responseData->buffer->Append(data, newLength))
     {
-        // Memory allocation failed, log the error
-        obs_log(LOG_ERROR, "Failed to append data while performing a HTTP request: %s", exception.what());
+        // Returning a length other than the one given aborts the transfer,
+        // so a partial response is never handed to the parsers
+        responseData->error = responseData->buffer->GetSize() + newLength > ResponseBuffer::MaxSize ?
+            "Response exceeds the maximum size" : "Failed to allocate memory for the response";
+        obs_log(LOG_ERROR, "Aborted HTTP request: %s", responseData->error);
+        return 0;
     }
     
     return newLength;
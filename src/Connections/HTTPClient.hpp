@@ -1,12 +1,43 @@
 #pragma once
 
+// STL includes
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <string_view>
+
 // Project includes
 #include "../Connections/Address.hpp"
+#include "AppInfo.hpp"
+#include "ResponseBuffer.hpp"
 
 namespace MoonlightOBS
 {
     // Forward declarations
     class HostSettings;
+    class PairedHost;
+    class ResponseParser;
+
+    /**
+     * @brief Parameters of a stream launched (or resumed) on a GameStream host.
+     *
+     */
+    struct LaunchParameters
+    {
+        int appID                               = 0;        // ID of the app to launch, from the app list
+        uint32_t width                          = 1920;     // Width of the stream
+        uint32_t height                         = 1080;     // Height of the stream
+        uint32_t fps                            = 60;       // Frame rate of the stream
+        std::array<uint8_t, 16> remoteInputKey  = {};       // AES key encrypting the input sent to the host
+        int32_t remoteInputKeyID                = 0;        // ID of the remote input key
+        uint32_t surroundAudioInfo              = 0x30002;  // Audio channel count and mask (stereo by default)
+        bool playAudioOnHost                    = false;    // Keep playing the audio on the host?
+        bool hdr                                = false;    // Stream in HDR? (requires a 10 bit video format)
+    };
 
     /**
      * @brief Provides a simple HTTP client for making requests 
@@ -17,17 +48,57 @@ namespace MoonlightOBS
     {
     public:
         /**
-         * @brief Construct a new HTTPClient object.
+         * @brief The default HTTP port of GameStream hosts.
+         *
+         */
+        static constexpr uint16_t DefaultPort = 47989;
+
+        /**
+         * @brief Construct a new HTTPClient object making unauthenticated requests over HTTP.
          * 
          * @param address The address of the GameStream host to connect to.
          */
         HTTPClient(const Address& address);
 
+        /**
+         * @brief Construct a new HTTPClient object making authenticated requests over HTTPS to a paired host.
+         * @note The client certificate authenticates the requests, and the connection is only
+         *       accepted if the host presents the public key of the certificate pinned when pairing.
+         *       TLS sessions are shared by all clients of the same host,
+         *       so repeated requests resume the session instead of performing a full handshake.
+         *
+         * @param address The address of the GameStream host to connect to (the port is replaced with its HTTPS port).
+         * @param host The paired host.
+         *
+         * @exception std::invalid_argument If the pinned certificate of the host is invalid.
+         * @exception std::runtime_error If the client identity could not be loaded, or libcurl could not be set up.
+         */
+        HTTPClient(const Address& address, const PairedHost& host);
+
         /**
          * @brief Destroy the HTTPClient object.
          */
         ~HTTPClient();
 
+        HTTPClient(const HTTPClient&)               = delete;
+        HTTPClient& operator=(const HTTPClient&)    = delete;
+
+        /**
+         * @brief Limits how long each request may take, including waiting for the response.
+         * @note Only connecting is limited by default, as hosts can take a while to launch an app.
+         *
+         * @param timeoutMs The longest a request may take in milliseconds (0 for no limit).
+         */
+        void SetTimeout(long timeoutMs);
+
+        /**
+         * @brief Sets a flag which aborts the requests of the client once it's set.
+         * @note The flag must outlive the client. Aborted requests throw std::runtime_error.
+         *
+         * @param cancelled The flag, or null to never abort requests.
+         */
+        void SetCancelFlag(const std::atomic<bool>* cancelled);
+
         /**
          * @brief Gets the settings of the GameStream host.
          * @exception std::runtime_error If the request fails or the response is invalid.
@@ -36,10 +107,72 @@ namespace MoonlightOBS
          */
         HostSettings GetServerInfo() const;
 
+        /**
+         * @brief Gets the list of apps which can be launched on the GameStream host.
+         * @note Requires an authenticated client.
+         * @exception std::runtime_error If the request fails or the host reports an error.
+         *
+         * @return AppList The apps of the host.
+         */
+        AppList GetAppList() const;
+
+        /**
+         * @brief Gets the box art of an app on the GameStream host.
+         * @note Requires an authenticated client.
+         * @exception std::runtime_error If the request fails.
+         *
+         * @param appID The ID of the app.
+         * @return ResponseBuffer::Pointer The PNG image of the box art, or null if the host has no box art for the app.
+         */
+        ResponseBuffer::Pointer GetAppAsset(int appID) const;
+
+        /**
+         * @brief Launches an app on the GameStream host.
+         * @note Requires an authenticated client.
+         * @exception std::runtime_error If the request fails or the host fails to launch the app.
+         *
+         * @param parameters The parameters of the stream.
+         * @return std::string The RTSP session URL of the stream, or empty if the host didn't provide one.
+         */
+        std::string Launch(const LaunchParameters& parameters) const;
+
+        /**
+         * @brief Resumes streaming the app already running on the GameStream host.
+         * @note Requires an authenticated client. The app ID and resolution of the parameters are ignored.
+         * @exception std::runtime_error If the request fails or the host fails to resume the app.
+         *
+         * @param parameters The parameters of the stream.
+         * @return std::string The RTSP session URL of the stream, or empty if the host didn't provide one.
+         */
+        std::string Resume(const LaunchParameters& parameters) const;
+
+        /**
+         * @brief Quits the app running on the GameStream host.
+         * @note Requires an authenticated client.
+         * @exception std::runtime_error If the request fails or the host fails to quit the app.
+         *
+         */
+        void Cancel() const;
+
+        /**
+         * @brief Releases the TLS sessions shared by the clients of each paired host.
+         * @note Should be called once no clients remain, before the module is unloaded.
+         *
+         */
+        static void ReleaseSessions();
+
     private:
+        // TLS sessions and DNS results shared by the clients of a paired host
+        struct HostSession;
+
         struct ResponseData
         {
-            std::string data; // Holds the response data
+            void* curl;                     // libcurl handle performing the request
+            ResponseBuffer* buffer;         // Holds the response data (if not streamed to a parser)
+            ResponseParser* parser;         // Parses the response as it's received (if not buffered)
+            const char* error;              // Reason the transfer was aborted, if any
+            std::exception_ptr exception;   // Exception thrown by the parser, if any
+            bool reserved;                  // Has the buffer been sized from the Content-Length?
         };
         
         // libcurl handle
@@ -48,6 +181,22 @@ namespace MoonlightOBS
         // Address of the GameStream host
         Address m_address;
 
+        // Session shared with the other clients of the host (only set for HTTPS clients)
+        std::shared_ptr<HostSession> m_session;
+
+        // Longest a request may take in milliseconds (0 for no limit)
+        long m_timeoutMs;
+        // Flag which aborts the requests once set, if any
+        const std::atomic<bool>* m_cancelled;
+
+        // Sends a command to the host, checking that the given element of the response reports success,
+        // and returns the RTSP session URL of the response (if any)
+        std::string PerformCommand(std::string_view path, std::string_view resultName) const;
+        // Performs a GET request for the given path, returning the pooled response body
+        ResponseBuffer::Pointer PerformRequest(std::string_view path) const;
+        // Performs a GET request for the given path, writing the response to the given response data
+        void PerformRequest(std::string_view path, ResponseData& responseData) const;
+
         // Callback function for writing data called by libcurl
         static size_t CURLWriteCallback(char *data, size_t size, size_t nmemb, void *clientp);
     };
@@ -0,0 +1,144 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+// moonlight-common-c includes
+#include <Limelight.h>
+
+// Project includes
+#include "HostSettings.hpp"
+#include "../Utilities/Version.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Features of a stream which depend on what the host is able to encode.
+     *
+     */
+    enum class HostFeature
+    {
+        /**
+         * @brief The host encodes 10 bit HEVC or AV1, so it's able to stream HDR.
+         *
+         */
+        HDR,
+        /**
+         * @brief The host encodes 4:4:4 video. (Sunshine only)
+         *
+         */
+        YUV444,
+        /**
+         * @brief The host encodes AV1.
+         *
+         */
+        AV1
+    };
+
+    /**
+     * @brief Static helper class to check which stream features a GameStream host supports,
+     *        based on the codecs reported in its /serverinfo response.
+     *
+     */
+    class HostFeatures
+    {
+    public:
+        /**
+         * @brief Checks if a host supports a feature.
+         *
+         * @param settings The settings reported by the host.
+         * @param feature The feature to check for.
+         * @return true If the host supports the feature.
+         * @return false If the host doesn't support the feature.
+         */
+        static bool Supports(const HostSettings& settings, HostFeature feature)
+        {
+            return (GetVideoFormats(settings) & GetVideoFormatMask(feature)) != 0;
+        }
+
+        /**
+         * @brief Checks if a host is running Sunshine, rather than GeForce Experience.
+         * @note Sunshine reports its app version with a revision number of -1.
+         *
+         * @param appVersion The app version reported by the host.
+         * @return true If the host is running Sunshine.
+         * @return false If the host is running GeForce Experience, or its version is unknown.
+         */
+        static constexpr bool IsSunshine(const Version& appVersion)
+        {
+            return !appVersion.IsUnknown() && appVersion.GetRevision() < 0;
+        }
+
+        /**
+         * @brief Gets the video formats a host is able to encode.
+         * @note H.264 is always included, as every host encodes it. 4:4:4 formats are only
+         *       included for Sunshine, as GeForce Experience never streams them.
+         *
+         * @param settings The settings reported by the host.
+         * @return int The VIDEO_FORMAT_* values the host supports.
+         */
+        static int GetVideoFormats(const HostSettings& settings)
+        {
+            constexpr std::array<std::pair<int, int>, 10> CodecModes =
+            {{
+                { SCM_H264,             VIDEO_FORMAT_H264 },
+                { SCM_H264_HIGH8_444,   VIDEO_FORMAT_H264_HIGH8_444 },
+                { SCM_HEVC,             VIDEO_FORMAT_H265 },
+                { SCM_HEVC_MAIN10,      VIDEO_FORMAT_H265_MAIN10 },
+                { SCM_HEVC_REXT8_444,   VIDEO_FORMAT_H265_REXT8_444 },
+                { SCM_HEVC_REXT10_444,  VIDEO_FORMAT_H265_REXT10_444 },
+                { SCM_AV1_MAIN8,        VIDEO_FORMAT_AV1_MAIN8 },
+                { SCM_AV1_MAIN10,       VIDEO_FORMAT_AV1_MAIN10 },
+                { SCM_AV1_HIGH8_444,    VIDEO_FORMAT_AV1_HIGH8_444 },
+                { SCM_AV1_HIGH10_444,   VIDEO_FORMAT_AV1_HIGH10_444 }
+            }};
+
+            int formats = VIDEO_FORMAT_H264;
+            for (const auto& [codecMode, format] : CodecModes)
+            {
+                if ((settings.GetServerCodecModeSupport() & codecMode) != 0)
+                {
+                    formats |= format;
+                }
+            }
+
+            if (!IsSunshine(settings.GetAppVersion()))
+            {
+                formats &= ~VIDEO_FORMAT_MASK_YUV444;
+            }
+
+            return formats;
+        }
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        HostFeatures()                                  = delete;
+        HostFeatures(const HostFeatures&)               = delete;
+        HostFeatures& operator=(const HostFeatures&)    = delete;
+        ~HostFeatures()                                 = delete;
+
+    private:
+        // Gets the video formats which provide a feature
+        static constexpr int GetVideoFormatMask(HostFeature feature)
+        {
+            switch (feature)
+            {
+                case HostFeature::HDR:
+                    return VIDEO_FORMAT_MASK_10BIT;
+
+                case HostFeature::YUV444:
+                    return VIDEO_FORMAT_MASK_YUV444;
+
+                case HostFeature::AV1:
+                    return VIDEO_FORMAT_MASK_AV1;
+
+                default:
+                    throw std::invalid_argument("Unknown host feature.");
+            }
+        }
+    };
+} // namespace MoonlightOBS
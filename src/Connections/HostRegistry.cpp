@@ -0,0 +1,202 @@
+#include "HostRegistry.hpp"
+
+// STL includes
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Project includes
+#include "../Utilities/StringInterner.hpp"
+#include "HostSettings.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // A registered host
+    struct HostEntry
+    {
+        GameStreamHost host;
+        HostSettingsSnapshot settings;
+    };
+
+    // Storage for the registered hosts
+    // (names are interned, so the indexes can be keyed by views of them, and
+    // looked up from a std::string_view without allocating)
+    struct HostTable
+    {
+        std::shared_mutex mutex;
+        std::vector<HostEntry> hosts;
+        std::unordered_map<std::string_view, HostID> uniqueIDs;
+        std::unordered_map<std::string_view, HostID> names;
+        std::unordered_map<Address, HostID> addresses;
+    };
+
+    HostTable& GetTable()
+    {
+        static HostTable table;
+        return table;
+    }
+
+    // Gets the entry of a host, which must be called with the table locked
+    const HostEntry& GetEntry(const HostTable& table, HostID id)
+    {
+        if (id >= table.hosts.size())
+        {
+            throw std::out_of_range("Unknown host ID: " + std::to_string(id));
+        }
+
+        return table.hosts[id];
+    }
+
+    // Looks up a key in an index, which must be called with the table locked
+    template <typename Key>
+    HostID Find(const std::unordered_map<Key, HostID>& index, const Key& key)
+    {
+        auto iterator = index.find(key);
+        return iterator != index.end() ? iterator->second : InvalidHostID;
+    }
+
+    // Indexes a name of a host, which must be called with the table locked exclusively
+    void IndexName(HostTable& table, HostID id, std::string_view name)
+    {
+        if (!name.empty())
+        {
+            table.names[StringInterner::Get(StringInterner::Intern(name))] = id;
+        }
+    }
+
+    // Indexes the addresses of a host, which must be called with the table locked exclusively
+    void IndexAddresses(HostTable& table, HostID id, const GameStreamHost& host)
+    {
+        // An address which now belongs to another host (e.g. reassigned by DHCP) moves to it
+        if (host.GetIPv4Address().IsValid())
+        {
+            table.addresses[host.GetIPv4Address()] = id;
+        }
+        if (host.GetIPv6Address().IsValid())
+        {
+            table.addresses[host.GetIPv6Address()] = id;
+        }
+    }
+}
+
+HostID HostRegistry::Register(const GameStreamHost& host, const HostSettings& settings, HostSettingsChanges* changes)
+{
+    // Take the snapshot before locking, so interning its strings (which may allocate) doesn't
+    // hold up readers of the registry. The names below are interned with the registry locked,
+    // which can't deadlock, as the interner's lock is only ever taken inside the registry's.
+    HostSettingsSnapshot snapshot(settings);
+    std::string_view uniqueID = snapshot.GetUniqueID();
+    if (uniqueID.empty())
+    {
+        throw std::invalid_argument("Cannot register a host without a unique ID");
+    }
+
+    HostTable& table = GetTable();
+    std::unique_lock<std::shared_mutex> lock(table.mutex);
+
+    HostID id = Find(table.uniqueIDs, uniqueID);
+    if (id == InvalidHostID)
+    {
+        // Register the new host
+        id = static_cast<HostID>(table.hosts.size());
+        table.hosts.push_back({ host, snapshot });
+        table.uniqueIDs.emplace(uniqueID, id);
+
+        if (changes != nullptr)
+        {
+            changes->set();
+        }
+    }
+    else
+    {
+        // Update the existing host, keeping any addresses which weren't resolved this time
+        HostEntry& entry = table.hosts[id];
+        if (host.GetIPv4Address().IsValid())
+        {
+            entry.host.SetIPv4Address(host.GetIPv4Address());
+        }
+        if (host.GetIPv6Address().IsValid())
+        {
+            entry.host.SetIPv6Address(host.GetIPv6Address());
+        }
+        if (!host.GetHostname().empty())
+        {
+            entry.host.SetHostname(host.GetHostname());
+        }
+
+        if (changes != nullptr)
+        {
+            *changes = entry.settings.Diff(snapshot);
+        }
+        entry.settings = snapshot;
+    }
+
+    // Previous names are kept, so a renamed host can still be found by its old name
+    IndexName(table, id, host.GetHostname());
+    IndexName(table, id, snapshot.GetHostname());
+    IndexAddresses(table, id, host);
+
+    return id;
+}
+
+void HostRegistry::AddName(HostID id, std::string_view name)
+{
+    HostTable& table = GetTable();
+    std::unique_lock<std::shared_mutex> lock(table.mutex);
+
+    GetEntry(table, id);
+    IndexName(table, id, name);
+}
+
+HostID HostRegistry::FindByUniqueID(std::string_view uniqueID)
+{
+    HostTable& table = GetTable();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+
+    return Find(table.uniqueIDs, uniqueID);
+}
+
+HostID HostRegistry::FindByAddress(const Address& address)
+{
+    HostTable& table = GetTable();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+
+    return Find(table.addresses, address);
+}
+
+HostID HostRegistry::FindByName(std::string_view name)
+{
+    HostTable& table = GetTable();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+
+    return Find(table.names, name);
+}
+
+GameStreamHost HostRegistry::GetHost(HostID id)
+{
+    HostTable& table = GetTable();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+
+    return GetEntry(table, id).host;
+}
+
+HostSettingsSnapshot HostRegistry::GetSettings(HostID id)
+{
+    HostTable& table = GetTable();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+
+    return GetEntry(table, id).settings;
+}
+
+size_t HostRegistry::GetCount()
+{
+    HostTable& table = GetTable();
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+
+    return table.hosts.size();
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Project includes
+#include "GameStreamHost.hpp"
+#include "HostSettingsSnapshot.hpp"
+
+namespace MoonlightOBS
+{
+    // Forward declarations
+    class HostSettings;
+
+    /**
+     * @brief Stable identifier of a GameStream host in the HostRegistry.
+     *
+     */
+    using HostID = uint32_t;
+
+    /**
+     * @brief Identifier which never refers to a registered host.
+     *
+     */
+    constexpr HostID InvalidHostID = UINT32_MAX;
+
+    /**
+     * @brief Static helper class which holds every GameStream host known to the plugin.
+     *
+     * Hosts are deduplicated on the unique ID reported by /serverinfo, so the same machine
+     * found over IPv4, IPv6, manual entry or under a new name is a single entry. Hosts are
+     * stored in a flat array and never removed, so a HostID remains valid for the lifetime
+     * of the process, and hosts can also be found by any of their addresses or names.
+     *
+     * @note All functions are thread-safe.
+     */
+    class HostRegistry
+    {
+    public:
+        /**
+         * @brief Registers a GameStream host, or updates it if its unique ID is already registered.
+         * @note The valid addresses of the host replace those previously registered,
+         *       while unresolved addresses leave them unchanged.
+         *
+         * @param host The hostname and addresses of the host.
+         * @param settings The settings of the host, as reported by /serverinfo.
+         * @param changes If not null, receives the fields of the settings which changed.
+         *                (All fields are changed for a newly registered host)
+         * @return HostID The ID of the host.
+         *
+         * @exception std::invalid_argument If the settings have no unique ID.
+         */
+        static HostID Register(const GameStreamHost& host, const HostSettings& settings,
+            HostSettingsChanges* changes = nullptr);
+
+        /**
+         * @brief Adds another name which the host can be found by (e.g. an mDNS service name).
+         *
+         * @param id The ID of the host.
+         * @param name The name of the host.
+         *
+         * @exception std::out_of_range If the ID isn't registered.
+         */
+        static void AddName(HostID id, std::string_view name);
+
+        /**
+         * @brief Finds a host by the unique ID reported by /serverinfo.
+         *
+         * @param uniqueID The unique ID of the host.
+         * @return HostID The ID of the host, or InvalidHostID if it isn't registered.
+         */
+        static HostID FindByUniqueID(std::string_view uniqueID);
+
+        /**
+         * @brief Finds a host by one of its addresses.
+         *
+         * @param address The IPv4 or IPv6 address (including the port) of the host.
+         * @return HostID The ID of the host, or InvalidHostID if it isn't registered.
+         */
+        static HostID FindByAddress(const Address& address);
+
+        /**
+         * @brief Finds a host by its hostname, or one of the names added with AddName.
+         *
+         * @param name The name of the host.
+         * @return HostID The ID of the host, or InvalidHostID if it isn't registered.
+         */
+        static HostID FindByName(std::string_view name);
+
+        /**
+         * @brief Gets the hostname and addresses of a host.
+         *
+         * @param id The ID of the host.
+         * @return GameStreamHost The hostname and addresses of the host.
+         *
+         * @exception std::out_of_range If the ID isn't registered.
+         */
+        static GameStreamHost GetHost(HostID id);
+
+        /**
+         * @brief Gets the most recently registered settings of a host.
+         *
+         * @param id The ID of the host.
+         * @return HostSettingsSnapshot The settings of the host.
+         *
+         * @exception std::out_of_range If the ID isn't registered.
+         */
+        static HostSettingsSnapshot GetSettings(HostID id);
+
+        /**
+         * @brief Gets the number of registered hosts.
+         * @note The IDs of the registered hosts are 0 to GetCount() - 1.
+         *
+         * @return size_t The number of registered hosts.
+         */
+        static size_t GetCount();
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        HostRegistry()                                  = delete;
+        HostRegistry(const HostRegistry&)               = delete;
+        HostRegistry& operator=(const HostRegistry&)    = delete;
+        ~HostRegistry()                                 = delete;
+    };
+} // namespace MoonlightOBS
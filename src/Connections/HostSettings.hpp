@@ -10,12 +10,6 @@
 #include "PairStatus.hpp"
 #include "../Utilities/Version.hpp"
 
-// Forward declarations
-namespace tinyxml2
-{
-    class XMLElement;
-}
-
 namespace MoonlightOBS
 {
     /**
@@ -37,9 +31,9 @@ namespace MoonlightOBS
         /**
          * @brief Get the Hostname of the GameStream host.
          * 
-         * @return std::string The hostname of the GameStream host.
+         * @return const std::string& The hostname of the GameStream host.
          */
-        inline std::string GetHostname() const
+        inline const std::string& GetHostname() const
         {
             return m_hostname;
         }
@@ -68,9 +62,9 @@ namespace MoonlightOBS
         /**
          * @brief Get the Unique ID of the GameStream host.
          * 
-         * @return std::string The unique ID of the GameStream host.
+         * @return const std::string& The unique ID of the GameStream host.
          */
-        inline std::string GetUniqueID() const
+        inline const std::string& GetUniqueID() const
         {
             return m_uniqueID;
         }
@@ -108,9 +102,9 @@ namespace MoonlightOBS
         /**
          * @brief Gets the MAC address of the GameStream host.
          * 
-         * @return std::string The MAC address of the GameStream host.
+         * @return const std::string& The MAC address of the GameStream host.
          */
-        inline std::string GetMacAddress() const
+        inline const std::string& GetMacAddress() const
         {
             return m_macAddress;
         }
@@ -128,9 +122,9 @@ namespace MoonlightOBS
         /**
          * @brief Gets the local IP address of the GameStream host.
          * 
-         * @return std::string The local IP address of the GameStream host.
+         * @return const std::string& The local IP address of the GameStream host.
          */
-        inline std::string GetLocalIP() const
+        inline const std::string& GetLocalIP() const
         {
             return m_localIP;
         }
@@ -208,17 +202,10 @@ namespace MoonlightOBS
         // The external port of the GameStream host
         uint16_t m_externalPort;
 
-        // Helper function to convert a an XML element to a string
-        static std::string XMLElementToString(const tinyxml2::XMLElement* element);
-        // Helper function to parse an XML element to a version number
-        static Version XMLELementToVersion(const tinyxml2::XMLElement* element);
-        // Helper function to parse an XML element to a 64 bit unsigned integer
-        static uint64_t XMLElementToUInt64(const tinyxml2::XMLElement* element);
-        // Helper function to parse an XML element to an integer
-        static int XMLElementToInt(const tinyxml2::XMLElement* element);
-        // Helper function to prase an XML element to a PairStatus enumeration
-        static PairStatus XMLElementToPairStatus(const tinyxml2::XMLElement* element);
-        // Helper function to parse an XML element to a HostState enumeration
-        static HostState XMLElementToHostState(const tinyxml2::XMLElement* element);
+        // Constructs empty settings to be filled in by the ServerInfoParser
+        HostSettings();
+
+        // Allow the parser to fill in the settings as the response is parsed
+        friend class ServerInfoParser;
     };
 } // namespace MoonlightOBS
@@ -0,0 +1,114 @@
+#include "HostSettingsSnapshot.hpp"
+
+// STL includes
+#include <array>
+#include <string>
+
+// Project includes
+#include "../Utilities/StringInterner.hpp"
+#include "HostSettings.hpp"
+
+using namespace MoonlightOBS;
+
+HostSettingsSnapshot::HostSettingsSnapshot()
+    : m_appVersion(Version::GetUnknownVersion()),
+      m_gfeVersion(Version::GetUnknownVersion()),
+      m_maxLumaPixelsHEVC(0),
+      m_hostname(StringInterner::EmptyID),
+      m_uniqueID(StringInterner::EmptyID),
+      m_macAddress(StringInterner::EmptyID),
+      m_localIP(StringInterner::EmptyID),
+      m_currentGame(0),
+      m_serverCodecModeSupport(0),
+      m_httpsPort(0),
+      m_externalPort(0),
+      m_pairStatus(PairStatus::Unpaired),
+      m_hostState(HostState::SERVER_FREE) {}
+
+HostSettingsSnapshot::HostSettingsSnapshot(const HostSettings& settings)
+    : m_appVersion(settings.GetAppVersion()),
+      m_gfeVersion(settings.GetGFEVersion()),
+      m_maxLumaPixelsHEVC(settings.GetMaxLumaPixelsHEVC()),
+      m_hostname(StringInterner::Intern(settings.GetHostname())),
+      m_uniqueID(StringInterner::Intern(settings.GetUniqueID())),
+      m_macAddress(StringInterner::Intern(settings.GetMacAddress())),
+      m_localIP(StringInterner::Intern(settings.GetLocalIP())),
+      m_currentGame(settings.GetCurrentGame()),
+      m_serverCodecModeSupport(settings.GetServerCodecModeSupport()),
+      m_httpsPort(settings.GetHTTPSPort()),
+      m_externalPort(settings.GetExternalPort()),
+      m_pairStatus(settings.GetPairStatus()),
+      m_hostState(settings.GetHostState()) {}
+
+HostSettingsChanges HostSettingsSnapshot::Diff(const HostSettingsSnapshot& other) const
+{
+    HostSettingsChanges changes;
+    changes.set(static_cast<size_t>(HostSettingsField::Hostname),               m_hostname != other.m_hostname);
+    changes.set(static_cast<size_t>(HostSettingsField::UniqueID),               m_uniqueID != other.m_uniqueID);
+    changes.set(static_cast<size_t>(HostSettingsField::MacAddress),             m_macAddress != other.m_macAddress);
+    changes.set(static_cast<size_t>(HostSettingsField::LocalIP),                m_localIP != other.m_localIP);
+    changes.set(static_cast<size_t>(HostSettingsField::AppVersion),             m_appVersion != other.m_appVersion);
+    changes.set(static_cast<size_t>(HostSettingsField::GFEVersion),             m_gfeVersion != other.m_gfeVersion);
+    changes.set(static_cast<size_t>(HostSettingsField::MaxLumaPixelsHEVC),      m_maxLumaPixelsHEVC != other.m_maxLumaPixelsHEVC);
+    changes.set(static_cast<size_t>(HostSettingsField::CurrentGame),            m_currentGame != other.m_currentGame);
+    changes.set(static_cast<size_t>(HostSettingsField::ServerCodecModeSupport), m_serverCodecModeSupport != other.m_serverCodecModeSupport);
+    changes.set(static_cast<size_t>(HostSettingsField::PairStatus),             m_pairStatus != other.m_pairStatus);
+    changes.set(static_cast<size_t>(HostSettingsField::HostState),              m_hostState != other.m_hostState);
+    changes.set(static_cast<size_t>(HostSettingsField::HTTPSPort),              m_httpsPort != other.m_httpsPort);
+    changes.set(static_cast<size_t>(HostSettingsField::ExternalPort),           m_externalPort != other.m_externalPort);
+
+    return changes;
+}
+
+std::string HostSettingsSnapshot::FormatChanges(const HostSettingsChanges& changes)
+{
+    // Names of the fields, in the order of HostSettingsField
+    constexpr std::array<const char*, static_cast<size_t>(HostSettingsField::Count)> FieldNames =
+    {
+        "hostname", "unique ID", "MAC address", "local IP", "app version", "GFE version",
+        "max HEVC luma pixels", "current game", "codec support", "pair status", "state",
+        "HTTPS port", "external port"
+    };
+
+    std::string names;
+    for (size_t field = 0; field < changes.size(); field++)
+    {
+        if (changes.test(field))
+        {
+            names.append(names.empty() ? "" : ", ").append(FieldNames[field]);
+        }
+    }
+
+    return names;
+}
+
+std::string_view HostSettingsSnapshot::GetHostname() const
+{
+    return StringInterner::Get(m_hostname);
+}
+
+std::string_view HostSettingsSnapshot::GetUniqueID() const
+{
+    return StringInterner::Get(m_uniqueID);
+}
+
+std::string_view HostSettingsSnapshot::GetMacAddress() const
+{
+    return StringInterner::Get(m_macAddress);
+}
+
+std::string_view HostSettingsSnapshot::GetLocalIP() const
+{
+    return StringInterner::Get(m_localIP);
+}
+
+bool HostSettingsSnapshot::operator==(const HostSettingsSnapshot& other) const
+{
+    return m_appVersion == other.m_appVersion && m_gfeVersion == other.m_gfeVersion &&
+           m_maxLumaPixelsHEVC == other.m_maxLumaPixelsHEVC && m_hostname == other.m_hostname &&
+           m_uniqueID == other.m_uniqueID && m_macAddress == other.m_macAddress &&
+           m_localIP == other.m_localIP && m_currentGame == other.m_currentGame &&
+           m_serverCodecModeSupport == other.m_serverCodecModeSupport && m_httpsPort == other.m_httpsPort &&
+           m_externalPort == other.m_externalPort && m_pairStatus == other.m_pairStatus &&
+           m_hostState == other.m_hostState;
+}
@@ -0,0 +1,269 @@
+#pragma once
+
+// STL includes
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Project includes
+#include "HostState.hpp"
+#include "PairStatus.hpp"
+#include "../Utilities/Version.hpp"
+
+namespace MoonlightOBS
+{
+    // Forward declarations
+    class HostSettings;
+
+    /**
+     * @brief The fields of the settings of a GameStream host.
+     *
+     */
+    enum class HostSettingsField : uint8_t
+    {
+        Hostname,
+        UniqueID,
+        MacAddress,
+        LocalIP,
+        AppVersion,
+        GFEVersion,
+        MaxLumaPixelsHEVC,
+        CurrentGame,
+        ServerCodecModeSupport,
+        PairStatus,
+        HostState,
+        HTTPSPort,
+        ExternalPort,
+        Count
+    };
+
+    /**
+     * @brief Set of the fields which differ between two snapshots of the settings of a GameStream host.
+     *
+     */
+    using HostSettingsChanges = std::bitset<static_cast<size_t>(HostSettingsField::Count)>;
+
+    /**
+     * @brief Compact, trivially copyable snapshot of the settings of a GameStream host.
+     *
+     * Strings are interned (see StringInterner), so a snapshot is a fixed size and
+     * two snapshots can be compared, or diffed field by field, in constant time.
+     *
+     */
+    class HostSettingsSnapshot
+    {
+    public:
+        /**
+         * @brief Construct an empty snapshot, which differs from the snapshot of any valid settings.
+         *
+         */
+        HostSettingsSnapshot();
+
+        /**
+         * @brief Construct a snapshot of the settings of a GameStream host.
+         * @exception std::bad_alloc If the strings of the settings could not be interned.
+         *
+         * @param settings The settings to take a snapshot of.
+         */
+        explicit HostSettingsSnapshot(const HostSettings& settings);
+
+        /**
+         * @brief Gets the fields which differ between this snapshot and another.
+         *
+         * @param other The snapshot to compare against.
+         * @return HostSettingsChanges The set of fields which differ.
+         */
+        HostSettingsChanges Diff(const HostSettingsSnapshot& other) const;
+
+        /**
+         * @brief Formats a set of changed fields, for logging.
+         *
+         * @param changes The set of changed fields.
+         * @return std::string The names of the changed fields, separated by commas.
+         */
+        static std::string FormatChanges(const HostSettingsChanges& changes);
+
+        /**
+         * @brief Gets the hostname of the GameStream host.
+         *
+         * @return std::string_view The hostname, which remains valid for the lifetime of the process.
+         */
+        std::string_view GetHostname() const;
+
+        /**
+         * @brief Gets the unique ID of the GameStream host.
+         *
+         * @return std::string_view The unique ID, which remains valid for the lifetime of the process.
+         */
+        std::string_view GetUniqueID() const;
+
+        /**
+         * @brief Gets the MAC address of the GameStream host.
+         *
+         * @return std::string_view The MAC address, which remains valid for the lifetime of the process.
+         */
+        std::string_view GetMacAddress() const;
+
+        /**
+         * @brief Gets the local IP address of the GameStream host.
+         *
+         * @return std::string_view The local IP address, which remains valid for the lifetime of the process.
+         */
+        std::string_view GetLocalIP() const;
+
+        /**
+         * @brief Gets the interned ID of the unique ID of the GameStream host.
+         *
+         * @return uint32_t The interned ID of the unique ID.
+         */
+        inline uint32_t GetUniqueIDKey() const
+        {
+            return m_uniqueID;
+        }
+
+        /**
+         * @brief Get the Version of the GameStream host.
+         *
+         * @return Version The version of the GameStream host.
+         */
+        inline Version GetAppVersion() const
+        {
+            return m_appVersion;
+        }
+
+        /**
+         * @brief Get the version of GeForce Experience of the host.
+         *
+         * @return Version The version of the GeForce Experience of the host.
+         */
+        inline Version GetGFEVersion() const
+        {
+            return m_gfeVersion;
+        }
+
+        /**
+         * @brief Gets the maximum luma pixels for HEVC encoding.
+         *
+         * @return uint64_t The maximum luma pixels for HEVC encoding.
+         */
+        inline uint64_t GetMaxLumaPixelsHEVC() const
+        {
+            return m_maxLumaPixelsHEVC;
+        }
+
+        /**
+         * @brief Gets the code of the current game running on the GameStream host.
+         *
+         * @return int The code of the current game running on the GameStream host.
+         */
+        inline int GetCurrentGame() const
+        {
+            return m_currentGame;
+        }
+
+        /**
+         * @brief Gets the server codec mode support flag of the GameStream host.
+         *
+         * @return int The server codec mode support flag of the GameStream host.
+         */
+        inline int GetServerCodecModeSupport() const
+        {
+            return m_serverCodecModeSupport;
+        }
+
+        /**
+         * @brief Gets the pair status of the GameStream host.
+         *
+         * @return PairStatus The pair status of the GameStream host.
+         */
+        inline PairStatus GetPairStatus() const
+        {
+            return m_pairStatus;
+        }
+
+        /**
+         * @brief Gets the current streaming state of the GameStream host.
+         *
+         * @return HostState The current streaming state of the GameStream host.
+         */
+        inline HostState GetHostState() const
+        {
+            return m_hostState;
+        }
+
+        /**
+         * @brief Gets the HTTPS port of the GameStream host.
+         *
+         * @return uint16_t The HTTPS port of the GameStream host.
+         */
+        inline uint16_t GetHTTPSPort() const
+        {
+            return m_httpsPort;
+        }
+
+        /**
+         * @brief Gets the external port of the GameStream host.
+         *
+         * @return uint16_t The external port of the GameStream host.
+         */
+        inline uint16_t GetExternalPort() const
+        {
+            return m_externalPort;
+        }
+
+        /**
+         * @brief Compares two snapshots for equality.
+         *
+         * @param other The other snapshot to compare with.
+         * @return true If all of the fields of the snapshots are equal.
+         * @return false If any of the fields of the snapshots differ.
+         */
+        bool operator==(const HostSettingsSnapshot& other) const;
+
+        /**
+         * @brief Compares two snapshots for inequality.
+         *
+         * @param other The other snapshot to compare with.
+         * @return true If any of the fields of the snapshots differ.
+         * @return false If all of the fields of the snapshots are equal.
+         */
+        inline bool operator!=(const HostSettingsSnapshot& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        // The paired host store persists the fields of snapshots
+        friend class PairedHostStore;
+
+        // Versions of the host
+        Version m_appVersion;
+        Version m_gfeVersion;
+        // The maximum luma pixels for HEVC encoding
+        uint64_t m_maxLumaPixelsHEVC;
+
+        // Interned strings of the host
+        uint32_t m_hostname;
+        uint32_t m_uniqueID;
+        uint32_t m_macAddress;
+        uint32_t m_localIP;
+
+        // The current game running on the host
+        int32_t m_currentGame;
+        // The server codec mode support of the host
+        int32_t m_serverCodecModeSupport;
+
+        // The ports of the host
+        uint16_t m_httpsPort;
+        uint16_t m_externalPort;
+
+        // The pair status and streaming state of the host
+        PairStatus m_pairStatus;
+        HostState m_hostState;
+    };
+
+    static_assert(std::is_trivially_copyable<HostSettingsSnapshot>::value, "HostSettingsSnapshot must be trivially copyable");
+} // namespace MoonlightOBS
@@ -0,0 +1,150 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Project includes
+#include "GameStreamHost.hpp"
+#include "HostSettingsSnapshot.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Stream preferences of a paired GameStream host.
+     *
+     */
+    struct StreamPreferences
+    {
+        uint32_t width          = 0;        // Width of the stream, or 0 for the host's preferred resolution
+        uint32_t height         = 0;        // Height of the stream, or 0 for the host's preferred resolution
+        float fps               = 0.0f;     // Frame rate of the stream (0 to match the canvas, -1 for the highest)
+        uint32_t bitrate        = 20000;    // Bitrate of the stream in Kbps
+        bool hardwareDecoding   = true;     // Use hardware decoding when available?
+    };
+
+    /**
+     * @brief A GameStream host which has been paired with, as kept by the PairedHostStore.
+     *
+     */
+    class PairedHost
+    {
+    public:
+        /**
+         * @brief Construct a new PairedHost object.
+         *
+         * @param host The hostname and addresses of the host.
+         * @param settings The most recent settings of the host.
+         * @param serverCertificate The PEM certificate of the host, pinned when pairing.
+         * @param preferences The stream preferences of the host.
+         */
+        inline PairedHost(const GameStreamHost& host, const HostSettingsSnapshot& settings,
+            std::string_view serverCertificate, const StreamPreferences& preferences) :
+            m_host(host),
+            m_settings(settings),
+            m_serverCertificate(serverCertificate),
+            m_preferences(preferences) {}
+
+        /**
+         * @brief Gets the unique ID of the host, which identifies it in the store.
+         *
+         * @return std::string_view The unique ID of the host.
+         */
+        inline std::string_view GetUniqueID() const
+        {
+            return m_settings.GetUniqueID();
+        }
+
+        /**
+         * @brief Gets the hostname and addresses of the host.
+         *
+         * @return const GameStreamHost& The hostname and addresses of the host.
+         */
+        inline const GameStreamHost& GetHost() const
+        {
+            return m_host;
+        }
+
+        /**
+         * @brief Sets the hostname and addresses of the host.
+         *
+         * @param host The hostname and addresses of the host.
+         */
+        inline void SetHost(const GameStreamHost& host)
+        {
+            m_host = host;
+        }
+
+        /**
+         * @brief Gets the most recent settings of the host.
+         *
+         * @return const HostSettingsSnapshot& The settings of the host.
+         */
+        inline const HostSettingsSnapshot& GetSettings() const
+        {
+            return m_settings;
+        }
+
+        /**
+         * @brief Sets the most recent settings of the host.
+         * @note The unique ID of the settings should match that of the host.
+         *
+         * @param settings The settings of the host.
+         */
+        inline void SetSettings(const HostSettingsSnapshot& settings)
+        {
+            m_settings = settings;
+        }
+
+        /**
+         * @brief Gets the PEM certificate of the host, pinned when pairing.
+         *
+         * @return const std::string& The certificate of the host.
+         */
+        inline const std::string& GetServerCertificate() const
+        {
+            return m_serverCertificate;
+        }
+
+        /**
+         * @brief Sets the PEM certificate of the host.
+         *
+         * @param serverCertificate The certificate of the host.
+         */
+        inline void SetServerCertificate(std::string_view serverCertificate)
+        {
+            m_serverCertificate = serverCertificate;
+        }
+
+        /**
+         * @brief Gets the stream preferences of the host.
+         *
+         * @return const StreamPreferences& The stream preferences of the host.
+         */
+        inline const StreamPreferences& GetPreferences() const
+        {
+            return m_preferences;
+        }
+
+        /**
+         * @brief Sets the stream preferences of the host.
+         *
+         * @param preferences The stream preferences of the host.
+         */
+        inline void SetPreferences(const StreamPreferences& preferences)
+        {
+            m_preferences = preferences;
+        }
+
+    private:
+        // Hostname and addresses of the host
+        GameStreamHost m_host;
+        // Most recent settings of the host
+        HostSettingsSnapshot m_settings;
+        // PEM certificate of the host
+        std::string m_serverCertificate;
+        // Stream preferences of the host
+        StreamPreferences m_preferences;
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,396 @@
+#include "PairedHostStore.hpp"
+
+// STL includes
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+
+// OBS Studio includes
+#include <util/base.h>
+
+// Project includes
+#include "../plugin-support.h"
+#include "../Utilities/FileIO.hpp"
+#include "../Utilities/StringInterner.hpp"
+#include "Address.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Name of the store in the configuration directory of the module
+    constexpr const char* StoreFileName = "paired_hosts.bin";
+
+    // Identifies the file as a store, and the version of its format
+    constexpr char StoreMagic[8] = { 'M', 'L', 'O', 'B', 'S', 'P', 'H', '\0' };
+    constexpr uint32_t StoreVersion = 1;
+
+    // Largest string accepted when reading the store
+    // (the longest, a PEM certificate, is a few kilobytes)
+    constexpr uint32_t MaxStringLength = 64 * 1024;
+
+    // Snapshot of the paired hosts published to readers
+    std::shared_ptr<const PairedHosts> g_hosts = std::make_shared<const PairedHosts>();
+    // Guards the snapshot pointer, which is only held to copy or replace it
+    std::mutex g_hostsMutex;
+    // Ensures the store is only loaded once
+    std::once_flag g_loadFlag;
+    // Serialises writers, which read, modify and replace the snapshot
+    std::mutex g_writeMutex;
+
+    // Gets the published snapshot of the hosts
+    std::shared_ptr<const PairedHosts> LoadSnapshot()
+    {
+        std::lock_guard<std::mutex> lock(g_hostsMutex);
+        return g_hosts;
+    }
+
+    // Publishes a new snapshot of the hosts
+    void StoreSnapshot(std::shared_ptr<const PairedHosts> hosts)
+    {
+        // The previous snapshot is released after unlocking, in case this was its last reference
+        std::lock_guard<std::mutex> lock(g_hostsMutex);
+        g_hosts.swap(hosts);
+    }
+
+    // Appends an integer in little-endian order
+    template <typename T>
+    void WriteInteger(std::string& buffer, T value)
+    {
+        static_assert(std::is_integral<T>::value, "Only integers can be written");
+
+        using Unsigned = typename std::make_unsigned<T>::type;
+        Unsigned bits = static_cast<Unsigned>(value);
+        for (size_t i = 0; i < sizeof(T); i++)
+        {
+            buffer.push_back(static_cast<char>((bits >> (i * 8)) & 0xFF));
+        }
+    }
+
+    // Reads an integer in little-endian order, advancing past it
+    template <typename T>
+    T ReadInteger(std::string_view& data)
+    {
+        static_assert(std::is_integral<T>::value, "Only integers can be read");
+
+        if (data.size() < sizeof(T))
+        {
+            throw std::invalid_argument("Paired host store is truncated");
+        }
+
+        using Unsigned = typename std::make_unsigned<T>::type;
+        Unsigned bits = 0;
+        for (size_t i = 0; i < sizeof(T); i++)
+        {
+            bits |= static_cast<Unsigned>(static_cast<Unsigned>(static_cast<uint8_t>(data[i])) << (i * 8));
+        }
+        data.remove_prefix(sizeof(T));
+
+        return static_cast<T>(bits);
+    }
+
+    // Appends a length-prefixed string
+    void WriteString(std::string& buffer, std::string_view value)
+    {
+        WriteInteger<uint32_t>(buffer, static_cast<uint32_t>(value.size()));
+        buffer.append(value);
+    }
+
+    // Reads a length-prefixed string, advancing past it
+    std::string_view ReadString(std::string_view& data)
+    {
+        uint32_t length = ReadInteger<uint32_t>(data);
+        if (length > MaxStringLength || length > data.size())
+        {
+            throw std::invalid_argument("Paired host store has an invalid string");
+        }
+
+        std::string_view value = data.substr(0, length);
+        data.remove_prefix(length);
+
+        return value;
+    }
+
+    // Appends an address, as text
+    void WriteAddress(std::string& buffer, const Address& address)
+    {
+        std::array<char, Address::MaxStringSize> text;
+        WriteString(buffer, std::string_view(text.data(), address.Format(text.data(), text.size())));
+    }
+
+    // Reads an address, advancing past it
+    Address ReadAddress(std::string_view& data)
+    {
+        std::string_view text = ReadString(data);
+
+        Address address;
+        if (!text.empty() && !Address::TryParse(text, address))
+        {
+            throw std::invalid_argument("Paired host store has an invalid address");
+        }
+
+        return address;
+    }
+
+    // Appends a floating-point number, as its bit pattern
+    void WriteFloat(std::string& buffer, float value)
+    {
+        static_assert(sizeof(float) == sizeof(uint32_t), "float must be 32 bits");
+
+        uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        WriteInteger<uint32_t>(buffer, bits);
+    }
+
+    // Reads a floating-point number, advancing past it
+    float ReadFloat(std::string_view& data)
+    {
+        uint32_t bits = ReadInteger<uint32_t>(data);
+
+        float value = 0.0f;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Calculates the checksum which ends the store (FNV-1a)
+    uint64_t Checksum(std::string_view data)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (char byte : data)
+        {
+            hash ^= static_cast<uint8_t>(byte);
+            hash *= 1099511628211ull;
+        }
+
+        return hash;
+    }
+}
+
+std::shared_ptr<const PairedHosts> PairedHostStore::GetHosts()
+{
+    EnsureLoaded();
+
+    return LoadSnapshot();
+}
+
+std::optional<PairedHost> PairedHostStore::Find(std::string_view uniqueID)
+{
+    std::shared_ptr<const PairedHosts> hosts = GetHosts();
+    for (const PairedHost& host : *hosts)
+    {
+        if (host.GetUniqueID() == uniqueID)
+        {
+            return host;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void PairedHostStore::Save(const PairedHost& host)
+{
+    if (host.GetUniqueID().empty())
+    {
+        throw std::invalid_argument("Cannot save a paired host without a unique ID");
+    }
+
+    EnsureLoaded();
+    std::lock_guard<std::mutex> lock(g_writeMutex);
+
+    // Copy the current hosts, replacing the host if it's already paired
+    auto hosts = std::make_shared<PairedHosts>(*LoadSnapshot());
+    bool replaced = false;
+    for (PairedHost& existingHost : *hosts)
+    {
+        if (existingHost.GetUniqueID() == host.GetUniqueID())
+        {
+            existingHost = host;
+            replaced = true;
+            break;
+        }
+    }
+    if (!replaced)
+    {
+        hosts->push_back(host);
+    }
+
+    Publish(std::move(hosts));
+}
+
+bool PairedHostStore::Remove(std::string_view uniqueID)
+{
+    EnsureLoaded();
+    std::lock_guard<std::mutex> lock(g_writeMutex);
+
+    auto hosts = std::make_shared<PairedHosts>(*LoadSnapshot());
+    for (auto iterator = hosts->begin(); iterator != hosts->end(); ++iterator)
+    {
+        if (iterator->GetUniqueID() == uniqueID)
+        {
+            hosts->erase(iterator);
+            Publish(std::move(hosts));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void PairedHostStore::EnsureLoaded()
+{
+    std::call_once(g_loadFlag, []()
+    {
+        std::string path;
+        try
+        {
+            path = FileIO::GetConfigPath(StoreFileName);
+            MappedFile file(path);
+            if (file.Exists())
+            {
+                StoreSnapshot(std::make_shared<const PairedHosts>(Deserialize(file.GetView())));
+            }
+        }
+        catch (const std::exception& exception)
+        {
+            // Start with no paired hosts, rather than failing every read
+            // (the store is only replaced once a host is saved)
+            obs_log(LOG_WARNING, "Failed to load paired hosts from %s: %s", path.c_str(), exception.what());
+        }
+    });
+}
+
+void PairedHostStore::Publish(std::shared_ptr<const PairedHosts> hosts)
+{
+    // Only publish the hosts once they're on disk, so readers never see hosts which would be lost
+    FileIO::WriteAtomically(FileIO::GetConfigPath(StoreFileName), Serialize(*hosts));
+    StoreSnapshot(std::move(hosts));
+}
+
+std::string PairedHostStore::Serialize(const PairedHosts& hosts)
+{
+    std::string buffer;
+    buffer.reserve(64 + hosts.size() * 2048);
+
+    buffer.append(StoreMagic, sizeof(StoreMagic));
+    WriteInteger<uint32_t>(buffer, StoreVersion);
+    WriteInteger<uint32_t>(buffer, static_cast<uint32_t>(hosts.size()));
+
+    for (const PairedHost& host : hosts)
+    {
+        WriteString(buffer, host.GetHost().GetHostname());
+        WriteAddress(buffer, host.GetHost().GetIPv4Address());
+        WriteAddress(buffer, host.GetHost().GetIPv6Address());
+        SerializeSettings(buffer, host.GetSettings());
+        WriteString(buffer, host.GetServerCertificate());
+
+        const StreamPreferences& preferences = host.GetPreferences();
+        WriteInteger<uint32_t>(buffer, preferences.width);
+        WriteInteger<uint32_t>(buffer, preferences.height);
+        WriteFloat(buffer, preferences.fps);
+        WriteInteger<uint32_t>(buffer, preferences.bitrate);
+        WriteInteger<uint8_t>(buffer, preferences.hardwareDecoding ? 1 : 0);
+    }
+
+    WriteInteger<uint64_t>(buffer, Checksum(buffer));
+    return buffer;
+}
+
+PairedHosts PairedHostStore::Deserialize(std::string_view data)
+{
+    // Verify the header and checksum before reading anything else
+    if (data.size() < sizeof(StoreMagic) + sizeof(uint64_t) ||
+        std::memcmp(data.data(), StoreMagic, sizeof(StoreMagic)) != 0)
+    {
+        throw std::invalid_argument("File is not a paired host store");
+    }
+
+    std::string_view checksumData = data.substr(data.size() - sizeof(uint64_t));
+    data.remove_suffix(sizeof(uint64_t));
+    if (ReadInteger<uint64_t>(checksumData) != Checksum(data))
+    {
+        throw std::invalid_argument("Paired host store is corrupt");
+    }
+
+    data.remove_prefix(sizeof(StoreMagic));
+    uint32_t version = ReadInteger<uint32_t>(data);
+    if (version != StoreVersion)
+    {
+        throw std::invalid_argument("Unsupported paired host store version: " + std::to_string(version));
+    }
+
+    uint32_t count = ReadInteger<uint32_t>(data);
+    PairedHosts hosts;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        std::string_view hostname = ReadString(data);
+        Address ipv4Address = ReadAddress(data);
+        Address ipv6Address = ReadAddress(data);
+        HostSettingsSnapshot settings = DeserializeSettings(data);
+        std::string_view serverCertificate = ReadString(data);
+
+        StreamPreferences preferences;
+        preferences.width = ReadInteger<uint32_t>(data);
+        preferences.height = ReadInteger<uint32_t>(data);
+        preferences.fps = ReadFloat(data);
+        preferences.bitrate = ReadInteger<uint32_t>(data);
+        preferences.hardwareDecoding = ReadInteger<uint8_t>(data) != 0;
+
+        hosts.emplace_back(GameStreamHost(hostname, ipv4Address, ipv6Address), settings,
+            serverCertificate, preferences);
+    }
+
+    if (!data.empty())
+    {
+        throw std::invalid_argument("Paired host store has trailing data");
+    }
+
+    return hosts;
+}
+
+void PairedHostStore::SerializeSettings(std::string& buffer, const HostSettingsSnapshot& settings)
+{
+    WriteString(buffer, settings.GetHostname());
+    WriteString(buffer, settings.GetUniqueID());
+    WriteString(buffer, settings.GetMacAddress());
+    WriteString(buffer, settings.GetLocalIP());
+    WriteInteger<uint64_t>(buffer, settings.m_appVersion.GetKey());
+    WriteInteger<uint64_t>(buffer, settings.m_gfeVersion.GetKey());
+    WriteInteger<uint64_t>(buffer, settings.m_maxLumaPixelsHEVC);
+    WriteInteger<int32_t>(buffer, settings.m_currentGame);
+    WriteInteger<int32_t>(buffer, settings.m_serverCodecModeSupport);
+    WriteInteger<uint16_t>(buffer, settings.m_httpsPort);
+    WriteInteger<uint16_t>(buffer, settings.m_externalPort);
+    WriteInteger<uint8_t>(buffer, static_cast<uint8_t>(settings.m_pairStatus));
+    WriteInteger<uint8_t>(buffer, static_cast<uint8_t>(settings.m_hostState));
+}
+
+HostSettingsSnapshot PairedHostStore::DeserializeSettings(std::string_view& data)
+{
+    HostSettingsSnapshot settings;
+    settings.m_hostname = StringInterner::Intern(ReadString(data));
+    settings.m_uniqueID = StringInterner::Intern(ReadString(data));
+    settings.m_macAddress = StringInterner::Intern(ReadString(data));
+    settings.m_localIP = StringInterner::Intern(ReadString(data));
+    settings.m_appVersion = Version::FromKey(ReadInteger<uint64_t>(data));
+    settings.m_gfeVersion = Version::FromKey(ReadInteger<uint64_t>(data));
+    settings.m_maxLumaPixelsHEVC = ReadInteger<uint64_t>(data);
+    settings.m_currentGame = ReadInteger<int32_t>(data);
+    settings.m_serverCodecModeSupport = ReadInteger<int32_t>(data);
+    settings.m_httpsPort = ReadInteger<uint16_t>(data);
+    settings.m_externalPort = ReadInteger<uint16_t>(data);
+
+    uint8_t pairStatus = ReadInteger<uint8_t>(data);
+    uint8_t hostState = ReadInteger<uint8_t>(data);
+    if (pairStatus > static_cast<uint8_t>(PairStatus::Paired) || hostState > static_cast<uint8_t>(HostState::SERVER_BUSY))
+    {
+        throw std::invalid_argument("Paired host store has invalid host settings");
+    }
+    settings.m_pairStatus = static_cast<PairStatus>(pairStatus);
+    settings.m_hostState = static_cast<HostState>(hostState);
+
+    return settings;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+// STL includes
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Project includes
+#include "PairedHost.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief The paired hosts held by the PairedHostStore.
+     *
+     */
+    using PairedHosts = std::vector<PairedHost>;
+
+    /**
+     * @brief Static helper class which persists the paired GameStream hosts
+     *        in the configuration directory of the module.
+     *
+     * The store is loaded (memory-mapped) on first use. Readers get an immutable
+     * snapshot of the hosts, locking only to copy its pointer, so they never wait on
+     * the disk. Writers replace the file atomically, so it's never left partly written,
+     * and then publish a new snapshot.
+     *
+     */
+    class PairedHostStore
+    {
+    public:
+        /**
+         * @brief Gets a snapshot of the paired hosts.
+         * @note The snapshot isn't changed by later writes, so it may be kept and read freely.
+         *
+         * @return std::shared_ptr<const PairedHosts> The paired hosts, in the order they were paired.
+         */
+        static std::shared_ptr<const PairedHosts> GetHosts();
+
+        /**
+         * @brief Finds a paired host by its unique ID.
+         *
+         * @param uniqueID The unique ID of the host.
+         * @return std::optional<PairedHost> The paired host, or nothing if it isn't paired.
+         */
+        static std::optional<PairedHost> Find(std::string_view uniqueID);
+
+        /**
+         * @brief Adds a paired host, or replaces it if a host with the same unique ID is paired.
+         *
+         * @param host The paired host.
+         *
+         * @exception std::invalid_argument If the host has no unique ID.
+         * @exception std::runtime_error If the store could not be written.
+         */
+        static void Save(const PairedHost& host);
+
+        /**
+         * @brief Removes a paired host.
+         *
+         * @param uniqueID The unique ID of the host.
+         * @return true If the host was removed.
+         * @return false If the host wasn't paired.
+         *
+         * @exception std::runtime_error If the store could not be written.
+         */
+        static bool Remove(std::string_view uniqueID);
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        PairedHostStore()                                   = delete;
+        PairedHostStore(const PairedHostStore&)             = delete;
+        PairedHostStore& operator=(const PairedHostStore&)  = delete;
+        ~PairedHostStore()                                  = delete;
+
+    private:
+        // Loads the store from disk, if it hasn't been loaded yet
+        static void EnsureLoaded();
+        // Replaces the store on disk, and publishes the hosts to readers
+        static void Publish(std::shared_ptr<const PairedHosts> hosts);
+
+        // Converts the hosts to and from the format of the store
+        static std::string Serialize(const PairedHosts& hosts);
+        static PairedHosts Deserialize(std::string_view data);
+        // Converts the settings of a host to and from the format of the store
+        // (these access the private members of the snapshot)
+        static void SerializeSettings(std::string& buffer, const HostSettingsSnapshot& settings);
+        static HostSettingsSnapshot DeserializeSettings(std::string_view& data);
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,138 @@
+#include "ResponseBuffer.hpp"
+
+// STL includes
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+using namespace MoonlightOBS;
+
+namespace MoonlightOBS
+{
+    // Process-wide pool of idle response buffers
+    class ResponseBufferPool
+    {
+    public:
+        // Maximum number of idle buffers kept by the pool
+        static constexpr size_t MaxIdleBuffers      = 4;
+        // Buffers larger than this are freed instead of being kept by the pool
+        static constexpr size_t MaxRetainedCapacity = 4 * 1024 * 1024;
+
+        static ResponseBuffer* Take()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_idleBuffers.empty())
+                {
+                    ResponseBuffer* buffer = m_idleBuffers.back();
+                    m_idleBuffers.pop_back();
+                    return buffer;
+                }
+            }
+
+            return new ResponseBuffer();
+        }
+
+        static void Return(ResponseBuffer* buffer) noexcept
+        {
+            buffer->Clear();
+
+            if (buffer->GetCapacity() <= MaxRetainedCapacity)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_idleBuffers.size() < MaxIdleBuffers)
+                {
+                    // Storage for MaxIdleBuffers is reserved up front, so this can't throw
+                    m_idleBuffers.push_back(buffer);
+                    return;
+                }
+            }
+
+            delete buffer;
+        }
+
+    private:
+        static std::mutex m_mutex;
+        static std::vector<ResponseBuffer*> m_idleBuffers;
+
+        static std::vector<ResponseBuffer*> CreateIdleList()
+        {
+            std::vector<ResponseBuffer*> idleBuffers;
+            idleBuffers.reserve(MaxIdleBuffers);
+            return idleBuffers;
+        }
+    };
+
+    std::mutex ResponseBufferPool::m_mutex;
+    std::vector<ResponseBuffer*> ResponseBufferPool::m_idleBuffers = ResponseBufferPool::CreateIdleList();
+} // namespace MoonlightOBS
+
+void ResponseBuffer::Releaser::operator()(ResponseBuffer* buffer) const noexcept
+{
+    if (buffer != nullptr)
+    {
+        ResponseBufferPool::Return(buffer);
+    }
+}
+
+ResponseBuffer::Pointer ResponseBuffer::Acquire()
+{
+    return Pointer(ResponseBufferPool::Take());
+}
+
+bool ResponseBuffer::Reserve(size_t size) noexcept
+{
+    // Check if the buffer is already large enough
+    if (size <= m_capacity)
+    {
+        return true;
+    }
+    // Refuse responses larger than the hard limit
+    else if (size > MaxSize)
+    {
+        return false;
+    }
+
+    // Allocate the new storage without throwing on failure
+    std::unique_ptr<char[]> data(new (std::nothrow) char[size]);
+    if (data == nullptr)
+    {
+        return false;
+    }
+
+    // Move the existing data into the new storage
+    if (m_size > 0)
+    {
+        std::memcpy(data.get(), m_data.get(), m_size);
+    }
+
+    m_data      = std::move(data);
+    m_capacity  = size;
+    return true;
+}
+
+bool ResponseBuffer::Append(const char* data, size_t length) noexcept
+{
+    // Check the appended data won't exceed the hard limit
+    if (length > MaxSize - m_size)
+    {
+        return false;
+    }
+
+    // Grow geometrically when the Content-Length wasn't known up front
+    size_t requiredSize = m_size + length;
+    if (requiredSize > m_capacity)
+    {
+        size_t newCapacity = std::min(std::max(requiredSize, m_capacity * 2), MaxSize);
+        if (!Reserve(newCapacity))
+        {
+            return false;
+        }
+    }
+
+    std::memcpy(m_data.get() + m_size, data, length);
+    m_size = requiredSize;
+    return true;
+}
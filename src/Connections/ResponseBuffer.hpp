@@ -0,0 +1,125 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Reusable buffer holding the body of a HTTP response.
+     *
+     * Buffers are acquired from a process-wide pool and returned to it once the
+     * owning handle goes out of scope, so repeated requests reuse the same memory
+     * instead of growing a fresh string for every response.
+     *
+     */
+    class ResponseBuffer
+    {
+    private:
+        // Returns a buffer to the pool once its handle is destroyed
+        struct Releaser
+        {
+            void operator()(ResponseBuffer* buffer) const noexcept;
+        };
+
+    public:
+        /**
+         * @brief Handle to a pooled ResponseBuffer, returning it to the pool when destroyed.
+         *
+         */
+        using Pointer = std::unique_ptr<ResponseBuffer, Releaser>;
+
+        /**
+         * @brief The largest response body that will be accepted. (16 MiB)
+         *
+         */
+        static constexpr size_t MaxSize = 16 * 1024 * 1024;
+
+        /**
+         * @brief Acquires an empty buffer from the pool, allocating a new one if none are idle.
+         * @exception std::bad_alloc If a new buffer could not be allocated.
+         *
+         * @return Pointer Handle to the acquired buffer.
+         */
+        static Pointer Acquire();
+
+        /**
+         * @brief Ensures the buffer can hold at least the given number of bytes
+         *        without reallocating.
+         *
+         * @param size The number of bytes expected to be written.
+         * @return true If the buffer has room for the given number of bytes.
+         * @return false If the size exceeds MaxSize or the allocation failed.
+         */
+        bool Reserve(size_t size) noexcept;
+
+        /**
+         * @brief Appends data to the end of the buffer, growing it if required.
+         *
+         * @param data The data to append.
+         * @param length The number of bytes to append.
+         * @return true If the data was appended.
+         * @return false If the buffer would exceed MaxSize or the allocation failed,
+         *         in which case the buffer is left unchanged.
+         */
+        bool Append(const char* data, size_t length) noexcept;
+
+        /**
+         * @brief Discards the contents of the buffer, keeping its capacity.
+         *
+         */
+        inline void Clear() noexcept
+        {
+            m_size = 0;
+        }
+
+        /**
+         * @brief Gets a view of the data held in the buffer.
+         * @note The view is only valid until the buffer is modified or released.
+         *
+         * @return std::string_view View of the buffered data.
+         */
+        inline std::string_view GetView() const noexcept
+        {
+            return std::string_view(m_data.get(), m_size);
+        }
+
+        /**
+         * @brief Gets the number of bytes held in the buffer.
+         *
+         * @return size_t The number of bytes held in the buffer.
+         */
+        inline size_t GetSize() const noexcept
+        {
+            return m_size;
+        }
+
+        /**
+         * @brief Gets the number of bytes the buffer can hold without reallocating.
+         *
+         * @return size_t The capacity of the buffer.
+         */
+        inline size_t GetCapacity() const noexcept
+        {
+            return m_capacity;
+        }
+
+    private:
+        ResponseBuffer()                                    = default;
+        ~ResponseBuffer()                                   = default;
+        ResponseBuffer(const ResponseBuffer&)               = delete;
+        ResponseBuffer& operator=(const ResponseBuffer&)    = delete;
+
+        // Allows the pool to create and destroy buffers
+        friend class ResponseBufferPool;
+
+        // Buffered data
+        std::unique_ptr<char[]> m_data;
+        // Number of bytes held in the buffer
+        size_t m_size       = 0;
+        // Number of bytes allocated for the buffer
+        size_t m_capacity   = 0;
+    };
+} // namespace MoonlightOBS
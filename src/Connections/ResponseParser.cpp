@@ -0,0 +1,50 @@
+#include "ResponseParser.hpp"
+
+// STL includes
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace MoonlightOBS;
+
+ResponseParser::ResponseParser()
+    : m_reader(*this), m_statusCode(StatusOK), m_statusMessage() {}
+
+void ResponseParser::Feed(std::string_view chunk)
+{
+    m_reader.Feed(chunk);
+}
+
+void ResponseParser::FinishResponse()
+{
+    m_reader.Finish();
+
+    if (m_statusCode != StatusOK)
+    {
+        throw std::runtime_error("Host responded with status " + std::to_string(m_statusCode) +
+            (m_statusMessage.empty() ? std::string() : ": " + m_statusMessage));
+    }
+}
+
+void ResponseParser::OnAttribute(std::string_view name, std::string_view value, size_t depth)
+{
+    // Only the attributes of the root element report the status
+    if (depth != 0)
+    {
+        return;
+    }
+
+    if (name == "status_code")
+    {
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), m_statusCode);
+        if (error != std::errc() || end != value.data() + value.size())
+        {
+            throw std::invalid_argument("XML parsing error: Invalid status code '" + std::string(value) + "'");
+        }
+    }
+    else if (name == "status_message")
+    {
+        m_statusMessage.assign(value);
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// STL includes
+#include <string>
+#include <string_view>
+
+// Project includes
+#include "../Utilities/XMLStreamReader.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Base class for the streaming parsers of GameStream host responses.
+     *
+     * Every response has a "root" element whose "status_code" and "status_message"
+     * attributes report whether the request succeeded (e.g. a host which doesn't
+     * recognise the client certificate responds with status 401 and no other elements).
+     * The status is read here, so the derived parsers only handle the elements they need.
+     *
+     */
+    class ResponseParser : protected XMLStreamReader::Handler
+    {
+    public:
+        /**
+         * @brief The status code of a successful response.
+         *
+         */
+        static constexpr int StatusOK = 200;
+
+        /**
+         * @brief Parses the next chunk of the response.
+         * @exception std::invalid_argument If the response is invalid, or is unable to be parsed.
+         *
+         * @param chunk The next chunk of the response.
+         */
+        void Feed(std::string_view chunk);
+
+    protected:
+        /**
+         * @brief Construct a new ResponseParser object.
+         *
+         */
+        ResponseParser();
+
+        /**
+         * @brief Completes reading the response, and checks its status.
+         * @exception std::invalid_argument If the response is incomplete.
+         * @exception std::runtime_error If the host reported that the request failed.
+         *
+         */
+        void FinishResponse();
+
+        // XMLStreamReader::Handler implementation
+        void OnAttribute(std::string_view name, std::string_view value, size_t depth) override;
+
+    private:
+        // Tokenizer for the response
+        XMLStreamReader m_reader;
+
+        // Status reported by the root element
+        // (responses without a status, such as those of older hosts, are treated as successful)
+        int m_statusCode;
+        std::string m_statusMessage;
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,392 @@
+#include "ServerInfoParser.hpp"
+
+// STL includes
+#include <array>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Project includes
+#include "../Utilities/Version.hpp"
+
+using namespace MoonlightOBS;
+
+enum class ServerInfoParser::Field : uint8_t
+{
+    Hostname,
+    AppVersion,
+    GfeVersion,
+    UniqueID,
+    HttpsPort,
+    ExternalPort,
+    MaxLumaPixelsHEVC,
+    MacAddress,
+    LocalIP,
+    ServerCodecModeSupport,
+    PairStatus,
+    CurrentGame,
+    State,
+    Count,
+    None
+};
+
+namespace
+{
+    using Field = ServerInfoParser::Field;
+
+    // Maps the name of an element to the field it's parsed into
+    struct FieldEntry
+    {
+        std::string_view name;
+        Field field;
+    };
+
+    // Elements of the /serverinfo response which are parsed
+    constexpr std::array<FieldEntry, static_cast<size_t>(Field::Count)> FieldNames =
+    {{
+        { "hostname",               Field::Hostname },
+        { "appversion",             Field::AppVersion },
+        { "GfeVersion",             Field::GfeVersion },
+        { "uniqueid",               Field::UniqueID },
+        { "HttpsPort",              Field::HttpsPort },
+        { "ExternalPort",           Field::ExternalPort },
+        { "MaxLumaPixelsHEVC",      Field::MaxLumaPixelsHEVC },
+        { "mac",                    Field::MacAddress },
+        { "LocalIP",                Field::LocalIP },
+        { "ServerCodecModeSupport", Field::ServerCodecModeSupport },
+        { "PairStatus",             Field::PairStatus },
+        { "currentgame",            Field::CurrentGame },
+        { "state",                  Field::State },
+    }};
+
+    // Bitmask of all of the fields, all of which are required to be present in the response
+    constexpr uint32_t RequiredFields = (1u << static_cast<uint32_t>(Field::Count)) - 1;
+
+    // Number of slots in the perfect hash table (must be a power of two)
+    constexpr uint32_t FieldTableSize = 32;
+
+    // Seeded 32-bit FNV-1a hash of an element name
+    constexpr uint32_t HashName(std::string_view name, uint32_t seed)
+    {
+        uint32_t hash = 2166136261u ^ seed;
+        for (char character : name)
+        {
+            hash ^= static_cast<uint8_t>(character);
+            hash *= 16777619u;
+        }
+
+        return hash;
+    }
+
+    // Checks if a seed maps every element name to a unique slot
+    constexpr bool IsPerfectSeed(uint32_t seed)
+    {
+        uint32_t usedSlots = 0;
+        for (const FieldEntry& entry : FieldNames)
+        {
+            uint32_t slotBit = 1u << (HashName(entry.name, seed) & (FieldTableSize - 1));
+            if ((usedSlots & slotBit) != 0)
+            {
+                return false;
+            }
+
+            usedSlots |= slotBit;
+        }
+
+        return true;
+    }
+
+    // Finds the first seed which gives a perfect hash of the element names
+    constexpr uint32_t FindPerfectSeed()
+    {
+        uint32_t seed = 0;
+        while (!IsPerfectSeed(seed))
+        {
+            ++seed;
+        }
+
+        return seed;
+    }
+
+    constexpr uint32_t FieldHashSeed = FindPerfectSeed();
+    static_assert(IsPerfectSeed(FieldHashSeed), "Element names must hash to unique slots");
+
+    // Builds the perfect hash table of the element names
+    constexpr std::array<FieldEntry, FieldTableSize> BuildFieldTable()
+    {
+        std::array<FieldEntry, FieldTableSize> table = {};
+        for (FieldEntry& slot : table)
+        {
+            slot = { std::string_view(), Field::None };
+        }
+
+        for (const FieldEntry& entry : FieldNames)
+        {
+            table[HashName(entry.name, FieldHashSeed) & (FieldTableSize - 1)] = entry;
+        }
+
+        return table;
+    }
+
+    constexpr std::array<FieldEntry, FieldTableSize> FieldTable = BuildFieldTable();
+
+    // Looks up the field an element is parsed into
+    inline Field LookupField(std::string_view name)
+    {
+        const FieldEntry& entry = FieldTable[HashName(name, FieldHashSeed) & (FieldTableSize - 1)];
+        return entry.name == name ? entry.field : Field::None;
+    }
+
+    // Removes leading and trailing whitespace from text
+    inline std::string_view TrimWhitespace(std::string_view text)
+    {
+        constexpr std::string_view whitespace = " \t\r\n";
+
+        size_t start = text.find_first_not_of(whitespace);
+        if (start == std::string_view::npos)
+        {
+            return std::string_view();
+        }
+
+        return text.substr(start, text.find_last_not_of(whitespace) - start + 1);
+    }
+}
+
+ServerInfoParser::ServerInfoParser()
+    : m_currentField(Field::None), m_parsedFields(0), m_value(), m_valueLength(0) {}
+
+HostSettings ServerInfoParser::Finish()
+{
+    FinishResponse();
+
+    // Ensure all of the required elements were present
+    if ((m_parsedFields & RequiredFields) != RequiredFields)
+    {
+        for (const FieldEntry& entry : FieldNames)
+        {
+            if ((m_parsedFields & (1u << static_cast<uint32_t>(entry.field))) == 0)
+            {
+                throw std::invalid_argument("XML parsing error: Element '" + std::string(entry.name) + "' is missing");
+            }
+        }
+    }
+
+    return m_settings;
+}
+
+void ServerInfoParser::OnStartElement(std::string_view name, size_t depth)
+{
+    // Only the direct children of the root element are parsed
+    m_currentField = depth == 1 ? LookupField(name) : Field::None;
+    m_valueLength  = 0;
+
+    // String fields are parsed directly into the settings
+    std::string* stringField = GetStringField(m_currentField);
+    if (stringField != nullptr)
+    {
+        stringField->clear();
+    }
+}
+
+void ServerInfoParser::OnText(std::string_view text, size_t depth)
+{
+    if (depth != 1 || m_currentField == Field::None)
+    {
+        return;
+    }
+
+    std::string* stringField = GetStringField(m_currentField);
+    if (stringField != nullptr)
+    {
+        stringField->append(text);
+    }
+    else if (text.size() <= m_value.size() - m_valueLength)
+    {
+        text.copy(m_value.data() + m_valueLength, text.size());
+        m_valueLength += text.size();
+    }
+    else
+    {
+        throw std::invalid_argument("XML parsing error: Element value is too long");
+    }
+}
+
+void ServerInfoParser::OnEndElement(std::string_view name, size_t depth)
+{
+    if (depth != 1 || m_currentField == Field::None)
+    {
+        return;
+    }
+
+    ParseValue(name, std::string_view(m_value.data(), m_valueLength));
+
+    m_parsedFields |= 1u << static_cast<uint32_t>(m_currentField);
+    m_currentField  = Field::None;
+}
+
+std::string* ServerInfoParser::GetStringField(Field field)
+{
+    switch (field)
+    {
+        case Field::Hostname:
+            return &m_settings.m_hostname;
+
+        case Field::UniqueID:
+            return &m_settings.m_uniqueID;
+
+        case Field::MacAddress:
+            return &m_settings.m_macAddress;
+
+        case Field::LocalIP:
+            return &m_settings.m_localIP;
+
+        default:
+            return nullptr;
+    }
+}
+
+void ServerInfoParser::ParseValue(std::string_view name, std::string_view value)
+{
+    switch (m_currentField)
+    {
+        // Parse the string elements, which have been written directly into the settings
+        case Field::Hostname:
+        case Field::UniqueID:
+        case Field::MacAddress:
+        case Field::LocalIP:
+        {
+            if (GetStringField(m_currentField)->empty())
+            {
+                throw std::invalid_argument("XML parsing error: Element '" + std::string(name) + "' is empty");
+            }
+            break;
+        }
+
+        // Parse the "appversion" and "GfeVersion" elements
+        case Field::AppVersion:
+        case Field::GfeVersion:
+        {
+            value = TrimWhitespace(value);
+            if (value.empty())
+            {
+                throw std::invalid_argument("XML parsing error: Element '" + std::string(name) + "' is empty");
+            }
+
+            try
+            {
+                Version& version = m_currentField == Field::AppVersion ? m_settings.m_appVersion : m_settings.m_gfeVersion;
+                version = Version::FromString(value);
+            }
+            catch (const std::exception& exception)
+            {
+                throw std::invalid_argument("XML parsing error: " + std::string(exception.what()));
+            }
+            break;
+        }
+
+        // Parse the "HttpsPort" and "ExternalPort" elements
+        case Field::HttpsPort:
+        case Field::ExternalPort:
+        {
+            int port = ParseInt(name, value);
+            if (port < 0 || port > 65535)
+            {
+                throw std::invalid_argument("XML parsing error: Element '" + std::string(name) + "' is not a valid port number");
+            }
+
+            uint16_t& field = m_currentField == Field::HttpsPort ? m_settings.m_httpsPort : m_settings.m_externalPort;
+            field = static_cast<uint16_t>(port);
+            break;
+        }
+
+        // Parse the "MaxLumaPixelsHEVC" element
+        case Field::MaxLumaPixelsHEVC:
+            m_settings.m_maxLumaPixelsHEVC = ParseUInt64(name, value);
+            break;
+
+        // Parse the "ServerCodecModeSupport" element
+        case Field::ServerCodecModeSupport:
+            m_settings.m_serverCodecModeSupport = ParseInt(name, value);
+            break;
+
+        // Parse the "currentgame" element
+        case Field::CurrentGame:
+            m_settings.m_currentGame = ParseInt(name, value);
+            break;
+
+        // Parse the "PairStatus" element
+        case Field::PairStatus:
+        {
+            int pairStatus = ParseInt(name, value);
+            switch (pairStatus)
+            {
+                case 0:
+                    m_settings.m_pairStatus = PairStatus::Unpaired;
+                    break;
+                case 1:
+                    m_settings.m_pairStatus = PairStatus::Paired;
+                    break;
+                default:
+                    throw std::invalid_argument("XML parsing error: Element '" + std::string(name) +
+                        "' has an unknown PairStatus value: " + std::to_string(pairStatus));
+            }
+            break;
+        }
+
+        // Parse the "state" element
+        case Field::State:
+        {
+            value = TrimWhitespace(value);
+            if (value.empty())
+            {
+                throw std::invalid_argument("XML parsing error: Element '" + std::string(name) + "' is empty");
+            }
+            else if (value == "SUNSHINE_SERVER_FREE")
+            {
+                m_settings.m_hostState = HostState::SERVER_FREE;
+            }
+            else if (value == "SUNSHINE_SERVER_BUSY")
+            {
+                m_settings.m_hostState = HostState::SERVER_BUSY;
+            }
+            else
+            {
+                throw std::invalid_argument("XML parsing error: Element '" + std::string(name) +
+                    "' has an unknown value: " + std::string(value));
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+uint64_t ServerInfoParser::ParseUInt64(std::string_view name, std::string_view value)
+{
+    value = TrimWhitespace(value);
+
+    uint64_t result = 0;
+    auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (value.empty() || error != std::errc() || end != value.data() + value.size())
+    {
+        throw std::invalid_argument("XML parsing error: Element '" + std::string(name) + "' is not a valid unsigned integer");
+    }
+
+    return result;
+}
+
+int ServerInfoParser::ParseInt(std::string_view name, std::string_view value)
+{
+    value = TrimWhitespace(value);
+
+    int result = 0;
+    auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (value.empty() || error != std::errc() || end != value.data() + value.size())
+    {
+        throw std::invalid_argument("XML parsing error: Element '" + std::string(name) + "' is not a integer");
+    }
+
+    return result;
+}
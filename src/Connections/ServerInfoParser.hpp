@@ -0,0 +1,77 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Project includes
+#include "HostSettings.hpp"
+#include "ResponseParser.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Streaming parser for the /serverinfo response of a GameStream host.
+     *
+     * The response can be fed in chunks as it's received, with each element being
+     * written straight into the HostSettings being built, without building a document tree.
+     *
+     */
+    class ServerInfoParser final : public ResponseParser
+    {
+    public:
+        /**
+         * @brief Elements of the response which are parsed.
+         *
+         */
+        enum class Field : uint8_t;
+
+        /**
+         * @brief Construct a new ServerInfoParser object.
+         *
+         */
+        ServerInfoParser();
+
+        /**
+         * @brief Completes parsing of the response.
+         * @exception std::invalid_argument If the response is incomplete,
+         *            or is missing any of the required elements.
+         * @exception std::runtime_error If the host reported that the request failed.
+         *
+         * @return HostSettings The settings parsed from the response.
+         */
+        HostSettings Finish();
+
+    private:
+        // Settings being filled in by the parser
+        HostSettings m_settings;
+
+        // Element currently being parsed
+        Field m_currentField;
+        // Bitmask of the elements which have been parsed
+        uint32_t m_parsedFields;
+
+        // Text of the current element, for elements which aren't parsed directly into a string
+        std::array<char, 64> m_value;
+        size_t m_valueLength;
+
+        // XMLStreamReader::Handler implementation
+        void OnStartElement(std::string_view name, size_t depth) override;
+        void OnText(std::string_view text, size_t depth) override;
+        void OnEndElement(std::string_view name, size_t depth) override;
+
+        // Gets the string within the settings that a field is parsed into,
+        // or null if the field isn't a string
+        std::string* GetStringField(Field field);
+        // Parses the buffered text of the current element into its field
+        void ParseValue(std::string_view name, std::string_view value);
+
+        // Helper function to parse text to a 64 bit unsigned integer
+        static uint64_t ParseUInt64(std::string_view name, std::string_view value);
+        // Helper function to parse text to an integer
+        static int ParseInt(std::string_view name, std::string_view value);
+    };
+} // namespace MoonlightOBS
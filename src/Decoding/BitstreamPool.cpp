@@ -0,0 +1,76 @@
+#include "BitstreamPool.hpp"
+
+// STL includes
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+using namespace MoonlightOBS;
+
+BitstreamPool::~BitstreamPool()
+{
+    for (BitstreamBuffer* buffer : m_free)
+    {
+        Free(buffer);
+    }
+}
+
+BitstreamPool::Pointer BitstreamPool::Acquire(size_t size, size_t padding)
+{
+    BitstreamBuffer* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_free.empty())
+        {
+            buffer = m_free.back();
+            m_free.pop_back();
+        }
+    }
+
+    if (buffer == nullptr)
+    {
+        buffer = new BitstreamBuffer();
+        buffer->pool = this;
+    }
+    Pointer pointer(buffer);
+
+    size_t required = size + padding;
+    if (buffer->allocated < required)
+    {
+        // Grow with headroom, so a run of slightly larger frames doesn't grow it each time
+        size_t allocated = std::max(required + required / 2, buffer->allocated * 2);
+        allocated = (allocated + Alignment - 1) & ~(Alignment - 1);
+
+        if (buffer->data != nullptr)
+        {
+            ::operator delete(buffer->data, std::align_val_t(Alignment));
+            buffer->data = nullptr;
+            buffer->allocated = 0;
+        }
+        buffer->data = static_cast<uint8_t*>(::operator new(allocated, std::align_val_t(Alignment)));
+        buffer->allocated = allocated;
+    }
+
+    buffer->size = size;
+    std::memset(buffer->data + size, 0, padding);
+
+    return pointer;
+}
+
+void BitstreamPool::Release(BitstreamBuffer* buffer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free.push_back(buffer);
+}
+
+void BitstreamPool::Free(BitstreamBuffer* buffer)
+{
+    if (buffer->data != nullptr)
+    {
+        ::operator delete(buffer->data, std::align_val_t(Alignment));
+    }
+    delete buffer;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace MoonlightOBS
+{
+    // Forward declarations
+    class BitstreamPool;
+
+    /**
+     * @brief An aligned buffer holding the bitstream of a frame, followed by zeroed padding.
+     *
+     */
+    struct BitstreamBuffer
+    {
+        uint8_t* data           = nullptr;  // Bitstream, aligned to BitstreamPool::Alignment
+        size_t size             = 0;        // Size of the bitstream, excluding the padding
+        size_t allocated        = 0;        // Size of the allocation
+        BitstreamPool* pool     = nullptr;  // Pool the buffer returns to
+    };
+
+    /**
+     * @brief A pool of reusable bitstream buffers, which only ever grow.
+     *
+     * Decoders keep the bitstream of a frame until it's decoded, which with frame threading
+     * is after the next frames have been received, so a buffer is lent to the decoder and
+     * returned from whichever thread releases it. Once the pool has grown to the frames in
+     * flight and the largest frame, receiving a frame allocates nothing.
+     *
+     * The pool must outlive the decoders its buffers are lent to.
+     *
+     */
+    class BitstreamPool
+    {
+    public:
+        /**
+         * @brief The alignment of the bitstream, which suits the SIMD loads of every decoder.
+         *
+         */
+        static constexpr size_t Alignment = 64;
+
+        /**
+         * @brief Returns a buffer to its pool.
+         *
+         */
+        struct Returner
+        {
+            inline void operator()(BitstreamBuffer* buffer) const { buffer->pool->Release(buffer); }
+        };
+
+        /**
+         * @brief Owning pointer to a buffer, which returns it to its pool.
+         *
+         */
+        using Pointer = std::unique_ptr<BitstreamBuffer, Returner>;
+
+        BitstreamPool() = default;
+
+        /**
+         * @brief Frees the buffers of the pool.
+         *
+         */
+        ~BitstreamPool();
+
+        BitstreamPool(const BitstreamPool&)             = delete;
+        BitstreamPool& operator=(const BitstreamPool&)  = delete;
+
+        /**
+         * @brief Takes a buffer from the pool, growing it if it's too small.
+         *
+         * @param size The size of the bitstream.
+         * @param padding The number of zero bytes the decoder may read past the end of the bitstream.
+         * @return Pointer The buffer, with its size set and its padding zeroed.
+         * @exception std::bad_alloc If the buffer can't be grown.
+         */
+        Pointer Acquire(size_t size, size_t padding);
+
+        /**
+         * @brief Returns a buffer to the pool.
+         * @note May be called from any thread.
+         *
+         * @param buffer The buffer, which was acquired from this pool.
+         */
+        void Release(BitstreamBuffer* buffer);
+
+    private:
+        // Guards the free buffers
+        std::mutex m_mutex;
+        // Buffers which aren't lent out
+        std::vector<BitstreamBuffer*> m_free;
+
+        // Frees a buffer
+        static void Free(BitstreamBuffer* buffer);
+    };
+} // namespace MoonlightOBS
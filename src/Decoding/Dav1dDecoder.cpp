@@ -0,0 +1,240 @@
+#include "Dav1dDecoder.hpp"
+
+// STL includes
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// moonlight-common-c includes
+#include <Limelight.h>
+
+// dav1d includes
+#include <dav1d/dav1d.h>
+
+// OBS Studio includes
+#include <obs.h>
+#include <util/base.h>
+
+// Project includes
+#include "../plugin-support.h"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Frames in flight when frame threading is chosen
+    // (a second frame gains most of the throughput, as tiles and post-filters already use the pool)
+    constexpr int FrameThreadingDelay = 2;
+
+    // Returns a bitstream buffer lent to dav1d to its pool (Dav1dData free callback)
+    void ReleaseBitstream(const uint8_t* data, void* cookie)
+    {
+        BitstreamPool::Returner()(static_cast<BitstreamBuffer*>(cookie));
+        UNUSED_PARAMETER(data);
+    }
+
+    // Gets the chroma subsampling of a pixel layout
+    ChromaSubsampling GetSubsampling(Dav1dPixelLayout layout)
+    {
+        switch (layout)
+        {
+            case DAV1D_PIXEL_LAYOUT_I400:
+                return ChromaSubsampling::Monochrome;
+            case DAV1D_PIXEL_LAYOUT_I422:
+                return ChromaSubsampling::Yuv422;
+            case DAV1D_PIXEL_LAYOUT_I444:
+                return ChromaSubsampling::Yuv444;
+            default:
+                return ChromaSubsampling::Yuv420;
+        }
+    }
+
+    // Gets the colorimetry of a matrix coefficients value
+    Colorimetry GetColorimetry(Dav1dMatrixCoefficients matrix)
+    {
+        switch (matrix)
+        {
+            case DAV1D_MC_BT470BG:
+            case DAV1D_MC_BT601:
+                return Colorimetry::BT601;
+            case DAV1D_MC_BT709:
+                return Colorimetry::BT709;
+            case DAV1D_MC_BT2020_NCL:
+            case DAV1D_MC_BT2020_CL:
+                return Colorimetry::BT2020;
+            default:
+                return Colorimetry::Unspecified;
+        }
+    }
+
+    // Gets the transfer characteristics of a transfer characteristics value
+    TransferCharacteristics GetTransferCharacteristics(Dav1dTransferCharacteristics trc)
+    {
+        switch (trc)
+        {
+            case DAV1D_TRC_SMPTE2084:
+                return TransferCharacteristics::PQ;
+            case DAV1D_TRC_HLG:
+                return TransferCharacteristics::HLG;
+            default:
+                return TransferCharacteristics::SDR;
+        }
+    }
+}
+
+Dav1dDecoder::Dav1dDecoder(const DecoderSettings& settings, FrameCallback output, FramePool& framePool)
+    : VideoDecoder(std::move(output), framePool), m_context(nullptr)
+{
+    Dav1dSettings dav1dSettings;
+    dav1d_default_settings(&dav1dSettings);
+    dav1dSettings.n_threads         = static_cast<int>(settings.threadCount);
+    dav1dSettings.max_frame_delay   = settings.threading == DecodeThreading::Slice ? 1 : FrameThreadingDelay;
+    // Film grain is never used by game streams
+    dav1dSettings.apply_grain       = 0;
+    // Decode straight into the frame pool
+    dav1dSettings.allocator.cookie                      = this;
+    dav1dSettings.allocator.alloc_picture_callback      = OnAllocatePicture;
+    dav1dSettings.allocator.release_picture_callback    = OnReleasePicture;
+
+    int result = dav1d_open(&m_context, &dav1dSettings);
+    if (result < 0)
+    {
+        throw std::runtime_error("Failed to open the dav1d decoder: " + std::string(std::strerror(-result)));
+    }
+
+    obs_log(LOG_INFO, "Opened the dav1d %s decoder for %ux%u with %d threads and %d frames in flight",
+        dav1d_version(), settings.width, settings.height, dav1dSettings.n_threads, dav1dSettings.max_frame_delay);
+}
+
+Dav1dDecoder::~Dav1dDecoder()
+{
+    dav1d_close(&m_context);
+}
+
+bool Dav1dDecoder::Decode(BitstreamPool::Pointer bitstream, uint64_t timestamp)
+{
+    // dav1d keeps the data until the frame is decoded, so the buffer is lent to it rather than copied
+    BitstreamBuffer* buffer = bitstream.get();
+    Dav1dData input = {};
+    if (dav1d_data_wrap(&input, buffer->data, buffer->size, ReleaseBitstream, buffer) < 0)
+    {
+        obs_log(LOG_WARNING, "Failed to wrap the data of a frame");
+        return false;
+    }
+    bitstream.release();
+    input.m.timestamp = static_cast<int64_t>(timestamp);
+
+    do
+    {
+        int result = dav1d_send_data(m_context, &input);
+        if (result < 0 && result != DAV1D_ERR(EAGAIN))
+        {
+            obs_log(LOG_WARNING, "Failed to decode a frame: %s", std::strerror(-result));
+            dav1d_data_unref(&input);
+            return false;
+        }
+
+        // Receive the pictures the decoder completed, which also makes room for the rest of the data
+        Dav1dPicture picture = {};
+        while ((result = dav1d_get_picture(m_context, &picture)) == 0)
+        {
+            OutputPicture(picture);
+            dav1d_picture_unref(&picture);
+        }
+
+        if (result != DAV1D_ERR(EAGAIN))
+        {
+            obs_log(LOG_WARNING, "Failed to receive a decoded frame: %s", std::strerror(-result));
+            dav1d_data_unref(&input);
+            return false;
+        }
+    } while (input.sz > 0);
+
+    return true;
+}
+
+int Dav1dDecoder::GetSupportedVideoFormats()
+{
+    return VIDEO_FORMAT_AV1_MAIN8 | VIDEO_FORMAT_AV1_MAIN10 | VIDEO_FORMAT_AV1_HIGH8_444 | VIDEO_FORMAT_AV1_HIGH10_444;
+}
+
+void Dav1dDecoder::OutputPicture(const Dav1dPicture& picture)
+{
+    PictureFormat format;
+    format.subsampling  = GetSubsampling(picture.p.layout);
+    format.bitDepth     = static_cast<unsigned int>(picture.p.bpc);
+    format.colorimetry  = GetColorimetry(picture.seq_hdr->mtrx);
+    format.transfer     = GetTransferCharacteristics(picture.seq_hdr->trc);
+    format.fullRange    = picture.seq_hdr->color_range != 0;
+
+    // The planes are passed to OBS in the frame pool buffer, which OBS copies when the frame is output
+    obs_source_frame frame = {};
+    frame.width         = static_cast<uint32_t>(picture.p.w);
+    frame.height        = static_cast<uint32_t>(picture.p.h);
+    frame.timestamp     = static_cast<uint64_t>(picture.m.timestamp);
+    size_t planeCount = format.subsampling == ChromaSubsampling::Monochrome ? 1 : 3;
+    for (size_t plane = 0; plane < planeCount; plane++)
+    {
+        frame.data[plane]       = static_cast<uint8_t*>(picture.data[plane]);
+        frame.linesize[plane]   = static_cast<uint32_t>(picture.stride[plane == 0 ? 0 : 1]);
+    }
+
+    if (!Output(format, frame))
+    {
+        if (!m_loggedUnsupportedFormat)
+        {
+            obs_log(LOG_WARNING, "Dropping frames of unsupported layout %d at %d bits", picture.p.layout, picture.p.bpc);
+            m_loggedUnsupportedFormat = true;
+        }
+    }
+}
+
+int Dav1dDecoder::OnAllocatePicture(Dav1dPicture* picture, void* cookie)
+{
+    Dav1dDecoder* decoder = static_cast<Dav1dDecoder*>(cookie);
+
+    // dav1d writes up to 128 pixel aligned dimensions, like its default allocator allows for
+    const ptrdiff_t bytesPerSample = picture->p.bpc > 8 ? 2 : 1;
+    const ptrdiff_t alignedWidth = (picture->p.w + 127) & ~127;
+    const ptrdiff_t alignedHeight = (picture->p.h + 127) & ~127;
+    const bool hasChroma = picture->p.layout != DAV1D_PIXEL_LAYOUT_I400;
+    const int horizontalShift = picture->p.layout != DAV1D_PIXEL_LAYOUT_I444 ? 1 : 0;
+    const int verticalShift = picture->p.layout == DAV1D_PIXEL_LAYOUT_I420 ? 1 : 0;
+
+    const ptrdiff_t lumaStride = alignedWidth * bytesPerSample;
+    const ptrdiff_t chromaStride = hasChroma ? lumaStride >> horizontalShift : 0;
+    const size_t lumaSize = static_cast<size_t>(lumaStride * alignedHeight);
+    const size_t chromaSize = static_cast<size_t>(chromaStride * (alignedHeight >> verticalShift));
+
+    FrameBuffer* buffer = nullptr;
+    try
+    {
+        buffer = decoder->m_framePool.Acquire(lumaSize + 2 * chromaSize + DAV1D_PICTURE_ALIGNMENT);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return DAV1D_ERR(ENOMEM);
+    }
+
+    picture->data[0]        = buffer->data;
+    picture->data[1]        = hasChroma ? buffer->data + lumaSize : nullptr;
+    picture->data[2]        = hasChroma ? buffer->data + lumaSize + chromaSize : nullptr;
+    picture->stride[0]      = lumaStride;
+    picture->stride[1]      = chromaStride;
+    picture->allocator_data = buffer;
+
+    return 0;
+}
+
+void Dav1dDecoder::OnReleasePicture(Dav1dPicture* picture, void* cookie)
+{
+    FrameBuffer* buffer = static_cast<FrameBuffer*>(picture->allocator_data);
+    buffer->pool->Release(buffer);
+
+    UNUSED_PARAMETER(cookie);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+
+// dav1d includes
+#include <dav1d/dav1d.h>
+
+// OBS Studio includes
+#include <obs.h>
+
+// Project includes
+#include "VideoDecoder.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Decodes AV1 in software with dav1d, which is considerably faster than the AV1 decoders of libavcodec.
+     *
+     * dav1d spreads tiles, frames and post-filters over one thread pool. Frames in flight are
+     * limited to one when slice threading is chosen (the lowest latency), or two otherwise,
+     * and pictures are decoded straight into the frame pool and output to OBS from there.
+     *
+     */
+    class Dav1dDecoder : public VideoDecoder
+    {
+    public:
+        /**
+         * @brief Opens a decoder for a stream.
+         *
+         * @param settings The format of the stream, and how to decode it.
+         * @param output Receives each decoded picture.
+         * @param framePool Buffers the decoder writes its pictures into, which must outlive the decoder.
+         * @exception std::runtime_error If the decoder can't be opened.
+         */
+        Dav1dDecoder(const DecoderSettings& settings, FrameCallback output, FramePool& framePool);
+
+        /**
+         * @brief Closes the decoder.
+         *
+         */
+        ~Dav1dDecoder() override;
+
+        bool Decode(BitstreamPool::Pointer bitstream, uint64_t timestamp) override;
+
+        inline size_t GetInputPadding() const override
+        {
+            return 0;
+        }
+
+        inline const char* GetName() const override
+        {
+            return "dav1d";
+        }
+
+        /**
+         * @brief Gets the VIDEO_FORMAT_* values dav1d decodes.
+         *
+         * @return int The supported formats.
+         */
+        static int GetSupportedVideoFormats();
+
+    private:
+        // Decoder context
+        Dav1dContext* m_context;
+        // Has a picture of an unsupported layout been logged?
+        bool m_loggedUnsupportedFormat = false;
+
+        // Outputs a decoded picture to OBS
+        void OutputPicture(const Dav1dPicture& picture);
+
+        // Dav1dPicAllocator.alloc_picture_callback, giving the decoder a buffer from the frame pool to decode into
+        static int OnAllocatePicture(Dav1dPicture* picture, void* cookie);
+        // Dav1dPicAllocator.release_picture_callback, returning the buffer of a picture to the frame pool
+        static void OnReleasePicture(Dav1dPicture* picture, void* cookie);
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,494 @@
+#include "DecoderRenderer.hpp"
+
+// STL includes
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+
+// moonlight-common-c includes
+#include <Limelight.h>
+
+// OBS Studio includes
+#include <util/base.h>
+#include <util/platform.h>
+
+// Project includes
+#include "../plugin-support.h"
+#include "FFmpegDecoder.hpp"
+#include "SliceCount.hpp"
+#ifdef ENABLE_DAV1D
+#include "Dav1dDecoder.hpp"
+#endif
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Most threads to decode frames in parallel with, as each adds a frame of latency
+    constexpr unsigned int MaxFrameThreads = 4;
+
+    // The renderer moonlight-common-c streams to, if any
+    // (its callbacks have no context besides setup, but only one stream is active at a time)
+    std::atomic<DecoderRenderer*> g_activeRenderer(nullptr);
+    // Number of decoders open, which share the cores
+    std::atomic<unsigned int> g_openDecoders(0);
+
+    // Gets the VIDEO_FORMAT_* values the decoder backends can decode which the stream asks for
+    // (hosts stream the best format they're offered, so 10 bit and 4:4:4 are only offered when wanted)
+    int GetDecoderFormats(const StreamConfig& config)
+    {
+        int formats = FFmpegDecoder::GetSupportedVideoFormats();
+#ifdef ENABLE_DAV1D
+        formats |= Dav1dDecoder::GetSupportedVideoFormats();
+#endif
+        if (!config.hdr)
+        {
+            formats &= ~VIDEO_FORMAT_MASK_10BIT;
+        }
+        if (!config.yuv444)
+        {
+            formats &= ~VIDEO_FORMAT_MASK_YUV444;
+        }
+        return formats;
+    }
+
+    // Gets the codec of a VIDEO_FORMAT_* value, as a decoder decodes every profile of its codec
+    int GetCodec(int videoFormat)
+    {
+        if ((videoFormat & VIDEO_FORMAT_MASK_H264) != 0)
+        {
+            return VIDEO_FORMAT_MASK_H264;
+        }
+        if ((videoFormat & VIDEO_FORMAT_MASK_H265) != 0)
+        {
+            return VIDEO_FORMAT_MASK_H265;
+        }
+        return videoFormat & VIDEO_FORMAT_MASK_AV1;
+    }
+
+    // Opens the decoder backend of a format (dav1d for AV1 when it's available, otherwise libavcodec)
+    std::unique_ptr<VideoDecoder> CreateDecoder(const DecoderSettings& settings, const VideoDecoder::FrameCallback& output,
+        FramePool& framePool)
+    {
+#ifdef ENABLE_DAV1D
+        if ((settings.videoFormat & VIDEO_FORMAT_MASK_AV1) != 0)
+        {
+            return std::make_unique<Dav1dDecoder>(settings, output, framePool);
+        }
+#endif
+        return std::make_unique<FFmpegDecoder>(settings, output, framePool);
+    }
+}
+
+DecoderRenderer::DecoderRenderer(const StreamConfig& config, VideoDecoder::FrameCallback output)
+    : m_config(config), m_output(std::move(output)), m_supportedVideoFormats(GetDecoderFormats(config)), m_maxLuminance(0),
+      m_decoding(false), m_decodeThreadWaiting(false), m_decodeFailed(false), m_skippingToIDR(false), m_framesQueued(0),
+      m_framesDropped(0), m_queueOverflows(0), m_maxQueueDepth(0)
+{
+    LiInitializeVideoCallbacks(&m_callbacks);
+    m_callbacks.setup               = OnSetup;
+    m_callbacks.cleanup             = OnCleanup;
+    m_callbacks.submitDecodeUnit    = OnSubmitDecodeUnit;
+
+    if (m_config.decodeSubmission == DecodeSubmission::Direct)
+    {
+        m_callbacks.capabilities    = CAPABILITY_DIRECT_SUBMIT;
+    }
+    else
+    {
+        m_callbacks.capabilities    = CAPABILITY_PULL_RENDERER;
+        m_callbacks.start           = OnStart;
+        m_callbacks.stop            = OnStop;
+    }
+
+    unsigned int slices = GetSliceCount();
+    m_callbacks.capabilities |= CAPABILITY_SLICES_PER_FRAME(slices);
+    obs_log(LOG_INFO, "Asking for %u slices per frame at %ux%u", slices, m_config.width, m_config.height);
+}
+
+DecoderRenderer::~DecoderRenderer()
+{
+    // The stream should have been stopped, but the decoder mustn't be closed under the decode thread
+    StopDecodeThread();
+
+    std::lock_guard<std::mutex> lock(m_decoderMutex);
+    CloseDecoder();
+
+    DecoderRenderer* expected = this;
+    g_activeRenderer.compare_exchange_strong(expected, nullptr);
+}
+
+void DecoderRenderer::Prepare()
+{
+    // moonlight-common-c picks the newest codec both sides support
+    DecoderSettings settings;
+    if ((m_supportedVideoFormats & VIDEO_FORMAT_AV1_MAIN8) != 0)
+    {
+        settings.videoFormat = VIDEO_FORMAT_AV1_MAIN8;
+    }
+    else if ((m_supportedVideoFormats & VIDEO_FORMAT_H265) != 0)
+    {
+        settings.videoFormat = VIDEO_FORMAT_H265;
+    }
+    else if ((m_supportedVideoFormats & VIDEO_FORMAT_H264) != 0)
+    {
+        settings.videoFormat = VIDEO_FORMAT_H264;
+    }
+    else
+    {
+        return;
+    }
+    settings.width  = m_config.width;
+    settings.height = m_config.height;
+    settings.fps    = m_config.fps;
+
+    std::lock_guard<std::mutex> lock(m_decoderMutex);
+    try
+    {
+        OpenDecoder(settings);
+    }
+    catch (const std::exception& exception)
+    {
+        // The decoder is opened again when the stream is set up
+        obs_log(LOG_WARNING, "Failed to prepare the decoder: %s", exception.what());
+    }
+}
+
+void DecoderRenderer::OpenDecoder(const DecoderSettings& settings)
+{
+    if (m_decoder != nullptr && GetCodec(m_decoderSettings.videoFormat) == GetCodec(settings.videoFormat) &&
+        m_decoderSettings.width == settings.width && m_decoderSettings.height == settings.height)
+    {
+        return;
+    }
+
+    CloseDecoder();
+
+    DecoderSettings threaded = settings;
+    threaded.threading      = m_config.decodeThreading;
+    threaded.threadCount    = GetThreadCount();
+
+    m_decoder = CreateDecoder(threaded, [this](const obs_source_frame& frame) { OutputFrame(frame); }, m_framePool);
+    m_decoderSettings = threaded;
+    g_openDecoders++;
+}
+
+void DecoderRenderer::CloseDecoder()
+{
+    if (m_decoder != nullptr)
+    {
+        m_decoder.reset();
+        g_openDecoders--;
+    }
+}
+
+unsigned int DecoderRenderer::GetThreadCount() const
+{
+    if (m_config.decodeThreads != 0)
+    {
+        return m_config.decodeThreads;
+    }
+
+    // Leave a core for receiving the stream and OBS, and share the rest between the open decoders
+    unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+    unsigned int decoders = g_openDecoders.load() + 1;
+    unsigned int threads = std::max((cores > 1 ? cores - 1 : 1) / decoders, 1u);
+
+    return std::min(threads, m_config.decodeThreading == DecodeThreading::Frame ? MaxFrameThreads : SliceCount::MaxThreads);
+}
+
+unsigned int DecoderRenderer::GetSliceCount() const
+{
+    // Frame threads decode whole frames, so they gain nothing from slices
+    if (m_config.decodeThreading == DecodeThreading::Frame)
+    {
+        return 1;
+    }
+
+    return SliceCount::Get(m_config.height, GetThreadCount());
+}
+
+void DecoderRenderer::OutputFrame(const obs_source_frame& frame)
+{
+    if (m_config.toneMapHDR && ToneMapper::CanMap(frame))
+    {
+        m_toneMapper.SetPeakLuminance(m_maxLuminance.load(std::memory_order_relaxed));
+
+        obs_source_frame sdrFrame;
+        FrameBuffer* buffer = nullptr;
+        try
+        {
+            buffer = m_toneMapper.Map(frame, sdrFrame, m_framePool);
+        }
+        catch (const std::bad_alloc&)
+        {
+            obs_log(LOG_WARNING, "Failed to allocate the buffer of a tone mapped frame");
+            return;
+        }
+
+        // OBS copies the frame, so the buffer can be reused as soon as it's output
+        m_output(sdrFrame);
+        buffer->pool->Release(buffer);
+        return;
+    }
+
+    if (frame.trc != VIDEO_TRC_PQ)
+    {
+        m_output(frame);
+        return;
+    }
+
+    // OBS tone maps PQ frames from the brightest their content gets
+    obs_source_frame hdrFrame = frame;
+    hdrFrame.max_luminance = m_maxLuminance.load(std::memory_order_relaxed);
+    m_output(hdrFrame);
+}
+
+void DecoderRenderer::UpdateHdrMetadata()
+{
+    SS_HDR_METADATA metadata = {};
+    if (!LiGetHdrMetadata(&metadata))
+    {
+        return;
+    }
+
+    // The content light level describes the stream itself, while the display luminance may only bound it
+    m_maxLuminance.store(metadata.maxContentLightLevel != 0 ? metadata.maxContentLightLevel :
+        metadata.maxDisplayLuminance, std::memory_order_relaxed);
+}
+
+int DecoderRenderer::OnSetup(int videoFormat, int width, int height, int redrawRate, void* context, int drFlags)
+{
+    DecoderRenderer* renderer = static_cast<DecoderRenderer*>(context);
+
+    DecoderSettings settings;
+    settings.videoFormat    = videoFormat;
+    settings.width          = static_cast<uint32_t>(width);
+    settings.height         = static_cast<uint32_t>(height);
+    settings.fps            = static_cast<uint32_t>(redrawRate);
+
+    std::lock_guard<std::mutex> lock(renderer->m_decoderMutex);
+    try
+    {
+        renderer->OpenDecoder(settings);
+    }
+    catch (const std::exception& exception)
+    {
+        obs_log(LOG_ERROR, "Failed to set up the decoder: %s", exception.what());
+        return -1;
+    }
+
+    g_activeRenderer.store(renderer, std::memory_order_release);
+
+    UNUSED_PARAMETER(drFlags);
+    return 0;
+}
+
+int DecoderRenderer::Enqueue(BitstreamPool::Pointer bitstream, uint64_t timestamp, bool idr)
+{
+    // A failed frame breaks the references of the frames after it, like a dropped one
+    if (m_decodeFailed.exchange(false))
+    {
+        m_skippingToIDR = !idr;
+        if (m_skippingToIDR)
+        {
+            m_framesDropped++;
+            return DR_NEED_IDR;
+        }
+    }
+
+    if (m_skippingToIDR)
+    {
+        if (!idr)
+        {
+            m_framesDropped++;
+            return DR_OK;
+        }
+        m_skippingToIDR = false;
+    }
+
+    QueuedFrame frame;
+    frame.bitstream = std::move(bitstream);
+    frame.timestamp = timestamp;
+    if (!m_queue.TryPush(frame))
+    {
+        // The decoder can't keep up, so drop this frame and the ones referencing it
+        obs_log(LOG_DEBUG, "The decode queue is full, dropping frames until the next IDR frame");
+        m_queueOverflows++;
+        m_framesDropped++;
+        m_skippingToIDR = true;
+        return DR_NEED_IDR;
+    }
+    m_framesQueued++;
+    m_maxQueueDepth = std::max(m_maxQueueDepth, m_queue.GetSize());
+
+    // Only take the lock to wake the decode thread when it's waiting. The fence orders the push
+    // before reading the flag, as the one in RunDecodeThread orders setting it before checking the queue.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_decodeThreadWaiting.load(std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_frameQueued.notify_one();
+    }
+
+    return DR_OK;
+}
+
+void DecoderRenderer::RunDecodeThread()
+{
+    os_set_thread_name("moonlight-obs: decode");
+
+    QueuedFrame frame;
+    while (true)
+    {
+        if (!m_queue.TryPop(frame))
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_decodeThreadWaiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_frameQueued.wait(lock, [this]()
+            {
+                return m_queue.GetSize() != 0 || !m_decoding.load(std::memory_order_relaxed);
+            });
+            m_decodeThreadWaiting.store(false, std::memory_order_relaxed);
+
+            if (!m_decoding.load(std::memory_order_relaxed))
+            {
+                return;
+            }
+            continue;
+        }
+
+        if (!m_decoder->Decode(std::move(frame.bitstream), frame.timestamp))
+        {
+            m_decodeFailed = true;
+        }
+    }
+}
+
+void DecoderRenderer::StopDecodeThread()
+{
+    if (!m_decodeThread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_decoding = false;
+        m_frameQueued.notify_one();
+    }
+    m_decodeThread.join();
+
+    // Return the bitstreams of the frames which weren't decoded to the pool
+    QueuedFrame frame;
+    while (m_queue.TryPop(frame))
+    {
+        frame.bitstream.reset();
+    }
+
+    obs_log(LOG_INFO, "Decode queue: %llu frames queued, %llu dropped after it was full %llu times, at most %zu of %zu waiting",
+        static_cast<unsigned long long>(m_framesQueued), static_cast<unsigned long long>(m_framesDropped),
+        static_cast<unsigned long long>(m_queueOverflows), m_maxQueueDepth, QueueCapacity);
+}
+
+void DecoderRenderer::OnStart()
+{
+    DecoderRenderer* renderer = g_activeRenderer.load(std::memory_order_acquire);
+    if (renderer == nullptr || renderer->m_decoder == nullptr || renderer->m_decodeThread.joinable())
+    {
+        return;
+    }
+
+    renderer->m_decodeFailed    = false;
+    renderer->m_skippingToIDR   = false;
+    renderer->m_framesQueued    = 0;
+    renderer->m_framesDropped   = 0;
+    renderer->m_queueOverflows  = 0;
+    renderer->m_maxQueueDepth   = 0;
+    renderer->m_decoding        = true;
+    renderer->m_decodeThread    = std::thread(&DecoderRenderer::RunDecodeThread, renderer);
+}
+
+void DecoderRenderer::OnStop()
+{
+    DecoderRenderer* renderer = g_activeRenderer.load(std::memory_order_acquire);
+    if (renderer != nullptr)
+    {
+        renderer->StopDecodeThread();
+    }
+}
+
+void DecoderRenderer::OnCleanup()
+{
+    DecoderRenderer* renderer = g_activeRenderer.exchange(nullptr);
+    if (renderer == nullptr)
+    {
+        return;
+    }
+
+    // In case the stream was cleaned up without being stopped
+    renderer->StopDecodeThread();
+
+    std::lock_guard<std::mutex> lock(renderer->m_decoderMutex);
+    renderer->CloseDecoder();
+}
+
+int DecoderRenderer::OnSubmitDecodeUnit(PDECODE_UNIT decodeUnit)
+{
+    // The decoder isn't locked, as moonlight-common-c only submits between setup and cleanup
+    // (and queued frames are only pulled between start and stop, while the decode thread runs)
+    DecoderRenderer* renderer = g_activeRenderer.load(std::memory_order_acquire);
+    if (renderer == nullptr || renderer->m_decoder == nullptr)
+    {
+        return DR_OK;
+    }
+
+    // The host may change its HDR metadata when it changes the stream, which starts with an IDR frame
+    if (decodeUnit->hdrActive && decodeUnit->frameType == FRAME_TYPE_IDR)
+    {
+        renderer->UpdateHdrMetadata();
+    }
+
+    // Reassemble the frame into a pooled buffer with the padding the decoder may read past its end.
+    // Even a frame in a single buffer is copied, as moonlight-common-c frees it once this returns,
+    // while decoders read past its end and keep it until the frame is decoded.
+    BitstreamPool::Pointer bitstream;
+    try
+    {
+        bitstream = renderer->m_bitstreamPool.Acquire(static_cast<size_t>(decodeUnit->fullLength),
+            renderer->m_decoder->GetInputPadding());
+    }
+    catch (const std::bad_alloc&)
+    {
+        obs_log(LOG_WARNING, "Failed to allocate the bitstream of a frame");
+        return DR_NEED_IDR;
+    }
+
+    uint8_t* destination = bitstream->data;
+    for (PLENTRY entry = decodeUnit->bufferList; entry != nullptr; entry = entry->next)
+    {
+        std::memcpy(destination, entry->data, static_cast<size_t>(entry->length));
+        destination += entry->length;
+    }
+
+    // Timestamp with the clock of OBS, which the frame is presented against
+    uint64_t timestamp = os_gettime_ns();
+    if (renderer->m_decodeThread.joinable())
+    {
+        return renderer->Enqueue(std::move(bitstream), timestamp, decodeUnit->frameType == FRAME_TYPE_IDR);
+    }
+    if (!renderer->m_decoder->Decode(std::move(bitstream), timestamp))
+    {
+        return DR_NEED_IDR;
+    }
+
+    return DR_OK;
+}
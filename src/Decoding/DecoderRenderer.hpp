@@ -0,0 +1,193 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// moonlight-common-c includes
+#include <Limelight.h>
+
+// Project includes
+#include "../Streaming/StreamConfig.hpp"
+#include "../Utilities/SPSCQueue.hpp"
+#include "BitstreamPool.hpp"
+#include "FramePool.hpp"
+#include "ToneMapper.hpp"
+#include "VideoDecoder.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Receives the video stream from moonlight-common-c and decodes it with a VideoDecoder backend.
+     *
+     * The decoder is opened when moonlight-common-c sets up the video stream with the format
+     * negotiated with the host, unless the one warmed up by Prepare already matches it.
+     * AV1 is decoded with dav1d when the plugin is built with ENABLE_DAV1D, and everything else
+     * with libavcodec. Each frame is reassembled from the buffers of its decode unit into a pooled
+     * buffer which the decoder adopts, and the pictures are passed to the output callback.
+     * Every profile the decoders support is advertised, except 10 bit ones unless the config asks
+     * for HDR, and 4:4:4 ones unless it asks for 4:4:4, so the host only sends those when they're
+     * wanted. The pictures of every profile are passed to OBS as they are. The luminance of HDR streams is
+     * read from the host's mastering metadata at each IDR frame, for OBS to tone map from, or
+     * for the ToneMapper when the config has HDR10 pictures tone mapped on the CPU.
+     *
+     * Decoding threads are sized from the core count, shared between the streams being decoded,
+     * unless a thread count is set in the config. Unless decoding is only frame threaded, the host
+     * is asked to split each frame into a slice per thread (fewer for small resolutions), so the
+     * slice threads can decode a frame in parallel instead of leaving it to a single core.
+     *
+     * Frames are decoded on the thread receiving the stream when the config asks for direct
+     * submission. Otherwise moonlight-common-c runs as a pull renderer, whose frames the
+     * ConnectionOrchestrator pulls on a thread of its own, and each is reassembled and pushed onto
+     * a bounded lock-free queue for a decode thread, so a slow frame never holds up receiving.
+     * When the queue is full, frames are dropped until the next IDR frame, which is requested.
+     * How deep the queue got and how many frames it dropped are logged when the stream stops.
+     *
+     */
+    class DecoderRenderer
+    {
+    public:
+        /**
+         * @brief The number of frames the decode queue holds.
+         *
+         */
+        static constexpr size_t QueueCapacity = 16;
+
+        /**
+         * @brief Construct a new DecoderRenderer object.
+         *
+         * @param config The stream parameters, and how to thread decoding.
+         * @param output Receives each decoded picture.
+         */
+        DecoderRenderer(const StreamConfig& config, VideoDecoder::FrameCallback output);
+
+        /**
+         * @brief Closes the decoder, if it's still open.
+         *
+         */
+        ~DecoderRenderer();
+
+        DecoderRenderer(const DecoderRenderer&)             = delete;
+        DecoderRenderer& operator=(const DecoderRenderer&)  = delete;
+
+        /**
+         * @brief Opens the decoder of the format the host is most likely to choose,
+         *        so it doesn't have to be opened once the stream starts.
+         * @note Runs while the host is being contacted, before the video stream is set up.
+         *
+         */
+        void Prepare();
+
+        /**
+         * @brief Gets the callbacks to pass to moonlight-common-c, with this object as their context.
+         *
+         * @return DECODER_RENDERER_CALLBACKS* The callbacks, which live as long as this object.
+         */
+        inline DECODER_RENDERER_CALLBACKS* GetCallbacks()
+        {
+            return &m_callbacks;
+        }
+
+        /**
+         * @brief Gets the VIDEO_FORMAT_* values the decoders can decode, limited to
+         *        10 bit formats for HDR streams and 4:4:4 formats for 4:4:4 streams.
+         *
+         * @return int The supported formats.
+         */
+        inline int GetSupportedVideoFormats() const
+        {
+            return m_supportedVideoFormats;
+        }
+
+    private:
+        // Stream parameters, and how to thread decoding
+        StreamConfig m_config;
+        // Receives each decoded picture
+        VideoDecoder::FrameCallback m_output;
+        // Callbacks passed to moonlight-common-c
+        DECODER_RENDERER_CALLBACKS m_callbacks;
+        // VIDEO_FORMAT_* values the decoders can decode
+        int m_supportedVideoFormats;
+        // Brightest the content of the host's HDR stream gets in nits, or 0 if unknown
+        std::atomic<uint16_t> m_maxLuminance;
+
+        // Buffers the bitstream of each frame is reassembled into, which are lent to the decoder
+        // (declared before the decoder, which may hold some of them until it's closed)
+        BitstreamPool m_bitstreamPool;
+        // Buffers the decoder writes its pictures into (likewise declared before the decoder)
+        FramePool m_framePool;
+
+        // Guards the decoder while it's opened by Prepare or OnSetup, and closed by OnCleanup
+        std::mutex m_decoderMutex;
+        // Decoder, if open
+        std::unique_ptr<VideoDecoder> m_decoder;
+        // Settings the decoder was opened with
+        DecoderSettings m_decoderSettings;
+        // Tone maps HDR10 pictures for SDR canvases, when the config asks for it
+        ToneMapper m_toneMapper;
+
+        // A reassembled frame waiting to be decoded
+        struct QueuedFrame
+        {
+            BitstreamPool::Pointer bitstream;   // Bitstream of the frame
+            uint64_t timestamp = 0;             // When the frame was received
+        };
+
+        // Frames waiting for the decode thread (pushed by the thread receiving the stream)
+        SPSCQueue<QueuedFrame, QueueCapacity> m_queue;
+        // Thread decoding the queued frames
+        std::thread m_decodeThread;
+        // Is the decode thread running?
+        std::atomic<bool> m_decoding;
+        // Is the decode thread waiting for a frame?
+        std::atomic<bool> m_decodeThreadWaiting;
+        // Guards waiting for the queue
+        std::mutex m_queueMutex;
+        // Signalled when a frame is queued while the decode thread waits, or the stream stops
+        std::condition_variable m_frameQueued;
+        // Did decoding a queued frame fail, so an IDR frame must be requested?
+        std::atomic<bool> m_decodeFailed;
+        // Are frames being dropped until the next IDR frame, as the queue was full? (receiving thread only)
+        bool m_skippingToIDR;
+        // Frames queued, frames dropped, times the queue was full, and deepest the queue got (receiving thread only)
+        uint64_t m_framesQueued;
+        uint64_t m_framesDropped;
+        uint64_t m_queueOverflows;
+        size_t m_maxQueueDepth;
+
+        // Opens the decoder for a format, unless the open one matches it (m_decoderMutex must be held)
+        void OpenDecoder(const DecoderSettings& settings);
+        // Closes the decoder (m_decoderMutex must be held)
+        void CloseDecoder();
+        // Gets the number of threads to decode with
+        unsigned int GetThreadCount() const;
+        // Gets the number of slices to ask the host to split each frame into
+        unsigned int GetSliceCount() const;
+        // Passes a decoded picture to the output callback, with the luminance of HDR pictures
+        void OutputFrame(const obs_source_frame& frame);
+        // Reads the luminance of the host's HDR stream
+        void UpdateHdrMetadata();
+        // Pushes a frame onto the decode queue, returning the DR_* status for moonlight-common-c
+        int Enqueue(BitstreamPool::Pointer bitstream, uint64_t timestamp, bool idr);
+        // Decodes the queued frames (runs on m_decodeThread)
+        void RunDecodeThread();
+        // Stops the decode thread, dropping the frames still queued
+        void StopDecodeThread();
+
+        // DECODER_RENDERER_CALLBACKS.setup
+        static int OnSetup(int videoFormat, int width, int height, int redrawRate, void* context, int drFlags);
+        // DECODER_RENDERER_CALLBACKS.start, starting the decode thread
+        static void OnStart();
+        // DECODER_RENDERER_CALLBACKS.stop, stopping the decode thread
+        static void OnStop();
+        // DECODER_RENDERER_CALLBACKS.cleanup
+        static void OnCleanup();
+        // DECODER_RENDERER_CALLBACKS.submitDecodeUnit
+        static int OnSubmitDecodeUnit(PDECODE_UNIT decodeUnit);
+    };
+} // namespace MoonlightOBS
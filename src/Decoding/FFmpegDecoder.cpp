@@ -0,0 +1,401 @@
+#include "FFmpegDecoder.hpp"
+
+// STL includes
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// moonlight-common-c includes
+#include <Limelight.h>
+
+// FFmpeg includes
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavutil/error.h>
+#include <libavutil/frame.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libavutil/pixfmt.h>
+}
+
+// OBS Studio includes
+#include <obs.h>
+#include <util/base.h>
+
+// Project includes
+#include "../plugin-support.h"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Software AV1 decoders, in order of preference
+    // (the native AV1 decoder of libavcodec only decodes through hardware acceleration)
+    constexpr const char* AV1DecoderNames[] = { "libdav1d", "libaom-av1" };
+
+    // Finds the decoder of a VIDEO_FORMAT_* value
+    const AVCodec* FindDecoder(int videoFormat)
+    {
+        if ((videoFormat & VIDEO_FORMAT_MASK_H264) != 0)
+        {
+            return avcodec_find_decoder(AV_CODEC_ID_H264);
+        }
+        if ((videoFormat & VIDEO_FORMAT_MASK_H265) != 0)
+        {
+            return avcodec_find_decoder(AV_CODEC_ID_HEVC);
+        }
+        if ((videoFormat & VIDEO_FORMAT_MASK_AV1) != 0)
+        {
+            for (const char* name : AV1DecoderNames)
+            {
+                const AVCodec* codec = avcodec_find_decoder_by_name(name);
+                if (codec != nullptr)
+                {
+                    return codec;
+                }
+            }
+        }
+
+        return nullptr;
+    }
+
+    // Returns a bitstream buffer lent to libavcodec to its pool (AVBufferRef free callback)
+    void ReleaseBitstream(void* opaque, uint8_t* data)
+    {
+        BitstreamPool::Returner()(static_cast<BitstreamBuffer*>(opaque));
+        UNUSED_PARAMETER(data);
+    }
+
+    // Returns a picture buffer lent to libavcodec to its pool (AVBufferRef free callback)
+    void ReleaseFrame(void* opaque, uint8_t* data)
+    {
+        FrameBuffer* buffer = static_cast<FrameBuffer*>(opaque);
+        buffer->pool->Release(buffer);
+        UNUSED_PARAMETER(data);
+    }
+
+    // Gets the layout of a pixel format, for the formats the software decoders output
+    bool GetPictureLayout(AVPixelFormat format, PictureFormat& picture)
+    {
+        switch (format)
+        {
+            case AV_PIX_FMT_GRAY8:
+                picture.subsampling = ChromaSubsampling::Monochrome;
+                break;
+            case AV_PIX_FMT_YUV420P:
+            case AV_PIX_FMT_YUVJ420P:
+            case AV_PIX_FMT_YUV420P10LE:
+                picture.subsampling = ChromaSubsampling::Yuv420;
+                break;
+            case AV_PIX_FMT_NV12:
+            case AV_PIX_FMT_P010LE:
+                picture.subsampling = ChromaSubsampling::Yuv420;
+                picture.semiPlanar  = true;
+                break;
+            case AV_PIX_FMT_YUV422P:
+            case AV_PIX_FMT_YUVJ422P:
+            case AV_PIX_FMT_YUV422P10LE:
+                picture.subsampling = ChromaSubsampling::Yuv422;
+                break;
+            case AV_PIX_FMT_NV16:
+                picture.subsampling = ChromaSubsampling::Yuv422;
+                picture.semiPlanar  = true;
+                break;
+            case AV_PIX_FMT_YUV444P:
+            case AV_PIX_FMT_YUVJ444P:
+            case AV_PIX_FMT_YUV444P10LE:
+            case AV_PIX_FMT_YUV444P12LE:
+                picture.subsampling = ChromaSubsampling::Yuv444;
+                break;
+            case AV_PIX_FMT_NV24:
+                picture.subsampling = ChromaSubsampling::Yuv444;
+                picture.semiPlanar  = true;
+                break;
+            default:
+                return false;
+        }
+
+        switch (format)
+        {
+            case AV_PIX_FMT_YUV420P10LE:
+            case AV_PIX_FMT_P010LE:
+            case AV_PIX_FMT_YUV422P10LE:
+            case AV_PIX_FMT_YUV444P10LE:
+                picture.bitDepth = 10;
+                break;
+            case AV_PIX_FMT_YUV444P12LE:
+                picture.bitDepth = 12;
+                break;
+            default:
+                picture.bitDepth = 8;
+                break;
+        }
+
+        // The deprecated JPEG formats are full range whatever the frame says
+        picture.fullRange = format == AV_PIX_FMT_YUVJ420P || format == AV_PIX_FMT_YUVJ422P || format == AV_PIX_FMT_YUVJ444P;
+
+        return true;
+    }
+
+    // Gets the colorimetry of a matrix coefficients value
+    Colorimetry GetColorimetry(AVColorSpace colorspace)
+    {
+        switch (colorspace)
+        {
+            case AVCOL_SPC_BT470BG:
+            case AVCOL_SPC_SMPTE170M:
+                return Colorimetry::BT601;
+            case AVCOL_SPC_BT709:
+                return Colorimetry::BT709;
+            case AVCOL_SPC_BT2020_NCL:
+            case AVCOL_SPC_BT2020_CL:
+                return Colorimetry::BT2020;
+            default:
+                return Colorimetry::Unspecified;
+        }
+    }
+
+    // Gets the transfer characteristics of a transfer characteristics value
+    TransferCharacteristics GetTransferCharacteristics(AVColorTransferCharacteristic trc)
+    {
+        switch (trc)
+        {
+            case AVCOL_TRC_SMPTE2084:
+                return TransferCharacteristics::PQ;
+            case AVCOL_TRC_ARIB_STD_B67:
+                return TransferCharacteristics::HLG;
+            default:
+                return TransferCharacteristics::SDR;
+        }
+    }
+
+    // Formats an FFmpeg error code
+    std::string FormatError(int error)
+    {
+        char message[AV_ERROR_MAX_STRING_SIZE] = {};
+        av_strerror(error, message, sizeof(message));
+        return message;
+    }
+}
+
+FFmpegDecoder::FFmpegDecoder(const DecoderSettings& settings, FrameCallback output, FramePool& framePool)
+    : VideoDecoder(std::move(output), framePool)
+{
+    const AVCodec* codec = FindDecoder(settings.videoFormat);
+    if (codec == nullptr)
+    {
+        throw std::runtime_error("No decoder for video format " + std::to_string(settings.videoFormat));
+    }
+
+    m_context.reset(avcodec_alloc_context3(codec));
+    m_packet.reset(av_packet_alloc());
+    m_frame.reset(av_frame_alloc());
+    if (m_context == nullptr || m_packet == nullptr || m_frame == nullptr)
+    {
+        throw std::runtime_error("Failed to allocate the decoder");
+    }
+
+    m_context->width        = static_cast<int>(settings.width);
+    m_context->height       = static_cast<int>(settings.height);
+    m_context->opaque       = this;
+    m_context->get_buffer2  = OnGetBuffer;
+
+    switch (settings.threading)
+    {
+        case DecodeThreading::Slice:
+            m_context->thread_type = FF_THREAD_SLICE;
+            // Output each frame as soon as it's decoded (which frame threading can't do)
+            m_context->flags |= AV_CODEC_FLAG_LOW_DELAY;
+            break;
+        case DecodeThreading::Frame:
+            m_context->thread_type = FF_THREAD_FRAME;
+            break;
+        case DecodeThreading::SliceAndFrame:
+            m_context->thread_type = FF_THREAD_SLICE | FF_THREAD_FRAME;
+            break;
+    }
+    m_context->thread_count = static_cast<int>(settings.threadCount);
+
+    int result = avcodec_open2(m_context.get(), codec, nullptr);
+    if (result < 0)
+    {
+        throw std::runtime_error("Failed to open the " + std::string(codec->name) + " decoder: " + FormatError(result));
+    }
+
+    obs_log(LOG_INFO, "Opened the %s decoder for %ux%u with %d %s threads", codec->name, settings.width,
+        settings.height, m_context->thread_count,
+        (m_context->active_thread_type & FF_THREAD_FRAME) != 0 ? "frame" : "slice");
+}
+
+bool FFmpegDecoder::Decode(BitstreamPool::Pointer bitstream, uint64_t timestamp)
+{
+    // Lend the buffer to libavcodec, which would otherwise copy a packet it doesn't hold a reference to
+    BitstreamBuffer* buffer = bitstream.get();
+    m_packet->buf = av_buffer_create(buffer->data, buffer->allocated, ReleaseBitstream, buffer, 0);
+    if (m_packet->buf == nullptr)
+    {
+        obs_log(LOG_WARNING, "Failed to allocate the packet of a frame");
+        return false;
+    }
+    bitstream.release();
+
+    m_packet->data  = buffer->data;
+    m_packet->size  = static_cast<int>(buffer->size);
+    m_packet->pts   = static_cast<int64_t>(timestamp);
+
+    // The decoder takes its own reference to the buffer
+    int result = avcodec_send_packet(m_context.get(), m_packet.get());
+    av_packet_unref(m_packet.get());
+    if (result < 0)
+    {
+        obs_log(LOG_WARNING, "Failed to decode a frame: %s", FormatError(result).c_str());
+        return false;
+    }
+
+    // With frame threading, a packet may complete none or several pictures
+    while ((result = avcodec_receive_frame(m_context.get(), m_frame.get())) == 0)
+    {
+        OutputFrame();
+        av_frame_unref(m_frame.get());
+    }
+
+    if (result != AVERROR(EAGAIN) && result != AVERROR_EOF)
+    {
+        obs_log(LOG_WARNING, "Failed to receive a decoded frame: %s", FormatError(result).c_str());
+        return false;
+    }
+
+    return true;
+}
+
+int FFmpegDecoder::GetSupportedVideoFormats()
+{
+    // Each decoder decodes every profile the host can send, which FrameFormat passes to OBS as it is
+    int formats = 0;
+    if (FindDecoder(VIDEO_FORMAT_H264) != nullptr)
+    {
+        formats |= VIDEO_FORMAT_H264 | VIDEO_FORMAT_H264_HIGH8_444;
+    }
+    if (FindDecoder(VIDEO_FORMAT_H265) != nullptr)
+    {
+        formats |= VIDEO_FORMAT_H265 | VIDEO_FORMAT_H265_MAIN10 | VIDEO_FORMAT_H265_REXT8_444 | VIDEO_FORMAT_H265_REXT10_444;
+    }
+    if (FindDecoder(VIDEO_FORMAT_AV1_MAIN8) != nullptr)
+    {
+        formats |= VIDEO_FORMAT_AV1_MAIN8 | VIDEO_FORMAT_AV1_MAIN10 | VIDEO_FORMAT_AV1_HIGH8_444 | VIDEO_FORMAT_AV1_HIGH10_444;
+    }
+
+    return formats;
+}
+
+void FFmpegDecoder::OutputFrame()
+{
+    PictureFormat picture;
+    if (!GetPictureLayout(static_cast<AVPixelFormat>(m_frame->format), picture))
+    {
+        LogUnsupportedFormat();
+        return;
+    }
+    picture.colorimetry = GetColorimetry(m_frame->colorspace);
+    picture.transfer    = GetTransferCharacteristics(m_frame->color_trc);
+    picture.fullRange   = picture.fullRange || m_frame->color_range == AVCOL_RANGE_JPEG;
+
+    // The planes are passed to OBS in the frame pool buffer, which OBS copies when the frame is output
+    obs_source_frame frame = {};
+    for (size_t plane = 0; plane < MAX_AV_PLANES && m_frame->data[plane] != nullptr; plane++)
+    {
+        frame.data[plane]       = m_frame->data[plane];
+        frame.linesize[plane]   = static_cast<uint32_t>(m_frame->linesize[plane]);
+    }
+    frame.width     = static_cast<uint32_t>(m_frame->width);
+    frame.height    = static_cast<uint32_t>(m_frame->height);
+    frame.timestamp = static_cast<uint64_t>(m_frame->best_effort_timestamp != AV_NOPTS_VALUE ?
+        m_frame->best_effort_timestamp : m_frame->pts);
+
+    if (!Output(picture, frame))
+    {
+        LogUnsupportedFormat();
+    }
+}
+
+void FFmpegDecoder::LogUnsupportedFormat()
+{
+    if (!m_loggedUnsupportedFormat)
+    {
+        const char* name = av_get_pix_fmt_name(static_cast<AVPixelFormat>(m_frame->format));
+        obs_log(LOG_WARNING, "Dropping frames of unsupported pixel format %s", name != nullptr ? name : "unknown");
+        m_loggedUnsupportedFormat = true;
+    }
+}
+
+int FFmpegDecoder::OnGetBuffer(AVCodecContext* context, AVFrame* frame, int flags)
+{
+    FFmpegDecoder* decoder = static_cast<FFmpegDecoder*>(context->opaque);
+    AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+
+    // Leave decoders which don't support custom buffers, and formats which aren't planar YUV, to libavcodec
+    const AVPixFmtDescriptor* descriptor = av_pix_fmt_desc_get(format);
+    if ((context->codec->capabilities & AV_CODEC_CAP_DR1) == 0 || descriptor == nullptr ||
+        (descriptor->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL)) != 0)
+    {
+        return avcodec_default_get_buffer2(context, frame, flags);
+    }
+
+    // Pad the picture as the decoder requires, for motion vectors past its edges and SIMD
+    int width = frame->width;
+    int height = frame->height;
+    int strideAlignment[AV_NUM_DATA_POINTERS] = {};
+    avcodec_align_dimensions2(context, &width, &height, strideAlignment);
+
+    int linesizes[4] = {};
+    int planeCount = av_pix_fmt_count_planes(format);
+    if (av_image_fill_linesizes(linesizes, format, width) < 0 || planeCount <= 0 || planeCount > 4)
+    {
+        return avcodec_default_get_buffer2(context, frame, flags);
+    }
+
+    // Lay the planes out one after another, each with aligned rows and room to read past its end
+    size_t offsets[4] = {};
+    size_t size = 0;
+    for (int plane = 0; plane < planeCount; plane++)
+    {
+        linesizes[plane] = static_cast<int>((static_cast<size_t>(linesizes[plane]) + FramePool::Alignment - 1) &
+            ~(FramePool::Alignment - 1));
+        int shift = plane == 1 || plane == 2 ? descriptor->log2_chroma_h : 0;
+        size_t rows = static_cast<size_t>((height + (1 << shift) - 1) >> shift);
+
+        offsets[plane] = size;
+        size += static_cast<size_t>(linesizes[plane]) * rows + FramePool::Alignment;
+    }
+
+    FrameBuffer* buffer = nullptr;
+    try
+    {
+        buffer = decoder->m_framePool.Acquire(size);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return AVERROR(ENOMEM);
+    }
+
+    frame->buf[0] = av_buffer_create(buffer->data, buffer->allocated, ReleaseFrame, buffer, 0);
+    if (frame->buf[0] == nullptr)
+    {
+        buffer->pool->Release(buffer);
+        return AVERROR(ENOMEM);
+    }
+
+    for (int plane = 0; plane < planeCount; plane++)
+    {
+        frame->data[plane]      = buffer->data + offsets[plane];
+        frame->linesize[plane]  = linesizes[plane];
+    }
+    frame->extended_data = frame->data;
+
+    return 0;
+}
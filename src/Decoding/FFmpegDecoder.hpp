@@ -0,0 +1,75 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+
+// OBS Studio includes
+#include <obs.h>
+
+// Project includes
+#include "../Utilities/FFmpegPointer.hpp"
+#include "VideoDecoder.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Decodes H.264, HEVC and AV1 in software with libavcodec.
+     *
+     * The decoder is opened with low delay, so each frame is output as soon as it's decoded.
+     * Slice threading decodes the slices of a frame in parallel without adding latency, while
+     * frame threading decodes several frames in parallel and delays the output by a frame per
+     * extra thread (libavcodec ignores low delay when frame threading is used).
+     *
+     */
+    class FFmpegDecoder : public VideoDecoder
+    {
+    public:
+        /**
+         * @brief Opens a decoder for a stream.
+         *
+         * @param settings The format of the stream, and how to decode it.
+         * @param output Receives each decoded picture.
+         * @param framePool Buffers the decoder writes its pictures into, which must outlive the decoder.
+         * @exception std::runtime_error If libavcodec has no decoder for the format, or it can't be opened.
+         */
+        FFmpegDecoder(const DecoderSettings& settings, FrameCallback output, FramePool& framePool);
+
+        bool Decode(BitstreamPool::Pointer bitstream, uint64_t timestamp) override;
+
+        inline size_t GetInputPadding() const override
+        {
+            return AV_INPUT_BUFFER_PADDING_SIZE;
+        }
+
+        inline const char* GetName() const override
+        {
+            return m_context->codec->name;
+        }
+
+        /**
+         * @brief Gets the VIDEO_FORMAT_* values libavcodec has decoders for.
+         *
+         * @return int The supported formats.
+         */
+        static int GetSupportedVideoFormats();
+
+    private:
+        // Decoder context
+        FFmpegPointer<AVCodecContext> m_context;
+        // Packet the bitstream is passed in
+        FFmpegPointer<AVPacket> m_packet;
+        // Picture received from the decoder
+        FFmpegPointer<AVFrame> m_frame;
+        // Has a picture of an unsupported pixel format been logged?
+        bool m_loggedUnsupportedFormat = false;
+
+        // Outputs the received picture to OBS
+        void OutputFrame();
+        // Logs the first picture of an unsupported pixel format
+        void LogUnsupportedFormat();
+
+        // AVCodecContext.get_buffer2, giving the decoder a buffer from the frame pool to decode into
+        static int OnGetBuffer(AVCodecContext* context, AVFrame* frame, int flags);
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,122 @@
+#include "FrameConverter.hpp"
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+
+// OBS Studio includes
+#include <obs.h>
+
+// Project includes
+#include "../Utilities/WorkerPool.hpp"
+#include "PixelKernels.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Fewest rows worth converting on another thread
+    constexpr size_t MinimumRows = 16;
+    // Bits 10 bit samples are shifted by to MSB align them in 16 bits
+    constexpr unsigned int MSBAlignShift = 6;
+
+    // Aligns a linesize for the vector stores of the kernels, and the uploads of OBS
+    size_t AlignLinesize(size_t linesize)
+    {
+        return (linesize + FramePool::Alignment - 1) & ~(FramePool::Alignment - 1);
+    }
+
+    // Splits the chroma of a semi-planar 8 bit picture into planes
+    FrameBuffer* DeinterleaveChroma(const PictureFormat& picture, obs_source_frame& frame, FramePool& framePool)
+    {
+        const size_t chromaWidth = picture.subsampling == ChromaSubsampling::Yuv422 ? (frame.width + 1) / 2 : frame.width;
+        const size_t rows = frame.height;
+        const size_t linesize = AlignLinesize(chromaWidth);
+
+        FrameBuffer* buffer = framePool.Acquire(linesize * rows * 2);
+        const uint8_t* source = frame.data[1];
+        const size_t sourceLinesize = frame.linesize[1];
+        uint8_t* u = buffer->data;
+        uint8_t* v = buffer->data + linesize * rows;
+
+        WorkerPool::ParallelFor(rows, MinimumRows, [&](size_t begin, size_t end)
+        {
+            for (size_t row = begin; row < end; row++)
+            {
+                PixelKernels::DeinterleaveChroma8(source + row * sourceLinesize, u + row * linesize, v + row * linesize,
+                    chromaWidth);
+            }
+        });
+
+        // The luma plane is read as it is
+        frame.data[1]       = u;
+        frame.data[2]       = v;
+        frame.linesize[1]   = static_cast<uint32_t>(linesize);
+        frame.linesize[2]   = static_cast<uint32_t>(linesize);
+        return buffer;
+    }
+
+    // MSB aligns the samples of a planar 10 bit 4:4:4 picture, interleaving its chroma
+    FrameBuffer* InterleaveChroma(obs_source_frame& frame, FramePool& framePool)
+    {
+        const size_t width = frame.width;
+        const size_t rows = frame.height;
+        const size_t lumaLinesize = AlignLinesize(width * sizeof(uint16_t));
+        const size_t chromaLinesize = AlignLinesize(width * 2 * sizeof(uint16_t));
+
+        FrameBuffer* buffer = framePool.Acquire((lumaLinesize + chromaLinesize) * rows);
+        uint8_t* luma = buffer->data;
+        uint8_t* chroma = buffer->data + lumaLinesize * rows;
+
+        const obs_source_frame& source = frame;
+        WorkerPool::ParallelFor(rows, MinimumRows, [&](size_t begin, size_t end)
+        {
+            for (size_t row = begin; row < end; row++)
+            {
+                PixelKernels::Shift16(reinterpret_cast<const uint16_t*>(source.data[0] + row * source.linesize[0]),
+                    reinterpret_cast<uint16_t*>(luma + row * lumaLinesize), width, MSBAlignShift);
+                PixelKernels::InterleaveChroma16(reinterpret_cast<const uint16_t*>(source.data[1] + row * source.linesize[1]),
+                    reinterpret_cast<const uint16_t*>(source.data[2] + row * source.linesize[2]),
+                    reinterpret_cast<uint16_t*>(chroma + row * chromaLinesize), width, MSBAlignShift);
+            }
+        });
+
+        frame.data[0]       = luma;
+        frame.data[1]       = chroma;
+        frame.data[2]       = nullptr;
+        frame.linesize[0]   = static_cast<uint32_t>(lumaLinesize);
+        frame.linesize[1]   = static_cast<uint32_t>(chromaLinesize);
+        frame.linesize[2]   = 0;
+        return buffer;
+    }
+}
+
+bool FrameConverter::GetConvertedFormat(const PictureFormat& picture, PictureFormat& converted)
+{
+    converted = picture;
+
+    if (picture.bitDepth == 8 && picture.semiPlanar &&
+        (picture.subsampling == ChromaSubsampling::Yuv422 || picture.subsampling == ChromaSubsampling::Yuv444))
+    {
+        converted.semiPlanar = false;
+        return true;
+    }
+
+    if (picture.bitDepth == 10 && !picture.semiPlanar && picture.subsampling == ChromaSubsampling::Yuv444)
+    {
+        converted.semiPlanar = true;
+        return true;
+    }
+
+    return false;
+}
+
+FrameBuffer* FrameConverter::Convert(const PictureFormat& picture, obs_source_frame& frame, FramePool& framePool)
+{
+    if (picture.bitDepth == 8)
+    {
+        return DeinterleaveChroma(picture, frame, framePool);
+    }
+
+    return InterleaveChroma(frame, framePool);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// OBS Studio includes
+#include <obs.h>
+
+// Project includes
+#include "FrameFormat.hpp"
+#include "FramePool.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Static helper class which converts the planes of the few layouts OBS can't read as they are.
+     *
+     * Semi-planar 8 bit 4:2:2 and 4:4:4 pictures have their chroma split into planar I422 and I444,
+     * and planar 10 bit 4:4:4 HDR pictures (which OBS only reads as SDR through I412) are MSB
+     * aligned and interleaved into P416. Luma planes which only need copying are passed through.
+     * The rows are converted in parallel on the shared worker threads with the PixelKernels,
+     * into a buffer from the frame pool.
+     *
+     */
+    class FrameConverter
+    {
+    public:
+        /**
+         * @brief Gets the layout a picture is converted to.
+         *
+         * @param picture The layout of the picture, which FrameFormat can't describe.
+         * @param converted Receives the layout of the converted picture.
+         * @return true If the picture can be converted.
+         * @return false If there's no conversion for the layout.
+         */
+        static bool GetConvertedFormat(const PictureFormat& picture, PictureFormat& converted);
+
+        /**
+         * @brief Converts the planes of a frame, pointing the frame at the converted planes.
+         * @exception std::bad_alloc If the buffer couldn't be allocated.
+         *
+         * @param picture The layout of the picture, which GetConvertedFormat has a conversion for.
+         * @param frame The frame, whose planes, linesizes and dimensions are set.
+         * @param framePool The pool to take the buffer of the converted planes from.
+         * @return FrameBuffer* The buffer of the converted planes, to release once the frame is output.
+         */
+        static FrameBuffer* Convert(const PictureFormat& picture, obs_source_frame& frame, FramePool& framePool);
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        FrameConverter()                                    = delete;
+        FrameConverter(const FrameConverter&)               = delete;
+        FrameConverter& operator=(const FrameConverter&)    = delete;
+        ~FrameConverter()                                   = delete;
+    };
+} // namespace MoonlightOBS
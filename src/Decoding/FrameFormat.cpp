@@ -0,0 +1,207 @@
+#include "FrameFormat.hpp"
+
+// STL includes
+#include <cstddef>
+
+// OBS Studio includes
+#include <obs.h>
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Height from which pictures without signalled colorimetry are taken to be HD
+    constexpr uint32_t MinimumHDHeight = 720;
+
+    // How a picture layout is read by OBS
+    struct Passthrough
+    {
+        video_format format;        // Format OBS reads the planes as
+        video_format matrixFormat;  // Format of the picture's bit depth, which the matrix and range are for
+        float sampleScale;          // Scale from the samples OBS reads to those of the picture's bit depth
+    };
+
+    // Finds the OBS format which reads a picture layout as it is
+    bool GetPassthrough(const PictureFormat& picture, Passthrough& passthrough)
+    {
+        passthrough.sampleScale = 1.0f;
+
+        switch (picture.bitDepth)
+        {
+            case 8:
+                switch (picture.subsampling)
+                {
+                    case ChromaSubsampling::Monochrome:
+                        passthrough.format = VIDEO_FORMAT_Y800;
+                        break;
+                    case ChromaSubsampling::Yuv420:
+                        passthrough.format = picture.semiPlanar ? VIDEO_FORMAT_NV12 : VIDEO_FORMAT_I420;
+                        break;
+                    case ChromaSubsampling::Yuv422:
+                        passthrough.format = picture.semiPlanar ? VIDEO_FORMAT_NONE : VIDEO_FORMAT_I422;
+                        break;
+                    case ChromaSubsampling::Yuv444:
+                        passthrough.format = picture.semiPlanar ? VIDEO_FORMAT_NONE : VIDEO_FORMAT_I444;
+                        break;
+                }
+                passthrough.matrixFormat = passthrough.format;
+                break;
+
+            case 10:
+                switch (picture.subsampling)
+                {
+                    case ChromaSubsampling::Monochrome:
+                        passthrough.format = VIDEO_FORMAT_NONE;
+                        break;
+                    case ChromaSubsampling::Yuv420:
+                        passthrough.format = picture.semiPlanar ? VIDEO_FORMAT_P010 : VIDEO_FORMAT_I010;
+                        break;
+                    case ChromaSubsampling::Yuv422:
+                        // MSB aligned samples read the same at 16 bits
+                        passthrough.format = picture.semiPlanar ? VIDEO_FORMAT_P216 : VIDEO_FORMAT_I210;
+                        break;
+                    case ChromaSubsampling::Yuv444:
+                        if (picture.semiPlanar)
+                        {
+                            passthrough.format = VIDEO_FORMAT_P416;
+                        }
+                        else if (picture.transfer == TransferCharacteristics::SDR)
+                        {
+                            // OBS has no planar 10 bit 4:4:4 format, but reads I412 samples as they are stored,
+                            // so 10 bit samples only need scaling from 12 bits
+                            passthrough.format = VIDEO_FORMAT_I412;
+                            passthrough.sampleScale = 4095.0f / 1023.0f;
+                        }
+                        else
+                        {
+                            // OBS only converts I412 as SDR, so HDR pictures are converted to P416 by FrameConverter
+                            passthrough.format = VIDEO_FORMAT_NONE;
+                        }
+                        break;
+                }
+                passthrough.matrixFormat = passthrough.format == VIDEO_FORMAT_NONE ? VIDEO_FORMAT_NONE : VIDEO_FORMAT_I010;
+                break;
+
+            case 12:
+                passthrough.format = picture.subsampling == ChromaSubsampling::Yuv444 && !picture.semiPlanar ?
+                    VIDEO_FORMAT_I412 : VIDEO_FORMAT_NONE;
+                passthrough.matrixFormat = passthrough.format;
+                break;
+
+            default:
+                passthrough.format = VIDEO_FORMAT_NONE;
+                break;
+        }
+
+        return passthrough.format != VIDEO_FORMAT_NONE;
+    }
+
+    // Gets the OBS colour space whose matrix a picture was encoded with
+    video_colorspace GetColorspace(const PictureFormat& picture, uint32_t height)
+    {
+        switch (picture.transfer)
+        {
+            case TransferCharacteristics::PQ:
+                return VIDEO_CS_2100_PQ;
+            case TransferCharacteristics::HLG:
+                return VIDEO_CS_2100_HLG;
+            case TransferCharacteristics::SDR:
+                break;
+        }
+
+        switch (picture.colorimetry)
+        {
+            case Colorimetry::BT601:
+                return VIDEO_CS_601;
+            case Colorimetry::BT709:
+                return VIDEO_CS_709;
+            case Colorimetry::BT2020:
+                // The BT.2100 colour spaces share the BT.2020 matrix, and SDR is kept by the transfer characteristics
+                return VIDEO_CS_2100_PQ;
+            case Colorimetry::Unspecified:
+                break;
+        }
+
+        return height >= MinimumHDHeight ? VIDEO_CS_709 : VIDEO_CS_601;
+    }
+
+    // Gets the transfer characteristics OBS converts a picture from
+    video_trc GetTrc(TransferCharacteristics transfer)
+    {
+        switch (transfer)
+        {
+            case TransferCharacteristics::PQ:
+                return VIDEO_TRC_PQ;
+            case TransferCharacteristics::HLG:
+                return VIDEO_TRC_HLG;
+            case TransferCharacteristics::SDR:
+                break;
+        }
+
+        return VIDEO_TRC_DEFAULT;
+    }
+}
+
+bool FrameFormat::Describe(const PictureFormat& picture, obs_source_frame& frame)
+{
+    Passthrough passthrough;
+    if (!GetPassthrough(picture, passthrough))
+    {
+        return false;
+    }
+
+    frame.format        = passthrough.format;
+    frame.full_range    = picture.fullRange;
+    frame.trc           = static_cast<uint8_t>(GetTrc(picture.transfer));
+    if (!video_format_get_parameters_for_format(GetColorspace(picture, frame.height),
+        picture.fullRange ? VIDEO_RANGE_FULL : VIDEO_RANGE_PARTIAL, passthrough.matrixFormat,
+        frame.color_matrix, frame.color_range_min, frame.color_range_max))
+    {
+        return false;
+    }
+
+    if (passthrough.sampleScale != 1.0f)
+    {
+        // OBS clamps the samples to the range, then multiplies them by the Y, Cb and Cr columns of the matrix,
+        // so scaling both converts the samples on the GPU
+        for (size_t row = 0; row < 3; row++)
+        {
+            for (size_t column = 0; column < 3; column++)
+            {
+                frame.color_matrix[row * 4 + column] *= passthrough.sampleScale;
+            }
+        }
+        for (size_t component = 0; component < 3; component++)
+        {
+            frame.color_range_min[component] /= passthrough.sampleScale;
+            frame.color_range_max[component] /= passthrough.sampleScale;
+        }
+    }
+
+    return true;
+}
+
+uint32_t FrameFormat::GetPlaneHeight(video_format format, uint32_t height, size_t plane)
+{
+    switch (format)
+    {
+        case VIDEO_FORMAT_Y800:
+            return plane == 0 ? height : 0;
+        case VIDEO_FORMAT_I420:
+        case VIDEO_FORMAT_I010:
+            return plane == 0 ? height : plane < 3 ? (height + 1) / 2 : 0;
+        case VIDEO_FORMAT_NV12:
+        case VIDEO_FORMAT_P010:
+            return plane == 0 ? height : plane == 1 ? (height + 1) / 2 : 0;
+        case VIDEO_FORMAT_I422:
+        case VIDEO_FORMAT_I210:
+        case VIDEO_FORMAT_I444:
+        case VIDEO_FORMAT_I412:
+            return plane < 3 ? height : 0;
+        case VIDEO_FORMAT_P216:
+        case VIDEO_FORMAT_P416:
+            return plane < 2 ? height : 0;
+        default:
+            return 0;
+    }
+}
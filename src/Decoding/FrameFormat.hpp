@@ -0,0 +1,104 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+
+// OBS Studio includes
+#include <obs.h>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief How the chroma planes of a picture are subsampled.
+     *
+     */
+    enum class ChromaSubsampling : uint8_t
+    {
+        Monochrome = 0, // No chroma planes
+        Yuv420,         // Chroma halved horizontally and vertically
+        Yuv422,         // Chroma halved horizontally
+        Yuv444          // Full resolution chroma
+    };
+
+    /**
+     * @brief The matrix coefficients a picture was encoded with.
+     *
+     */
+    enum class Colorimetry : uint8_t
+    {
+        Unspecified = 0,    // Not signalled, so chosen from the resolution
+        BT601,              // SD
+        BT709,              // HD
+        BT2020              // UHD and HDR (non-constant luminance)
+    };
+
+    /**
+     * @brief The transfer characteristics of a picture.
+     *
+     */
+    enum class TransferCharacteristics : uint8_t
+    {
+        SDR = 0,    // BT.709, BT.601 or sRGB gamma
+        PQ,         // SMPTE ST 2084
+        HLG         // ARIB STD-B67
+    };
+
+    /**
+     * @brief The layout and colour of a decoded picture, as signalled by the decoder.
+     *
+     */
+    struct PictureFormat
+    {
+        ChromaSubsampling subsampling           = ChromaSubsampling::Yuv420;    // Chroma subsampling
+        unsigned int bitDepth                   = 8;                            // Bits per sample
+        bool semiPlanar                         = false;                        // Are the chroma samples interleaved in one plane? (like NV12 and P010)
+        Colorimetry colorimetry                 = Colorimetry::Unspecified;     // Matrix coefficients
+        TransferCharacteristics transfer        = TransferCharacteristics::SDR; // Transfer characteristics
+        bool fullRange                          = false;                        // Are the samples full range?
+    };
+
+    /**
+     * @brief Static helper class which describes decoded pictures to OBS, so their planes are passed to it as they are.
+     *
+     * Almost every layout the host can send maps to a format OBS reads natively: NV12, I420 and I444
+     * for 8 bits, P010 and I010 for 10 bit 4:2:0, and I412 for 10 bit 4:4:4 SDR, whose samples
+     * are scaled to 12 bits by folding the scale into the colour matrix rather than converting them.
+     * The few layouts left have to be converted by FrameConverter.
+     * The matrix and range come from OBS for the colour space, and HDR pictures are tagged with
+     * their transfer characteristics so OBS can tone map them to the canvas.
+     *
+     */
+    class FrameFormat
+    {
+    public:
+        /**
+         * @brief Fills in the format, colour matrix, range and transfer characteristics of a frame.
+         *
+         * @param picture The layout and colour of the picture.
+         * @param frame The frame, whose height chooses the colorimetry when it's unspecified.
+         * @return true If OBS can read the picture as it is.
+         * @return false If OBS has no format for the layout.
+         */
+        static bool Describe(const PictureFormat& picture, obs_source_frame& frame);
+
+        /**
+         * @brief Gets the number of rows in a plane of a frame, for the formats Describe outputs.
+         *
+         * @param format The format of the frame.
+         * @param height The height of the frame.
+         * @param plane The index of the plane.
+         * @return uint32_t The number of rows, or 0 if the format has no such plane.
+         */
+        static uint32_t GetPlaneHeight(video_format format, uint32_t height, size_t plane);
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        FrameFormat()                               = delete;
+        FrameFormat(const FrameFormat&)             = delete;
+        FrameFormat& operator=(const FrameFormat&)  = delete;
+        ~FrameFormat()                              = delete;
+    };
+} // namespace MoonlightOBS
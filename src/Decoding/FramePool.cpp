@@ -0,0 +1,79 @@
+#include "FramePool.hpp"
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+
+using namespace MoonlightOBS;
+
+FramePool::~FramePool()
+{
+    for (FrameBuffer* buffer : m_free)
+    {
+        Free(buffer);
+    }
+}
+
+FrameBuffer* FramePool::Acquire(size_t size)
+{
+    size = (size + Alignment - 1) & ~(Alignment - 1);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (size > m_bufferSize)
+    {
+        // The pictures grew, so the smaller buffers are dropped and a new set is allocated
+        for (FrameBuffer* buffer : m_free)
+        {
+            Free(buffer);
+        }
+        m_free.clear();
+        m_bufferSize = size;
+
+        m_free.reserve(PreallocatedBuffers);
+        for (size_t i = 0; i < PreallocatedBuffers; i++)
+        {
+            m_free.push_back(Allocate(m_bufferSize));
+        }
+    }
+
+    if (m_free.empty())
+    {
+        // More pictures are referenced than have been so far
+        return Allocate(m_bufferSize);
+    }
+
+    FrameBuffer* buffer = m_free.back();
+    m_free.pop_back();
+    return buffer;
+}
+
+void FramePool::Release(FrameBuffer* buffer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (buffer->allocated < m_bufferSize)
+    {
+        // Acquired before the pictures grew
+        Free(buffer);
+        return;
+    }
+
+    m_free.push_back(buffer);
+}
+
+FrameBuffer* FramePool::Allocate(size_t size)
+{
+    std::unique_ptr<FrameBuffer> buffer = std::make_unique<FrameBuffer>();
+    buffer->data = static_cast<uint8_t*>(::operator new(size, std::align_val_t(Alignment)));
+    buffer->allocated = size;
+    buffer->pool = this;
+    return buffer.release();
+}
+
+void FramePool::Free(FrameBuffer* buffer)
+{
+    ::operator delete(buffer->data, std::align_val_t(Alignment));
+    delete buffer;
+}
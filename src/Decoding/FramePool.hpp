@@ -0,0 +1,96 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace MoonlightOBS
+{
+    // Forward declarations
+    class FramePool;
+
+    /**
+     * @brief An aligned buffer holding the planes of a decoded picture.
+     *
+     */
+    struct FrameBuffer
+    {
+        uint8_t* data           = nullptr;  // Planes, aligned to FramePool::Alignment
+        size_t allocated        = 0;        // Size of the allocation
+        FramePool* pool         = nullptr;  // Pool the buffer returns to
+    };
+
+    /**
+     * @brief A pool of buffers which decoders write their pictures into directly.
+     *
+     * Decoders acquire a buffer for each picture they decode (through get_buffer2 in libavcodec,
+     * or the picture allocator of dav1d) and release it once it's no longer referenced, which
+     * for reference frames is after the frames referencing them have been decoded. OBS copies
+     * a frame when it's output, so a buffer never has to wait for OBS to be recycled.
+     *
+     * Buffers are sized for the largest picture requested, and several are allocated at once
+     * when the size grows, so a stream doesn't allocate after its first frame.
+     *
+     * The pool must outlive the decoders its buffers are lent to.
+     *
+     */
+    class FramePool
+    {
+    public:
+        /**
+         * @brief The alignment of the planes, which suits the SIMD stores of every decoder.
+         *
+         */
+        static constexpr size_t Alignment = 64;
+
+        /**
+         * @brief The number of buffers allocated when the buffer size grows.
+         *
+         */
+        static constexpr size_t PreallocatedBuffers = 4;
+
+        FramePool() = default;
+
+        /**
+         * @brief Frees the buffers of the pool.
+         *
+         */
+        ~FramePool();
+
+        FramePool(const FramePool&)             = delete;
+        FramePool& operator=(const FramePool&)  = delete;
+
+        /**
+         * @brief Takes a buffer from the pool.
+         * @note May be called from any thread.
+         *
+         * @param size The size of the picture, including any padding the decoder needs.
+         * @return FrameBuffer* The buffer, which must be released to the pool.
+         * @exception std::bad_alloc If a buffer can't be allocated.
+         */
+        FrameBuffer* Acquire(size_t size);
+
+        /**
+         * @brief Returns a buffer to the pool.
+         * @note May be called from any thread.
+         *
+         * @param buffer The buffer, which was acquired from this pool.
+         */
+        void Release(FrameBuffer* buffer);
+
+    private:
+        // Guards the members below
+        std::mutex m_mutex;
+        // Buffers which aren't lent out
+        std::vector<FrameBuffer*> m_free;
+        // Size of the buffers
+        size_t m_bufferSize = 0;
+
+        // Allocates a buffer
+        FrameBuffer* Allocate(size_t size);
+        // Frees a buffer
+        static void Free(FrameBuffer* buffer);
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,579 @@
+#include "PixelKernels.hpp"
+
+// STL includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PIXEL_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC compiles intrinsics of any instruction set without flags
+#define TARGET_SSE41
+#define TARGET_AVX2
+#else
+// Compile the vector versions for their instruction sets, leaving the rest of the plugin portable
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PIXEL_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+// OBS Studio includes
+#include <util/base.h>
+
+// Project includes
+#include "../plugin-support.h"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // The versions of the kernels chosen for the CPU
+    struct KernelTable
+    {
+        InstructionSet instructionSet;
+        void (*deinterleaveChroma8)(const uint8_t*, uint8_t*, uint8_t*, size_t);
+        void (*shift16)(const uint16_t*, uint16_t*, size_t, unsigned int);
+        void (*interleaveChroma16)(const uint16_t*, const uint16_t*, uint16_t*, size_t, unsigned int);
+        void (*toneMap)(const ToneMapParameters&, const ToneMapRows&);
+    };
+
+    // BT.2020 non-constant luminance Y'CbCr to R'G'B'
+    constexpr float CrToR = 1.4746f;
+    constexpr float CbToG = -0.16455f;
+    constexpr float CrToG = -0.57135f;
+    constexpr float CbToB = 1.8814f;
+
+    // BT.2020 to BT.709 primaries, in linear light
+    constexpr float GamutMatrix[3][3] = {
+        { 1.6605f, -0.5876f, -0.0728f },
+        { -0.1246f, 1.1329f, -0.0083f },
+        { -0.0182f, -0.1006f, 1.1187f }
+    };
+
+    // BT.709 R'G'B' to Y'
+    constexpr float KR = 0.2126f;
+    constexpr float KG = 0.7152f;
+    constexpr float KB = 0.0722f;
+    // BT.709 R'G'B' to limited range 8 bit Y'CbCr
+    constexpr float LumaOutOffset = 16.0f;
+    constexpr float LumaOutScale = 219.0f;
+    constexpr float ChromaOutOffset = 128.0f;
+    constexpr float CbOutScale = 224.0f / 1.8556f;
+    constexpr float CrOutScale = 224.0f / 1.5748f;
+
+    // Scalar versions
+
+    void DeinterleaveChroma8Scalar(const uint8_t* uv, uint8_t* u, uint8_t* v, size_t count)
+    {
+        for (size_t pair = 0; pair < count; pair++)
+        {
+            u[pair] = uv[pair * 2];
+            v[pair] = uv[pair * 2 + 1];
+        }
+    }
+
+    void Shift16Scalar(const uint16_t* source, uint16_t* destination, size_t count, unsigned int shift)
+    {
+        for (size_t sample = 0; sample < count; sample++)
+        {
+            destination[sample] = static_cast<uint16_t>(source[sample] << shift);
+        }
+    }
+
+    void InterleaveChroma16Scalar(const uint16_t* u, const uint16_t* v, uint16_t* uv, size_t count, unsigned int shift)
+    {
+        for (size_t pair = 0; pair < count; pair++)
+        {
+            uv[pair * 2]        = static_cast<uint16_t>(u[pair] << shift);
+            uv[pair * 2 + 1]    = static_cast<uint16_t>(v[pair] << shift);
+        }
+    }
+
+    // Looks up a value in [0, 1] in a tone map table
+    inline float LookUp(const float* table, float value)
+    {
+        value = std::min(std::max(value, 0.0f), 1.0f);
+        return table[static_cast<size_t>(value * (ToneMapParameters::TableSize - 1) + 0.5f)];
+    }
+
+    // Rounds an output sample to a byte
+    inline uint8_t ToByte(float value)
+    {
+        return static_cast<uint8_t>(std::min(std::max(value + 0.5f, 0.0f), 255.0f));
+    }
+
+    // Tone maps a pixel to gamma coded BT.709 R'G'B'
+    inline void ToneMapPixel(const ToneMapParameters& parameters, float y, float cb, float cr, float rgb[3])
+    {
+        float linear[3] = {
+            LookUp(parameters.pqToLinear, y + CrToR * cr),
+            LookUp(parameters.pqToLinear, y + CbToG * cb + CrToG * cr),
+            LookUp(parameters.pqToLinear, y + CbToB * cb)
+        };
+
+        for (size_t component = 0; component < 3; component++)
+        {
+            float mapped = GamutMatrix[component][0] * linear[0] + GamutMatrix[component][1] * linear[1] +
+                GamutMatrix[component][2] * linear[2];
+            rgb[component] = LookUp(parameters.sqrtToGamma, std::sqrt(std::max(mapped, 0.0f)));
+        }
+    }
+
+    // Tone maps the 2x2 blocks [begin, end) of a pair of rows
+    void ToneMapBlocks(const ToneMapParameters& parameters, const ToneMapRows& rows, size_t begin, size_t end)
+    {
+        for (size_t block = begin; block < end; block++)
+        {
+            uint16_t cbSample = parameters.semiPlanar ? rows.chroma[0][block * 2] : rows.chroma[0][block];
+            uint16_t crSample = parameters.semiPlanar ? rows.chroma[0][block * 2 + 1] : rows.chroma[1][block];
+            float cb = (static_cast<float>(cbSample >> parameters.shift) - parameters.chromaOffset) * parameters.chromaScale;
+            float cr = (static_cast<float>(crSample >> parameters.shift) - parameters.chromaOffset) * parameters.chromaScale;
+
+            float sum[3] = {};
+            for (size_t row = 0; row < 2; row++)
+            {
+                // The last column of an odd width is its own block
+                for (size_t column = block * 2; column < std::min(block * 2 + 2, rows.width); column++)
+                {
+                    float y = (static_cast<float>(rows.luma[row][column] >> parameters.shift) - parameters.lumaOffset) *
+                        parameters.lumaScale;
+
+                    float rgb[3];
+                    ToneMapPixel(parameters, y, cb, cr, rgb);
+                    rows.lumaOut[row][column] = ToByte(LumaOutOffset + LumaOutScale * (KR * rgb[0] + KG * rgb[1] + KB * rgb[2]));
+
+                    sum[0] += rgb[0];
+                    sum[1] += rgb[1];
+                    sum[2] += rgb[2];
+                }
+            }
+
+            float pixels = block * 2 + 1 < rows.width ? 4.0f : 2.0f;
+            float r = sum[0] / pixels;
+            float b = sum[2] / pixels;
+            float luma = KR * r + KG * (sum[1] / pixels) + KB * b;
+            rows.cbOut[block] = ToByte(ChromaOutOffset + CbOutScale * (b - luma));
+            rows.crOut[block] = ToByte(ChromaOutOffset + CrOutScale * (r - luma));
+        }
+    }
+
+    void ToneMapScalar(const ToneMapParameters& parameters, const ToneMapRows& rows)
+    {
+        ToneMapBlocks(parameters, rows, 0, (rows.width + 1) / 2);
+    }
+
+#ifdef PIXEL_KERNELS_X86
+    // SSE4.1 versions
+
+    TARGET_SSE41 void DeinterleaveChroma8SSE41(const uint8_t* uv, uint8_t* u, uint8_t* v, size_t count)
+    {
+        const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+        size_t pair = 0;
+        for (; pair + 16 <= count; pair += 16)
+        {
+            __m128i first   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + pair * 2));
+            __m128i second  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(uv + pair * 2 + 16));
+            __m128i uSamples = _mm_packus_epi16(_mm_and_si128(first, lowBytes), _mm_and_si128(second, lowBytes));
+            __m128i vSamples = _mm_packus_epi16(_mm_srli_epi16(first, 8), _mm_srli_epi16(second, 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(u + pair), uSamples);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(v + pair), vSamples);
+        }
+        DeinterleaveChroma8Scalar(uv + pair * 2, u + pair, v + pair, count - pair);
+    }
+
+    TARGET_SSE41 void Shift16SSE41(const uint16_t* source, uint16_t* destination, size_t count, unsigned int shift)
+    {
+        const __m128i shiftCount = _mm_cvtsi32_si128(static_cast<int>(shift));
+        size_t sample = 0;
+        for (; sample + 8 <= count; sample += 8)
+        {
+            __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + sample));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + sample), _mm_sll_epi16(samples, shiftCount));
+        }
+        Shift16Scalar(source + sample, destination + sample, count - sample, shift);
+    }
+
+    TARGET_SSE41 void InterleaveChroma16SSE41(const uint16_t* u, const uint16_t* v, uint16_t* uv, size_t count,
+        unsigned int shift)
+    {
+        const __m128i shiftCount = _mm_cvtsi32_si128(static_cast<int>(shift));
+        size_t pair = 0;
+        for (; pair + 8 <= count; pair += 8)
+        {
+            __m128i uSamples = _mm_sll_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(u + pair)), shiftCount);
+            __m128i vSamples = _mm_sll_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + pair)), shiftCount);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + pair * 2), _mm_unpacklo_epi16(uSamples, vSamples));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(uv + pair * 2 + 8), _mm_unpackhi_epi16(uSamples, vSamples));
+        }
+        InterleaveChroma16Scalar(u + pair, v + pair, uv + pair * 2, count - pair, shift);
+    }
+
+    // AVX2 versions (which work within 128 bit lanes, so the lanes are put back in order)
+
+    TARGET_AVX2 void DeinterleaveChroma8AVX2(const uint8_t* uv, uint8_t* u, uint8_t* v, size_t count)
+    {
+        const __m256i lowBytes = _mm256_set1_epi16(0x00FF);
+        size_t pair = 0;
+        for (; pair + 32 <= count; pair += 32)
+        {
+            __m256i first   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(uv + pair * 2));
+            __m256i second  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(uv + pair * 2 + 32));
+            __m256i uSamples = _mm256_packus_epi16(_mm256_and_si256(first, lowBytes), _mm256_and_si256(second, lowBytes));
+            __m256i vSamples = _mm256_packus_epi16(_mm256_srli_epi16(first, 8), _mm256_srli_epi16(second, 8));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(u + pair), _mm256_permute4x64_epi64(uSamples, 0xD8));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(v + pair), _mm256_permute4x64_epi64(vSamples, 0xD8));
+        }
+        DeinterleaveChroma8SSE41(uv + pair * 2, u + pair, v + pair, count - pair);
+    }
+
+    TARGET_AVX2 void Shift16AVX2(const uint16_t* source, uint16_t* destination, size_t count, unsigned int shift)
+    {
+        const __m128i shiftCount = _mm_cvtsi32_si128(static_cast<int>(shift));
+        size_t sample = 0;
+        for (; sample + 16 <= count; sample += 16)
+        {
+            __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + sample));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + sample), _mm256_sll_epi16(samples, shiftCount));
+        }
+        Shift16SSE41(source + sample, destination + sample, count - sample, shift);
+    }
+
+    TARGET_AVX2 void InterleaveChroma16AVX2(const uint16_t* u, const uint16_t* v, uint16_t* uv, size_t count,
+        unsigned int shift)
+    {
+        const __m128i shiftCount = _mm_cvtsi32_si128(static_cast<int>(shift));
+        size_t pair = 0;
+        for (; pair + 16 <= count; pair += 16)
+        {
+            __m256i uSamples = _mm256_sll_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(u + pair)), shiftCount);
+            __m256i vSamples = _mm256_sll_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + pair)), shiftCount);
+            __m256i low     = _mm256_unpacklo_epi16(uSamples, vSamples);
+            __m256i high    = _mm256_unpackhi_epi16(uSamples, vSamples);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(uv + pair * 2), _mm256_permute2x128_si256(low, high, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(uv + pair * 2 + 16), _mm256_permute2x128_si256(low, high, 0x31));
+        }
+        InterleaveChroma16SSE41(u + pair, v + pair, uv + pair * 2, count - pair, shift);
+    }
+
+    // The AVX2 versions round as the scalar ones do (adding a half and truncating, rather than
+    // rounding to even), and add in the same order, so their output matches bit for bit
+
+    // Rounds 8 values as LookUp and ToByte do
+    TARGET_AVX2 inline __m256i RoundAVX2(__m256 values)
+    {
+        return _mm256_cvttps_epi32(_mm256_add_ps(values, _mm256_set1_ps(0.5f)));
+    }
+
+    // Looks up 8 values in [0, 1] in a tone map table
+    TARGET_AVX2 inline __m256 LookUpAVX2(const float* table, __m256 values)
+    {
+        values = _mm256_min_ps(_mm256_max_ps(values, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+        __m256i indices = RoundAVX2(_mm256_mul_ps(values, _mm256_set1_ps(ToneMapParameters::TableSize - 1)));
+        return _mm256_i32gather_ps(table, indices, sizeof(float));
+    }
+
+    // Tone maps 8 pixels, adding their R'G'B' to the sums and returning their output luma
+    TARGET_AVX2 inline __m256i ToneMapPixelsAVX2(const ToneMapParameters& parameters, __m256 y, __m256 cb, __m256 cr,
+        __m256 sum[3])
+    {
+        __m256 linear[3] = {
+            LookUpAVX2(parameters.pqToLinear, _mm256_add_ps(y, _mm256_mul_ps(_mm256_set1_ps(CrToR), cr))),
+            LookUpAVX2(parameters.pqToLinear, _mm256_add_ps(_mm256_add_ps(y, _mm256_mul_ps(_mm256_set1_ps(CbToG), cb)),
+                _mm256_mul_ps(_mm256_set1_ps(CrToG), cr))),
+            LookUpAVX2(parameters.pqToLinear, _mm256_add_ps(y, _mm256_mul_ps(_mm256_set1_ps(CbToB), cb)))
+        };
+
+        __m256 rgb[3];
+        for (size_t component = 0; component < 3; component++)
+        {
+            __m256 mapped = _mm256_add_ps(_mm256_add_ps(
+                _mm256_mul_ps(_mm256_set1_ps(GamutMatrix[component][0]), linear[0]),
+                _mm256_mul_ps(_mm256_set1_ps(GamutMatrix[component][1]), linear[1])),
+                _mm256_mul_ps(_mm256_set1_ps(GamutMatrix[component][2]), linear[2]));
+            rgb[component] = LookUpAVX2(parameters.sqrtToGamma, _mm256_sqrt_ps(_mm256_max_ps(mapped, _mm256_setzero_ps())));
+            sum[component] = _mm256_add_ps(sum[component], rgb[component]);
+        }
+
+        __m256 luma = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(KR), rgb[0]),
+            _mm256_mul_ps(_mm256_set1_ps(KG), rgb[1])), _mm256_mul_ps(_mm256_set1_ps(KB), rgb[2]));
+        return RoundAVX2(_mm256_add_ps(_mm256_set1_ps(LumaOutOffset), _mm256_mul_ps(_mm256_set1_ps(LumaOutScale), luma)));
+    }
+
+    // Packs 8 output samples to bytes, storing them
+    TARGET_AVX2 inline void StoreBlocksAVX2(uint8_t* destination, __m256i samples)
+    {
+        __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(samples, samples), _mm256_setzero_si256());
+        uint32_t low = static_cast<uint32_t>(_mm256_cvtsi256_si32(packed));
+        uint32_t high = static_cast<uint32_t>(_mm256_extract_epi32(packed, 4));
+        std::memcpy(destination, &low, sizeof(low));
+        std::memcpy(destination + 4, &high, sizeof(high));
+    }
+
+    // Tone maps 8 blocks at a time, splitting the pixels of each row into even and odd columns
+    TARGET_AVX2 void ToneMapAVX2(const ToneMapParameters& parameters, const ToneMapRows& rows)
+    {
+        const __m128i shift = _mm_cvtsi32_si128(static_cast<int>(parameters.shift));
+        const __m256i lowHalves = _mm256_set1_epi32(0xFFFF);
+        const __m256 lumaOffset = _mm256_set1_ps(parameters.lumaOffset);
+        const __m256 lumaScale = _mm256_set1_ps(parameters.lumaScale);
+        const __m256 chromaOffset = _mm256_set1_ps(parameters.chromaOffset);
+        const __m256 chromaScale = _mm256_set1_ps(parameters.chromaScale);
+
+        size_t block = 0;
+        for (; (block + 8) * 2 <= rows.width; block += 8)
+        {
+            __m256i cbSamples;
+            __m256i crSamples;
+            if (parameters.semiPlanar)
+            {
+                __m256i chroma = _mm256_srl_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows.chroma[0] + block * 2)), shift);
+                cbSamples = _mm256_and_si256(chroma, lowHalves);
+                crSamples = _mm256_srli_epi32(chroma, 16);
+            }
+            else
+            {
+                cbSamples = _mm256_cvtepu16_epi32(_mm_srl_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows.chroma[0] + block)), shift));
+                crSamples = _mm256_cvtepu16_epi32(_mm_srl_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(rows.chroma[1] + block)), shift));
+            }
+            __m256 cb = _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(cbSamples), chromaOffset), chromaScale);
+            __m256 cr = _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(crSamples), chromaOffset), chromaScale);
+
+            __m256 sum[3] = { _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+            for (size_t row = 0; row < 2; row++)
+            {
+                __m256i luma = _mm256_srl_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows.luma[row] + block * 2)), shift);
+                __m256 even = _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_and_si256(luma, lowHalves)), lumaOffset), lumaScale);
+                __m256 odd = _mm256_mul_ps(_mm256_sub_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(luma, 16)), lumaOffset), lumaScale);
+
+                __m256i evenOut = ToneMapPixelsAVX2(parameters, even, cb, cr, sum);
+                __m256i oddOut = ToneMapPixelsAVX2(parameters, odd, cb, cr, sum);
+
+                // Put the columns back in order, then the lanes
+                __m256i words = _mm256_or_si256(evenOut, _mm256_slli_epi32(oddOut, 16));
+                __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), 0x08);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(rows.lumaOut[row] + block * 2), _mm256_castsi256_si128(bytes));
+            }
+
+            const __m256 quarter = _mm256_set1_ps(0.25f);
+            __m256 r = _mm256_mul_ps(sum[0], quarter);
+            __m256 b = _mm256_mul_ps(sum[2], quarter);
+            __m256 luma = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(KR), r),
+                _mm256_mul_ps(_mm256_set1_ps(KG), _mm256_mul_ps(sum[1], quarter))), _mm256_mul_ps(_mm256_set1_ps(KB), b));
+            StoreBlocksAVX2(rows.cbOut + block, RoundAVX2(_mm256_add_ps(_mm256_set1_ps(ChromaOutOffset),
+                _mm256_mul_ps(_mm256_set1_ps(CbOutScale), _mm256_sub_ps(b, luma)))));
+            StoreBlocksAVX2(rows.crOut + block, RoundAVX2(_mm256_add_ps(_mm256_set1_ps(ChromaOutOffset),
+                _mm256_mul_ps(_mm256_set1_ps(CrOutScale), _mm256_sub_ps(r, luma)))));
+        }
+
+        ToneMapBlocks(parameters, rows, block, (rows.width + 1) / 2);
+    }
+
+    // Finds the best instruction set the CPU and OS support
+    InstructionSet DetectInstructionSet()
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int registers[4] = {};
+        __cpuid(registers, 0);
+        int highestLeaf = registers[0];
+
+        __cpuid(registers, 1);
+        bool sse41 = (registers[2] & (1 << 19)) != 0;
+        // AVX state must be saved by the OS as well as supported by the CPU
+        bool avx = (registers[2] & (1 << 27)) != 0 && (registers[2] & (1 << 28)) != 0 &&
+            (_xgetbv(0) & 0x6) == 0x6;
+
+        bool avx2 = false;
+        if (avx && highestLeaf >= 7)
+        {
+            __cpuidex(registers, 7, 0);
+            avx2 = (registers[1] & (1 << 5)) != 0;
+        }
+#else
+        __builtin_cpu_init();
+        bool sse41 = __builtin_cpu_supports("sse4.1");
+        bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        if (avx2)
+        {
+            return InstructionSet::AVX2;
+        }
+        return sse41 ? InstructionSet::SSE41 : InstructionSet::Scalar;
+    }
+#endif
+
+#ifdef PIXEL_KERNELS_NEON
+    // NEON versions (which every 64 bit ARM CPU has)
+
+    void DeinterleaveChroma8NEON(const uint8_t* uv, uint8_t* u, uint8_t* v, size_t count)
+    {
+        size_t pair = 0;
+        for (; pair + 16 <= count; pair += 16)
+        {
+            uint8x16x2_t samples = vld2q_u8(uv + pair * 2);
+            vst1q_u8(u + pair, samples.val[0]);
+            vst1q_u8(v + pair, samples.val[1]);
+        }
+        DeinterleaveChroma8Scalar(uv + pair * 2, u + pair, v + pair, count - pair);
+    }
+
+    void Shift16NEON(const uint16_t* source, uint16_t* destination, size_t count, unsigned int shift)
+    {
+        const int16x8_t shiftCount = vdupq_n_s16(static_cast<int16_t>(shift));
+        size_t sample = 0;
+        for (; sample + 8 <= count; sample += 8)
+        {
+            vst1q_u16(destination + sample, vshlq_u16(vld1q_u16(source + sample), shiftCount));
+        }
+        Shift16Scalar(source + sample, destination + sample, count - sample, shift);
+    }
+
+    void InterleaveChroma16NEON(const uint16_t* u, const uint16_t* v, uint16_t* uv, size_t count, unsigned int shift)
+    {
+        const int16x8_t shiftCount = vdupq_n_s16(static_cast<int16_t>(shift));
+        size_t pair = 0;
+        for (; pair + 8 <= count; pair += 8)
+        {
+            uint16x8x2_t samples;
+            samples.val[0] = vshlq_u16(vld1q_u16(u + pair), shiftCount);
+            samples.val[1] = vshlq_u16(vld1q_u16(v + pair), shiftCount);
+            vst2q_u16(uv + pair * 2, samples);
+        }
+        InterleaveChroma16Scalar(u + pair, v + pair, uv + pair * 2, count - pair, shift);
+    }
+#endif
+
+    // The versions of the kernels for each instruction set this build has them for
+    constexpr KernelTable ScalarTable = { InstructionSet::Scalar, DeinterleaveChroma8Scalar, Shift16Scalar,
+        InterleaveChroma16Scalar, ToneMapScalar };
+#ifdef PIXEL_KERNELS_X86
+    constexpr KernelTable SSE41Table = { InstructionSet::SSE41, DeinterleaveChroma8SSE41, Shift16SSE41,
+        InterleaveChroma16SSE41, ToneMapScalar };
+    constexpr KernelTable AVX2Table = { InstructionSet::AVX2, DeinterleaveChroma8AVX2, Shift16AVX2,
+        InterleaveChroma16AVX2, ToneMapAVX2 };
+#elif defined(PIXEL_KERNELS_NEON)
+    constexpr KernelTable NEONTable = { InstructionSet::NEON, DeinterleaveChroma8NEON, Shift16NEON,
+        InterleaveChroma16NEON, ToneMapScalar };
+#endif
+
+    // Gets the versions of the kernels for an instruction set, or null if this build has none for it
+    const KernelTable* FindTable(InstructionSet instructionSet)
+    {
+        switch (instructionSet)
+        {
+            case InstructionSet::Scalar:
+                return &ScalarTable;
+#ifdef PIXEL_KERNELS_X86
+            case InstructionSet::SSE41:
+                return &SSE41Table;
+            case InstructionSet::AVX2:
+                return &AVX2Table;
+#elif defined(PIXEL_KERNELS_NEON)
+            case InstructionSet::NEON:
+                return &NEONTable;
+#endif
+            default:
+                return nullptr;
+        }
+    }
+
+    // Finds the best instruction set the kernels have versions for, which the CPU supports
+    InstructionSet GetBestInstructionSet()
+    {
+#ifdef PIXEL_KERNELS_X86
+        static const InstructionSet instructionSet = DetectInstructionSet();
+        return instructionSet;
+#elif defined(PIXEL_KERNELS_NEON)
+        return InstructionSet::NEON;
+#else
+        return InstructionSet::Scalar;
+#endif
+    }
+
+    // Versions of the kernels chosen with SetInstructionSet, if any
+    std::atomic<const KernelTable*> g_chosenTable(nullptr);
+
+    const KernelTable& GetTable()
+    {
+        const KernelTable* chosen = g_chosenTable.load(std::memory_order_acquire);
+        if (chosen != nullptr)
+        {
+            return *chosen;
+        }
+
+        static const KernelTable& table = []() -> const KernelTable&
+        {
+            const KernelTable* best = FindTable(GetBestInstructionSet());
+            obs_log(LOG_INFO, "Converting frames with %s kernels", PixelKernels::GetName(best->instructionSet));
+            return *best;
+        }();
+        return table;
+    }
+}
+
+void PixelKernels::DeinterleaveChroma8(const uint8_t* uv, uint8_t* u, uint8_t* v, size_t count)
+{
+    GetTable().deinterleaveChroma8(uv, u, v, count);
+}
+
+void PixelKernels::Shift16(const uint16_t* source, uint16_t* destination, size_t count, unsigned int shift)
+{
+    GetTable().shift16(source, destination, count, shift);
+}
+
+void PixelKernels::InterleaveChroma16(const uint16_t* u, const uint16_t* v, uint16_t* uv, size_t count,
+    unsigned int shift)
+{
+    GetTable().interleaveChroma16(u, v, uv, count, shift);
+}
+
+void PixelKernels::ToneMap(const ToneMapParameters& parameters, const ToneMapRows& rows)
+{
+    GetTable().toneMap(parameters, rows);
+}
+
+InstructionSet PixelKernels::GetInstructionSet()
+{
+    return GetTable().instructionSet;
+}
+
+bool PixelKernels::IsSupported(InstructionSet instructionSet)
+{
+    // The CPU runs the versions of every instruction set up to the best one it supports
+    return FindTable(instructionSet) != nullptr &&
+        static_cast<uint8_t>(instructionSet) <= static_cast<uint8_t>(GetBestInstructionSet());
+}
+
+void PixelKernels::SetInstructionSet(InstructionSet instructionSet)
+{
+    if (!IsSupported(instructionSet))
+    {
+        throw std::invalid_argument("Instruction set isn't supported");
+    }
+
+    g_chosenTable.store(FindTable(instructionSet), std::memory_order_release);
+}
+
+const char* PixelKernels::GetName(InstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+        case InstructionSet::SSE41:
+            return "SSE4.1";
+        case InstructionSet::AVX2:
+            return "AVX2";
+        case InstructionSet::NEON:
+            return "NEON";
+        default:
+            return "scalar";
+    }
+}
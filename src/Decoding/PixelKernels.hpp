@@ -0,0 +1,156 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief The instruction sets the pixel kernels have versions for.
+     *
+     */
+    enum class InstructionSet : uint8_t
+    {
+        Scalar = 0, // Plain C++
+        SSE41,      // x86 SSE4.1
+        AVX2,       // x86 AVX2
+        NEON        // ARM NEON
+    };
+
+    /**
+     * @brief How 10 bit BT.2020 PQ samples are tone mapped to 8 bit BT.709 SDR ones.
+     *
+     */
+    struct ToneMapParameters
+    {
+        /**
+         * @brief The number of entries in each table.
+         *
+         */
+        static constexpr size_t TableSize = 4096;
+
+        const float* pqToLinear     = nullptr;  // PQ coded BT.2020 components to tone mapped linear ones (1 is SDR peak)
+        const float* sqrtToGamma    = nullptr;  // Square roots of linear BT.709 components to sRGB coded ones
+        float lumaOffset            = 64.0f;    // Luma sample of black
+        float lumaScale             = 0.0f;     // Scale from luma samples to [0, 1]
+        float chromaOffset          = 512.0f;   // Chroma sample of grey
+        float chromaScale           = 0.0f;     // Scale from chroma samples to [-0.5, 0.5]
+        unsigned int shift          = 0;        // Bits the samples are shifted left by (6 for P010)
+        bool semiPlanar             = false;    // Are the chroma samples interleaved?
+    };
+
+    /**
+     * @brief A pair of rows of a 4:2:0 picture to tone map, and the rows of the I420 picture they're mapped to.
+     *
+     */
+    struct ToneMapRows
+    {
+        const uint16_t* luma[2]     = {};       // Luma rows (the same row twice for the last row of an odd height)
+        const uint16_t* chroma[2]   = {};       // Cb and Cr rows, or the interleaved row in chroma[0]
+        uint8_t* lumaOut[2]         = {};       // Receive the luma rows
+        uint8_t* cbOut              = nullptr;  // Receives the Cb row
+        uint8_t* crOut              = nullptr;  // Receives the Cr row
+        size_t width                = 0;        // Width of the luma rows
+    };
+
+    /**
+     * @brief Static helper class with the row kernels of the few conversions OBS can't do on the GPU.
+     *
+     * Each kernel has a scalar version, which also finishes the ends of rows the vector versions
+     * leave, and versions for SSE4.1, AVX2 and NEON. The fastest version the CPU supports is chosen
+     * the first time a kernel is called. Rows don't need any alignment.
+     *
+     */
+    class PixelKernels
+    {
+    public:
+        /**
+         * @brief Splits a row of interleaved 8 bit chroma pairs into U and V rows.
+         *
+         * @param uv The interleaved row, of 2 * count samples.
+         * @param u Receives the U samples.
+         * @param v Receives the V samples.
+         * @param count The number of pairs.
+         */
+        static void DeinterleaveChroma8(const uint8_t* uv, uint8_t* u, uint8_t* v, size_t count);
+
+        /**
+         * @brief Shifts a row of 16 bit samples left, such as to MSB align 10 bit samples.
+         *
+         * @param source The samples.
+         * @param destination Receives the shifted samples.
+         * @param count The number of samples.
+         * @param shift The bits to shift each sample left by.
+         */
+        static void Shift16(const uint16_t* source, uint16_t* destination, size_t count, unsigned int shift);
+
+        /**
+         * @brief Interleaves rows of 16 bit U and V samples into chroma pairs, shifting them left.
+         *
+         * @param u The U samples.
+         * @param v The V samples.
+         * @param uv Receives the interleaved row, of 2 * count samples.
+         * @param count The number of pairs.
+         * @param shift The bits to shift each sample left by.
+         */
+        static void InterleaveChroma16(const uint16_t* u, const uint16_t* v, uint16_t* uv, size_t count,
+            unsigned int shift);
+
+        /**
+         * @brief Tone maps a pair of rows of a 10 bit BT.2020 PQ picture to BT.709 SDR I420.
+         *
+         * Each pixel is converted to R'G'B', tone mapped per component through a table, converted
+         * to BT.709 primaries, and gamma coded through a second table. The chroma of each 2x2 block
+         * is taken from the average of its gamma coded pixels.
+         * @note The vector version needs the gathers of AVX2, so other CPUs use the scalar version.
+         *
+         * @param parameters The tables and sample scaling.
+         * @param rows The rows to tone map.
+         */
+        static void ToneMap(const ToneMapParameters& parameters, const ToneMapRows& rows);
+
+        /**
+         * @brief Gets the instruction set the kernels run with.
+         *
+         * @return InstructionSet The instruction set.
+         */
+        static InstructionSet GetInstructionSet();
+
+        /**
+         * @brief Checks if the kernels have versions for an instruction set which the CPU runs.
+         *
+         * @param instructionSet The instruction set.
+         * @return true If the kernels are able to run with the instruction set.
+         * @return false If the kernels have no versions for it, or the CPU doesn't support it.
+         */
+        static bool IsSupported(InstructionSet instructionSet);
+
+        /**
+         * @brief Makes the kernels run with an instruction set, rather than the best one the CPU supports.
+         * @note Used to compare and benchmark the versions of the kernels; shouldn't be called
+         *       while the kernels are running.
+         *
+         * @param instructionSet The instruction set.
+         * @exception std::invalid_argument If the instruction set isn't supported.
+         */
+        static void SetInstructionSet(InstructionSet instructionSet);
+
+        /**
+         * @brief Gets the name of an instruction set, for logging.
+         *
+         * @param instructionSet The instruction set.
+         * @return const char* The name.
+         */
+        static const char* GetName(InstructionSet instructionSet);
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        PixelKernels()                                  = delete;
+        PixelKernels(const PixelKernels&)               = delete;
+        PixelKernels& operator=(const PixelKernels&)    = delete;
+        ~PixelKernels()                                 = delete;
+    };
+} // namespace MoonlightOBS
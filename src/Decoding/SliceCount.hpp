@@ -0,0 +1,52 @@
+#pragma once
+
+// STL includes
+#include <algorithm>
+#include <cstdint>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Static helper class which chooses how many slices the host is asked to split each frame into,
+     *        so the slice threads of the decoder can decode a frame in parallel.
+     *
+     */
+    class SliceCount
+    {
+    public:
+        /**
+         * @brief The most threads to decode the slices of a frame with (encoders rarely split frames into more slices).
+         *
+         */
+        static constexpr unsigned int MaxThreads = 16;
+
+        /**
+         * @brief The fewest rows worth a slice of their own, as each slice costs the encoder some efficiency
+         *        (so 1080p is split into at most 4 slices, and 4K into 8).
+         *
+         */
+        static constexpr uint32_t MinimumRows = 270;
+
+        /**
+         * @brief Gets the number of slices to ask the host to split each frame into.
+         *
+         * @param height The height of the stream.
+         * @param threads The number of threads decoding the slices.
+         * @return unsigned int A slice per thread, but no more than the resolution is worth, and at least one.
+         */
+        static constexpr unsigned int Get(uint32_t height, unsigned int threads)
+        {
+            unsigned int byResolution = std::max(height / MinimumRows, 1u);
+            return std::clamp(std::min(threads, byResolution), 1u, MaxThreads);
+        }
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        SliceCount()                                = delete;
+        SliceCount(const SliceCount&)               = delete;
+        SliceCount& operator=(const SliceCount&)    = delete;
+        ~SliceCount()                               = delete;
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,177 @@
+#include "ToneMapper.hpp"
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// OBS Studio includes
+#include <obs.h>
+
+// Project includes
+#include "../Utilities/WorkerPool.hpp"
+#include "FrameFormat.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Fewest pairs of rows worth tone mapping on another thread
+    constexpr size_t MinimumRowPairs = 8;
+
+    // Constants of the SMPTE ST 2084 (PQ) transfer function
+    constexpr double PQ_M1 = 2610.0 / 16384.0;
+    constexpr double PQ_M2 = 2523.0 / 4096.0 * 128.0;
+    constexpr double PQ_C1 = 3424.0 / 4096.0;
+    constexpr double PQ_C2 = 2413.0 / 4096.0 * 32.0;
+    constexpr double PQ_C3 = 2392.0 / 4096.0 * 32.0;
+    // Luminance in nits of a PQ signal of 1
+    constexpr double PQPeakLuminance = 10000.0;
+
+    // PQ codes a luminance in nits
+    double EncodePQ(double luminance)
+    {
+        double power = std::pow(std::max(luminance, 0.0) / PQPeakLuminance, PQ_M1);
+        return std::pow((PQ_C1 + PQ_C2 * power) / (1.0 + PQ_C3 * power), PQ_M2);
+    }
+
+    // Decodes a PQ signal to a luminance in nits
+    double DecodePQ(double signal)
+    {
+        double power = std::pow(std::max(signal, 0.0), 1.0 / PQ_M2);
+        return PQPeakLuminance * std::pow(std::max(power - PQ_C1, 0.0) / (PQ_C2 - PQ_C3 * power), 1.0 / PQ_M1);
+    }
+
+    // sRGB codes a linear component
+    double EncodeSRGB(double linear)
+    {
+        return linear <= 0.0031308 ? 12.92 * linear : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+    }
+
+    // Aligns a linesize for OBS's uploads
+    size_t AlignLinesize(size_t linesize)
+    {
+        return (linesize + FramePool::Alignment - 1) & ~(FramePool::Alignment - 1);
+    }
+}
+
+ToneMapper::ToneMapper()
+    : m_peakLuminance(DefaultPeakLuminance), m_pqToLinear(ToneMapParameters::TableSize),
+      m_sqrtToGamma(ToneMapParameters::TableSize)
+{
+    // The table is indexed by square roots, which spends its entries on the shadows like gamma coding does
+    for (size_t entry = 0; entry < ToneMapParameters::TableSize; entry++)
+    {
+        double root = static_cast<double>(entry) / (ToneMapParameters::TableSize - 1);
+        m_sqrtToGamma[entry] = static_cast<float>(EncodeSRGB(root * root));
+    }
+
+    BuildPQTable();
+}
+
+bool ToneMapper::CanMap(const obs_source_frame& frame)
+{
+    return frame.trc == VIDEO_TRC_PQ && (frame.format == VIDEO_FORMAT_I010 || frame.format == VIDEO_FORMAT_P010);
+}
+
+void ToneMapper::SetPeakLuminance(uint16_t peakLuminance)
+{
+    if (peakLuminance == 0)
+    {
+        peakLuminance = DefaultPeakLuminance;
+    }
+
+    if (peakLuminance != m_peakLuminance)
+    {
+        m_peakLuminance = peakLuminance;
+        BuildPQTable();
+    }
+}
+
+void ToneMapper::BuildPQTable()
+{
+    // BT.2390 EETF, from [0, source peak] to [0, SDR peak] in the PQ domain
+    const double sourcePeak = EncodePQ(m_peakLuminance);
+    const double maxLuminance = std::min(EncodePQ(SDRPeakLuminance) / sourcePeak, 1.0);
+    const double kneeStart = 1.5 * maxLuminance - 0.5;
+
+    for (size_t entry = 0; entry < ToneMapParameters::TableSize; entry++)
+    {
+        double signal = std::min(static_cast<double>(entry) / (ToneMapParameters::TableSize - 1) / sourcePeak, 1.0);
+        if (signal > kneeStart && kneeStart < 1.0)
+        {
+            // Hermite spline from the knee to the SDR peak
+            double t = (signal - kneeStart) / (1.0 - kneeStart);
+            double t2 = t * t;
+            double t3 = t2 * t;
+            signal = (2.0 * t3 - 3.0 * t2 + 1.0) * kneeStart + (t3 - 2.0 * t2 + t) * (1.0 - kneeStart) +
+                (-2.0 * t3 + 3.0 * t2) * maxLuminance;
+        }
+
+        double luminance = DecodePQ(signal * sourcePeak);
+        m_pqToLinear[entry] = static_cast<float>(std::min(luminance / SDRPeakLuminance, 1.0));
+    }
+}
+
+FrameBuffer* ToneMapper::Map(const obs_source_frame& source, obs_source_frame& destination, FramePool& framePool) const
+{
+    const size_t width = source.width;
+    const size_t height = source.height;
+    const size_t chromaWidth = (width + 1) / 2;
+    const size_t chromaHeight = (height + 1) / 2;
+    const size_t lumaLinesize = AlignLinesize(width);
+    const size_t chromaLinesize = AlignLinesize(chromaWidth);
+
+    FrameBuffer* buffer = framePool.Acquire(lumaLinesize * height + chromaLinesize * chromaHeight * 2);
+
+    ToneMapParameters parameters;
+    parameters.pqToLinear   = m_pqToLinear.data();
+    parameters.sqrtToGamma  = m_sqrtToGamma.data();
+    parameters.semiPlanar   = source.format == VIDEO_FORMAT_P010;
+    parameters.shift        = parameters.semiPlanar ? 6 : 0;
+    parameters.lumaOffset   = source.full_range ? 0.0f : 64.0f;
+    parameters.lumaScale    = source.full_range ? 1.0f / 1023.0f : 1.0f / 876.0f;
+    parameters.chromaOffset = 512.0f;
+    parameters.chromaScale  = source.full_range ? 1.0f / 1023.0f : 1.0f / 896.0f;
+
+    destination = {};
+    destination.data[0]     = buffer->data;
+    destination.data[1]     = buffer->data + lumaLinesize * height;
+    destination.data[2]     = destination.data[1] + chromaLinesize * chromaHeight;
+    destination.linesize[0] = static_cast<uint32_t>(lumaLinesize);
+    destination.linesize[1] = static_cast<uint32_t>(chromaLinesize);
+    destination.linesize[2] = static_cast<uint32_t>(chromaLinesize);
+    destination.width       = source.width;
+    destination.height      = source.height;
+    destination.timestamp   = source.timestamp;
+
+    WorkerPool::ParallelFor(chromaHeight, MinimumRowPairs, [&](size_t begin, size_t end)
+    {
+        for (size_t pair = begin; pair < end; pair++)
+        {
+            size_t top = pair * 2;
+            size_t bottom = std::min(top + 1, height - 1);
+
+            ToneMapRows rows;
+            rows.luma[0]    = reinterpret_cast<const uint16_t*>(source.data[0] + top * source.linesize[0]);
+            rows.luma[1]    = reinterpret_cast<const uint16_t*>(source.data[0] + bottom * source.linesize[0]);
+            rows.chroma[0]  = reinterpret_cast<const uint16_t*>(source.data[1] + pair * source.linesize[1]);
+            rows.chroma[1]  = parameters.semiPlanar ? nullptr :
+                reinterpret_cast<const uint16_t*>(source.data[2] + pair * source.linesize[2]);
+            rows.lumaOut[0] = destination.data[0] + top * lumaLinesize;
+            rows.lumaOut[1] = destination.data[0] + bottom * lumaLinesize;
+            rows.cbOut      = destination.data[1] + pair * chromaLinesize;
+            rows.crOut      = destination.data[2] + pair * chromaLinesize;
+            rows.width      = width;
+            PixelKernels::ToneMap(parameters, rows);
+        }
+    });
+
+    PictureFormat sdr;
+    sdr.subsampling = ChromaSubsampling::Yuv420;
+    sdr.colorimetry = Colorimetry::BT709;
+    FrameFormat::Describe(sdr, destination);
+
+    return buffer;
+}
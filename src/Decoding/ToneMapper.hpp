@@ -0,0 +1,104 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <vector>
+
+// OBS Studio includes
+#include <obs.h>
+
+// Project includes
+#include "FramePool.hpp"
+#include "PixelKernels.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Tone maps 10 bit HDR10 frames to 8 bit BT.709 SDR frames on the CPU, for SDR canvases.
+     *
+     * The BT.2390 EETF compresses the highlights from the peak luminance of the stream to the SDR
+     * peak in the PQ domain, per component. It's folded with the PQ EOTF into a table, which is
+     * rebuilt when the peak changes, and the sRGB OETF is a second table. The rows are mapped in
+     * pairs on the shared worker threads with PixelKernels::ToneMap, into a buffer from the frame pool.
+     *
+     */
+    class ToneMapper
+    {
+    public:
+        /**
+         * @brief The peak luminance in nits assumed when the host doesn't send it.
+         *
+         */
+        static constexpr uint16_t DefaultPeakLuminance = 1000;
+
+        /**
+         * @brief The luminance in nits SDR white is mapped from (BT.2408 reference white).
+         *
+         */
+        static constexpr float SDRPeakLuminance = 203.0f;
+
+        /**
+         * @brief Construct a new ToneMapper object, for the default peak luminance.
+         *
+         */
+        ToneMapper();
+
+        /**
+         * @brief Can a frame be tone mapped?
+         *
+         * @param frame The frame.
+         * @return true If the frame is PQ coded I010 or P010.
+         * @return false Otherwise.
+         */
+        static bool CanMap(const obs_source_frame& frame);
+
+        /**
+         * @brief Sets the peak luminance of the stream, rebuilding the tone map if it changed.
+         *
+         * @param peakLuminance The peak luminance in nits, or 0 for the default.
+         */
+        void SetPeakLuminance(uint16_t peakLuminance);
+
+        /**
+         * @brief Tone maps a frame.
+         * @exception std::bad_alloc If the buffer couldn't be allocated.
+         *
+         * @param source The frame, which CanMap accepts.
+         * @param destination Receives the SDR I420 frame.
+         * @param framePool The pool to take the buffer of the SDR planes from.
+         * @return FrameBuffer* The buffer of the SDR planes, to release once the frame is output.
+         */
+        FrameBuffer* Map(const obs_source_frame& source, obs_source_frame& destination, FramePool& framePool) const;
+
+        /**
+         * @brief Get the table of PQ coded components to tone mapped linear ones, where 1 is SDR white.
+         *
+         * @return const std::vector<float>& The table, indexed by the PQ signal times TableSize - 1.
+         */
+        inline const std::vector<float>& GetPQTable() const
+        {
+            return m_pqToLinear;
+        }
+
+        /**
+         * @brief Get the table of square roots of linear components to sRGB coded ones.
+         *
+         * @return const std::vector<float>& The table, indexed by the square root times TableSize - 1.
+         */
+        inline const std::vector<float>& GetGammaTable() const
+        {
+            return m_sqrtToGamma;
+        }
+
+    private:
+        // Peak luminance the tone map was built for
+        uint16_t m_peakLuminance;
+        // PQ coded components to tone mapped linear ones
+        std::vector<float> m_pqToLinear;
+        // Square roots of linear components to sRGB coded ones
+        std::vector<float> m_sqrtToGamma;
+
+        // Builds the PQ table for the peak luminance
+        void BuildPQTable();
+    };
+} // namespace MoonlightOBS
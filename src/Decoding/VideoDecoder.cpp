@@ -0,0 +1,50 @@
+#include "VideoDecoder.hpp"
+
+// STL includes
+#include <new>
+
+// OBS Studio includes
+#include <obs.h>
+#include <util/base.h>
+
+// Project includes
+#include "../plugin-support.h"
+#include "FrameConverter.hpp"
+
+using namespace MoonlightOBS;
+
+bool VideoDecoder::Output(const PictureFormat& picture, obs_source_frame& frame)
+{
+    if (FrameFormat::Describe(picture, frame))
+    {
+        m_output(frame);
+        return true;
+    }
+
+    PictureFormat converted;
+    if (!FrameConverter::GetConvertedFormat(picture, converted))
+    {
+        return false;
+    }
+
+    FrameBuffer* buffer = nullptr;
+    try
+    {
+        buffer = FrameConverter::Convert(picture, frame, m_framePool);
+    }
+    catch (const std::bad_alloc&)
+    {
+        obs_log(LOG_WARNING, "Failed to allocate the buffer of a converted frame");
+        return true;
+    }
+
+    // OBS copies the frame, so the buffer can be reused as soon as it's output
+    bool described = FrameFormat::Describe(converted, frame);
+    if (described)
+    {
+        m_output(frame);
+    }
+    buffer->pool->Release(buffer);
+
+    return described;
+}
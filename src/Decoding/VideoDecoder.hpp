@@ -0,0 +1,103 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+// OBS Studio includes
+#include <obs.h>
+
+// Project includes
+#include "../Streaming/StreamConfig.hpp"
+#include "BitstreamPool.hpp"
+#include "FrameFormat.hpp"
+#include "FramePool.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief The negotiated format of a video stream, and how to decode it.
+     *
+     */
+    struct DecoderSettings
+    {
+        int videoFormat                 = 0;                        // VIDEO_FORMAT_* value negotiated with the host
+        uint32_t width                  = 0;                        // Width of the stream
+        uint32_t height                 = 0;                        // Height of the stream
+        uint32_t fps                    = 0;                        // Frame rate of the stream
+        DecodeThreading threading       = DecodeThreading::Slice;   // How decoding is threaded
+        unsigned int threadCount        = 1;                        // Threads to decode with
+    };
+
+    /**
+     * @brief A decoder backend, which decodes the bitstream of each frame and outputs the pictures as OBS frames.
+     *
+     */
+    class VideoDecoder
+    {
+    public:
+        /**
+         * @brief Receives each decoded picture.
+         * @note The planes of the frame are only valid during the call.
+         *
+         */
+        using FrameCallback = std::function<void(const obs_source_frame& frame)>;
+
+        virtual ~VideoDecoder() = default;
+
+        VideoDecoder(const VideoDecoder&)               = delete;
+        VideoDecoder& operator=(const VideoDecoder&)    = delete;
+
+        /**
+         * @brief Decodes the bitstream of a frame, outputting any pictures it completes.
+         *
+         * @param bitstream The bitstream, followed by GetInputPadding() bytes of zeros, which the
+         *                  decoder holds (without copying it) until it's done with it.
+         * @param timestamp The presentation time of the frame in nanoseconds.
+         * @return true If the bitstream was decoded.
+         * @return false If the bitstream couldn't be decoded, and decoding should restart from an IDR frame.
+         */
+        virtual bool Decode(BitstreamPool::Pointer bitstream, uint64_t timestamp) = 0;
+
+        /**
+         * @brief Gets the number of zero bytes the decoder may read past the end of a bitstream.
+         *
+         * @return size_t The padding in bytes.
+         */
+        virtual size_t GetInputPadding() const = 0;
+
+        /**
+         * @brief Gets the name of the decoder, for logging.
+         *
+         * @return const char* The name.
+         */
+        virtual const char* GetName() const = 0;
+
+    protected:
+        /**
+         * @brief Construct a new VideoDecoder object.
+         *
+         * @param output Receives each decoded picture.
+         * @param framePool Buffers the decoder writes its pictures into.
+         */
+        VideoDecoder(FrameCallback output, FramePool& framePool)
+            : m_output(std::move(output)), m_framePool(framePool) {}
+
+        /**
+         * @brief Outputs a decoded picture, converting it first if OBS can't read its layout.
+         *
+         * @param picture The layout and colour of the picture.
+         * @param frame The frame, whose planes, linesizes, dimensions and timestamp are set.
+         * @return true If the picture was output, or dropped because its conversion failed.
+         * @return false If the layout is unsupported.
+         */
+        bool Output(const PictureFormat& picture, obs_source_frame& frame);
+
+        // Receives each decoded picture
+        FrameCallback m_output;
+        // Buffers the decoder writes its pictures into
+        FramePool& m_framePool;
+    };
+} // namespace MoonlightOBS
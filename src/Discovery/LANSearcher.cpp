@@ -5,10 +5,12 @@
 #include <atomic>
 #include <functional>
 #include <map>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 
 // OBS Studio includes
@@ -43,6 +45,7 @@
 #include "../Connections/GameStreamHost.hpp"
 #include "mDNSRecordExtractor.hpp"
 #include "../Connections/HTTPClient.hpp"
+#include "../Connections/HostRegistry.hpp"
 #include "../Connections/HostSettings.hpp"
 
 using namespace MoonlightOBS;
@@ -50,7 +53,7 @@ using namespace MoonlightOBS;
 std::thread LANSearcher::m_searchThread;
 std::atomic_bool LANSearcher::m_searching{false};
 
-void LANSearcher::Start(std::function<void(const GameStreamHost&)> callback)
+void LANSearcher::Start(std::function<void(HostID)> callback)
 {
     // Ensure callback is not null
     if (callback == nullptr)
@@ -99,12 +102,19 @@ void LANSearcher::Start(std::function<void(const GameStreamHost&)> callback)
     m_searchThread.detach();
 }
 
-void LANSearcher::SearchThread(std::function<void(const GameStreamHost&)> callback, int ipv4Socket, int ipv6Socket)
+void LANSearcher::SearchThread(std::function<void(HostID)> callback, int ipv4Socket, int ipv6Socket)
 {
     // Hosts that have been found and have been 
-    // notified to the callback function
-    // (Service name / GameStreamHost)
-    std::map<std::string, GameStreamHost> foundHosts;
+    // notified to the callback function during this search
+    std::unordered_set<HostID> notifiedHosts;
+
+    // Checks if the host advertising a service has already been notified during this search
+    // (hosts found by a previous search are resolved again, as their addresses may have changed)
+    auto isNotified = [&notifiedHosts](const std::string& service)
+    {
+        HostID id = HostRegistry::FindByName(service);
+        return id != InvalidHostID && notifiedHosts.find(id) != notifiedHosts.end();
+    };
 
     // Loop until the search is stopped
     do
@@ -136,8 +146,8 @@ void LANSearcher::SearchThread(std::function<void(const GameStreamHost&)> callba
                 // if the host is not already in the found hosts map
                 for (const auto& service : discoveredServices)
                 {
-                    // Check if the host is already in the found hosts map
-                    if (foundHosts.find(service) != foundHosts.end())
+                    // Check if the host has already been found
+                    if (isNotified(service))
                     {
                         // Host already exists, skip it
                         continue;
@@ -168,9 +178,8 @@ void LANSearcher::SearchThread(std::function<void(const GameStreamHost&)> callba
                 // if the host is not already in the found hosts map
                 for (const auto& service : discoveredServices)
                 {
-                    // Check if the host is already in the found hosts map
-                    if (foundHosts.find(service) != foundHosts.end() || 
-                        discoveredHosts.find(service) != discoveredHosts.end()) 
+                    // Check if the host has already been found
+                    if (isNotified(service) || discoveredHosts.find(service) != discoveredHosts.end()) 
                     {
                         // Host is already discovered and resolved or 
                         // discovered by the ipv4 query, skip it
@@ -399,27 +408,28 @@ void LANSearcher::SearchThread(std::function<void(const GameStreamHost&)> callba
             }
 
             // Set the unknown addresses to empty if they were not resolved
-            if (host.GetIPv4Address().GetAddress().empty())
+            if (host.GetIPv4Address().IsEmpty())
             {
                 host.SetIPv4Address(Address::GetEmpty());
             }
-            if (host.GetIPv6Address().GetAddress().empty())
+            if (host.GetIPv6Address().IsEmpty())
             {
                 host.SetIPv6Address(Address::GetEmpty());
             }
             
-            // Attempt to resolve the hostname of the host using the /serverInfo endpoint
+            // Attempt to resolve the settings of the host using the /serverInfo endpoint
+            std::optional<HostSettings> settings;
             try
             {
-                // Resolve the hostname of the host using the 
+                // Resolve the settings of the host using the 
                 // /serverinfo endpoint of the host
-                std::string hostname = ResolveHostname(host.GetIPv4Address().IsValid() ? 
+                settings = ResolveSettings(host.GetIPv4Address().IsValid() ? 
                     host.GetIPv4Address() : host.GetIPv6Address());
 
-                if (!hostname.empty())
+                if (!settings->GetHostname().empty())
                 {
                     // Set the hostname of the host to the resolved hostname
-                    host.SetHostname(hostname);
+                    host.SetHostname(settings->GetHostname());
                 }
                 else
                 {
@@ -449,14 +459,41 @@ void LANSearcher::SearchThread(std::function<void(const GameStreamHost&)> callba
                 continue;
             }
 
-            // Add the host to the found hosts map
-            foundHosts.try_emplace(serviceName, host);
+            // Register the host, merging it with any other record of the same machine
+            // (e.g. found over the other socket, entered manually or renamed)
+            HostID hostID = InvalidHostID;
+            HostSettingsChanges changes;
+            try
+            {
+                hostID = HostRegistry::Register(host, *settings, &changes);
+                HostRegistry::AddName(hostID, serviceName);
+            }
+            catch (const std::exception& exception)
+            {
+                obs_log(LOG_WARNING, "Failed to register host: %s (%s)", host.GetHostname().c_str(), exception.what());
+
+                // Skip this host
+                continue;
+            }
+
+            // Log what changed since the host was last found (every field changes for a new host)
+            if (changes.any() && !changes.all())
+            {
+                obs_log(LOG_INFO, "Settings of GameStream host %s changed: %s", host.GetHostname().c_str(),
+                    HostSettingsSnapshot::FormatChanges(changes).c_str());
+            }
+
+            // Skip the host if it has already been notified under another service name
+            if (!notifiedHosts.insert(hostID).second)
+            {
+                continue;
+            }
 
             // Log the resolved host with its service name and addresses
             LogHost(LOG_INFO, "Found GameStream host", host, serviceName);
             
             // Alert callback function with the found host
-            callback(host);
+            callback(hostID);
         }
     } while (m_searching.load(std::memory_order_acquire));
 
@@ -564,16 +601,14 @@ SRVRecord LANSearcher::ResolvemDNSHostname(const std::string_view& serviceName,
     return srvRecords.front();
 }
 
-std::string LANSearcher::ResolveHostname(const Address& address)
+HostSettings LANSearcher::ResolveSettings(const Address& address)
 {
     // Create the HTTP client
     HTTPClient httpClient(address);
 
     // Get the server info from the GameStream host
     // This may thrown an exception, but it will be caught by the caller
-    HostSettings serverInfo = httpClient.GetServerInfo();
-
-    return serverInfo.GetHostname();
+    return httpClient.GetServerInfo();
 }
 
 Address LANSearcher::ResolveIPAddress(const GameStreamHost& host, int socket, bool useIPv6)
@@ -670,7 +705,8 @@ void LANSearcher::LogHost(int level, const std::string_view& message, GameStream
     logStream << ")";
             
     // Send the log message to OBS
-    obs_log(level, logStream.str().c_str());
+    // (host names come from the network, so they must not be used as the format string)
+    obs_log(level, "%s", logStream.str().c_str());
 }
 
 void LANSearcher::Stop()
@@ -9,11 +9,15 @@
 #include <thread>
 #include <vector>
 
+// Project includes
+#include "../Connections/HostRegistry.hpp"
+
 namespace MoonlightOBS
 {
     // Forward declarations
     class Address;
     class GameStreamHost;
+    class HostSettings;
     class SRVRecord;
 
     /**
@@ -27,8 +31,9 @@ namespace MoonlightOBS
          * @brief Starts searching for GameStream hosts on the local network.
          * 
          * @param callback The callback function to be called when a host 
-         *                 is found, with the host as the parameter to the 
-         *                 callback function.
+         *                 is found, with the ID of the host in the HostRegistry
+         *                 as the parameter to the callback function.
+         *                 (Each host is notified at most once per search)
          * 
          * @exception std::logic_error If the search is already running.
          *                             -or-
@@ -36,7 +41,7 @@ namespace MoonlightOBS
          * 
          * @exception std::runtime_error If the search fails to start.      
          */
-        static void Start(std::function <void(const GameStreamHost&)> callback);
+        static void Start(std::function<void(HostID)> callback);
 
         /**
          * @brief Stops searching for GameStream hosts on the local network.
@@ -72,16 +77,16 @@ namespace MoonlightOBS
         static std::atomic_bool m_searching;
 
         // Function invoked by the search thread
-        static void SearchThread(std::function<void(const GameStreamHost&)> callback, 
+        static void SearchThread(std::function<void(HostID)> callback, 
             int ipv4Socket, int ipv6Socket);
         
         // Function used discover the instance names of the available GameStream hosts
         static std::vector<std::string> DiscoverInstanceNames(int socket);
         // Function used to discover the mDNS hostname and port of a discovered GameStream host
         static SRVRecord ResolvemDNSHostname(const std::string_view& serviceName, int socket);
-        // Function used to resolve the hostname of the GameStream host 
-        // using the /serverinfo endpoint of the host
-        static std::string ResolveHostname(const Address& address);
+        // Function used to resolve the settings (including the hostname and unique ID)
+        // of the GameStream host using the /serverinfo endpoint of the host
+        static HostSettings ResolveSettings(const Address& address);
         // Function used to resolve the IP address of a discovered GameStream host
         static Address ResolveIPAddress(const GameStreamHost& host, int socket, bool useIPv6);
 
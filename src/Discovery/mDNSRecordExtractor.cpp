@@ -10,7 +10,11 @@
 // mdns includes
 #include <mdns.h>
 
+// OBS Studio includes
+#include <util/base.h>
+
 // Project includes
+#include "../plugin-support.h"
 #include "../Connections/Address.hpp"
 
 using namespace MoonlightOBS;
@@ -41,6 +45,65 @@ mDNSRecordExtractor mDNSRecordExtractor::Extract(int socket, int queryID_filter,
     return extractor;
 }
 
+mDNSRecordExtractor mDNSRecordExtractor::Parse(const void* packet, size_t size, int queryID_filter,
+    std::string service_filter, int entryType_filterMask)
+{
+    // Create an instance of mDNSRecordExtractor to handle the records
+    mDNSRecordExtractor extractor(service_filter, entryType_filterMask);
+
+    // The header is the query ID, the flags, and the number of questions, answers,
+    // authority and additional records, each as a big endian 16 bit integer
+    constexpr size_t HeaderSize = 12;
+    if (packet == nullptr || size < HeaderSize)
+    {
+        return extractor;
+    }
+
+    const uint8_t* bytes = static_cast<const uint8_t*>(packet);
+    auto readUInt16 = [bytes](size_t offset)
+    {
+        return static_cast<uint16_t>((bytes[offset] << 8) | bytes[offset + 1]);
+    };
+
+    uint16_t queryID = readUInt16(0);
+    if (queryID_filter > 0 && queryID != queryID_filter)
+    {
+        // Not a response to the query
+        return extractor;
+    }
+
+    // Skip the questions, along with their record type and class
+    size_t offset = HeaderSize;
+    uint16_t questions = readUInt16(4);
+    for (uint16_t question = 0; question < questions; question++)
+    {
+        if (!mdns_string_skip(packet, size, &offset) || size - offset < 4)
+        {
+            return extractor;
+        }
+        offset += 4;
+    }
+
+    // Parse each section of records, stopping at the first which is truncated (as mdns_query_recv does)
+    constexpr std::array<mdns_entry_type_t, 3> Sections =
+    {
+        MDNS_ENTRYTYPE_ANSWER, MDNS_ENTRYTYPE_AUTHORITY, MDNS_ENTRYTYPE_ADDITIONAL
+    };
+    for (size_t section = 0; section < Sections.size(); section++)
+    {
+        uint16_t records = readUInt16(6 + section * 2);
+        size_t parsed = mdns_records_parse(-1, nullptr, 0, packet, size, &offset, Sections[section], queryID,
+            records, &mDNSRecordExtractor::OnCallback, &extractor);
+        extractor.m_responsesHandled += parsed;
+        if (parsed != records)
+        {
+            break;
+        }
+    }
+
+    return extractor;
+}
+
 int mDNSRecordExtractor::OnCallback(int sock, const struct sockaddr* from, size_t addrlen,
                                     mdns_entry_type_t entry, uint16_t query_id, uint16_t rtype,
                                     uint16_t rclass, uint32_t ttl, const void* data, size_t size,
@@ -52,43 +115,73 @@ int mDNSRecordExtractor::OnCallback(int sock, const struct sockaddr* from, size_
     // Check if the pointer cast failed
     if (extractor == nullptr)
     {
-        throw std::runtime_error("User data is null.");
+        // Stop parsing, as there's nowhere to store the records
+        return -1;
+    }
+
+    // This is called from within the C mdns library, so exceptions must not escape it.
+    // A malformed record only skips that record, as the packet may hold the records
+    // of other hosts (and any device on the network can respond).
+    try
+    {
+        HandleRecord(*extractor, entry, rtype, data, size, name_offset, record_offset, record_length);
     }
+    catch (const std::exception& exception)
+    {
+        obs_log(LOG_WARNING, "Skipping a malformed mDNS record: %s", exception.what());
+    }
+    catch (...)
+    {
+        obs_log(LOG_WARNING, "Skipping a malformed mDNS record");
+    }
+
+    UNUSED_PARAMETER(sock);
+    UNUSED_PARAMETER(from);
+    UNUSED_PARAMETER(addrlen);
+    UNUSED_PARAMETER(query_id);
+    UNUSED_PARAMETER(rclass);
+    UNUSED_PARAMETER(ttl);
+    UNUSED_PARAMETER(name_length);
+
+    // Return 0 to indicate that we have handled the record
+    return 0;
+}
 
+void mDNSRecordExtractor::HandleRecord(mDNSRecordExtractor& extractor, mdns_entry_type_t entry, uint16_t rtype, 
+                                       const void* data, size_t size, size_t name_offset, size_t record_offset, 
+                                       size_t record_length)
+{
     // Check if the entry type is in the filter mask
-    if ((static_cast<int>(entry) & extractor->m_entryType_filterMask) == 0)
+    if ((static_cast<int>(entry) & extractor.m_entryType_filterMask) == 0)
     {
         // Ignore this record type
-        return 0;
+        return;
     }
 
     // Parse the name of the record
     std::string recordName = ExtractString_mDNS(data, size, name_offset);
-    if (!extractor->m_service_filter.empty() && recordName != extractor->m_service_filter)
+    if (!extractor.m_service_filter.empty() && recordName != extractor.m_service_filter)
     {
         // Ignore records that aren't of the specified service type
-        return 0;
+        return;
     }
 
     // Parse the record
     mdns_record_type_t recordType = static_cast<mdns_record_type_t>(rtype);
     switch (recordType)
     {
-        case MDNS_RECORDTYPE_IGNORE:
-            // Ignore this record type
-            break;
-
         // A record - IPv4 Address
         case MDNS_RECORDTYPE_A:
         {
             // Parse the A record
-            sockaddr_in socketAddress;
+            // (the address is left zeroed by the mdns library if the record is malformed)
+            sockaddr_in socketAddress = {};
             mdns_record_parse_a(data, size, record_offset, record_length, &socketAddress);
 
-            // Convert the parsed IPv4 address to a string
-            Address ipv4Address = SockaddrToAddress(socketAddress, sizeof(socketAddress));
+            // Convert the parsed IPv4 address to an Address
+            Address ipv4Address = Address::FromSockaddr(reinterpret_cast<const sockaddr*>(&socketAddress), sizeof(socketAddress));
             // Store the parsed IPv4 address
-            extractor->m_ipv4Records.push_back(ipv4Address);
+            extractor.m_ipv4Records.push_back(ipv4Address);
             break;
         }
 
@@ -104,15 +197,13 @@ int mDNSRecordExtractor::OnCallback(int sock, const struct sockaddr* from, size_
             std::string ptrRecord(ptrString_mdns.str, ptrString_mdns.length);
             
             // Store the parsed PTR record
-            extractor->m_ptrRecords.push_back(ptrRecord);
+            extractor.m_ptrRecords.push_back(ptrRecord);
             break;
         }
         
         // TXT record - Arbitrary text string
         case MDNS_RECORDTYPE_TXT:
         {
-            // Offset within the TXT record's RDATA
-            size_t txtItem_offset = 0;
             // Buffer for a single "key=value" string
             std::array<mdns_record_txt_t, 32> txtItemBuffer;
 
@@ -130,7 +221,7 @@ int mDNSRecordExtractor::OnCallback(int sock, const struct sockaddr* from, size_
                 std::string value(recordItem.value.str, recordItem.value.length);
 
                 // Store the parsed TXT record
-                extractor->m_txtRecords.emplace_back(key, value);
+                extractor.m_txtRecords.emplace_back(key, value);
             }
 
             break;
@@ -140,13 +231,14 @@ int mDNSRecordExtractor::OnCallback(int sock, const struct sockaddr* from, size_
         case MDNS_RECORDTYPE_AAAA:
         {
             // Parse the AAAA record
-            sockaddr_in6 socketAddress;
+            // (the address is left zeroed by the mdns library if the record is malformed)
+            sockaddr_in6 socketAddress = {};
             mdns_record_parse_aaaa(data, size, record_offset, record_length, &socketAddress);
 
-            // Convert the parsed IPv6 address to a string
-            Address ipv6Address = SockaddrToAddress(socketAddress, sizeof(socketAddress));
+            // Convert the parsed IPv6 address to an Address
+            Address ipv6Address = Address::FromSockaddr(reinterpret_cast<const sockaddr*>(&socketAddress), sizeof(socketAddress));
             // Store the parsed IPv6 address
-            extractor->m_ipv6Records.push_back(ipv6Address);
+            extractor.m_ipv6Records.push_back(ipv6Address);
             break;
         }
 
@@ -161,24 +253,17 @@ int mDNSRecordExtractor::OnCallback(int sock, const struct sockaddr* from, size_
                 sizeof(char) * srvBuffer.size());
 
             // Store the parsed SRV record
-            extractor->m_srvRecords.push_back({record.priority, record.weight, record.port, 
+            extractor.m_srvRecords.push_back({record.priority, record.weight, record.port, 
                 std::string(record.name.str, record.name.length)});
 
             break;
         }
-        
-        // Any available records
-        case MDNS_RECORDTYPE_ANY:
-        {
-            throw std::runtime_error("MDNS_RECORDTYPE_ANY is not supported.");
-        }
 
-    default:
-        throw std::runtime_error("Unknown record type.");
+        // Any other record types (including MDNS_RECORDTYPE_ANY) aren't used
+        // for discovering hosts, and may be sent by any device on the network
+        default:
+            break;
     }
-
-    // Return 0 to indicate that we have handled the record
-    return 0;
 }
 
 std::string mDNSRecordExtractor::ExtractString_mDNS(const void* data, size_t size, size_t offset)
@@ -188,48 +273,10 @@ std::string mDNSRecordExtractor::ExtractString_mDNS(const void* data, size_t siz
     std::array<char, 256> nameStringBuffer;
     // Extract the string from the mDNS data
     // (this uses an internal function from the mdns library and may not be desirable)
-    mdns_string_t recordName_mdns = mdns_string_extract(data, sizeof(nameStringBuffer), 
+    mdns_string_t recordName_mdns = mdns_string_extract(data, size, 
         &offset, nameStringBuffer.data(), sizeof(char) * nameStringBuffer.size());
     
     // Convert the parsed mdns string to a C++ string
     return std::string(recordName_mdns.str, recordName_mdns.length);
 }
 
-Address mDNSRecordExtractor::SockaddrToAddress(const sockaddr_in& sockaddr, size_t addressLength)
-{
-    std::array<char, NI_MAXHOST> host;
-    std::array<char, NI_MAXSERV> service;
-
-    // Attempt to convert the sockaddr_in structure to a human-readable address
-    // using the host and service buffers
-    if (getnameinfo(reinterpret_cast<const struct sockaddr*>(&sockaddr), 
-                    static_cast<socklen_t>(addressLength), host.data(), NI_MAXHOST, 
-                    service.data(), NI_MAXSERV, NI_NUMERICHOST | NI_NUMERICSERV) != 0)
-    {
-        throw std::runtime_error("Failed to convert sockaddr to Address.");
-    }
-
-    // Create an Address object from the host and service buffers
-    uint16_t port = static_cast<uint16_t>(std::stoul(service.data()));
-    return Address(host.data(), port);
-}
-
-Address mDNSRecordExtractor::SockaddrToAddress(const sockaddr_in6& sockaddr, size_t addressLength)
-{
-    std::array<char, NI_MAXHOST> host;
-    std::array<char, NI_MAXSERV> service;
-    
-    // Attempt to convert the sockaddr_in6 structure to a human-readable address
-    // using the host and service buffers
-    if (getnameinfo(reinterpret_cast<const struct sockaddr*>(&sockaddr),
-                    static_cast<socklen_t>(addressLength), host.data(), NI_MAXHOST,
-                    service.data(), NI_MAXSERV, NI_NUMERICHOST | NI_NUMERICSERV) != 0)
-    {
-        // Consider more specific error handling or logging
-        throw std::runtime_error("Failed to convert sockaddr_in6 to Address.");
-    }
-
-    // Create an Address object from the host and service buffers
-    uint16_t port = static_cast<uint16_t>(std::stoul(service.data()));
-    return Address(host.data(), port);
-}
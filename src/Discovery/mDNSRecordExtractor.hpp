@@ -12,10 +12,6 @@
 #include "../Connections/Address.hpp"
 #include "SRVRecord.hpp"
 
-// Forward declarations
-struct sockaddr_in;
-struct sockaddr_in6;
-
 namespace MoonlightOBS
 {
     // Forward declarations
@@ -46,12 +42,46 @@ namespace MoonlightOBS
          *                             (By default, it handle all types of entries.) 
          * 
          * @return mDNSRecordExtractor object containing the extracted records.
+         * @note Records which are unable to be parsed are logged and skipped, so a single
+         *       misbehaving device doesn't hide the records of every other device.
          * 
          * @exception std::invalid_argument If the socket is invalid.
          */
         static mDNSRecordExtractor Extract(int socket, int queryID_filter = 0, std::string service_filter = "",
             int entryType_filterMask = MDNS_ENTRYTYPE_QUESTION | MDNS_ENTRYTYPE_ANSWER | MDNS_ENTRYTYPE_AUTHORITY | MDNS_ENTRYTYPE_ADDITIONAL
         );
+
+        /**
+         * @brief Extracts the mDNS records from a response packet which has already been received,
+         *        walking it the same way as Extract does (such as for captured packets).
+         * 
+         * @param packet The packet, starting at its header.
+         * @param size The size of the packet in bytes.
+         * @param queryID_filter The ID of the query to filter the response, 
+         *                       or 0 to accept any response.
+         * @param service_filter The name of the service to filter the response.
+         *                       (By default, it will receive all services)
+         * @param entryType_filterMask Bitmask filter which entry types to handle.
+         *                             (By default, it handle all types of entries.) 
+         * 
+         * @return mDNSRecordExtractor object containing the extracted records, which is empty
+         *         if the packet is truncated before its records.
+         * @note Records which are unable to be parsed are logged and skipped, as with Extract.
+         */
+        static mDNSRecordExtractor Parse(const void* packet, size_t size, int queryID_filter = 0,
+            std::string service_filter = "",
+            int entryType_filterMask = MDNS_ENTRYTYPE_QUESTION | MDNS_ENTRYTYPE_ANSWER | MDNS_ENTRYTYPE_AUTHORITY | MDNS_ENTRYTYPE_ADDITIONAL
+        );
+
+        /**
+         * @brief Gets the number of records which were read from the response.
+         * 
+         * @return size_t The number of records, including those which were filtered out or skipped.
+         */
+        size_t GetResponsesHandled() const
+        {
+            return m_responsesHandled;
+        }
         
         /**
          * @brief Gets the received PTR records.
@@ -149,7 +179,8 @@ namespace MoonlightOBS
          * @param record_length The length of the record in the data.
          * @param user_data User data to pass to the callback function.
          * 
-         * @return 0 on indicate the record was handled, -1 on error.
+         * @return 0 to continue with the next record, or -1 if there's nowhere to store the records.
+         * @note This never throws, as it's called from within the C mdns library.
          */
         static int OnCallback(int sock, const struct sockaddr* from, size_t addrlen,
                                mdns_entry_type_t entry, uint16_t query_id, uint16_t rtype,
@@ -157,11 +188,12 @@ namespace MoonlightOBS
                                size_t name_offset, size_t name_length, size_t record_offset,
                                size_t record_length, void* user_data);
 
+        // Parses a single record into the extractor
+        static void HandleRecord(mDNSRecordExtractor& extractor, mdns_entry_type_t entry, uint16_t rtype, 
+                                 const void* data, size_t size, size_t name_offset, size_t record_offset, 
+                                 size_t record_length);
+
         // Converts buffer to a string
         static std::string ExtractString_mDNS(const void* data, size_t size, size_t offset);
-        // Converts sockaddr_in to Address
-        static Address SockaddrToAddress(const sockaddr_in& sockaddr, size_t addressLength);
-        // Converts sockaddr_in6 to Address
-        static Address SockaddrToAddress(const sockaddr_in6& sockaddr, size_t addressLength);
     };
 } // namespace MoonlightOBS
@@ -0,0 +1,199 @@
+#include "AppPickerDialog.hpp"
+
+// STL includes
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Qt includes
+#include <QHBoxLayout>
+#include <QIcon>
+#include <QImage>
+#include <QLabel>
+#include <QListWidget>
+#include <QMetaObject>
+#include <QPixmap>
+#include <QPushButton>
+#include <QSize>
+#include <QString>
+#include <QThread>
+#include <QVBoxLayout>
+
+// OBS Studio includes
+#include <util/base.h>
+#include <obs-module.h>
+
+// Project includes
+#include "../Connections/AppCatalogue.hpp"
+
+using namespace MoonlightOBS;
+
+AppPickerDialog::AppPickerDialog(std::string_view uniqueID, int selectedAppID, QWidget* parent)
+    : QDialog(parent), m_uniqueID(uniqueID), m_selectedAppID(selectedAppID),
+      m_callbackGuard(std::make_shared<CallbackGuard>())
+{
+    m_callbackGuard->dialog = this;
+
+    setWindowTitle(obs_module_text("AppPickerDialog.Title"));
+
+    // Label for the app list
+    QLabel* appsLabel = new QLabel(obs_module_text("AppPickerDialog.Apps"), this);
+    // Apps list widget, showing the box art of each app above its title
+    m_appListWidget = new QListWidget(this);
+    m_appListWidget->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_appListWidget->setViewMode(QListView::IconMode);
+    m_appListWidget->setIconSize(QSize(AppCatalogue::BoxArtWidth, AppCatalogue::BoxArtHeight));
+    m_appListWidget->setResizeMode(QListView::Adjust);
+    m_appListWidget->setMovement(QListView::Static);
+    m_appListWidget->setWordWrap(true);
+    m_appListWidget->setUniformItemSizes(true);
+
+    // Select button
+    m_selectButton = new QPushButton(obs_module_text("AppPickerDialog.Select"), this);
+    // Cancel button
+    m_cancelButton = new QPushButton(obs_module_text("AppPickerDialog.Cancel"), this);
+
+    // Main layout
+    QVBoxLayout* mainLayout = new QVBoxLayout();
+    mainLayout->addWidget(appsLabel);
+    mainLayout->addWidget(m_appListWidget);
+    // Button layout
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_selectButton);
+    buttonLayout->addWidget(m_cancelButton);
+
+    // Add the button layout to the main layout
+    // and set the main layout
+    mainLayout->addLayout(buttonLayout);
+    setLayout(mainLayout);
+    setMinimumSize(720, 520);
+
+    // Connect signals and slots
+    connect(m_appListWidget, &QListWidget::currentItemChanged, this, &AppPickerDialog::OnAppSelectionChanged);
+    connect(m_appListWidget, &QListWidget::itemDoubleClicked, this, &QDialog::accept);
+    connect(m_selectButton, &QPushButton::clicked, this, &QDialog::accept);
+    connect(m_cancelButton, &QPushButton::clicked, this, &QDialog::reject);
+
+    // Show the cached apps immediately
+    std::shared_ptr<const AppList> cachedApps = AppCatalogue::GetApps(m_uniqueID);
+    if (cachedApps != nullptr)
+    {
+        SetApps(*cachedApps);
+    }
+    m_selectButton->setEnabled(m_appListWidget->currentItem() != nullptr);
+
+    // Refresh the apps in the background, updating the list if they've changed
+    std::weak_ptr<CallbackGuard> guard = m_callbackGuard;
+    AppCatalogue::Refresh(m_uniqueID, [guard](std::shared_ptr<const AppList> apps)
+    {
+        RunOnDialog(guard, [apps](AppPickerDialog* dialog)
+        {
+            dialog->SetApps(*apps);
+        });
+    });
+}
+
+AppPickerDialog::~AppPickerDialog()
+{
+    // Stop the callbacks still queued in the AppCatalogue from posting to the dialog
+    // (anything already posted is discarded by Qt when the dialog is destroyed)
+    std::lock_guard<std::mutex> lock(m_callbackGuard->mutex);
+    m_callbackGuard->dialog = nullptr;
+}
+
+void AppPickerDialog::OnAppSelectionChanged(QListWidgetItem* current, QListWidgetItem* previous)
+{
+    UNUSED_PARAMETER(previous);
+
+    // Enable the select button if an app is selected
+    m_selectButton->setEnabled(current != nullptr);
+    m_selectedAppID = current != nullptr ? current->data(Qt::UserRole).toInt() : 0;
+}
+
+void AppPickerDialog::SetApps(const AppList& apps)
+{
+    // Keep the selection across refreshes
+    int selectedAppID = m_selectedAppID;
+
+    m_appListWidget->clear();
+    for (const AppInfo& app : apps)
+    {
+        QListWidgetItem* item = new QListWidgetItem(QString::fromStdString(app.title));
+        item->setData(Qt::UserRole, app.id);
+        item->setSizeHint(QSize(AppCatalogue::BoxArtWidth + 20, AppCatalogue::BoxArtHeight + 40));
+        m_appListWidget->addItem(item);
+
+        if (app.id == selectedAppID)
+        {
+            m_appListWidget->setCurrentItem(item);
+        }
+    }
+
+    // Load the box art of each app, showing each image as soon as it's ready
+    // (images already in memory are set before this returns)
+    std::weak_ptr<CallbackGuard> guard = m_callbackGuard;
+    for (const AppInfo& app : apps)
+    {
+        AppCatalogue::LoadBoxArt(m_uniqueID, app.id, [guard](int appID, const QImage& image)
+        {
+            RunOnDialog(guard, [appID, image](AppPickerDialog* dialog)
+            {
+                dialog->SetBoxArt(appID, image);
+            });
+        });
+    }
+}
+
+void AppPickerDialog::SetBoxArt(int appID, const QImage& image)
+{
+    // Apps whose box art couldn't be loaded keep the default icon
+    if (image.isNull())
+    {
+        return;
+    }
+
+    for (int i = 0; i < m_appListWidget->count(); ++i)
+    {
+        QListWidgetItem* item = m_appListWidget->item(i);
+        if (item->data(Qt::UserRole).toInt() == appID)
+        {
+            item->setIcon(QIcon(QPixmap::fromImage(image)));
+            break;
+        }
+    }
+}
+
+void AppPickerDialog::RunOnDialog(const std::weak_ptr<CallbackGuard>& guard, std::function<void(AppPickerDialog*)> function)
+{
+    std::shared_ptr<CallbackGuard> callbackGuard = guard.lock();
+    if (callbackGuard == nullptr)
+    {
+        return;
+    }
+
+    // The dialog can't be destroyed while the lock is held
+    std::lock_guard<std::mutex> lock(callbackGuard->mutex);
+    AppPickerDialog* dialog = callbackGuard->dialog;
+    if (dialog == nullptr)
+    {
+        return;
+    }
+
+    // Callbacks on the UI thread (such as for box art already in memory) run immediately,
+    // while those on the background thread are posted to the UI thread
+    if (QThread::currentThread() == dialog->thread())
+    {
+        function(dialog);
+    }
+    else
+    {
+        QMetaObject::invokeMethod(dialog, [dialog, function = std::move(function)]()
+        {
+            function(dialog);
+        }, Qt::QueuedConnection);
+    }
+}
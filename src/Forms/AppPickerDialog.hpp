@@ -0,0 +1,98 @@
+#pragma once
+
+// STL includes
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// Qt includes
+#include <QDialog>
+
+// Project includes
+#include "../Connections/AppInfo.hpp"
+
+// Forward declarations
+class QImage;
+class QListWidget;
+class QListWidgetItem;
+class QPushButton;
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Dialog for choosing the app to stream from a paired GameStream host.
+     *
+     * The cached apps of the host are shown immediately while they're refreshed
+     * in the background, and the box art of each app appears as soon as it has loaded.
+     *
+     */
+    class AppPickerDialog : public QDialog
+    {
+        Q_OBJECT
+
+    public:
+        /**
+         * @brief Construct the AppPickerDialog dialog for choosing an app of a paired host.
+         *
+         * @param uniqueID The unique ID of the paired host.
+         * @param selectedAppID The ID of the app to select initially.
+         * @param parent The parent widget for this dialog.
+         */
+        AppPickerDialog(std::string_view uniqueID, int selectedAppID, QWidget* parent = nullptr);
+
+        /**
+         * @brief Destroy the AppPickerDialog dialog.
+         *
+         */
+        ~AppPickerDialog() override;
+
+        /**
+         * @brief Get the ID of the selected app.
+         *
+         * @return int The ID of the selected app, or 0 if no app is selected.
+         */
+        inline int GetSelectedAppID() const
+        {
+            return m_selectedAppID;
+        }
+
+    private slots:
+        void OnAppSelectionChanged(QListWidgetItem* current, QListWidgetItem* previous);
+
+    private:
+        // Lets the callbacks of the AppCatalogue, which are called on its background thread,
+        // post to the dialog only while it's alive
+        struct CallbackGuard
+        {
+            std::mutex mutex;
+            AppPickerDialog* dialog = nullptr;
+        };
+
+        // Unique ID of the host
+        std::string m_uniqueID;
+
+        // List of apps
+        QListWidget* m_appListWidget;
+        // Button for choosing the selected app
+        QPushButton* m_selectButton;
+        // Button for canceling the dialog
+        QPushButton* m_cancelButton;
+
+        // ID of the selected app
+        // (the ID of each app is stored in the data of its list item)
+        int m_selectedAppID;
+
+        // Guard shared with the callbacks of the AppCatalogue
+        std::shared_ptr<CallbackGuard> m_callbackGuard;
+
+        // Fills the list with apps, keeping the selection, and loads their box art
+        void SetApps(const AppList& apps);
+        // Sets the box art of an app in the list
+        void SetBoxArt(int appID, const QImage& image);
+
+        // Runs a function with the dialog on its thread, if the dialog is still alive
+        static void RunOnDialog(const std::weak_ptr<CallbackGuard>& guard, std::function<void(AppPickerDialog*)> function);
+    };
+} // namespace MoonlightOBS
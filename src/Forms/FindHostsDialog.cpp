@@ -1,8 +1,17 @@
 #include "FindHostsDialog.hpp"
 
+// STL includes
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
 // Qt includes
 #include <QLabel>
 #include <QListWidget>
+#include <QMetaObject>
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QVBoxLayout>
@@ -14,15 +23,20 @@
 
 // Project includes
 #include "../plugin-support.h"
+#include "../Connections/Address.hpp"
 #include "../Connections/GameStreamHost.hpp"
+#include "../Connections/HostSettings.hpp"
+#include "../Connections/HTTPClient.hpp"
 #include "../Discovery/LANSearcher.hpp"
 #include "ManualPairingDialog.hpp"
 
 using namespace MoonlightOBS;
 
 FindHostsDialog::FindHostsDialog(QWidget* parent)
-    : QDialog(parent), m_selectedHost(GameStreamHost::GetEmpty())
+    : QDialog(parent), m_selectedHostID(InvalidHostID), m_callbackGuard(std::make_shared<CallbackGuard>())
 {
+    m_callbackGuard->dialog = this;
+
     setWindowTitle(obs_module_text("FindHostsDialog.Title"));
 
     // Label for the host list
@@ -65,12 +79,14 @@ FindHostsDialog::FindHostsDialog(QWidget* parent)
     connect(m_cancelButton, &QPushButton::clicked, this, &QDialog::reject);
 
     // Start searching for hosts
-    LANSearcher::Start([this](const GameStreamHost& foundHost)
+    LANSearcher::Start([this](HostID foundHostID)
     {
-        // Keep track of the found hosts
-        m_foundHosts.emplace(foundHost.GetHostname(), foundHost);
-        // Add the found host to the list widget
-        m_hostListWidget->addItem(QString::fromStdString(foundHost.GetHostname()));
+        GameStreamHost foundHost = HostRegistry::GetHost(foundHostID);
+
+        // Add the found host to the list widget, keeping its ID with the item
+        QListWidgetItem* item = new QListWidgetItem(QString::fromStdString(foundHost.GetHostname()));
+        item->setData(Qt::UserRole, QVariant::fromValue<uint>(foundHostID));
+        m_hostListWidget->addItem(item);
     });
 }
 
@@ -81,6 +97,16 @@ FindHostsDialog::~FindHostsDialog()
     {
         LANSearcher::Stop();
     }
+
+    // Stop the manual connection from posting to the dialog, then wait for it to finish
+    {
+        std::lock_guard<std::mutex> lock(m_callbackGuard->mutex);
+        m_callbackGuard->dialog = nullptr;
+    }
+    if (m_manualConnectThread.joinable())
+    {
+        m_manualConnectThread.join();
+    }
 }
 
 void FindHostsDialog::OnHostSelectionChanged(QListWidgetItem* current, QListWidgetItem* previous)
@@ -92,28 +118,15 @@ void FindHostsDialog::OnHostSelectionChanged(QListWidgetItem* current, QListWidg
         // Enable the pair button if a host is selected
         m_pairButton->setEnabled(true);
 
-        std::string hostName = current->text().toStdString();
-
-        auto iteratorToHost = m_foundHosts.find(hostName);
-        if (iteratorToHost != m_foundHosts.end())
-        {
-            // Set the selected host
-            m_selectedHost = iteratorToHost->second;
-        }
-        else
-        {
-            // This shouldn't happen
-            // Set the selected host to an empty host
-            m_selectedHost = GameStreamHost::GetEmpty();
-            
-            // Log this event
-            obs_log(LOG_WARNING, "Unable to select %s, not in map.", hostName.c_str());
-        }
+        // Set the selected host
+        m_selectedHostID = static_cast<HostID>(current->data(Qt::UserRole).toUInt());
     }
     else
     {
         // Disable the pair button if no host is selected
         m_pairButton->setEnabled(false);
+
+        m_selectedHostID = InvalidHostID;
     }
 }
 
@@ -125,10 +138,105 @@ void FindHostsDialog::OnManuallyConnectClicked()
     if (dialog.exec() == QDialog::Accepted) 
     {
         // Get the address entered in the dialog
-        QString address = dialog.GetAddress();
-        
-        // Close the main dialog
-        // as the user has selected the device they wish to pair with
-        accept();
+        std::string addressText = dialog.GetAddress().trimmed().toStdString();
+
+        Address address;
+        if (!Address::TryParse(addressText, address) || address.IsEmpty())
+        {
+            obs_log(LOG_WARNING, "Invalid address entered for manual pairing: %s", addressText.c_str());
+            return;
+        }
+        if (address.GetPortNumber() == 0)
+        {
+            address.SetPortNumber(HTTPClient::DefaultPort);
+        }
+
+        // Contact the host on its own thread, as it can take until the request times out
+        // (the previous connection has finished, as the button is disabled while connecting)
+        if (m_manualConnectThread.joinable())
+        {
+            m_manualConnectThread.join();
+        }
+        m_manuallyConnectButton->setEnabled(false);
+        m_manuallyConnectButton->setText(obs_module_text("FindHostsDialog.Connecting"));
+
+        std::weak_ptr<CallbackGuard> guard = m_callbackGuard;
+        m_manualConnectThread = std::thread([guard, address, addressText]()
+        {
+            HostID hostID = InvalidHostID;
+            try
+            {
+                // Get the settings of the host, and register it
+                // (a hostname is resolved by libcurl over either protocol, so it's stored as the IPv4 address)
+                HostSettings settings = HTTPClient(address).GetServerInfo();
+                GameStreamHost host = address.IsIPv6() ? GameStreamHost::FromIPv6(settings.GetHostname(), address)
+                    : GameStreamHost::FromIPv4(settings.GetHostname(), address);
+
+                HostSettingsChanges changes;
+                hostID = HostRegistry::Register(host, settings, &changes);
+                if (changes.any() && !changes.all())
+                {
+                    obs_log(LOG_INFO, "Settings of GameStream host %s changed: %s", settings.GetHostname().c_str(),
+                        HostSettingsSnapshot::FormatChanges(changes).c_str());
+                }
+            }
+            catch (const std::exception& exception)
+            {
+                obs_log(LOG_WARNING, "Failed to connect to host at %s: %s", addressText.c_str(), exception.what());
+            }
+
+            RunOnDialog(guard, [hostID](FindHostsDialog* dialog)
+            {
+                dialog->OnManuallyConnected(hostID);
+            });
+        });
     }
 }
+
+void FindHostsDialog::OnManuallyConnected(HostID hostID)
+{
+    m_manuallyConnectButton->setText(obs_module_text("FindHostsDialog.ManuallyConnect"));
+    m_manuallyConnectButton->setEnabled(true);
+
+    if (hostID == InvalidHostID)
+    {
+        return;
+    }
+
+    // Close the main dialog
+    // as the user has selected the device they wish to pair with
+    m_selectedHostID = hostID;
+    accept();
+}
+
+void FindHostsDialog::RunOnDialog(const std::weak_ptr<CallbackGuard>& guard, std::function<void(FindHostsDialog*)> function)
+{
+    std::shared_ptr<CallbackGuard> callbackGuard = guard.lock();
+    if (callbackGuard == nullptr)
+    {
+        return;
+    }
+
+    // The dialog can't be destroyed while the lock is held
+    std::lock_guard<std::mutex> lock(callbackGuard->mutex);
+    FindHostsDialog* dialog = callbackGuard->dialog;
+    if (dialog == nullptr)
+    {
+        return;
+    }
+
+    QMetaObject::invokeMethod(dialog, [dialog, function = std::move(function)]()
+    {
+        function(dialog);
+    }, Qt::QueuedConnection);
+}
+
+GameStreamHost FindHostsDialog::GetSelectedHost() const
+{
+    if (m_selectedHostID == InvalidHostID)
+    {
+        return GameStreamHost::GetEmpty();
+    }
+
+    return HostRegistry::GetHost(m_selectedHostID);
+}
@@ -1,13 +1,17 @@
 #pragma once
 
 // STL includes
-#include <map>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 // Qt includes
 #include <QDialog>
 
 // Project includes
 #include "../Connections/GameStreamHost.hpp"
+#include "../Connections/HostRegistry.hpp"
 
 // Forward declarations
 class QListWidget;
@@ -43,11 +47,18 @@ namespace MoonlightOBS
         /**
          * @brief Get the Selected Host.
          * 
-         * @return Host The selected host.
+         * @return Host The selected host, or an empty host if no host is selected.
          */
-        inline GameStreamHost GetSelectedHost() const
+        GameStreamHost GetSelectedHost() const;
+
+        /**
+         * @brief Get the ID of the selected host in the HostRegistry.
+         * 
+         * @return HostID The ID of the selected host, or InvalidHostID if no host is selected.
+         */
+        inline HostID GetSelectedHostID() const
         {
-            return m_selectedHost;
+            return m_selectedHostID;
         }
 
     private slots:
@@ -55,6 +66,14 @@ namespace MoonlightOBS
         void OnManuallyConnectClicked();
 
     private:
+        // Lets the manual connection, which runs on its own thread,
+        // post to the dialog only while it's alive
+        struct CallbackGuard
+        {
+            std::mutex mutex;
+            FindHostsDialog* dialog = nullptr;
+        };
+
         // List of found hosts
         QListWidget* m_hostListWidget;
         // Button for pairing with the selected host
@@ -64,10 +83,20 @@ namespace MoonlightOBS
         // Button for canceling the dialog
         QPushButton* m_cancelButton;
 
-        // Selected host
-        GameStreamHost m_selectedHost;
-        // Map of found hosts
-        // Key: Host name, Value: Host object
-        std::map<std::string, GameStreamHost> m_foundHosts;
+        // ID of the selected host
+        // (the ID of each found host is stored in the data of its list item)
+        HostID m_selectedHostID;
+
+        // Guard shared with the thread of the manual connection
+        std::shared_ptr<CallbackGuard> m_callbackGuard;
+        // Thread requesting the settings of a manually entered address
+        std::thread m_manualConnectThread;
+
+        // Selects the host registered by the manual connection and closes the dialog,
+        // or lets another address be entered if connecting failed
+        void OnManuallyConnected(HostID hostID);
+
+        // Runs a function with the dialog on its thread, if the dialog is still alive
+        static void RunOnDialog(const std::weak_ptr<CallbackGuard>& guard, std::function<void(FindHostsDialog*)> function);
     };
 } // namespace MoonlightOBS
@@ -1,8 +1,15 @@
 #include "OBSSource.hpp"
 
 // STL includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <mutex>
 #include <new>
 #include <stdexcept>
+#include <string>
 
 // OBS Studio includes
 #include <obs.h>
@@ -13,6 +20,13 @@
 // Project includes
 #include "plugin-support.h"
 #include "Properties.hpp"
+#include "Streaming/StreamSession.hpp"
+
+namespace
+{
+    // Frame rate streamed at when the highest frame rate is chosen
+    constexpr uint32_t HighestFPS = 120;
+}
 
 using namespace MoonlightOBS;
 
@@ -30,6 +44,10 @@ obs_source_info OBSSource::CreateSourceInfo()
     source_info.get_properties  = OnOBSGetProperties;
     source_info.get_defaults    = OnOBSGetDefaults;
     source_info.audio_render    = OnOBSAudioRender;
+    source_info.activate        = OnOBSSourceActivate;
+    source_info.deactivate      = OnOBSSourceDeactivate;
+    source_info.show            = OnOBSSourceShow;
+    source_info.hide            = OnOBSSourceHide;
 
     return source_info;
 }
@@ -46,6 +64,142 @@ OBSSource::OBSSource(obs_source_t* source)
     }
 }
 
+// Destroy the OBSSource object
+OBSSource::~OBSSource()
+{
+    Disconnect();
+}
+
+void OBSSource::Connect()
+{
+    obs_data_t* settings = obs_source_get_settings(m_source);
+    StreamConfig config = ReadStreamConfig(settings);
+    std::chrono::seconds inactiveTimeout = ReadInactiveTimeout(settings);
+    obs_data_release(settings);
+
+    // Keep the current stream if the config hasn't changed, only passing on the inactive timeout
+    std::shared_ptr<StreamSession> session = GetSession();
+    if (session != nullptr && session->GetConfig() == config)
+    {
+        session->SetInactiveTimeout(m_source, inactiveTimeout);
+        return;
+    }
+
+    Disconnect();
+    session = StreamSession::Attach(config, m_source, inactiveTimeout);
+
+    std::lock_guard<std::mutex> lock(m_sessionMutex);
+    m_session = std::move(session);
+}
+
+void OBSSource::Disconnect()
+{
+    std::shared_ptr<StreamSession> session;
+    {
+        std::lock_guard<std::mutex> lock(m_sessionMutex);
+        session = std::move(m_session);
+    }
+
+    // Releasing the last reference disconnects, which mustn't block the graphics thread under the lock
+    if (session != nullptr)
+    {
+        session->Detach(m_source);
+    }
+}
+
+std::shared_ptr<StreamSession> OBSSource::GetSession()
+{
+    std::lock_guard<std::mutex> lock(m_sessionMutex);
+    return m_session;
+}
+
+StreamConfig OBSSource::ReadStreamConfig(obs_data_t* settings)
+{
+    StreamConfig config;
+    config.uniqueID         = obs_data_get_string(settings, "host");
+    config.appID            = static_cast<int>(obs_data_get_int(settings, "app"));
+    config.bitrate          = static_cast<uint32_t>(std::lround(obs_data_get_double(settings, "bitrate") * 1000.0));
+    config.hardwareDecoding = obs_data_get_bool(settings, "hardware_decoding");
+    config.decodeThreads    = static_cast<uint32_t>(std::max(obs_data_get_int(settings, "decode_threads"), 0ll));
+
+    std::string decodeThreading = obs_data_get_string(settings, "decode_threading");
+    if (decodeThreading == "frame")
+    {
+        config.decodeThreading = DecodeThreading::Frame;
+    }
+    else if (decodeThreading == "slice_frame")
+    {
+        config.decodeThreading = DecodeThreading::SliceAndFrame;
+    }
+
+    if (std::string(obs_data_get_string(settings, "decode_submission")) == "direct")
+    {
+        config.decodeSubmission = DecodeSubmission::Direct;
+    }
+
+    std::string framePacing = obs_data_get_string(settings, "frame_pacing");
+    if (framePacing == "smooth")
+    {
+        config.framePacing = FramePacing::Smooth;
+    }
+    else if (framePacing == "fixed")
+    {
+        config.framePacing = FramePacing::FixedDelay;
+        config.pacingDelay = static_cast<uint32_t>(std::clamp(obs_data_get_int(settings, "pacing_delay"), 0ll, 1000ll));
+    }
+
+    // Stream at the size and frame rate of the canvas, unless a custom resolution or frame rate is chosen
+    obs_video_info videoInfo = {};
+    if (obs_get_video_info(&videoInfo) && videoInfo.fps_den != 0)
+    {
+        config.width    = videoInfo.base_width;
+        config.height   = videoInfo.base_height;
+        config.fps      = static_cast<uint32_t>(std::lround(static_cast<double>(videoInfo.fps_num) / videoInfo.fps_den));
+
+        // HDR canvases take HDR frames as they are, while SDR canvases only ask for HDR to tone map it
+        bool hdrCanvas = videoInfo.colorspace == VIDEO_CS_2100_PQ || videoInfo.colorspace == VIDEO_CS_2100_HLG;
+        config.toneMapHDR = obs_data_get_bool(settings, "tone_map_hdr") && !hdrCanvas;
+        config.hdr = hdrCanvas || config.toneMapHDR;
+    }
+    config.yuv444 = obs_data_get_bool(settings, "yuv444");
+
+    if (std::string(obs_data_get_string(settings, "display_type")) == "custom")
+    {
+        // The resolution is either "<width>x<height>" or "<height>p" (for 16:9 resolutions)
+        const char* resolution = obs_data_get_string(settings, "resolution");
+        unsigned int width = 0;
+        unsigned int height = 0;
+        if (std::sscanf(resolution, "%ux%u", &width, &height) == 2 && width != 0 && height != 0)
+        {
+            config.width    = width;
+            config.height   = height;
+        }
+        else if (std::sscanf(resolution, "%up", &height) == 1 && height != 0)
+        {
+            config.width    = (height * 16 / 9 + 1) & ~1u;
+            config.height   = height;
+        }
+
+        double fps = obs_data_get_double(settings, "fps");
+        if (fps > 0.0)
+        {
+            config.fps = static_cast<uint32_t>(std::lround(fps));
+        }
+        else if (fps < 0.0)
+        {
+            config.fps = HighestFPS;
+        }
+    }
+
+    return config;
+}
+
+std::chrono::seconds OBSSource::ReadInactiveTimeout(obs_data_t* settings)
+{
+    long long inactiveTimeout = obs_data_get_int(settings, "inactive_timeout");
+    return std::chrono::seconds(inactiveTimeout > 0 ? inactiveTimeout : 0);
+}
+
 // obs_source_info.get_name callback
 const char* OBSSource::OnOBSSourceGetName(void* type_data)
 {
@@ -95,9 +249,8 @@ void OBSSource::OnOBSSourceDestroy(void* data)
 obs_properties_t* OBSSource::OnOBSGetProperties(void* data)
 {
     // Create the source properties
-    Properties properties;
+    Properties properties(static_cast<OBSSource*>(data));
 
-    UNUSED_PARAMETER(data);
     return properties.GetHandle();
 }
 
@@ -131,6 +284,66 @@ void OBSSource::OnOBSGetDefaults(obs_data_t* settings)
     obs_data_set_default_double(settings, "fps", 0.0);
     // Set the hardware decoding to the default value
     obs_data_set_default_bool(settings, "hardware_decoding", true);
+    // Set the decode threading to the default value (Slices, which add no latency)
+    obs_data_set_default_string(settings, "decode_threading", "slice");
+    // Set the decode threads to the default value (automatic)
+    obs_data_set_default_int(settings, "decode_threads", 0);
+    // Set the decode submission to the default value (Queued, so receiving never waits for decoding)
+    obs_data_set_default_string(settings, "decode_submission", "queued");
+    // Set the HDR tone mapping to the default value (SDR canvases ask for SDR streams)
+    obs_data_set_default_bool(settings, "tone_map_hdr", false);
+    // Set 4:4:4 streaming to the default value (4:2:0, which takes less bandwidth)
+    obs_data_set_default_bool(settings, "yuv444", false);
+    // Set the frame pacing to the default value (Lowest latency)
+    obs_data_set_default_string(settings, "frame_pacing", "lowest");
+    // Set the pacing delay to the default value (none)
+    obs_data_set_default_int(settings, "pacing_delay", 0);
     // Set the Audio Output Mode to the default value (Capture audio only)
     obs_data_set_default_string(settings, "audio_mode", "AudioOutputMode.Capture");
+    // Set the inactive timeout to the default value (one minute)
+    obs_data_set_default_int(settings, "inactive_timeout", 60);
+}
+
+// obs_source_info.activate callback
+void OBSSource::OnOBSSourceActivate(void* data)
+{
+    OBSSource* context = static_cast<OBSSource*>(data);
+    std::shared_ptr<StreamSession> session = context->GetSession();
+    if (session != nullptr)
+    {
+        session->SetSourceActive(context->m_source, true);
+    }
+}
+
+// obs_source_info.deactivate callback
+void OBSSource::OnOBSSourceDeactivate(void* data)
+{
+    OBSSource* context = static_cast<OBSSource*>(data);
+    std::shared_ptr<StreamSession> session = context->GetSession();
+    if (session != nullptr)
+    {
+        session->SetSourceActive(context->m_source, false);
+    }
+}
+
+// obs_source_info.show callback
+void OBSSource::OnOBSSourceShow(void* data)
+{
+    OBSSource* context = static_cast<OBSSource*>(data);
+    std::shared_ptr<StreamSession> session = context->GetSession();
+    if (session != nullptr)
+    {
+        session->SetSourceShowing(context->m_source, true);
+    }
+}
+
+// obs_source_info.hide callback
+void OBSSource::OnOBSSourceHide(void* data)
+{
+    OBSSource* context = static_cast<OBSSource*>(data);
+    std::shared_ptr<StreamSession> session = context->GetSession();
+    if (session != nullptr)
+    {
+        session->SetSourceShowing(context->m_source, false);
+    }
 }
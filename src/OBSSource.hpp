@@ -1,10 +1,21 @@
 #pragma once
 
+// STL includes
+#include <chrono>
+#include <memory>
+#include <mutex>
+
 // OBS Studio includes
 #include <obs.h>
 
+// Project includes
+#include "Streaming/StreamConfig.hpp"
+
 namespace MoonlightOBS
 {
+    // Forward declarations
+    class StreamSession;
+
     /**
      * @brief Handles the OBS studio source.
      * 
@@ -29,6 +40,21 @@ namespace MoonlightOBS
             return m_source;
         }
 
+        /**
+         * @brief Connects to the host and app selected in the settings of the source,
+         *        replacing any current connection.
+         * @note The stream is shared with other sources showing the same host and app with
+         *       the same config. Connecting runs on a background thread, so this returns immediately.
+         *
+         */
+        void Connect();
+
+        /**
+         * @brief Detaches from the stream, which disconnects once no other source shows it.
+         *
+         */
+        void Disconnect();
+
     private:
         /**
          * @brief Construct a new OBSSource object
@@ -39,12 +65,25 @@ namespace MoonlightOBS
          * @brief Destroy the OBSSource object
          * 
          */
-        ~OBSSource() = default;
+        ~OBSSource();
         OBSSource(const OBSSource&) = delete; // Disable copy constructor
 
         // OBS Studio source instance
         obs_source_t* m_source;
 
+        // Guards m_session, as it's changed from the UI thread and used from the graphics thread
+        std::mutex m_sessionMutex;
+        // Stream shown by the source, if connecting or connected
+        std::shared_ptr<StreamSession> m_session;
+
+        // Gets the stream shown by the source, if any
+        std::shared_ptr<StreamSession> GetSession();
+
+        // Reads the host, app and stream parameters from the settings of the source
+        static StreamConfig ReadStreamConfig(obs_data_t* settings);
+        // Reads how long the source may be inactive before its stream disconnects
+        static std::chrono::seconds ReadInactiveTimeout(obs_data_t* settings);
+
         // obs_source_info.get_name callback
         static const char* OnOBSSourceGetName(void* type_data);
         // obs_source_info.create callback
@@ -59,5 +98,13 @@ namespace MoonlightOBS
             uint32_t mixers, size_t channels, size_t sample_rate);
         // obs_source_info.get_defaults callback
         static void OnOBSGetDefaults(obs_data_t* settings);
+        // obs_source_info.activate callback
+        static void OnOBSSourceActivate(void* data);
+        // obs_source_info.deactivate callback
+        static void OnOBSSourceDeactivate(void* data);
+        // obs_source_info.show callback
+        static void OnOBSSourceShow(void* data);
+        // obs_source_info.hide callback
+        static void OnOBSSourceHide(void* data);
     };
 }
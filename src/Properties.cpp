@@ -2,30 +2,43 @@
 
 // STL includes
 #include <cassert>
+#include <exception>
+#include <memory>
 #include <string>
 
 // OBS Studio includes
 #include <obs-frontend-api.h>
 #include <obs-module.h>
 #include <obs-properties.h>
+#include <util/base.h>
 
 // Qt includes
 #include <QtWidgets>
 
 // Project includes
+#include "plugin-support.h"
+#include "Connections/AppCatalogue.hpp"
+#include "Connections/AppInfo.hpp"
+#include "Connections/PairedHostStore.hpp"
+#include "Forms/AppPickerDialog.hpp"
 #include "Forms/FindHostsDialog.hpp"
 #include "OBSSource.hpp"
+#include "Streaming/ConnectionStatistics.hpp"
 
 using namespace MoonlightOBS;
 
-Properties::Properties()
+Properties::Properties(OBSSource* source)
 {
     // Create the properties handle
     m_handle = obs_properties_create();
+    obs_properties_set_param(m_handle, source, nullptr);
 
     // Create the properties
     m_hostList                  = CreateHostListProperty(m_handle);
+    m_appList                   = CreateAppListProperty(m_handle);
+    m_chooseAppButton           = CreateChooseAppButton(m_handle);
     m_connectionStatus          = CreateConnectionStatusProperty(m_handle);
+    m_connectionStats           = CreateConnectionStatsProperty(m_handle);
     m_connectButton             = CreateConnectButton(m_handle);
     m_pairButton                = CreatePairButton(m_handle);
     m_removeButton              = CreateRemoveButton(m_handle);
@@ -35,7 +48,15 @@ Properties::Properties()
     m_resolutionList            = CreateResolutionList(m_handle);
     m_fpsList                   = CreateFPSList(m_handle);
     m_hardwareDecodingCheckbox  = CreateHardwareDecodingCheckbox(m_handle);
+    m_decodeThreadingList       = CreateDecodeThreadingList(m_handle);
+    m_decodeThreadsInput        = CreateDecodeThreadsInput(m_handle);
+    m_decodeSubmissionList      = CreateDecodeSubmissionList(m_handle);
+    m_toneMapHDRCheckbox        = CreateToneMapHDRCheckbox(m_handle);
+    m_yuv444Checkbox            = CreateYUV444Checkbox(m_handle);
+    m_framePacingList           = CreateFramePacingList(m_handle);
+    m_pacingDelayInput          = CreatePacingDelayInput(m_handle);
     m_audioModeList             = CreateAudioModeList(m_handle);
+    m_inactiveTimeoutInput      = CreateInactiveTimeoutInput(m_handle);
 
     // Initially disable the resolution and FPS properties
     // HACK: This is a workaround for the fact that the internal logic of the plugin isn't implemented yet
@@ -57,11 +78,157 @@ obs_property_t* Properties::CreateHostListProperty(obs_properties_t* props)
         OBS_COMBO_FORMAT_STRING     // Format as strings
     );
 
-    // TODO: Retrieve the list of paired devices and add them to the combo box
+    // Add the paired hosts to the combo box
+    ListPairedHosts(property);
+
+    // Add callback for when the selected host changes, to list its apps
+    obs_property_set_modified_callback(property, OnHostChanged);
+
+    return property;
+}
+
+bool Properties::OnHostChanged(obs_properties_t* props, obs_property_t* property, obs_data_t* settings)
+{
+    // Get the selected host
+    std::string selectedHost(obs_data_get_string(settings, "host"));
+
+    // List the cached apps of the host, so they're shown instantly
+    obs_property_t* appList = obs_properties_get(props, "app");
+    obs_property_list_clear(appList);
+    if (!selectedHost.empty())
+    {
+        std::shared_ptr<const AppList> apps = AppCatalogue::GetApps(selectedHost);
+        if (apps != nullptr)
+        {
+            for (const AppInfo& app : *apps)
+            {
+                obs_property_list_add_int(appList, app.title.c_str(), app.id);
+            }
+        }
+
+        // Refresh the apps in the background, and have OBS recreate the properties once they've
+        // changed, so the new apps are listed (the source is only weakly referenced, as the
+        // refresh can outlive it)
+        OBSSource* source = static_cast<OBSSource*>(obs_properties_get_param(props));
+        if (source != nullptr)
+        {
+            std::shared_ptr<obs_weak_source_t> weakSource(obs_source_get_weak_source(source->GetSource()),
+                obs_weak_source_release);
+            AppCatalogue::Refresh(selectedHost, [weakSource](std::shared_ptr<const AppList> apps)
+            {
+                UNUSED_PARAMETER(apps);
+
+                obs_source_t* currentSource = obs_weak_source_get_source(weakSource.get());
+                if (currentSource != nullptr)
+                {
+                    obs_source_update_properties(currentSource);
+                    obs_source_release(currentSource);
+                }
+            });
+        }
+    }
+
+    obs_property_set_enabled(obs_properties_get(props, "choose_app"), !selectedHost.empty());
+
+    // Show how long connecting to the host has taken recently
+    std::string stats = !selectedHost.empty() ? ConnectionStatistics::GetSummary(selectedHost) : std::string();
+    obs_data_set_string(settings, "connection_stats",
+        !stats.empty() ? stats.c_str() : obs_module_text("ConnectionStats.None"));
+
+    UNUSED_PARAMETER(property);
+
+    // Repaint the UI
+    return true;
+}
+
+void Properties::ListPairedHosts(obs_property_t* property)
+{
+    obs_property_list_clear(property);
+
+    // Add the paired hosts to the combo box, identified by their unique IDs
+    // (this only reads the in-memory snapshot of the store, so it never blocks on disk or the network)
+    std::shared_ptr<const PairedHosts> pairedHosts = PairedHostStore::GetHosts();
+    for (const PairedHost& pairedHost : *pairedHosts)
+    {
+        std::string uniqueID(pairedHost.GetUniqueID());
+        obs_property_list_add_string(property, pairedHost.GetHost().GetHostname().c_str(), uniqueID.c_str());
+    }
+}
+
+obs_property_t* Properties::CreateAppListProperty(obs_properties_t* props)
+{
+    // Ensure the properties handle is valid
+    assert(props != nullptr);
+
+    // Create the combo box for selecting the app to stream
+    // (it's filled with the apps of the selected host when the host is set)
+    obs_property_t* property = obs_properties_add_list(
+        props,
+        "app",                      // Internal name of the property
+        obs_module_text("App"),     // Label displayed in the UI
+        OBS_COMBO_TYPE_LIST,        // Combo box type
+        OBS_COMBO_FORMAT_INT        // Format as app IDs
+    );
 
     return property;
 }
 
+obs_property_t* Properties::CreateChooseAppButton(obs_properties_t* props)
+{
+    // Ensure the properties handle is valid
+    assert(props != nullptr);
+
+    // Create the "Choose App" button
+    obs_property_t* button = obs_properties_add_button(
+        props,
+        "choose_app",                       // Internal name of the button
+        obs_module_text("App.Choose"),      // Label displayed on the button
+        [](obs_properties_t* props, obs_property_t* property, void* data) -> bool
+        {
+            return Properties::OnChooseAppButtonPressed(props, property, static_cast<OBSSource*>(data));
+        } // Callback function for button click
+    );
+
+    return button;
+}
+
+bool Properties::OnChooseAppButtonPressed(obs_properties_t* props, obs_property_t* property, OBSSource* source)
+{
+    // Get the current settings of the source instance
+    obs_data_t* settings = obs_source_get_settings(source->GetSource());
+
+    // Get the currently selected host and app
+    std::string selectedHost(obs_data_get_string(settings, "host"));
+    int selectedApp = static_cast<int>(obs_data_get_int(settings, "app"));
+
+    bool changed = false;
+    if (!selectedHost.empty())
+    {
+        // Display the app picker for the host
+        QWidget* mainWindow = static_cast<QWidget*>(obs_frontend_get_main_window());
+        AppPickerDialog dialog(selectedHost, selectedApp, mainWindow);
+        if (dialog.exec() == QDialog::Accepted && dialog.GetSelectedAppID() != 0)
+        {
+            obs_data_set_int(settings, "app", dialog.GetSelectedAppID());
+            obs_source_update(source->GetSource(), settings);
+            changed = true;
+        }
+    }
+    else
+    {
+        // No host selected, show an error message
+        DisplayMessageBox("Error", obs_module_text("Device.NoDevice"));
+    }
+
+    obs_data_release(settings);
+
+    UNUSED_PARAMETER(props);
+    UNUSED_PARAMETER(property);
+
+    // Repaint the UI if an app was chosen, so the app list shows it
+    return changed;
+}
+
 obs_property_t* Properties::CreateConnectionStatusProperty(obs_properties_t* props)
 {
     // Ensure the properties handle is valid
@@ -83,6 +250,23 @@ obs_property_t* Properties::CreateConnectionStatusProperty(obs_properties_t* pro
     return property;
 }
 
+obs_property_t* Properties::CreateConnectionStatsProperty(obs_properties_t* props)
+{
+    // Ensure the properties handle is valid
+    assert(props != nullptr);
+
+    // Create the text showing the recent times of each connection stage of the selected host
+    // (its text is set when the host is selected)
+    obs_property_t* property = obs_properties_add_text(
+        props,
+        "connection_stats",                     // Internal name of the property
+        obs_module_text("ConnectionStats"),     // Label displayed in the UI
+        OBS_TEXT_INFO                           // Text type
+    );
+
+    return property;
+}
+
 obs_property_t* Properties::CreateConnectButton(obs_properties_t* props)
 {
     // Ensure the properties handle is valid
@@ -107,25 +291,30 @@ bool Properties::OnConnectButtonPressed(obs_properties_t* props, obs_property_t*
     // Get the current settings of the source instance
     obs_data_t* settings = obs_source_get_settings(source->GetSource());
 
-    // Get the currently selected value from the "host" list property
+    // Get the currently selected host and app
     std::string selectedHost(obs_data_get_string(settings, "host"));
+    int selectedApp = static_cast<int>(obs_data_get_int(settings, "app"));
+    obs_data_release(settings);
 
-    if (!selectedHost.empty())
+    if (selectedHost.empty())
+    {
+        // No host selected, show an error message
+        DisplayMessageBox("Error", obs_module_text("Device.NoDevice"));
+    }
+    else if (selectedApp == 0)
     {
-        // TODO: Implement the connection logic using the selected host
+        // No app selected, show an error message
+        DisplayMessageBox("Error", obs_module_text("App.NoApp"));
     }
     else
     {
-        // No host selected, show an error message
-        DisplayMessageBox("Error", obs_module_text("Device.NoDevice"));
+        // Connect in the background, so the UI isn't held up by the host
+        source->Connect();
     }
 
-    // TODO: Implement the "Connect" button
-
     UNUSED_PARAMETER(props);
     UNUSED_PARAMETER(property);
-    UNUSED_PARAMETER(source);
-    
+
     // Don't repaint the UI
     return false;
 }
@@ -194,9 +383,25 @@ bool Properties::OnRemoveButtonPressed(obs_properties_t* props, obs_property_t*
     // Get the currently selected value from the "host" list property
     std::string selectedHost(obs_data_get_string(settings, "host"));
 
+    bool removed = false;
     if (!selectedHost.empty())
     {
-        // TODO: Implement the unpairing logic
+        // Forget the host, so it has to be paired again before it's streamed from
+        try
+        {
+            removed = PairedHostStore::Remove(selectedHost);
+        }
+        catch (const std::exception& exception)
+        {
+            obs_log(LOG_WARNING, "Failed to unpair host %s: %s", selectedHost.c_str(), exception.what());
+            DisplayMessageBox("Error", obs_module_text("Device.UnpairFailed"));
+        }
+
+        if (removed)
+        {
+            obs_data_set_string(settings, "host", "");
+            ListPairedHosts(obs_properties_get(props, "host"));
+        }
     }
     else
     {
@@ -204,11 +409,12 @@ bool Properties::OnRemoveButtonPressed(obs_properties_t* props, obs_property_t*
         DisplayMessageBox("Error", obs_module_text("Device.NoDevice"));
     }
 
-    UNUSED_PARAMETER(props);
+    obs_data_release(settings);
+
     UNUSED_PARAMETER(property);
 
-    // Don't repaint the UI
-    return false;
+    // Repaint the UI if the host was removed, so the host list no longer shows it
+    return removed;
 }
 
 obs_property_t* Properties::CreateReconnectCheckbox(obs_properties_t* props)
@@ -351,6 +557,137 @@ obs_property_t* Properties::CreateHardwareDecodingCheckbox(obs_properties_t* pro
     return checkbox;
 }
 
+obs_property_t* Properties::CreateDecodeThreadingList(obs_properties_t* props)
+{
+    // Ensure the properties handle is valid
+    assert(props != nullptr);
+
+    // Add combo box for selecting how software decoding is threaded
+    obs_property_t* decodeThreading = obs_properties_add_list(
+        props,
+        "decode_threading",                     // Internal name of the property
+        obs_module_text("DecodeThreading"),     // Label displayed in the UI
+        OBS_COMBO_TYPE_LIST,                    // Combo box type
+        OBS_COMBO_FORMAT_STRING                 // Format as strings
+    );
+
+    // Add options to the combo box
+    obs_property_list_add_string(decodeThreading, obs_module_text("DecodeThreading.Slice"), "slice");
+    obs_property_list_add_string(decodeThreading, obs_module_text("DecodeThreading.Frame"), "frame");
+    obs_property_list_add_string(decodeThreading, obs_module_text("DecodeThreading.SliceAndFrame"), "slice_frame");
+
+    return decodeThreading;
+}
+
+obs_property_t* Properties::CreateDecodeThreadsInput(obs_properties_t* props)
+{
+    // Ensure the properties handle is valid
+    assert(props != nullptr);
+
+    // Create the number input for how many threads to decode with
+    obs_property_t* input = obs_properties_add_int(
+        props,
+        "decode_threads",                       // Internal name of the property
+        obs_module_text("DecodeThreads"),       // Label displayed in the UI
+        0,                                      // Minimum value (automatic)
+        64,                                     // Maximum value
+        1                                       // Step size
+    );
+
+    return input;
+}
+
+obs_property_t* Properties::CreateDecodeSubmissionList(obs_properties_t* props)
+{
+    // Ensure the properties handle is valid
+    assert(props != nullptr);
+
+    // Add combo box for selecting which thread frames are decoded on
+    obs_property_t* decodeSubmission = obs_properties_add_list(
+        props,
+        "decode_submission",                    // Internal name of the property
+        obs_module_text("DecodeSubmission"),    // Label displayed in the UI
+        OBS_COMBO_TYPE_LIST,                    // Combo box type
+        OBS_COMBO_FORMAT_STRING                 // Format as strings
+    );
+
+    // Add options to the combo box
+    obs_property_list_add_string(decodeSubmission, obs_module_text("DecodeSubmission.Queued"), "queued");
+    obs_property_list_add_string(decodeSubmission, obs_module_text("DecodeSubmission.Direct"), "direct");
+
+    return decodeSubmission;
+}
+
+obs_property_t* Properties::CreateToneMapHDRCheckbox(obs_properties_t* props)
+{
+    // Ensure the properties handle is valid
+    assert(props != nullptr);
+
+    // Create the "Stream HDR and tone map it for SDR canvases" checkbox
+    obs_property_t* checkbox = obs_properties_add_bool(
+        props,
+        "tone_map_hdr",                         // Internal name of the property
+        obs_module_text("ToneMapHDR")           // Label displayed in the UI
+    );
+
+    return checkbox;
+}
+
+obs_property_t* Properties::CreateYUV444Checkbox(obs_properties_t* props)
+{
+    // Ensure the properties handle is valid
+    assert(props != nullptr);
+
+    // Create the "Stream 4:4:4 video" checkbox
+    obs_property_t* checkbox = obs_properties_add_bool(
+        props,
+        "yuv444",                               // Internal name of the property
+        obs_module_text("YUV444")               // Label displayed in the UI
+    );
+
+    return checkbox;
+}
+
+obs_property_t* Properties::CreateFramePacingList(obs_properties_t* props)
+{
+    // Ensure the properties handle is valid
+    assert(props != nullptr);
+
+    // Add combo box for selecting how frames are paced out to OBS
+    obs_property_t* framePacing = obs_properties_add_list(
+        props,
+        "frame_pacing",                         // Internal name of the property
+        obs_module_text("FramePacing"),         // Label displayed in the UI
+        OBS_COMBO_TYPE_LIST,                    // Combo box type
+        OBS_COMBO_FORMAT_STRING                 // Format as strings
+    );
+
+    // Add options to the combo box
+    obs_property_list_add_string(framePacing, obs_module_text("FramePacing.LowestLatency"), "lowest");
+    obs_property_list_add_string(framePacing, obs_module_text("FramePacing.Smooth"), "smooth");
+    obs_property_list_add_string(framePacing, obs_module_text("FramePacing.FixedDelay"), "fixed");
+
+    return framePacing;
+}
+
+obs_property_t* Properties::CreatePacingDelayInput(obs_properties_t* props)
+{
+    // Ensure the properties handle is valid
+    assert(props != nullptr);
+
+    // Create the number input for the delay of the fixed delay pacing
+    obs_property_t* input = obs_properties_add_int(
+        props,
+        "pacing_delay",                         // Internal name of the property
+        obs_module_text("PacingDelay"),         // Label displayed in the UI
+        0,                                      // Minimum value
+        1000,                                   // Maximum value
+        10                                      // Step size
+    );
+
+    return input;
+}
+
 obs_property_t* Properties::CreateAudioModeList(obs_properties_t* props)
 {
     // Ensure the properties handle is valid
@@ -373,6 +710,24 @@ obs_property_t* Properties::CreateAudioModeList(obs_properties_t* props)
     return audioMode;
 }
 
+obs_property_t* Properties::CreateInactiveTimeoutInput(obs_properties_t* props)
+{
+    // Ensure the properties handle is valid
+    assert(props != nullptr);
+
+    // Create the number input for how long the source may be inactive before disconnecting
+    obs_property_t* input = obs_properties_add_int(
+        props,
+        "inactive_timeout",                     // Internal name of the property
+        obs_module_text("InactiveTimeout"),     // Label displayed in the UI
+        0,                                      // Minimum value (never disconnect)
+        3600,                                   // Maximum value
+        5                                       // Step size
+    );
+
+    return input;
+}
+
 void Properties::DisplayMessageBox(std::string title, std::string message)
 {
     // Ensure arguments are valid
@@ -23,8 +23,10 @@ namespace MoonlightOBS
         /**
          * @brief Construct a new Properties object
          * 
+         * @param source The source the properties belong to, kept as the parameter of the
+         *               properties so their callbacks are able to reach it.
          */
-        Properties();
+        Properties(OBSSource* source);
         /**
          * @brief Destroy the Properties object
          * 
@@ -48,11 +50,26 @@ namespace MoonlightOBS
         // "Device" combo box
         obs_property_t* m_hostList;
         static obs_property_t* CreateHostListProperty(obs_properties_t* props);
+        static bool OnHostChanged(obs_properties_t* props, obs_property_t* property, obs_data_t* settings);
+        static void ListPairedHosts(obs_property_t* property);
+
+        // "App" combo box
+        obs_property_t* m_appList;
+        static obs_property_t* CreateAppListProperty(obs_properties_t* props);
+
+        // "Choose App" button
+        obs_property_t* m_chooseAppButton;
+        static obs_property_t* CreateChooseAppButton(obs_properties_t* props);
+        static bool OnChooseAppButtonPressed(obs_properties_t* props, obs_property_t* property, OBSSource* source);
 
         // Connection status text property
         obs_property_t* m_connectionStatus;
         static obs_property_t* CreateConnectionStatusProperty(obs_properties_t* props);
 
+        // Connection stage times text property
+        obs_property_t* m_connectionStats;
+        static obs_property_t* CreateConnectionStatsProperty(obs_properties_t* props);
+
         // "Connect" button
         obs_property_t* m_connectButton;
         static obs_property_t* CreateConnectButton(obs_properties_t* props);
@@ -93,10 +110,42 @@ namespace MoonlightOBS
         obs_property_t* m_hardwareDecodingCheckbox;
         static obs_property_t* CreateHardwareDecodingCheckbox(obs_properties_t* props);
 
+        // "Decode Threading" combo box
+        obs_property_t* m_decodeThreadingList;
+        static obs_property_t* CreateDecodeThreadingList(obs_properties_t* props);
+
+        // "Decode Threads" number input
+        obs_property_t* m_decodeThreadsInput;
+        static obs_property_t* CreateDecodeThreadsInput(obs_properties_t* props);
+
+        // "Decode Submission" combo box
+        obs_property_t* m_decodeSubmissionList;
+        static obs_property_t* CreateDecodeSubmissionList(obs_properties_t* props);
+
+        // "Stream HDR and tone map it for SDR canvases" checkbox
+        obs_property_t* m_toneMapHDRCheckbox;
+        static obs_property_t* CreateToneMapHDRCheckbox(obs_properties_t* props);
+
+        // "Stream 4:4:4 video" checkbox
+        obs_property_t* m_yuv444Checkbox;
+        static obs_property_t* CreateYUV444Checkbox(obs_properties_t* props);
+
+        // "Frame Pacing" combo box
+        obs_property_t* m_framePacingList;
+        static obs_property_t* CreateFramePacingList(obs_properties_t* props);
+
+        // "Pacing Delay" number input
+        obs_property_t* m_pacingDelayInput;
+        static obs_property_t* CreatePacingDelayInput(obs_properties_t* props);
+
         // "Audio Output Mode" combo box
         obs_property_t* m_audioModeList;
         static obs_property_t* CreateAudioModeList(obs_properties_t* props);
 
+        // "Disconnect after inactive for" number input
+        obs_property_t* m_inactiveTimeoutInput;
+        static obs_property_t* CreateInactiveTimeoutInput(obs_properties_t* props);
+
         // Displays a message box with the given title and message
         static void DisplayMessageBox(std::string title, std::string message);
     };
@@ -0,0 +1,668 @@
+#include "ConnectionOrchestrator.hpp"
+
+// STL includes
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// OpenSSL includes
+#include <openssl/rand.h>
+
+// OBS Studio includes
+#include <util/base.h>
+#include <util/platform.h>
+
+// Project includes
+#include "../plugin-support.h"
+#include "../Connections/ClientIdentity.hpp"
+#include "../Connections/HostFeatures.hpp"
+#include "../Connections/HostSettings.hpp"
+#include "../Connections/HostSettingsSnapshot.hpp"
+#include "../Connections/HTTPClient.hpp"
+#include "../Connections/PairedHostStore.hpp"
+#include "../Utilities/Version.hpp"
+#include "ConnectionStatistics.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // How long an address may take to respond to /serverinfo
+    // (an address which accepts the connection but never responds would otherwise hold up connecting)
+    constexpr long ServerInfoTimeoutMs = 5000;
+
+    // Size of the packets of the video stream
+    // (moonlight-common-c lowers it when it detects the host is remote)
+    constexpr int PacketSize = 1392;
+
+    // The connection which owns the global state of moonlight-common-c, if any
+    std::atomic<ConnectionOrchestrator*> g_activeConnection(nullptr);
+
+    // The address of a host which responded first to /serverinfo, and the settings it responded with
+    struct HostRace
+    {
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::optional<std::pair<Address, HostSettings>> winner;
+        size_t pending = 0;
+        std::string errors;
+    };
+
+    // Formats a version as moonlight-common-c parses it
+    // (keeping the revision of -1 which identifies Sunshine hosts, which Version::ToString omits)
+    std::string FormatVersion(const Version& version)
+    {
+        return version.ToString() + (!version.IsUnknown() && version.GetRevision() < 0 ? ".-1" : "");
+    }
+}
+
+ConnectionOrchestrator::ConnectionOrchestrator(const StreamConfig& config, const StreamCallbacks& callbacks)
+    : m_config(config), m_callbacks(callbacks), m_hostname(config.uniqueID), m_interrupted(false), m_cancelRequests(false),
+      m_connected(false), m_decodingPaused(false), m_waitingForIDR(false), m_pulling(false)
+{
+    // Forward the decoder callbacks, so the first frame can be timestamped
+    if (m_callbacks.decoder != nullptr)
+    {
+        m_decoder = *m_callbacks.decoder;
+    }
+    else
+    {
+        LiInitializeVideoCallbacks(&m_decoder);
+    }
+    m_decoder.submitDecodeUnit = OnSubmitDecodeUnit;
+    if ((m_decoder.capabilities & CAPABILITY_PULL_RENDERER) != 0)
+    {
+        m_decoder.start = OnStart;
+        m_decoder.stop = OnStop;
+    }
+
+    // Forward the listener callbacks, so the stages of moonlight-common-c can be timestamped
+    if (m_callbacks.listener != nullptr)
+    {
+        m_listener = *m_callbacks.listener;
+    }
+    else
+    {
+        LiInitializeConnectionCallbacks(&m_listener);
+    }
+    m_listener.stageStarting = OnStageStarting;
+    m_listener.stageComplete = OnStageComplete;
+    m_listener.stageFailed = OnStageFailed;
+    m_listener.connectionStarted = OnConnectionStarted;
+    m_listener.connectionTerminated = OnConnectionTerminated;
+}
+
+ConnectionOrchestrator::~ConnectionOrchestrator()
+{
+    Disconnect();
+    JoinBackgroundThreads();
+
+    // moonlight-common-c stops the video stream when it disconnects, but the pull thread mustn't outlive this
+    if (m_pullThread.joinable())
+    {
+        m_pulling = false;
+        LiWakeWaitForVideoFrame();
+        m_pullThread.join();
+    }
+}
+
+void ConnectionOrchestrator::Connect()
+{
+    // Claim the global state of moonlight-common-c
+    ConnectionOrchestrator* expected = nullptr;
+    if (!g_activeConnection.compare_exchange_strong(expected, this))
+    {
+        throw std::runtime_error("Another stream is already connected");
+    }
+
+    // Time the connection from now, as it may have waited for another one to finish
+    m_timeline.Reset();
+
+    std::optional<PairedHost> host;
+    std::optional<std::pair<Address, HostSettings>> reached;
+    try
+    {
+        host = PairedHostStore::Find(m_config.uniqueID);
+        if (!host.has_value())
+        {
+            throw std::runtime_error("Host is not paired");
+        }
+        m_hostname = host->GetHost().GetHostname();
+
+        // Warm up the decoder while the host is contacted, as neither depends on the other
+        std::future<void> decoderReady = std::async(std::launch::async, [this]()
+        {
+            if (m_callbacks.prepareDecoder)
+            {
+                m_callbacks.prepareDecoder();
+            }
+            m_timeline.Mark(ConnectionStep::DecoderReady);
+        });
+
+        // The identity is loaded in the background when the module loads, so this rarely waits
+        ClientIdentity::Get();
+        m_timeline.Mark(ConnectionStep::IdentityReady);
+
+        reached.emplace(ReachHost(*host));
+        m_timeline.Mark(ConnectionStep::HostReached);
+        ThrowIfInterrupted();
+
+        const Address& address = reached->first;
+        const HostSettings& settings = reached->second;
+
+        STREAM_CONFIGURATION streamConfig;
+        LiInitializeStreamConfiguration(&streamConfig);
+        streamConfig.width                  = static_cast<int>(m_config.width);
+        streamConfig.height                 = static_cast<int>(m_config.height);
+        streamConfig.fps                    = static_cast<int>(m_config.fps);
+        streamConfig.bitrate                = static_cast<int>(m_config.bitrate);
+        streamConfig.packetSize             = PacketSize;
+        streamConfig.streamingRemotely      = STREAM_CFG_AUTO;
+        streamConfig.audioConfiguration     = AUDIO_CONFIGURATION_STEREO;
+        streamConfig.supportedVideoFormats  = m_callbacks.supportedVideoFormats & HostFeatures::GetVideoFormats(settings);
+        streamConfig.clientRefreshRateX100  = static_cast<int>(m_config.fps * 100);
+        streamConfig.encryptionFlags        = ENCFLG_AUDIO;
+
+        // Generate the key encrypting the input sent to the host
+        if (RAND_bytes(reinterpret_cast<unsigned char*>(streamConfig.remoteInputAesKey), sizeof(streamConfig.remoteInputAesKey)) != 1 ||
+            RAND_bytes(reinterpret_cast<unsigned char*>(streamConfig.remoteInputAesIv), sizeof(streamConfig.remoteInputAesIv)) != 1)
+        {
+            throw std::runtime_error("Failed to generate the remote input key");
+        }
+
+        LogUnsupportedFeatures(settings);
+
+        std::string rtspSessionUrl = StartApp(*host, address, settings, streamConfig);
+        m_timeline.Mark(ConnectionStep::AppStarted);
+
+        // The decoder is set up while the streams start, so it must be ready first
+        decoderReady.get();
+        ThrowIfInterrupted();
+
+        StartStreams(address, settings, rtspSessionUrl, streamConfig);
+        m_timeline.Mark(ConnectionStep::StreamStarted);
+        m_connected = true;
+
+        // Stop the streams if connecting was interrupted while they were starting
+        ThrowIfInterrupted();
+    }
+    catch (...)
+    {
+        if (m_connected)
+        {
+            Disconnect();
+        }
+        else
+        {
+            g_activeConnection.store(nullptr);
+        }
+        JoinBackgroundThreads();
+        m_timeline.Log(m_hostname);
+        throw;
+    }
+
+    obs_log(LOG_INFO, "Started streaming from %s in %llu ms", m_hostname.c_str(),
+        static_cast<unsigned long long>(m_timeline.GetElapsed(ConnectionStep::StreamStarted).value_or(0) / 1000000));
+
+    // Keep the settings of the host current, so they're up to date for the next connection
+    // (this is done once the streams have started, so it doesn't delay the first frame)
+    HostSettingsSnapshot snapshot(reached->second);
+
+    // The running app and the busy state change with every stream, so they alone aren't saved
+    HostSettingsChanges changes = host->GetSettings().Diff(snapshot);
+    changes.reset(static_cast<size_t>(HostSettingsField::CurrentGame));
+    changes.reset(static_cast<size_t>(HostSettingsField::HostState));
+    if (changes.any())
+    {
+        obs_log(LOG_INFO, "Saving the changed settings of %s: %s", m_hostname.c_str(),
+            HostSettingsSnapshot::FormatChanges(changes).c_str());
+        host->SetSettings(snapshot);
+        try
+        {
+            PairedHostStore::Save(*host);
+        }
+        catch (const std::exception& exception)
+        {
+            obs_log(LOG_WARNING, "Failed to save the settings of %s: %s", m_hostname.c_str(), exception.what());
+        }
+    }
+}
+
+void ConnectionOrchestrator::Interrupt()
+{
+    m_interrupted = true;
+    m_cancelRequests = true;
+
+    // Only interrupt moonlight-common-c if it's connecting for this connection
+    if (g_activeConnection.load() == this)
+    {
+        LiInterruptConnection();
+    }
+}
+
+void ConnectionOrchestrator::SetDecodingPaused(bool paused)
+{
+    bool wasPaused = m_decodingPaused.exchange(paused);
+    if (wasPaused && !paused)
+    {
+        // Resume from an IDR frame rather than waiting for the host to send one
+        m_waitingForIDR = true;
+        if (m_connected)
+        {
+            LiRequestIdrFrame();
+        }
+    }
+}
+
+void ConnectionOrchestrator::Disconnect()
+{
+    if (!m_connected)
+    {
+        return;
+    }
+
+    LiStopConnection();
+    m_connected = false;
+    g_activeConnection.store(nullptr);
+
+    obs_log(LOG_INFO, "Stopped streaming from %s", m_hostname.c_str());
+}
+
+std::pair<Address, HostSettings> ConnectionOrchestrator::ReachHost(const PairedHost& host)
+{
+    std::vector<Address> addresses;
+    for (const Address& address : { host.GetHost().GetIPv4Address(), host.GetHost().GetIPv6Address() })
+    {
+        if (!address.IsEmpty())
+        {
+            addresses.push_back(address);
+        }
+    }
+    if (addresses.empty())
+    {
+        throw std::runtime_error("Host has no known address");
+    }
+
+    // Request /serverinfo from every address at once, so an address which can't be reached
+    // (such as a stale IPv6 address) costs nothing unless every address is unreachable
+    std::shared_ptr<HostRace> race = std::make_shared<HostRace>();
+    race->pending = addresses.size();
+    for (const Address& address : addresses)
+    {
+        m_backgroundThreads.emplace_back([this, race, address, host]()
+        {
+            os_set_thread_name("moonlight-obs: reach host");
+
+            std::string error;
+            try
+            {
+                HTTPClient client(address, host);
+                client.SetTimeout(ServerInfoTimeoutMs);
+                client.SetCancelFlag(&m_cancelRequests);
+                HostSettings settings = client.GetServerInfo();
+
+                // The address may have been reassigned to another host since it was last seen
+                if (settings.GetUniqueID() != host.GetUniqueID())
+                {
+                    throw std::runtime_error("A different host responded");
+                }
+
+                std::lock_guard<std::mutex> lock(race->mutex);
+                if (!race->winner.has_value())
+                {
+                    race->winner.emplace(address, std::move(settings));
+                }
+            }
+            catch (const std::exception& exception)
+            {
+                error = address.GetString() + ": " + exception.what();
+            }
+
+            std::lock_guard<std::mutex> lock(race->mutex);
+            if (!error.empty())
+            {
+                race->errors.append(race->errors.empty() ? "" : "; ").append(error);
+            }
+            race->pending--;
+            race->finished.notify_all();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(race->mutex);
+    race->finished.wait(lock, [&race]()
+    {
+        return race->winner.has_value() || race->pending == 0;
+    });
+
+    // Abort the requests to the other addresses rather than waiting for them to respond
+    m_cancelRequests = true;
+    ThrowIfInterrupted();
+
+    if (!race->winner.has_value())
+    {
+        throw std::runtime_error("Failed to reach host: " + race->errors);
+    }
+
+    return *race->winner;
+}
+
+std::string ConnectionOrchestrator::StartApp(const PairedHost& host, const Address& address, const HostSettings& settings,
+    const STREAM_CONFIGURATION& streamConfig)
+{
+    LaunchParameters parameters;
+    parameters.appID                = m_config.appID;
+    parameters.width                = m_config.width;
+    parameters.height               = m_config.height;
+    parameters.fps                  = m_config.fps;
+    parameters.surroundAudioInfo    = SURROUNDAUDIOINFO_FROM_AUDIO_CONFIGURATION(streamConfig.audioConfiguration);
+    parameters.hdr                  = (streamConfig.supportedVideoFormats & VIDEO_FORMAT_MASK_10BIT) != 0 &&
+                                      HostFeatures::Supports(settings, HostFeature::HDR);
+    std::memcpy(parameters.remoteInputKey.data(), streamConfig.remoteInputAesKey, parameters.remoteInputKey.size());
+
+    // The ID of the key is the first 4 bytes of the IV, in big-endian order
+    const unsigned char* iv = reinterpret_cast<const unsigned char*>(streamConfig.remoteInputAesIv);
+    parameters.remoteInputKeyID = static_cast<int32_t>((static_cast<uint32_t>(iv[0]) << 24) |
+        (static_cast<uint32_t>(iv[1]) << 16) | (static_cast<uint32_t>(iv[2]) << 8) | static_cast<uint32_t>(iv[3]));
+
+    // Resume the TLS session of the /serverinfo request
+    HTTPClient client(address, host);
+
+    // Resuming the app skips launching it again, which can take seconds
+    int currentGame = settings.GetCurrentGame();
+    if (currentGame == m_config.appID)
+    {
+        obs_log(LOG_INFO, "Resuming app %d on %s", m_config.appID, m_hostname.c_str());
+        return client.Resume(parameters);
+    }
+
+    // Another app must be quit before this one is launched
+    if (currentGame != 0)
+    {
+        obs_log(LOG_INFO, "Quitting app %d on %s to launch app %d", currentGame, m_hostname.c_str(), m_config.appID);
+        client.Cancel();
+        ThrowIfInterrupted();
+    }
+
+    obs_log(LOG_INFO, "Launching app %d on %s", m_config.appID, m_hostname.c_str());
+    return client.Launch(parameters);
+}
+
+void ConnectionOrchestrator::StartStreams(const Address& address, const HostSettings& settings,
+    const std::string& rtspSessionUrl, STREAM_CONFIGURATION& streamConfig)
+{
+    std::array<char, Address::MaxStringSize> host;
+    if (address.Format(host.data(), host.size(), Address::FormatOmitPort) == 0)
+    {
+        throw std::runtime_error("Failed to format the address of the host");
+    }
+
+    std::string appVersion = FormatVersion(settings.GetAppVersion());
+    std::string gfeVersion = FormatVersion(settings.GetGFEVersion());
+
+    SERVER_INFORMATION serverInfo;
+    LiInitializeServerInformation(&serverInfo);
+    serverInfo.address                  = host.data();
+    serverInfo.serverInfoAppVersion     = appVersion.c_str();
+    serverInfo.serverInfoGfeVersion     = !settings.GetGFEVersion().IsUnknown() ? gfeVersion.c_str() : nullptr;
+    serverInfo.rtspSessionUrl           = !rtspSessionUrl.empty() ? rtspSessionUrl.c_str() : nullptr;
+    serverInfo.serverCodecModeSupport   = settings.GetServerCodecModeSupport();
+
+    int result = LiStartConnection(&serverInfo, &streamConfig, &m_listener, &m_decoder, m_callbacks.audio,
+        m_callbacks.decoderContext, m_callbacks.decoderFlags, m_callbacks.audioContext, m_callbacks.audioFlags);
+    if (result != 0)
+    {
+        throw std::runtime_error("Failed to start the streams (error " + std::to_string(result) + ")");
+    }
+}
+
+void ConnectionOrchestrator::LogUnsupportedFeatures(const HostSettings& settings) const
+{
+    // Video formats of each feature, and its name for logging
+    struct FeatureFormats
+    {
+        HostFeature feature;
+        int formats;
+        const char* name;
+    };
+    constexpr std::array<FeatureFormats, 3> Features =
+    {{
+        { HostFeature::HDR,     VIDEO_FORMAT_MASK_10BIT,    "HDR" },
+        { HostFeature::YUV444,  VIDEO_FORMAT_MASK_YUV444,   "4:4:4" },
+        { HostFeature::AV1,     VIDEO_FORMAT_MASK_AV1,      "AV1" }
+    }};
+
+    for (const FeatureFormats& feature : Features)
+    {
+        if ((m_callbacks.supportedVideoFormats & feature.formats) != 0 && !HostFeatures::Supports(settings, feature.feature))
+        {
+            obs_log(LOG_INFO, "%s doesn't support streaming %s, so it's disabled", m_hostname.c_str(), feature.name);
+        }
+    }
+}
+
+void ConnectionOrchestrator::ThrowIfInterrupted() const
+{
+    if (m_interrupted)
+    {
+        throw std::runtime_error("Connecting was interrupted");
+    }
+}
+
+void ConnectionOrchestrator::JoinBackgroundThreads()
+{
+    m_cancelRequests = true;
+    for (std::thread& thread : m_backgroundThreads)
+    {
+        thread.join();
+    }
+    m_backgroundThreads.clear();
+}
+
+void ConnectionOrchestrator::PullFrames()
+{
+    os_set_thread_name("moonlight-obs: receive");
+
+    while (m_pulling.load(std::memory_order_relaxed))
+    {
+        // Returns false once woken by OnStop, or when the stream ends
+        VIDEO_FRAME_HANDLE handle = nullptr;
+        PDECODE_UNIT decodeUnit = nullptr;
+        if (!LiWaitForNextVideoFrame(&handle, &decodeUnit))
+        {
+            break;
+        }
+
+        LiCompleteVideoFrame(handle, OnSubmitDecodeUnit(decodeUnit));
+    }
+}
+
+void ConnectionOrchestrator::OnStart()
+{
+    ConnectionOrchestrator* connection = g_activeConnection.load(std::memory_order_acquire);
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    // Start the decoder before frames are pulled for it
+    DECODER_RENDERER_CALLBACKS* decoder = connection->m_callbacks.decoder;
+    if (decoder != nullptr && decoder->start != nullptr)
+    {
+        decoder->start();
+    }
+
+    connection->m_pulling = true;
+    connection->m_pullThread = std::thread(&ConnectionOrchestrator::PullFrames, connection);
+}
+
+void ConnectionOrchestrator::OnStop()
+{
+    ConnectionOrchestrator* connection = g_activeConnection.load(std::memory_order_acquire);
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    if (connection->m_pullThread.joinable())
+    {
+        connection->m_pulling = false;
+        LiWakeWaitForVideoFrame();
+        connection->m_pullThread.join();
+    }
+
+    DECODER_RENDERER_CALLBACKS* decoder = connection->m_callbacks.decoder;
+    if (decoder != nullptr && decoder->stop != nullptr)
+    {
+        decoder->stop();
+    }
+}
+
+int ConnectionOrchestrator::OnSubmitDecodeUnit(PDECODE_UNIT decodeUnit)
+{
+    // moonlight-common-c has no context for its callbacks, but only one connection is active at a time
+    ConnectionOrchestrator* connection = g_activeConnection.load(std::memory_order_acquire);
+    if (connection == nullptr)
+    {
+        return DR_OK;
+    }
+
+    // Drop frames while decoding is paused, and after resuming until an IDR frame arrives
+    if (connection->m_decodingPaused.load(std::memory_order_relaxed))
+    {
+        return DR_OK;
+    }
+    if (connection->m_waitingForIDR.load(std::memory_order_relaxed))
+    {
+        if (decodeUnit->frameType != FRAME_TYPE_IDR)
+        {
+            return DR_OK;
+        }
+        connection->m_waitingForIDR = false;
+    }
+
+    DECODER_RENDERER_CALLBACKS* decoder = connection->m_callbacks.decoder;
+    int result = decoder != nullptr && decoder->submitDecodeUnit != nullptr ? decoder->submitDecodeUnit(decodeUnit) : DR_OK;
+
+    if (result == DR_OK && !connection->m_timeline.GetElapsed(ConnectionStep::FirstFrame).has_value())
+    {
+        connection->m_timeline.Mark(ConnectionStep::FirstFrame);
+        connection->m_timeline.Log(connection->m_hostname);
+        ConnectionStatistics::RecordFirstFrame(connection->m_config.uniqueID, connection->m_hostname,
+            connection->m_timeline);
+    }
+
+    return result;
+}
+
+void ConnectionOrchestrator::OnStageStarting(int stage)
+{
+    ConnectionOrchestrator* connection = g_activeConnection.load(std::memory_order_acquire);
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    connection->m_timeline.MarkStageStarting(stage);
+
+    CONNECTION_LISTENER_CALLBACKS* listener = connection->m_callbacks.listener;
+    if (listener != nullptr && listener->stageStarting != nullptr)
+    {
+        listener->stageStarting(stage);
+    }
+}
+
+void ConnectionOrchestrator::OnStageComplete(int stage)
+{
+    ConnectionOrchestrator* connection = g_activeConnection.load(std::memory_order_acquire);
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    connection->m_timeline.MarkStageComplete(stage);
+
+    CONNECTION_LISTENER_CALLBACKS* listener = connection->m_callbacks.listener;
+    if (listener != nullptr && listener->stageComplete != nullptr)
+    {
+        listener->stageComplete(stage);
+    }
+}
+
+void ConnectionOrchestrator::OnStageFailed(int stage, int errorCode)
+{
+    ConnectionOrchestrator* connection = g_activeConnection.load(std::memory_order_acquire);
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    obs_log(LOG_WARNING, "Connecting to %s failed at stage '%s' (error %d)", connection->m_hostname.c_str(),
+        LiGetStageName(stage), errorCode);
+
+    CONNECTION_LISTENER_CALLBACKS* listener = connection->m_callbacks.listener;
+    if (listener != nullptr && listener->stageFailed != nullptr)
+    {
+        listener->stageFailed(stage, errorCode);
+    }
+}
+
+void ConnectionOrchestrator::OnConnectionStarted()
+{
+    ConnectionOrchestrator* connection = g_activeConnection.load(std::memory_order_acquire);
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    connection->m_timeline.Mark(ConnectionStep::Connected);
+    ConnectionStatistics::RecordConnected(connection->m_config.uniqueID, connection->m_hostname,
+        connection->m_timeline);
+
+    CONNECTION_LISTENER_CALLBACKS* listener = connection->m_callbacks.listener;
+    if (listener != nullptr && listener->connectionStarted != nullptr)
+    {
+        listener->connectionStarted();
+    }
+}
+
+void ConnectionOrchestrator::OnConnectionTerminated(int errorCode)
+{
+    ConnectionOrchestrator* connection = g_activeConnection.load(std::memory_order_acquire);
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    if (errorCode == ML_ERROR_GRACEFUL_TERMINATION)
+    {
+        obs_log(LOG_INFO, "%s ended the stream", connection->m_hostname.c_str());
+    }
+    else
+    {
+        obs_log(LOG_ERROR, "The stream from %s was terminated (error %d)", connection->m_hostname.c_str(), errorCode);
+    }
+
+    CONNECTION_LISTENER_CALLBACKS* listener = connection->m_callbacks.listener;
+    if (listener != nullptr && listener->connectionTerminated != nullptr)
+    {
+        listener->connectionTerminated(errorCode);
+    }
+
+    // LiStopConnection waits for this thread, so the owner disconnects from one of its own
+    if (connection->m_callbacks.terminated)
+    {
+        connection->m_callbacks.terminated(errorCode);
+    }
+}
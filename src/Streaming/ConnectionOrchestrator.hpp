@@ -0,0 +1,219 @@
+#pragma once
+
+// STL includes
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// moonlight-common-c includes
+#include <Limelight.h>
+
+// Project includes
+#include "../Connections/Address.hpp"
+#include "../Connections/HostSettings.hpp"
+#include "../Connections/PairedHost.hpp"
+#include "ConnectionTimeline.hpp"
+#include "StreamConfig.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief The callbacks moonlight-common-c streams to, and how to prepare them.
+     * @note Callbacks which are null are replaced by moonlight-common-c with ones which do nothing.
+     *
+     */
+    struct StreamCallbacks
+    {
+        DECODER_RENDERER_CALLBACKS* decoder     = nullptr;              // Receives the video stream
+        void* decoderContext                    = nullptr;              // Passed to the setup callback of the decoder
+        int decoderFlags                        = 0;                    // Passed to the setup callback of the decoder
+        int supportedVideoFormats               = VIDEO_FORMAT_H264;    // VIDEO_FORMAT_* values the decoder supports
+        AUDIO_RENDERER_CALLBACKS* audio         = nullptr;              // Receives the audio stream
+        void* audioContext                      = nullptr;              // Passed to the init callback of the audio renderer
+        int audioFlags                          = 0;                    // Passed to the init callback of the audio renderer
+        CONNECTION_LISTENER_CALLBACKS* listener = nullptr;              // Receives the progress and state of the connection
+        std::function<void()> prepareDecoder;                           // Warms up the decoder while the host is contacted
+        std::function<void(int errorCode)> terminated;                  // Told when the streams end, on a thread of moonlight-common-c
+    };
+
+    /**
+     * @brief Connects to a paired host, taking as little time as possible until the first frame.
+     *
+     * Steps which don't depend on each other run concurrently: the decoder is warmed up while
+     * /serverinfo is requested from every address of the host at once (the first to respond wins),
+     * over the TLS session shared with the other requests to the host. The app is resumed rather
+     * than relaunched if the host reports it's already running, and each step is timestamped
+     * in a ConnectionTimeline (along with the stages reported by moonlight-common-c), which is
+     * added to the ConnectionStatistics of the host once moonlight-common-c reports the
+     * connection as started, and logged once the first frame arrives.
+     *
+     * When the decoder runs as a pull renderer, the frames are pulled from moonlight-common-c on
+     * a thread started with the video stream, and passed to the decoder as if they were submitted.
+     *
+     * When the host ends the streams (or they're lost), the terminated callback is told so the
+     * owner can disconnect; this can't be done from the thread reporting it, as disconnecting
+     * waits for that thread to finish.
+     *
+     * moonlight-common-c keeps its connection state in globals, so only one connection
+     * can be started per process at a time.
+     *
+     */
+    class ConnectionOrchestrator
+    {
+    public:
+        /**
+         * @brief Construct a new ConnectionOrchestrator object.
+         *
+         * @param config The host, app and stream parameters to stream with.
+         * @param callbacks The callbacks to stream to, which must outlive the connection.
+         */
+        ConnectionOrchestrator(const StreamConfig& config, const StreamCallbacks& callbacks);
+
+        /**
+         * @brief Disconnects from the host, if connected.
+         *
+         */
+        ~ConnectionOrchestrator();
+
+        ConnectionOrchestrator(const ConnectionOrchestrator&)               = delete;
+        ConnectionOrchestrator& operator=(const ConnectionOrchestrator&)    = delete;
+
+        /**
+         * @brief Connects to the host, returning once the streams have started.
+         * @note Blocks for as long as connecting takes, so it shouldn't be called on the UI or graphics threads.
+         *
+         * @exception std::runtime_error If the host isn't paired or can't be reached, the app can't be started,
+         *            the streams can't be started, another connection is active, or connecting was interrupted.
+         */
+        void Connect();
+
+        /**
+         * @brief Aborts connecting, making Connect throw as soon as possible.
+         * @note May be called from any thread.
+         *
+         */
+        void Interrupt();
+
+        /**
+         * @brief Stops the streams, if they were started.
+         *
+         */
+        void Disconnect();
+
+        /**
+         * @brief Pauses or resumes decoding, without stopping the streams.
+         * @note While paused, frames are dropped before they reach the decoder. On resuming,
+         *       an IDR frame is requested and frames are dropped until it arrives, as the frames
+         *       before it reference frames which weren't decoded. May be called from any thread.
+         *
+         * @param paused Should decoding be paused?
+         */
+        void SetDecodingPaused(bool paused);
+
+        /**
+         * @brief Checks if the streams have been started.
+         *
+         * @return true If connected.
+         * @return false If not connected.
+         */
+        inline bool IsConnected() const
+        {
+            return m_connected;
+        }
+
+        /**
+         * @brief Gets the timestamps of the steps of connecting.
+         *
+         * @return const ConnectionTimeline& The timeline of the connection.
+         */
+        inline const ConnectionTimeline& GetTimeline() const
+        {
+            return m_timeline;
+        }
+
+        /**
+         * @brief Gets the host, app and stream parameters streamed with.
+         *
+         * @return const StreamConfig& The config of the stream.
+         */
+        inline const StreamConfig& GetConfig() const
+        {
+            return m_config;
+        }
+
+    private:
+        // Host, app and stream parameters
+        StreamConfig m_config;
+        // Callbacks the streams are passed to
+        StreamCallbacks m_callbacks;
+        // Decoder and listener callbacks given to moonlight-common-c, which forward to those of m_callbacks
+        DECODER_RENDERER_CALLBACKS m_decoder;
+        CONNECTION_LISTENER_CALLBACKS m_listener;
+
+        // When each step of connecting completed
+        ConnectionTimeline m_timeline;
+        // Hostname of the host, for logging
+        std::string m_hostname;
+
+        // Has connecting been interrupted?
+        std::atomic<bool> m_interrupted;
+        // Have the /serverinfo requests still in progress been cancelled?
+        std::atomic<bool> m_cancelRequests;
+        // Have the streams been started?
+        std::atomic<bool> m_connected;
+        // Is decoding paused?
+        std::atomic<bool> m_decodingPaused;
+        // Are frames being dropped until the next IDR frame?
+        std::atomic<bool> m_waitingForIDR;
+
+        // Thread pulling frames from moonlight-common-c, if the decoder is a pull renderer
+        std::thread m_pullThread;
+        // Is the pull thread running?
+        std::atomic<bool> m_pulling;
+
+        // Threads requesting /serverinfo from the addresses which didn't respond first,
+        // whose requests are cancelled once an address responds (they're joined when destroyed)
+        std::vector<std::thread> m_backgroundThreads;
+
+        // Requests /serverinfo from every address of the host at once,
+        // returning the address which responded first and its settings
+        std::pair<Address, HostSettings> ReachHost(const PairedHost& host);
+        // Starts (or resumes) the app on the host, returning the RTSP session URL
+        std::string StartApp(const PairedHost& host, const Address& address, const HostSettings& settings,
+            const STREAM_CONFIGURATION& streamConfig);
+        // Starts the streams with moonlight-common-c
+        void StartStreams(const Address& address, const HostSettings& settings, const std::string& rtspSessionUrl,
+            STREAM_CONFIGURATION& streamConfig);
+
+        // Logs the features the decoder supports which the host doesn't, so they won't be streamed
+        void LogUnsupportedFeatures(const HostSettings& settings) const;
+        // Throws if connecting has been interrupted
+        void ThrowIfInterrupted() const;
+        // Cancels the requests of the threads still requesting /serverinfo, and waits for them
+        void JoinBackgroundThreads();
+
+        // Pulls frames from moonlight-common-c and submits them (runs on m_pullThread)
+        void PullFrames();
+
+        // DECODER_RENDERER_CALLBACKS.start and .stop of pull renderers, starting and stopping
+        // the pull thread around forwarding them
+        static void OnStart();
+        static void OnStop();
+        // DECODER_RENDERER_CALLBACKS.submitDecodeUnit, marking the first frame before forwarding it
+        static int OnSubmitDecodeUnit(PDECODE_UNIT decodeUnit);
+        // CONNECTION_LISTENER_CALLBACKS.stageStarting, .stageComplete and .stageFailed,
+        // timestamping the stage before forwarding it
+        static void OnStageStarting(int stage);
+        static void OnStageComplete(int stage);
+        static void OnStageFailed(int stage, int errorCode);
+        // CONNECTION_LISTENER_CALLBACKS.connectionStarted, timestamping the connection and
+        // recording its stages before forwarding it
+        static void OnConnectionStarted();
+        // CONNECTION_LISTENER_CALLBACKS.connectionTerminated, logging and forwarding it
+        static void OnConnectionTerminated(int errorCode);
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,197 @@
+#include "ConnectionStatistics.hpp"
+
+// STL includes
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// moonlight-common-c includes
+#include <Limelight.h>
+
+// OBS Studio includes
+#include <util/base.h>
+
+// Project includes
+#include "../plugin-support.h"
+#include "ConnectionTimeline.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // The stages histograms are kept for: reaching the host and starting the app,
+    // each stage of moonlight-common-c, being connected, the first frame, and the whole connection
+    constexpr size_t ReachHostMetric    = 0;
+    constexpr size_t StartAppMetric     = 1;
+    constexpr size_t FirstStageMetric   = 2;
+    constexpr size_t ConnectedMetric    = FirstStageMetric + STAGE_MAX - 1;
+    constexpr size_t FirstFrameMetric   = ConnectedMetric + 1;
+    constexpr size_t TotalMetric        = FirstFrameMetric + 1;
+    constexpr size_t MetricCount        = TotalMetric + 1;
+
+    using HostHistograms = std::array<LatencyHistogram, MetricCount>;
+
+    // Histograms of each host, keyed by unique ID
+    struct StatisticsTable
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, HostHistograms> hosts;
+    };
+
+    StatisticsTable& GetTable()
+    {
+        static StatisticsTable table;
+        return table;
+    }
+
+    // Gets the name of a metric
+    const char* GetMetricName(size_t metric)
+    {
+        switch (metric)
+        {
+            case ReachHostMetric:
+                return "Reach host";
+            case StartAppMetric:
+                return "Start app";
+            case ConnectedMetric:
+                return "Connected";
+            case FirstFrameMetric:
+                return "First frame";
+            case TotalMetric:
+                return "Total";
+            default:
+                return LiGetStageName(static_cast<int>(metric - FirstStageMetric + 1));
+        }
+    }
+
+    // Gets the time between two points of a timeline, if both were reached
+    std::optional<uint64_t> Between(std::optional<uint64_t> start, std::optional<uint64_t> end)
+    {
+        if (!start.has_value() || !end.has_value() || *end < *start)
+        {
+            return std::nullopt;
+        }
+
+        return *end - *start;
+    }
+
+    // Formats a duration in whole milliseconds
+    std::string FormatMs(uint64_t duration)
+    {
+        return std::to_string((duration + 500000) / 1000000) + " ms";
+    }
+
+    // Records the durations of a range of metrics which were reached, and logs their histograms
+    void RecordMetrics(std::string_view uniqueID, std::string_view hostname,
+        const std::array<std::optional<uint64_t>, MetricCount>& durations, size_t firstMetric, size_t lastMetric)
+    {
+        std::string summary;
+        size_t count = 0;
+        {
+            StatisticsTable& table = GetTable();
+            std::lock_guard<std::mutex> lock(table.mutex);
+
+            HostHistograms& histograms = table.hosts[std::string(uniqueID)];
+            for (size_t metric = firstMetric; metric <= lastMetric; metric++)
+            {
+                if (durations[metric].has_value())
+                {
+                    histograms[metric].Record(*durations[metric]);
+                }
+                if (histograms[metric].GetCount() != 0)
+                {
+                    summary.append(summary.empty() ? "" : ", ").append(GetMetricName(metric)).append(" ")
+                        .append(FormatMs(histograms[metric].GetPercentile(50))).append(" (p90 ")
+                        .append(FormatMs(histograms[metric].GetPercentile(90))).append(")");
+                }
+            }
+            count = histograms[lastMetric].GetCount();
+        }
+
+        obs_log(LOG_INFO, "Connection stages for %.*s over the last %zu connections (median): %s",
+            static_cast<int>(hostname.size()), hostname.data(), count, summary.c_str());
+    }
+}
+
+void LatencyHistogram::Record(uint64_t duration)
+{
+    m_durations[m_next] = duration;
+    m_next = (m_next + 1) % WindowSize;
+    m_count = std::min(m_count + 1, WindowSize);
+}
+
+uint64_t LatencyHistogram::GetPercentile(unsigned int percentile) const
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+
+    // The window is small, so a copy is selected from rather than keeping it sorted
+    std::array<uint64_t, WindowSize> durations = m_durations;
+    // Nearest-rank percentile
+    size_t rank = (m_count * std::min(percentile, 100u) + 99) / 100;
+    size_t index = rank > 0 ? rank - 1 : 0;
+    std::nth_element(durations.begin(), durations.begin() + index, durations.begin() + m_count);
+    return durations[index];
+}
+
+void ConnectionStatistics::RecordConnected(std::string_view uniqueID, std::string_view hostname,
+    const ConnectionTimeline& timeline)
+{
+    std::array<std::optional<uint64_t>, MetricCount> durations;
+    durations[ReachHostMetric] = timeline.GetElapsed(ConnectionStep::HostReached);
+    durations[StartAppMetric] = Between(timeline.GetElapsed(ConnectionStep::HostReached),
+        timeline.GetElapsed(ConnectionStep::AppStarted));
+    for (int stage = STAGE_NONE + 1; stage < STAGE_MAX; stage++)
+    {
+        durations[FirstStageMetric + static_cast<size_t>(stage) - 1] = timeline.GetStageDuration(stage);
+    }
+    durations[ConnectedMetric] = timeline.GetElapsed(ConnectionStep::Connected);
+
+    RecordMetrics(uniqueID, hostname, durations, ReachHostMetric, ConnectedMetric);
+}
+
+void ConnectionStatistics::RecordFirstFrame(std::string_view uniqueID, std::string_view hostname,
+    const ConnectionTimeline& timeline)
+{
+    std::array<std::optional<uint64_t>, MetricCount> durations;
+    // Frames can arrive as soon as the video stream starts, before the remaining stages complete
+    durations[FirstFrameMetric] = Between(timeline.GetStageElapsed(STAGE_VIDEO_STREAM_START),
+        timeline.GetElapsed(ConnectionStep::FirstFrame));
+    durations[TotalMetric] = timeline.GetElapsed(ConnectionStep::FirstFrame);
+
+    RecordMetrics(uniqueID, hostname, durations, FirstFrameMetric, TotalMetric);
+}
+
+std::string ConnectionStatistics::GetSummary(std::string_view uniqueID)
+{
+    StatisticsTable& table = GetTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    auto host = table.hosts.find(std::string(uniqueID));
+    if (host == table.hosts.end())
+    {
+        return std::string();
+    }
+
+    std::string summary;
+    for (size_t metric = 0; metric < MetricCount; metric++)
+    {
+        const LatencyHistogram& histogram = host->second[metric];
+        if (histogram.GetCount() != 0)
+        {
+            summary.append(summary.empty() ? "" : "\n").append(GetMetricName(metric)).append(": ")
+                .append(FormatMs(histogram.GetPercentile(50))).append(", p90 ")
+                .append(FormatMs(histogram.GetPercentile(90)));
+        }
+    }
+
+    return summary;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace MoonlightOBS
+{
+    // Forward declarations
+    class ConnectionTimeline;
+
+    /**
+     * @brief A rolling histogram of the most recent durations of a connection stage.
+     *
+     */
+    class LatencyHistogram
+    {
+    public:
+        /**
+         * @brief The number of most recent durations kept.
+         *
+         */
+        static constexpr size_t WindowSize = 32;
+
+        /**
+         * @brief Records a duration, replacing the oldest if the window is full.
+         *
+         * @param duration The duration in nanoseconds.
+         */
+        void Record(uint64_t duration);
+
+        /**
+         * @brief Gets a percentile of the durations in the window.
+         *
+         * @param percentile The percentile, from 0 to 100.
+         * @return uint64_t The duration in nanoseconds, or 0 if no durations have been recorded.
+         */
+        uint64_t GetPercentile(unsigned int percentile) const;
+
+        /**
+         * @brief Gets the number of durations in the window.
+         *
+         * @return size_t The number of durations.
+         */
+        inline size_t GetCount() const
+        {
+            return m_count;
+        }
+
+    private:
+        // Ring of the most recent durations
+        std::array<uint64_t, WindowSize> m_durations = {};
+        // Position of the next duration in the ring
+        size_t m_next = 0;
+        // Number of durations in the ring
+        size_t m_count = 0;
+    };
+
+    /**
+     * @brief Static helper class which keeps rolling histograms of how long
+     *        each stage of connecting to each host took.
+     *
+     * The stages cover both the plugin (reaching the host and starting the app) and
+     * moonlight-common-c (from name resolution to the audio stream starting), as well
+     * as the time to the first frame, so a slow start can be attributed to the host,
+     * the network or the decoder. The histograms are kept in memory for the session.
+     *
+     */
+    class ConnectionStatistics
+    {
+    public:
+        /**
+         * @brief Records the stages of a connection up to it being connected, and logs their histograms for the host.
+         * @note Called from CONNECTION_LISTENER_CALLBACKS.connectionStarted, so connections which never
+         *       decode a frame (such as those of sources which are hidden) are still recorded.
+         *
+         * @param uniqueID The unique ID of the host.
+         * @param hostname The hostname of the host, for logging.
+         * @param timeline The timeline of the connection.
+         */
+        static void RecordConnected(std::string_view uniqueID, std::string_view hostname, const ConnectionTimeline& timeline);
+
+        /**
+         * @brief Records the time to the first frame of a connection, and logs its histograms for the host.
+         *
+         * @param uniqueID The unique ID of the host.
+         * @param hostname The hostname of the host, for logging.
+         * @param timeline The timeline of the connection.
+         */
+        static void RecordFirstFrame(std::string_view uniqueID, std::string_view hostname, const ConnectionTimeline& timeline);
+
+        /**
+         * @brief Gets a summary of the histograms of a host, with a line per stage.
+         *
+         * @param uniqueID The unique ID of the host.
+         * @return std::string The summary, or empty if no connections to the host have been recorded.
+         */
+        static std::string GetSummary(std::string_view uniqueID);
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        ConnectionStatistics()                                          = delete;
+        ConnectionStatistics(const ConnectionStatistics&)               = delete;
+        ConnectionStatistics& operator=(const ConnectionStatistics&)    = delete;
+        ~ConnectionStatistics()                                         = delete;
+    };
+} // namespace MoonlightOBS
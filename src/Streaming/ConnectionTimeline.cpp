@@ -0,0 +1,162 @@
+#include "ConnectionTimeline.hpp"
+
+// STL includes
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// OBS Studio includes
+#include <util/base.h>
+#include <util/platform.h>
+
+// Project includes
+#include "../plugin-support.h"
+
+using namespace MoonlightOBS;
+
+ConnectionTimeline::ConnectionTimeline()
+{
+    Reset();
+}
+
+void ConnectionTimeline::Reset()
+{
+    for (std::atomic<uint64_t>& time : m_times)
+    {
+        time.store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < STAGE_MAX; i++)
+    {
+        m_stageStarted[i].store(0, std::memory_order_relaxed);
+        m_stageCompleted[i].store(0, std::memory_order_relaxed);
+    }
+
+    Mark(ConnectionStep::Requested);
+}
+
+void ConnectionTimeline::Mark(ConnectionStep step)
+{
+    uint64_t expected = 0;
+    m_times[static_cast<size_t>(step)].compare_exchange_strong(expected, os_gettime_ns(), std::memory_order_relaxed);
+}
+
+std::optional<uint64_t> ConnectionTimeline::GetElapsed(ConnectionStep step) const
+{
+    uint64_t requested = m_times[static_cast<size_t>(ConnectionStep::Requested)].load(std::memory_order_relaxed);
+    uint64_t time = m_times[static_cast<size_t>(step)].load(std::memory_order_relaxed);
+    if (time == 0)
+    {
+        return std::nullopt;
+    }
+
+    return time - requested;
+}
+
+void ConnectionTimeline::Log(std::string_view hostname) const
+{
+    // Log the steps in the order they completed in, as independent steps overlap
+    std::vector<std::pair<uint64_t, ConnectionStep>> completed;
+    for (size_t i = static_cast<size_t>(ConnectionStep::Requested) + 1; i < m_times.size(); i++)
+    {
+        ConnectionStep step = static_cast<ConnectionStep>(i);
+        std::optional<uint64_t> elapsed = GetElapsed(step);
+        if (elapsed.has_value())
+        {
+            completed.emplace_back(*elapsed, step);
+        }
+    }
+    std::stable_sort(completed.begin(), completed.end(), [](const auto& a, const auto& b)
+    {
+        return a.first < b.first;
+    });
+
+    std::string summary;
+    for (const auto& [elapsed, step] : completed)
+    {
+        summary.append(summary.empty() ? "" : ", ").append(GetStepName(step))
+            .append(" +").append(std::to_string(elapsed / 1000000)).append(" ms");
+    }
+
+    obs_log(LOG_INFO, "Connection timeline for %.*s: %s", static_cast<int>(hostname.size()), hostname.data(),
+        summary.empty() ? "no steps completed" : summary.c_str());
+}
+
+void ConnectionTimeline::MarkStageStarting(int stage)
+{
+    if (stage > STAGE_NONE && stage < STAGE_MAX)
+    {
+        m_stageStarted[static_cast<size_t>(stage)].store(os_gettime_ns(), std::memory_order_relaxed);
+    }
+}
+
+void ConnectionTimeline::MarkStageComplete(int stage)
+{
+    if (stage > STAGE_NONE && stage < STAGE_MAX)
+    {
+        m_stageCompleted[static_cast<size_t>(stage)].store(os_gettime_ns(), std::memory_order_relaxed);
+    }
+}
+
+std::optional<uint64_t> ConnectionTimeline::GetStageDuration(int stage) const
+{
+    if (stage <= STAGE_NONE || stage >= STAGE_MAX)
+    {
+        return std::nullopt;
+    }
+
+    uint64_t started = m_stageStarted[static_cast<size_t>(stage)].load(std::memory_order_relaxed);
+    uint64_t completed = m_stageCompleted[static_cast<size_t>(stage)].load(std::memory_order_relaxed);
+    if (started == 0 || completed < started)
+    {
+        return std::nullopt;
+    }
+
+    return completed - started;
+}
+
+std::optional<uint64_t> ConnectionTimeline::GetStageElapsed(int stage) const
+{
+    if (stage <= STAGE_NONE || stage >= STAGE_MAX)
+    {
+        return std::nullopt;
+    }
+
+    uint64_t requested = m_times[static_cast<size_t>(ConnectionStep::Requested)].load(std::memory_order_relaxed);
+    uint64_t completed = m_stageCompleted[static_cast<size_t>(stage)].load(std::memory_order_relaxed);
+    if (completed == 0)
+    {
+        return std::nullopt;
+    }
+
+    return completed - requested;
+}
+
+const char* ConnectionTimeline::GetStepName(ConnectionStep step)
+{
+    switch (step)
+    {
+        case ConnectionStep::Requested:
+            return "requested";
+        case ConnectionStep::IdentityReady:
+            return "identity ready";
+        case ConnectionStep::HostReached:
+            return "host reached";
+        case ConnectionStep::DecoderReady:
+            return "decoder ready";
+        case ConnectionStep::AppStarted:
+            return "app started";
+        case ConnectionStep::Connected:
+            return "connected";
+        case ConnectionStep::StreamStarted:
+            return "stream started";
+        case ConnectionStep::FirstFrame:
+            return "first frame";
+        default:
+            return "unknown";
+    }
+}
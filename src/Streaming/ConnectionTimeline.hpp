@@ -0,0 +1,128 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+// moonlight-common-c includes
+#include <Limelight.h>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief The steps of connecting to a host, from the user asking to connect to the first frame.
+     *
+     */
+    enum class ConnectionStep : uint8_t
+    {
+        Requested = 0,      // Connecting was requested
+        IdentityReady,      // The client identity was loaded
+        HostReached,        // The host responded to /serverinfo on one of its addresses
+        DecoderReady,       // The decoder was warmed up
+        AppStarted,         // The host launched (or resumed) the app
+        Connected,          // moonlight-common-c reported the connection as started
+        StreamStarted,      // moonlight-common-c set up the RTSP, control, video and audio streams
+        FirstFrame,         // The first frame was accepted by the decoder
+
+        Count               // Number of steps
+    };
+
+    /**
+     * @brief Records when each step of connecting to a host completed.
+     * @note Steps may be marked from any thread, as independent steps run concurrently.
+     *
+     */
+    class ConnectionTimeline
+    {
+    public:
+        /**
+         * @brief Construct a new ConnectionTimeline object, marking the Requested step.
+         *
+         */
+        ConnectionTimeline();
+
+        /**
+         * @brief Clears every step, and marks the Requested step as completed now.
+         * @note Shouldn't be called while other threads may be marking steps.
+         *
+         */
+        void Reset();
+
+        /**
+         * @brief Marks a step as completed now.
+         * @note A step which was already marked keeps its first time.
+         *
+         * @param step The step which completed.
+         */
+        void Mark(ConnectionStep step);
+
+        /**
+         * @brief Gets how long after connecting was requested a step completed.
+         *
+         * @param step The step.
+         * @return std::optional<uint64_t> The time since the request in nanoseconds, or nothing if it hasn't completed.
+         */
+        std::optional<uint64_t> GetElapsed(ConnectionStep step) const;
+
+        /**
+         * @brief Logs the time each completed step took after the request.
+         *
+         * @param hostname The hostname of the host being connected to.
+         */
+        void Log(std::string_view hostname) const;
+
+        /**
+         * @brief Gets the name of a step, for logging.
+         *
+         * @param step The step.
+         * @return const char* The name of the step.
+         */
+        static const char* GetStepName(ConnectionStep step);
+
+        /**
+         * @brief Marks a stage of moonlight-common-c as starting now.
+         * @note Called from CONNECTION_LISTENER_CALLBACKS.stageStarting.
+         *
+         * @param stage The STAGE_* value of the stage.
+         */
+        void MarkStageStarting(int stage);
+
+        /**
+         * @brief Marks a stage of moonlight-common-c as completed now.
+         * @note Called from CONNECTION_LISTENER_CALLBACKS.stageComplete.
+         *
+         * @param stage The STAGE_* value of the stage.
+         */
+        void MarkStageComplete(int stage);
+
+        /**
+         * @brief Gets how long a stage of moonlight-common-c took.
+         *
+         * @param stage The STAGE_* value of the stage.
+         * @return std::optional<uint64_t> The duration of the stage in nanoseconds, or nothing if it hasn't completed.
+         */
+        std::optional<uint64_t> GetStageDuration(int stage) const;
+
+        /**
+         * @brief Gets how long after connecting was requested a stage of moonlight-common-c completed.
+         *
+         * @param stage The STAGE_* value of the stage.
+         * @return std::optional<uint64_t> The time since the request in nanoseconds, or nothing if it hasn't completed.
+         */
+        std::optional<uint64_t> GetStageElapsed(int stage) const;
+
+        ConnectionTimeline(const ConnectionTimeline&)               = delete;
+        ConnectionTimeline& operator=(const ConnectionTimeline&)    = delete;
+
+    private:
+        // Monotonic time each step completed at (os_gettime_ns), or 0 if it hasn't
+        std::array<std::atomic<uint64_t>, static_cast<size_t>(ConnectionStep::Count)> m_times;
+        // Monotonic times each stage of moonlight-common-c started and completed at, or 0 if it hasn't
+        std::array<std::atomic<uint64_t>, STAGE_MAX> m_stageStarted;
+        std::array<std::atomic<uint64_t>, STAGE_MAX> m_stageCompleted;
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,58 @@
+#include "FrameCadence.hpp"
+
+// STL includes
+#include <algorithm>
+
+using namespace MoonlightOBS;
+
+FrameCadence::FrameCadence(uint32_t fps, uint64_t tickNumerator, uint64_t tickDenominator, uint64_t now)
+    : m_fpsNumerator(static_cast<uint64_t>(std::max(fps, 1u)) * tickDenominator),
+      m_tickNumerator(std::max<uint64_t>(tickNumerator, 1)), m_credit(0), m_targetDepth(1), m_lastUnderflow(now)
+{
+}
+
+FrameCadenceTick FrameCadence::Tick(uint64_t now, size_t depth, bool stalled)
+{
+    FrameCadenceTick tick;
+
+    m_credit += m_fpsNumerator;
+    size_t due = static_cast<size_t>(m_credit / m_tickNumerator);
+    m_credit %= m_tickNumerator;
+
+    if (due > 0 && depth == 0)
+    {
+        // A stream which stopped (such as while its sources are hidden) isn't running dry
+        if (!stalled)
+        {
+            tick.duplicated = true;
+            m_targetDepth = std::min(m_targetDepth + 1, MaxTargetDepth);
+            m_lastUnderflow = now;
+        }
+
+        // Don't let the missed frames add up, which would burst them out later
+        m_credit = 0;
+        return tick;
+    }
+
+    if (due == 0)
+    {
+        return tick;
+    }
+
+    // Only the newest of several frames due in one tick is rendered
+    tick.skipped = std::min(due, depth) - 1;
+    tick.output = true;
+
+    // Catch up when more than the target has built up, such as after a burst of frames
+    size_t remaining = depth - tick.skipped - 1;
+    tick.caughtUp = remaining > m_targetDepth ? remaining - m_targetDepth : 0;
+
+    // Buffer a frame less once the stream has been steady for a while
+    if (m_targetDepth > 1 && now - m_lastUnderflow > ShrinkInterval)
+    {
+        m_targetDepth--;
+        m_lastUnderflow = now;
+    }
+
+    return tick;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief What the smooth pacing does with the buffered frames at a tick of the OBS video clock.
+     *
+     */
+    struct FrameCadenceTick
+    {
+        size_t skipped      = 0;        // Oldest frames to drop, as a newer frame due in the same tick supersedes them
+        bool output         = false;    // Whether to output the oldest frame left
+        size_t caughtUp     = 0;        // Frames after the output one to drop, to catch up to the target depth
+        bool duplicated     = false;    // Whether a frame was due but none was buffered, so OBS repeats a frame
+    };
+
+    /**
+     * @brief Decides which buffered frames the smooth pacing outputs and drops at each tick of the OBS video clock.
+     *
+     * Each tick owes as many frames as the stream's frame rate is of the canvas's, kept as an exact
+     * fraction so fractional canvas rates such as 59.94 are followed without drifting. The buffer aims
+     * to keep a target depth of frames, which grows by a frame each time it runs dry, and shrinks
+     * again once it hasn't for a while.
+     *
+     */
+    class FrameCadence
+    {
+    public:
+        /**
+         * @brief Most frames the buffer aims to keep after growing for jitter.
+         *
+         */
+        static constexpr size_t MaxTargetDepth = 4;
+
+        /**
+         * @brief Time in nanoseconds without running dry after which the target depth shrinks by a frame.
+         *
+         */
+        static constexpr uint64_t ShrinkInterval = 10000000000ULL;
+
+        /**
+         * @brief Construct a new FrameCadence object, aiming to buffer a frame.
+         *
+         * @param fps The frame rate of the stream.
+         * @param tickNumerator The numerator of the canvas's frame rate.
+         * @param tickDenominator The denominator of the canvas's frame rate.
+         * @param now The current time in nanoseconds.
+         */
+        FrameCadence(uint32_t fps, uint64_t tickNumerator, uint64_t tickDenominator, uint64_t now);
+
+        /**
+         * @brief Decides what to do with the buffered frames at a tick.
+         *
+         * @param now The time of the tick in nanoseconds.
+         * @param depth The number of frames buffered.
+         * @param stalled Whether the stream stopped sending frames, so running dry isn't counted.
+         * @return FrameCadenceTick The frames to drop and output.
+         */
+        FrameCadenceTick Tick(uint64_t now, size_t depth, bool stalled);
+
+        /**
+         * @brief Gets the number of frames the buffer aims to keep.
+         *
+         * @return size_t The target depth.
+         */
+        inline size_t GetTargetDepth() const
+        {
+            return m_targetDepth;
+        }
+
+    private:
+        // Frames per tick are m_fpsNumerator / m_tickNumerator
+        uint64_t m_fpsNumerator;
+        uint64_t m_tickNumerator;
+        // Frames due, in units of 1 / m_tickNumerator
+        uint64_t m_credit;
+        // Number of frames the buffer aims to keep
+        size_t m_targetDepth;
+        // When the buffer last ran dry, or the target depth last shrank
+        uint64_t m_lastUnderflow;
+    };
+} // namespace MoonlightOBS
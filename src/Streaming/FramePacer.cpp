@@ -0,0 +1,319 @@
+#include "FramePacer.hpp"
+
+// STL includes
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <utility>
+
+// OBS Studio includes
+#include <obs.h>
+#include <util/base.h>
+#include <util/platform.h>
+
+// Project includes
+#include "../plugin-support.h"
+#include "../Decoding/FrameFormat.hpp"
+#include "FrameCadence.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Most frames the smooth mode buffers, beyond which the oldest are dropped
+    constexpr size_t MaxDepth = 8;
+    // Time without frames after which the stream is considered paused rather than late
+    constexpr uint64_t StallInterval = 1000000000ULL;
+    // Time between logging the statistics
+    constexpr uint64_t LogInterval = 30000000000ULL;
+
+    // Aligns a size to the alignment of the frame pool
+    size_t Align(size_t size)
+    {
+        return (size + FramePool::Alignment - 1) & ~(FramePool::Alignment - 1);
+    }
+
+    // Gets the name of a pacing mode, for logging
+    const char* GetName(FramePacing mode)
+    {
+        switch (mode)
+        {
+            case FramePacing::Smooth:
+                return "smooth";
+            case FramePacing::FixedDelay:
+                return "fixed delay";
+            default:
+                return "lowest latency";
+        }
+    }
+
+    // Converts a time of os_gettime_ns to the steady clock, for waiting on condition variables
+    std::chrono::steady_clock::time_point ToSteadyClock(uint64_t time)
+    {
+        int64_t remaining = static_cast<int64_t>(time - os_gettime_ns());
+        return std::chrono::steady_clock::now() + std::chrono::nanoseconds(std::max<int64_t>(remaining, 0));
+    }
+}
+
+FramePacer::FramePacer(const StreamConfig& config, FrameCallback output)
+    : m_mode(config.framePacing), m_delay(static_cast<uint64_t>(config.pacingDelay) * 1000000ULL),
+      m_fps(std::max(config.fps, 1u)), m_output(std::move(output)), m_lastLogged(os_gettime_ns()),
+      m_lastOutput(0), m_lastSubmitted(0), m_stopping(false)
+{
+    if (m_mode == FramePacing::Smooth)
+    {
+        m_statistics.targetDepth = 1;
+        m_thread = std::thread(&FramePacer::RunSmooth, this);
+    }
+    else if (m_mode == FramePacing::FixedDelay)
+    {
+        m_thread = std::thread(&FramePacer::RunFixedDelay, this);
+    }
+}
+
+FramePacer::~FramePacer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_frameSubmitted.notify_all();
+    }
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    for (PendingFrame& pending : m_pending)
+    {
+        m_framePool.Release(pending.buffer);
+    }
+    m_pending.clear();
+
+    if (m_statistics.output > 0)
+    {
+        obs_log(LOG_INFO, "Paced frames for %s: %llu output, %llu dropped, %llu duplicated", GetName(m_mode),
+            static_cast<unsigned long long>(m_statistics.output), static_cast<unsigned long long>(m_statistics.dropped),
+            static_cast<unsigned long long>(m_statistics.duplicated));
+    }
+}
+
+void FramePacer::Submit(const obs_source_frame& frame)
+{
+    if (m_mode == FramePacing::LowestLatency)
+    {
+        Output(frame);
+        return;
+    }
+
+    // Decoders reuse their buffers once a frame is output, so buffered frames are copied
+    PendingFrame pending;
+    try
+    {
+        pending = Copy(frame);
+    }
+    catch (const std::bad_alloc&)
+    {
+        obs_log(LOG_WARNING, "Failed to allocate the buffer of a paced frame");
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastSubmitted = os_gettime_ns();
+    m_pending.push_back(pending);
+    if (m_pending.size() > MaxDepth)
+    {
+        DropOldest(m_pending.size() - MaxDepth);
+    }
+    m_frameSubmitted.notify_all();
+}
+
+FramePacingStatistics FramePacer::GetStatistics() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FramePacingStatistics statistics = m_statistics;
+    statistics.depth = m_pending.size();
+    return statistics;
+}
+
+FramePacer::PendingFrame FramePacer::Copy(const obs_source_frame& frame)
+{
+    size_t offsets[MAX_AV_PLANES] = {};
+    size_t size = 0;
+    for (size_t plane = 0; plane < MAX_AV_PLANES; plane++)
+    {
+        offsets[plane] = size;
+        if (frame.data[plane] != nullptr)
+        {
+            size += Align(static_cast<size_t>(frame.linesize[plane]) *
+                FrameFormat::GetPlaneHeight(frame.format, frame.height, plane));
+        }
+    }
+
+    PendingFrame pending;
+    pending.frame   = frame;
+    pending.buffer  = m_framePool.Acquire(size);
+    pending.due     = frame.timestamp + m_delay;
+
+    for (size_t plane = 0; plane < MAX_AV_PLANES; plane++)
+    {
+        if (frame.data[plane] == nullptr)
+        {
+            continue;
+        }
+
+        size_t planeSize = static_cast<size_t>(frame.linesize[plane]) *
+            FrameFormat::GetPlaneHeight(frame.format, frame.height, plane);
+        pending.frame.data[plane] = pending.buffer->data + offsets[plane];
+        std::memcpy(pending.frame.data[plane], frame.data[plane], planeSize);
+    }
+
+    return pending;
+}
+
+void FramePacer::Output(const obs_source_frame& frame)
+{
+    uint64_t now = os_gettime_ns();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // OBS shows the newest frame at each tick, so a frame output since the last tick is superseded
+        if (m_lastOutput != 0 && m_lastOutput > obs_get_video_frame_time())
+        {
+            m_statistics.dropped++;
+        }
+
+        // Without a buffer, a frame arriving late leaves OBS showing the previous one again
+        if (m_mode != FramePacing::Smooth && m_lastOutput != 0 && now - m_lastOutput < StallInterval)
+        {
+            uint64_t frameInterval = 1000000000ULL / m_fps;
+            uint64_t intervals = (now - m_lastOutput + frameInterval / 2) / frameInterval;
+            m_statistics.duplicated += intervals > 1 ? intervals - 1 : 0;
+        }
+
+        m_lastOutput = now;
+        m_statistics.output++;
+        LogStatistics(now);
+    }
+
+    m_output(frame);
+}
+
+void FramePacer::Release(PendingFrame& pending)
+{
+    Output(pending.frame);
+    m_framePool.Release(pending.buffer);
+}
+
+void FramePacer::RunSmooth()
+{
+    os_set_thread_name("moonlight-obs: pacing");
+
+    // Follow the canvas's frame rate exactly, even when it's fractional
+    uint64_t tickNumerator = 60;
+    uint64_t tickDenominator = 1;
+    obs_video_info videoInfo = {};
+    if (obs_get_video_info(&videoInfo) && videoInfo.fps_num != 0 && videoInfo.fps_den != 0)
+    {
+        tickNumerator = videoInfo.fps_num;
+        tickDenominator = videoInfo.fps_den;
+    }
+    const uint64_t tickInterval = 1000000000ULL * tickDenominator / tickNumerator;
+    // Frames are output this long before each tick, so they're in place when OBS renders
+    const uint64_t margin = tickInterval / 4;
+
+    FrameCadence cadence(m_fps, tickNumerator, tickDenominator, os_gettime_ns());
+    uint64_t lastWake = 0;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping)
+    {
+        // Wake shortly before the next tick, following the OBS video clock rather than counting
+        // intervals, so the pacer doesn't drift from it
+        uint64_t wake = obs_get_video_frame_time() + tickInterval - margin;
+        while (wake <= lastWake)
+        {
+            wake += tickInterval;
+        }
+        lastWake = wake;
+
+        if (m_frameSubmitted.wait_until(lock, ToSteadyClock(wake), [this]() { return m_stopping; }))
+        {
+            break;
+        }
+
+        uint64_t now = os_gettime_ns();
+        bool stalled = m_lastSubmitted == 0 || now - m_lastSubmitted > StallInterval;
+        FrameCadenceTick tick = cadence.Tick(now, m_pending.size(), stalled);
+        m_statistics.targetDepth = cadence.GetTargetDepth();
+        m_statistics.duplicated += tick.duplicated ? 1 : 0;
+        if (!tick.output)
+        {
+            continue;
+        }
+
+        DropOldest(tick.skipped);
+        PendingFrame pending = m_pending.front();
+        m_pending.pop_front();
+        DropOldest(tick.caughtUp);
+
+        lock.unlock();
+        Release(pending);
+        lock.lock();
+    }
+}
+
+void FramePacer::DropOldest(size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        m_framePool.Release(m_pending.front().buffer);
+        m_pending.pop_front();
+        m_statistics.dropped++;
+    }
+}
+
+void FramePacer::RunFixedDelay()
+{
+    os_set_thread_name("moonlight-obs: pacing");
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping)
+    {
+        if (m_pending.empty())
+        {
+            m_frameSubmitted.wait(lock, [this]() { return m_stopping || !m_pending.empty(); });
+            continue;
+        }
+
+        // Frames are received in order, so the oldest is due first
+        uint64_t due = m_pending.front().due;
+        if (os_gettime_ns() < due)
+        {
+            m_frameSubmitted.wait_until(lock, ToSteadyClock(due), [this]() { return m_stopping; });
+            continue;
+        }
+
+        PendingFrame pending = m_pending.front();
+        m_pending.pop_front();
+
+        lock.unlock();
+        Release(pending);
+        lock.lock();
+    }
+}
+
+void FramePacer::LogStatistics(uint64_t now)
+{
+    if (now - m_lastLogged < LogInterval)
+    {
+        return;
+    }
+    m_lastLogged = now;
+
+    obs_log(LOG_INFO, "Pacing frames for %s: %llu output, %llu dropped, %llu duplicated, %zu buffered (target %zu)",
+        GetName(m_mode), static_cast<unsigned long long>(m_statistics.output),
+        static_cast<unsigned long long>(m_statistics.dropped), static_cast<unsigned long long>(m_statistics.duplicated),
+        m_pending.size(), m_statistics.targetDepth);
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+// STL includes
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// OBS Studio includes
+#include <obs.h>
+
+// Project includes
+#include "../Decoding/FramePool.hpp"
+#include "StreamConfig.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Counters of how frames were paced.
+     *
+     */
+    struct FramePacingStatistics
+    {
+        uint64_t output         = 0;    // Frames output to OBS
+        uint64_t dropped        = 0;    // Frames dropped, as a newer frame superseded them
+        uint64_t duplicated     = 0;    // Ticks a new frame was due but none had arrived, so OBS repeated a frame
+        size_t depth            = 0;    // Frames buffered
+        size_t targetDepth      = 0;    // Frames the smooth mode aims to keep buffered
+    };
+
+    /**
+     * @brief Paces decoded frames out to OBS, which shows them unbuffered as soon as they're output.
+     *
+     * Lowest latency outputs each frame as soon as it's decoded, so a frame which OBS hasn't
+     * rendered yet is superseded by the next. Smooth buffers frames and outputs them one at a
+     * time just before the ticks of the OBS video clock, as many per tick as the stream's frame
+     * rate is of the canvas's (so fractional canvas rates such as 59.94 are followed exactly).
+     * Its buffer grows by a frame each time it runs dry, and shrinks again once it has stayed
+     * full for a while, dropping the oldest frames to catch up. Fixed delay outputs each frame a
+     * constant delay after it was received, to line up with other sources.
+     *
+     * Buffered frames are copied into a frame pool, as decoders reuse their buffers once a frame
+     * is output. The statistics are logged periodically.
+     *
+     */
+    class FramePacer
+    {
+    public:
+        /**
+         * @brief Receives each frame when it's due.
+         *
+         */
+        using FrameCallback = std::function<void(const obs_source_frame& frame)>;
+
+        /**
+         * @brief Construct a new FramePacer object, starting the pacing thread if the mode buffers frames.
+         *
+         * @param config The pacing mode and delay, and the frame rate of the stream.
+         * @param output Receives each frame when it's due.
+         */
+        FramePacer(const StreamConfig& config, FrameCallback output);
+
+        /**
+         * @brief Stops the pacing thread, dropping the buffered frames.
+         *
+         */
+        ~FramePacer();
+
+        FramePacer(const FramePacer&)               = delete;
+        FramePacer& operator=(const FramePacer&)    = delete;
+
+        /**
+         * @brief Submits a decoded frame, which is output when it's due.
+         *
+         * @param frame The frame, whose planes are only read during the call.
+         */
+        void Submit(const obs_source_frame& frame);
+
+        /**
+         * @brief Gets the counters of how frames were paced.
+         *
+         * @return FramePacingStatistics The counters.
+         */
+        FramePacingStatistics GetStatistics() const;
+
+    private:
+        // A frame waiting to be output
+        struct PendingFrame
+        {
+            obs_source_frame frame;     // The frame, whose planes are in the buffer
+            FrameBuffer* buffer;        // Buffer of the planes
+            uint64_t due;               // When the frame is due (for the fixed delay)
+        };
+
+        // Pacing mode
+        FramePacing m_mode;
+        // Delay of the fixed delay mode in nanoseconds
+        uint64_t m_delay;
+        // Frame rate of the stream
+        uint32_t m_fps;
+        // Receives each frame when it's due
+        FrameCallback m_output;
+        // Buffers the planes of the pending frames
+        FramePool m_framePool;
+
+        // Guards the members below
+        mutable std::mutex m_mutex;
+        // Signalled when a frame is submitted, or the pacer is stopping
+        std::condition_variable m_frameSubmitted;
+        // Frames waiting to be output, oldest first
+        std::deque<PendingFrame> m_pending;
+        // Counters of how frames were paced
+        FramePacingStatistics m_statistics;
+        // When the statistics were last logged
+        uint64_t m_lastLogged;
+        // When a frame was last output
+        uint64_t m_lastOutput;
+        // When a frame was last submitted to be buffered
+        uint64_t m_lastSubmitted;
+        // Is the pacer stopping?
+        bool m_stopping;
+
+        // Thread outputting the buffered frames
+        std::thread m_thread;
+
+        // Copies a frame into a buffer from the pool
+        PendingFrame Copy(const obs_source_frame& frame);
+        // Outputs a frame, counting it in the statistics
+        void Output(const obs_source_frame& frame);
+        // Outputs a pending frame, then returns its buffer to the pool
+        void Release(PendingFrame& pending);
+        // Outputs a frame per tick of the OBS video clock (runs on m_thread)
+        void RunSmooth();
+        // Drops the oldest pending frames, counting them in the statistics (m_mutex must be held)
+        void DropOldest(size_t count);
+        // Outputs each frame once its delay has passed (runs on m_thread)
+        void RunFixedDelay();
+        // Logs the statistics if enough time has passed (m_mutex must be held)
+        void LogStatistics(uint64_t now);
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,111 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief How a software decoder spreads the decoding of a stream across threads.
+     *
+     */
+    enum class DecodeThreading : uint8_t
+    {
+        Slice = 0,      // Decode the slices of each frame in parallel (no added latency)
+        Frame,          // Decode several frames in parallel (adds a frame of latency per extra thread)
+        SliceAndFrame   // Both, for the highest throughput
+    };
+
+    /**
+     * @brief Which thread the frames of the stream are decoded on.
+     *
+     */
+    enum class DecodeSubmission : uint8_t
+    {
+        Queued = 0,     // Queue frames for a decode thread, so receiving never waits for decoding
+        Direct          // Decode frames on the thread receiving them (lowest latency)
+    };
+
+    /**
+     * @brief How decoded frames are paced out to OBS.
+     *
+     */
+    enum class FramePacing : uint8_t
+    {
+        LowestLatency = 0,  // Output each frame as soon as it's decoded, so the latest frame wins
+        Smooth,             // Buffer a few frames to output one per tick of the OBS video clock
+        FixedDelay          // Output each frame a constant delay after it's received
+    };
+
+    /**
+     * @brief The host, app and stream parameters a source streams with.
+     *
+     */
+    struct StreamConfig
+    {
+        std::string uniqueID;               // Unique ID of the paired host
+        int appID               = 0;        // ID of the app to stream, from the app list of the host
+        uint32_t width          = 1920;     // Width of the stream
+        uint32_t height         = 1080;     // Height of the stream
+        uint32_t fps            = 60;       // Frame rate of the stream
+        uint32_t bitrate        = 20000;    // Bitrate of the stream in Kbps
+        bool hardwareDecoding   = true;     // Use hardware decoding when available?
+        DecodeThreading decodeThreading = DecodeThreading::Slice;   // How software decoding is threaded
+        uint32_t decodeThreads  = 0;        // Threads to decode with, or 0 to size them automatically
+        DecodeSubmission decodeSubmission = DecodeSubmission::Queued;   // Which thread frames are decoded on
+        bool hdr                = false;    // Ask for HDR (10 bit) video? (set for HDR canvases, or to tone map on SDR ones)
+        bool toneMapHDR         = false;    // Tone map HDR streams to SDR on the CPU? (only set for SDR canvases)
+        bool yuv444             = false;    // Ask for 4:4:4 video?
+        FramePacing framePacing = FramePacing::LowestLatency;       // How frames are paced out to OBS
+        uint32_t pacingDelay    = 0;        // Delay of FramePacing::FixedDelay in milliseconds
+
+        inline bool operator==(const StreamConfig& other) const
+        {
+            return uniqueID == other.uniqueID && appID == other.appID &&
+                   width == other.width && height == other.height && fps == other.fps &&
+                   bitrate == other.bitrate && hardwareDecoding == other.hardwareDecoding &&
+                   decodeThreading == other.decodeThreading && decodeThreads == other.decodeThreads &&
+                   decodeSubmission == other.decodeSubmission &&
+                   hdr == other.hdr && toneMapHDR == other.toneMapHDR && yuv444 == other.yuv444 &&
+                   framePacing == other.framePacing &&
+                   pacingDelay == other.pacingDelay;
+        }
+
+        inline bool operator!=(const StreamConfig& other) const
+        {
+            return !(*this == other);
+        }
+    };
+} // namespace MoonlightOBS
+
+/**
+ * @brief Hash of a StreamConfig, allowing it to be used as the key of unordered containers.
+ *
+ */
+template <>
+struct std::hash<MoonlightOBS::StreamConfig>
+{
+    inline size_t operator()(const MoonlightOBS::StreamConfig& config) const noexcept
+    {
+        // Combine the fields which take part in equality (as boost::hash_combine does)
+        size_t hash = std::hash<std::string>()(config.uniqueID);
+        auto combine = [&hash](size_t value)
+        {
+            hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+        };
+
+        combine(static_cast<size_t>(config.appID));
+        combine((static_cast<size_t>(config.width) << 16) ^ config.height);
+        combine(config.fps);
+        combine(config.bitrate);
+        combine((config.hardwareDecoding ? 1 : 0) | (config.toneMapHDR ? 2 : 0) | (config.hdr ? 4 : 0) |
+            (config.yuv444 ? 8 : 0) | (static_cast<size_t>(config.decodeSubmission) << 4));
+        combine((static_cast<size_t>(config.decodeThreading) << 16) ^ config.decodeThreads);
+        combine((static_cast<size_t>(config.framePacing) << 24) ^ config.pacingDelay);
+
+        return hash;
+    }
+};
@@ -0,0 +1,455 @@
+#include "StreamSession.hpp"
+
+// STL includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+
+// OBS Studio includes
+#include <obs.h>
+#include <util/base.h>
+#include <util/platform.h>
+
+// Project includes
+#include "../plugin-support.h"
+#include "../Decoding/DecoderRenderer.hpp"
+#include "ConnectionOrchestrator.hpp"
+#include "FramePacer.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Sessions of each config, and which of them holds the connection of moonlight-common-c
+    struct SessionTable
+    {
+        std::mutex mutex;
+        std::unordered_map<StreamConfig, std::weak_ptr<StreamSession>> sessions;
+
+        // Is a session connecting or connected? (only one can be, per process)
+        bool connectionActive = false;
+        // Signalled when the connection is released, or a session waiting for it is stopping
+        std::condition_variable connectionReleased;
+    };
+
+    SessionTable& GetTable()
+    {
+        static SessionTable table;
+        return table;
+    }
+}
+
+struct StreamSession::Connection
+{
+    // Paces the decoded frames out to the sources (outlives the renderer, which submits to it)
+    FramePacer pacer;
+    // Decoder of the video stream
+    DecoderRenderer renderer;
+    // Connection to the host
+    ConnectionOrchestrator orchestrator;
+    // Thread connecting to the host
+    std::thread thread;
+    // Is the connection being stopped?
+    std::atomic<bool> stopping;
+    // Does the connection hold the connection of moonlight-common-c? (guarded by the registry)
+    bool holdsConnection;
+    // Have the streams ended, and with which error? (guarded by the connection mutex of the session)
+    std::optional<int> terminatedError;
+
+    Connection(const StreamConfig& config, StreamSession& session)
+        : pacer(config, [&session](const obs_source_frame& frame) { session.OutputVideo(frame); }),
+          renderer(config, [this](const obs_source_frame& frame) { pacer.Submit(frame); }),
+          orchestrator(config, GetCallbacks(renderer, session, *this)), stopping(false), holdsConnection(false) {}
+
+    // Gets the callbacks streaming to a renderer, and telling the session when the streams end
+    static StreamCallbacks GetCallbacks(DecoderRenderer& renderer, StreamSession& session, Connection& connection)
+    {
+        StreamCallbacks callbacks;
+        callbacks.decoder               = renderer.GetCallbacks();
+        callbacks.decoderContext        = &renderer;
+        callbacks.supportedVideoFormats = renderer.GetSupportedVideoFormats();
+        callbacks.prepareDecoder        = [&renderer]() { renderer.Prepare(); };
+        callbacks.terminated            = [&session, &connection](int errorCode)
+        {
+            session.OnConnectionTerminated(connection, errorCode);
+        };
+        return callbacks;
+    }
+
+    // Connects to the host, once the session before it has disconnected (runs on thread)
+    void Run()
+    {
+        os_set_thread_name("moonlight-obs: connect");
+
+        // Wait for the session before this one to disconnect
+        SessionTable& table = GetTable();
+        {
+            std::unique_lock<std::mutex> lock(table.mutex);
+            table.connectionReleased.wait(lock, [this, &table]()
+            {
+                return !table.connectionActive || stopping;
+            });
+            if (stopping)
+            {
+                return;
+            }
+
+            table.connectionActive = true;
+            holdsConnection = true;
+        }
+
+        try
+        {
+            orchestrator.Connect();
+        }
+        catch (const std::exception& exception)
+        {
+            obs_log(LOG_ERROR, "Failed to connect: %s", exception.what());
+
+            // Let a waiting session connect instead
+            std::lock_guard<std::mutex> lock(table.mutex);
+            table.connectionActive = false;
+            holdsConnection = false;
+            table.connectionReleased.notify_all();
+        }
+    }
+};
+
+StreamSession::StreamSession(const StreamConfig& config)
+    : m_config(config), m_stopping(false) {}
+
+StreamSession::~StreamSession()
+{
+    SessionTable& table = GetTable();
+    {
+        std::lock_guard<std::mutex> lock(table.mutex);
+
+        // A new session may already have replaced this one for the same config
+        auto entry = table.sessions.find(m_config);
+        if (entry != table.sessions.end() && entry->second.expired())
+        {
+            table.sessions.erase(entry);
+        }
+    }
+
+    std::unique_ptr<Connection> connection;
+    {
+        std::lock_guard<std::mutex> lock(m_connectionMutex);
+        m_stopping = true;
+        connection = std::move(m_connection);
+        m_stateChanged.notify_all();
+    }
+
+    if (m_inactivityThread.joinable())
+    {
+        m_inactivityThread.join();
+    }
+    StopConnecting(std::move(connection));
+}
+
+std::shared_ptr<StreamSession> StreamSession::Attach(const StreamConfig& config, obs_source_t* source,
+    std::chrono::seconds inactiveTimeout)
+{
+    SessionTable& table = GetTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    std::shared_ptr<StreamSession> session;
+    auto entry = table.sessions.find(config);
+    if (entry != table.sessions.end())
+    {
+        session = entry->second.lock();
+    }
+
+    bool created = session == nullptr;
+    if (created)
+    {
+        session = std::shared_ptr<StreamSession>(new StreamSession(config));
+        table.sessions[config] = session;
+    }
+
+    // Frames are paced by the session, so OBS shows each as soon as it's output
+    obs_source_set_async_unbuffered(source, true);
+
+    size_t sourceCount = 0;
+    {
+        std::lock_guard<std::mutex> sourcesLock(session->m_sourcesMutex);
+        session->m_sources.push_back({ source, obs_source_showing(source), obs_source_active(source), inactiveTimeout });
+        sourceCount = session->m_sources.size();
+    }
+
+    std::lock_guard<std::mutex> connectionLock(session->m_connectionMutex);
+    if (created)
+    {
+        // Connect even if the source isn't shown yet, as it was asked to; the connection
+        // is dropped again if it stays inactive
+        session->StartConnecting();
+        session->m_inactivityThread = std::thread(&StreamSession::WatchInactivity, session.get());
+    }
+    else
+    {
+        obs_log(LOG_INFO, "Sharing the stream of app %d on %s with %zu sources", config.appID,
+            config.uniqueID.c_str(), sourceCount);
+    }
+    session->ApplySourceState();
+
+    return session;
+}
+
+void StreamSession::Detach(obs_source_t* source)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sourcesMutex);
+        m_sources.erase(std::remove_if(m_sources.begin(), m_sources.end(), [source](const AttachedSource& attached)
+        {
+            return attached.source == source;
+        }), m_sources.end());
+    }
+
+    std::lock_guard<std::mutex> lock(m_connectionMutex);
+    ApplySourceState();
+}
+
+void StreamSession::SetSourceShowing(obs_source_t* source, bool showing)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sourcesMutex);
+        for (AttachedSource& attached : m_sources)
+        {
+            if (attached.source == source)
+            {
+                attached.showing = showing;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_connectionMutex);
+    ApplySourceState();
+}
+
+void StreamSession::SetSourceActive(obs_source_t* source, bool active)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sourcesMutex);
+        for (AttachedSource& attached : m_sources)
+        {
+            if (attached.source == source)
+            {
+                attached.active = active;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_connectionMutex);
+    ApplySourceState();
+}
+
+void StreamSession::SetInactiveTimeout(obs_source_t* source, std::chrono::seconds inactiveTimeout)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sourcesMutex);
+        for (AttachedSource& attached : m_sources)
+        {
+            if (attached.source == source)
+            {
+                attached.inactiveTimeout = inactiveTimeout;
+            }
+        }
+    }
+
+    // Wake the inactivity thread, so it waits for the new timeout
+    std::lock_guard<std::mutex> lock(m_connectionMutex);
+    ApplySourceState();
+}
+
+void StreamSession::OutputVideo(const obs_source_frame& frame) const
+{
+    std::lock_guard<std::mutex> lock(m_sourcesMutex);
+    for (const AttachedSource& attached : m_sources)
+    {
+        if (attached.showing)
+        {
+            obs_source_output_video(attached.source, &frame);
+        }
+    }
+}
+
+void StreamSession::StartConnecting()
+{
+    if (m_stopping || m_connection != nullptr)
+    {
+        return;
+    }
+
+    bool showing = false;
+    bool active = false;
+    std::chrono::seconds inactiveTimeout(0);
+    GetSourceState(showing, active, inactiveTimeout);
+
+    m_connection = std::make_unique<Connection>(m_config, *this);
+    m_connection->orchestrator.SetDecodingPaused(!showing);
+    m_connection->thread = std::thread(&Connection::Run, m_connection.get());
+}
+
+void StreamSession::StopConnecting(std::unique_ptr<Connection> connection)
+{
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    SessionTable& table = GetTable();
+    {
+        // Wake the connecting thread if it's waiting for the connection
+        std::lock_guard<std::mutex> lock(table.mutex);
+        connection->stopping = true;
+        table.connectionReleased.notify_all();
+    }
+
+    // Abort connecting if it's still in progress, then stop the streams. This waits for the
+    // decoding thread, which outputs frames under m_sourcesMutex, so no locks may be held.
+    connection->orchestrator.Interrupt();
+    if (connection->thread.joinable())
+    {
+        connection->thread.join();
+    }
+    connection->orchestrator.Disconnect();
+
+    if (connection->holdsConnection)
+    {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        table.connectionActive = false;
+        table.connectionReleased.notify_all();
+    }
+}
+
+void StreamSession::ApplySourceState()
+{
+    if (m_stopping)
+    {
+        return;
+    }
+
+    bool showing = false;
+    bool active = false;
+    std::chrono::seconds inactiveTimeout(0);
+    GetSourceState(showing, active, inactiveTimeout);
+
+    // Reconnect once a source is used again after the session disconnected for inactivity.
+    // The app is still running on the host, so it's resumed rather than relaunched.
+    if ((showing || active) && m_connection == nullptr)
+    {
+        obs_log(LOG_INFO, "Reconnecting to app %d on %s, as a source was activated", m_config.appID,
+            m_config.uniqueID.c_str());
+        StartConnecting();
+    }
+
+    // Skip decoding while no source is shown
+    if (m_connection != nullptr)
+    {
+        m_connection->orchestrator.SetDecodingPaused(!showing);
+    }
+
+    m_stateChanged.notify_all();
+}
+
+void StreamSession::OnConnectionTerminated(Connection& connection, int errorCode)
+{
+    std::lock_guard<std::mutex> lock(m_connectionMutex);
+    connection.terminatedError = errorCode;
+    m_stateChanged.notify_all();
+}
+
+void StreamSession::WatchInactivity()
+{
+    os_set_thread_name("moonlight-obs: inactivity");
+
+    std::unique_lock<std::mutex> lock(m_connectionMutex);
+    // When the sources stopped being used, if they aren't
+    std::optional<std::chrono::steady_clock::time_point> inactiveSince;
+    while (!m_stopping)
+    {
+        bool showing = false;
+        bool active = false;
+        std::chrono::seconds inactiveTimeout(0);
+        GetSourceState(showing, active, inactiveTimeout);
+
+        // Stop the streams once they've ended, releasing the connection of moonlight-common-c
+        if (m_connection != nullptr && m_connection->terminatedError.has_value())
+        {
+            int errorCode = *m_connection->terminatedError;
+            inactiveSince.reset();
+            std::unique_ptr<Connection> connection = std::move(m_connection);
+            lock.unlock();
+            StopConnecting(std::move(connection));
+            lock.lock();
+
+            // Reconnect straight away if the streams were lost while in use, but not if the host
+            // ended them (such as when the app was quit), until a source is activated again
+            if (errorCode != ML_ERROR_GRACEFUL_TERMINATION && (showing || active) && !m_stopping)
+            {
+                obs_log(LOG_INFO, "Reconnecting to app %d on %s, as the stream was lost", m_config.appID,
+                    m_config.uniqueID.c_str());
+                StartConnecting();
+            }
+            continue;
+        }
+
+        if (m_connection == nullptr || showing || active || inactiveTimeout.count() == 0)
+        {
+            inactiveSince.reset();
+            m_stateChanged.wait(lock);
+            continue;
+        }
+
+        // Disconnect if no source is used again before the timeout
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (!inactiveSince.has_value())
+        {
+            inactiveSince = now;
+        }
+        if (now < *inactiveSince + inactiveTimeout)
+        {
+            m_stateChanged.wait_until(lock, *inactiveSince + inactiveTimeout);
+            continue;
+        }
+
+        obs_log(LOG_INFO, "Disconnecting from app %d on %s, as its sources have been inactive for %lld seconds",
+            m_config.appID, m_config.uniqueID.c_str(), static_cast<long long>(inactiveTimeout.count()));
+
+        inactiveSince.reset();
+        std::unique_ptr<Connection> connection = std::move(m_connection);
+        lock.unlock();
+        StopConnecting(std::move(connection));
+        lock.lock();
+    }
+}
+
+void StreamSession::GetSourceState(bool& showing, bool& active, std::chrono::seconds& inactiveTimeout) const
+{
+    std::lock_guard<std::mutex> lock(m_sourcesMutex);
+
+    showing = false;
+    active = false;
+    // A source which never lets the session disconnect keeps it connected while it's attached
+    bool keepConnected = false;
+    inactiveTimeout = std::chrono::seconds(0);
+    for (const AttachedSource& attached : m_sources)
+    {
+        showing = showing || attached.showing;
+        active = active || attached.active;
+        keepConnected = keepConnected || attached.inactiveTimeout.count() == 0;
+        inactiveTimeout = std::max(inactiveTimeout, attached.inactiveTimeout);
+    }
+
+    if (keepConnected)
+    {
+        inactiveTimeout = std::chrono::seconds(0);
+    }
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+// STL includes
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// OBS Studio includes
+#include <obs.h>
+
+// Project includes
+#include "StreamConfig.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief A stream from a host, shared by every source showing the same host and app with the same config.
+     *
+     * Sessions are kept in a process-wide registry keyed by their StreamConfig. The first source
+     * to attach to a config starts the session, later sources share it, and the session
+     * disconnects once the last source has released it. Each frame is received and decoded once
+     * and output to every attached source; OBS copies async frames when they're output, so the
+     * same decoded buffer serves every source.
+     *
+     * The session follows the visibility of its sources: while none of them are shown, frames
+     * are dropped before decoding (and an IDR frame is requested once one is shown again),
+     * and once none of them have been active for their inactive timeout, the session
+     * disconnects until one of them is activated again. When the streams end, the session
+     * disconnects too, and reconnects straight away if they were lost while in use.
+     *
+     * moonlight-common-c supports one connection per process, so a session waits for the
+     * session before it to disconnect before it connects.
+     *
+     */
+    class StreamSession
+    {
+    public:
+        /**
+         * @brief Attaches a source to the session of a config, starting the session if there isn't one.
+         * @note Connecting runs on a background thread, so this returns immediately.
+         *
+         * @param config The host, app and stream parameters of the source.
+         * @param source The source, which frames are output to until it's detached.
+         * @param inactiveTimeout How long the source may be inactive before it lets the session
+         *                        disconnect, or zero to keep the session connected while it's attached.
+         * @return std::shared_ptr<StreamSession> The session, which stays alive while it's held.
+         */
+        static std::shared_ptr<StreamSession> Attach(const StreamConfig& config, obs_source_t* source,
+            std::chrono::seconds inactiveTimeout);
+
+        /**
+         * @brief Detaches a source, so frames are no longer output to it.
+         * @note The session disconnects once every reference to it has been released.
+         *
+         * @param source The source.
+         */
+        void Detach(obs_source_t* source);
+
+        /**
+         * @brief Sets whether a source is shown (in any view), which frames are only decoded for.
+         *
+         * @param source The source.
+         * @param showing Is the source shown?
+         */
+        void SetSourceShowing(obs_source_t* source, bool showing);
+
+        /**
+         * @brief Sets whether a source is active (shown on the program output),
+         *        which the session stays connected for.
+         *
+         * @param source The source.
+         * @param active Is the source active?
+         */
+        void SetSourceActive(obs_source_t* source, bool active);
+
+        /**
+         * @brief Sets how long a source may be inactive before it lets the session disconnect.
+         *
+         * @param source The source.
+         * @param inactiveTimeout The inactive timeout, or zero to keep the session connected while it's attached.
+         */
+        void SetInactiveTimeout(obs_source_t* source, std::chrono::seconds inactiveTimeout);
+
+        /**
+         * @brief Disconnects from the host, aborting connecting if it's in progress.
+         *
+         */
+        ~StreamSession();
+
+        StreamSession(const StreamSession&)             = delete;
+        StreamSession& operator=(const StreamSession&)  = delete;
+
+        /**
+         * @brief Outputs a decoded frame to every attached source which is shown.
+         *
+         * @param frame The frame.
+         */
+        void OutputVideo(const obs_source_frame& frame) const;
+
+        /**
+         * @brief Gets the host, app and stream parameters of the session.
+         *
+         * @return const StreamConfig& The config of the session.
+         */
+        inline const StreamConfig& GetConfig() const
+        {
+            return m_config;
+        }
+
+    private:
+        // A source attached to the session
+        struct AttachedSource
+        {
+            obs_source_t* source;                   // The source
+            bool showing;                           // Is it shown in any view?
+            bool active;                            // Is it shown on the program output?
+            std::chrono::seconds inactiveTimeout;   // How long it may be inactive before the session disconnects
+        };
+
+        // A connection to the host, and the thread connecting it
+        struct Connection;
+
+        // Host, app and stream parameters
+        StreamConfig m_config;
+
+        // Guards the attached sources
+        mutable std::mutex m_sourcesMutex;
+        // Sources frames are output to
+        std::vector<AttachedSource> m_sources;
+
+        // Guards the members below
+        std::mutex m_connectionMutex;
+        // Connection to the host, if connecting or connected
+        std::unique_ptr<Connection> m_connection;
+        // Signalled when the sources change state, or the session is stopping
+        std::condition_variable m_stateChanged;
+        // Thread disconnecting the session once its sources have been inactive for long enough
+        std::thread m_inactivityThread;
+        // Is the session being destroyed?
+        bool m_stopping;
+
+        explicit StreamSession(const StreamConfig& config);
+
+        // Starts connecting to the host, if not already (m_connectionMutex must be held)
+        void StartConnecting();
+        // Aborts connecting, and stops the streams of a connection (without any locks held)
+        static void StopConnecting(std::unique_ptr<Connection> connection);
+        // Applies the state of the sources to the connection (m_connectionMutex must be held)
+        void ApplySourceState();
+        // Marks a connection as ended, so m_inactivityThread disconnects it (called by moonlight-common-c)
+        void OnConnectionTerminated(Connection& connection, int errorCode);
+        // Disconnects the session once its sources have been inactive for long enough,
+        // or its streams have ended (runs on m_inactivityThread)
+        void WatchInactivity();
+
+        // Gets whether any source is shown, whether any is active, and the longest inactive timeout
+        void GetSourceState(bool& showing, bool& active, std::chrono::seconds& inactiveTimeout) const;
+    };
+} // namespace MoonlightOBS
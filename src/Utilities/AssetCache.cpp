@@ -0,0 +1,454 @@
+#include "AssetCache.hpp"
+
+// STL includes
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// OpenSSL includes
+#include <openssl/evp.h>
+
+// OBS Studio includes
+#include <util/base.h>
+#include <util/platform.h>
+
+// Project includes
+#include "../plugin-support.h"
+#include "FileIO.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // First line of the index, identifying its format
+    constexpr std::string_view IndexHeader = "moonlight-obs asset cache 1\n";
+    // Hash of a line recording that a key was removed
+    constexpr std::string_view RemovedHash = "-";
+    // Fewest lines of the index before it's rewritten, however few keys it holds
+    constexpr size_t MinimumCompactionLines = 64;
+    // Name of the index within the directory of the cache
+    constexpr const char* IndexFileName = "index";
+    // Extension of the files in the cache
+    constexpr const char* FileExtension = ".bin";
+
+    // Calculates the lowercase hexadecimal SHA-256 hash of data
+    std::string HashContents(std::string_view contents)
+    {
+        std::array<unsigned char, EVP_MAX_MD_SIZE> hash;
+        unsigned int hashLength = 0;
+        if (EVP_Digest(contents.data(), contents.size(), hash.data(), &hashLength, EVP_sha256(), nullptr) != 1)
+        {
+            throw std::runtime_error("Failed to hash the asset");
+        }
+
+        constexpr std::string_view digits = "0123456789abcdef";
+        std::string result;
+        result.reserve(hashLength * 2);
+        for (unsigned int i = 0; i < hashLength; ++i)
+        {
+            result.push_back(digits[hash[i] >> 4]);
+            result.push_back(digits[hash[i] & 0x0F]);
+        }
+
+        return result;
+    }
+
+    // Parses an unsigned integer field of the index
+    bool ParseField(std::string_view text, uint64_t& value)
+    {
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size();
+    }
+
+    // Appends a line of the index
+    void AppendLine(std::string& index, std::string_view hash, uint64_t lastUsed, uint64_t size, std::string_view key)
+    {
+        index.append(hash).push_back('\t');
+        index.append(std::to_string(lastUsed)).push_back('\t');
+        index.append(std::to_string(size)).push_back('\t');
+        index.append(key).push_back('\n');
+    }
+}
+
+AssetCache::AssetCache(std::string directory, uint64_t maxSize)
+    : m_directory(std::move(directory)), m_maxSize(maxSize), m_totalSize(0), m_useCounter(0), m_dirty(false),
+      m_indexLines(0), m_indexCurrent(false)
+{
+    os_mkdirs(m_directory.c_str());
+
+    try
+    {
+        LoadIndex();
+    }
+    catch (const std::exception& exception)
+    {
+        // Without the index the files can't be found, so the cache starts empty
+        obs_log(LOG_WARNING, "Failed to load asset cache index: %s", exception.what());
+        m_entries.clear();
+        m_files.clear();
+        m_totalSize = 0;
+        m_indexCurrent = false;
+    }
+
+    // Files the index doesn't list would otherwise stay on disk outside of the maximum size
+    if (!m_indexCurrent)
+    {
+        RemoveUnlistedFiles();
+    }
+}
+
+AssetCache::~AssetCache()
+{
+    Flush();
+}
+
+std::unique_ptr<MappedFile> AssetCache::Get(std::string_view key)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto entry = m_entries.find(std::string(key));
+    if (entry == m_entries.end())
+    {
+        return nullptr;
+    }
+
+    std::unique_ptr<MappedFile> file;
+    try
+    {
+        file = std::make_unique<MappedFile>(GetFilePath(entry->second.hash));
+    }
+    catch (const std::exception& exception)
+    {
+        obs_log(LOG_WARNING, "Failed to read cached asset: %s", exception.what());
+    }
+
+    // Forget the key if its file has been removed from under the cache
+    if (file == nullptr || !file->Exists())
+    {
+        RemoveEntry(entry);
+        m_dirty = true;
+        return nullptr;
+    }
+
+    entry->second.lastUsed = ++m_useCounter;
+    m_dirty = true;
+
+    return file;
+}
+
+void AssetCache::Put(std::string_view key, std::string_view contents)
+{
+    if (key.empty() || key.find_first_of("\t\r\n") != std::string_view::npos)
+    {
+        throw std::invalid_argument("Invalid asset cache key");
+    }
+
+    // Hash the contents before locking, as it's the most expensive part of storing a file
+    std::string hash = HashContents(contents);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto entry = m_entries.find(std::string(key));
+    if (entry != m_entries.end())
+    {
+        // Nothing needs to be written if the contents haven't changed
+        if (entry->second.hash == hash)
+        {
+            entry->second.lastUsed = ++m_useCounter;
+            m_dirty = true;
+            return;
+        }
+
+        RemoveEntry(entry);
+    }
+
+    // Write the file, unless it's already stored under another key
+    auto file = m_files.find(hash);
+    if (file == m_files.end())
+    {
+        FileIO::WriteAtomically(GetFilePath(hash), contents);
+
+        file = m_files.emplace(hash, File{ contents.size(), 0 }).first;
+        m_totalSize += contents.size();
+    }
+    ++file->second.references;
+
+    AppendLine(m_pendingLines, hash, ++m_useCounter, file->second.size, key);
+    m_entries.emplace(std::string(key), Entry{ std::move(hash), m_useCounter });
+
+    Evict();
+    WritePendingLines();
+}
+
+void AssetCache::Flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_dirty)
+    {
+        return;
+    }
+
+    try
+    {
+        SaveIndex();
+    }
+    catch (const std::exception& exception)
+    {
+        obs_log(LOG_WARNING, "Failed to save asset cache index: %s", exception.what());
+    }
+}
+
+void AssetCache::LoadIndex()
+{
+    MappedFile index(GetIndexPath());
+    std::string_view data = index.GetView();
+    if (!index.Exists())
+    {
+        return;
+    }
+    else if (data.substr(0, IndexHeader.size()) != IndexHeader)
+    {
+        throw std::runtime_error("Unknown index format");
+    }
+    data.remove_prefix(IndexHeader.size());
+
+    // Each line holds the hash, last use and size of a file, and the key stored under it.
+    // Lines are appended as files are stored, so a later line of a key replaces the earlier
+    // ones, and a line with the removed hash records that the key was removed.
+    std::unordered_map<std::string, std::pair<Entry, uint64_t>> entries;
+    size_t lines = 0;
+    bool truncated = false;
+    while (!data.empty())
+    {
+        size_t lineEnd = data.find('\n');
+        if (lineEnd == std::string_view::npos)
+        {
+            // Appending the last line was cut short (such as by a crash), so only its change is lost
+            obs_log(LOG_WARNING, "Ignoring truncated asset cache index entry");
+            truncated = true;
+            break;
+        }
+        std::string_view line = data.substr(0, lineEnd);
+        data.remove_prefix(lineEnd + 1);
+        lines++;
+
+        std::array<std::string_view, 4> fields;
+        for (size_t i = 0; i < fields.size(); ++i)
+        {
+            size_t fieldEnd = i + 1 < fields.size() ? line.find('\t') : line.size();
+            if (fieldEnd == std::string_view::npos)
+            {
+                throw std::runtime_error("Malformed index entry");
+            }
+
+            fields[i] = line.substr(0, fieldEnd);
+            line.remove_prefix(std::min(fieldEnd + 1, line.size()));
+        }
+
+        uint64_t lastUsed = 0;
+        uint64_t size = 0;
+        bool removed = fields[0] == RemovedHash;
+        if ((!removed && (fields[0].empty() || fields[0].find_first_not_of("0123456789abcdef") != std::string_view::npos)) ||
+            !ParseField(fields[1], lastUsed) || !ParseField(fields[2], size) || fields[3].empty())
+        {
+            throw std::runtime_error("Malformed index entry");
+        }
+
+        if (removed)
+        {
+            entries.erase(std::string(fields[3]));
+        }
+        else
+        {
+            entries[std::string(fields[3])] = { Entry{ std::string(fields[0]), lastUsed }, size };
+        }
+
+        m_useCounter = std::max(m_useCounter, lastUsed);
+    }
+
+    for (auto& [key, value] : entries)
+    {
+        auto& [entry, size] = value;
+        auto [file, isNew] = m_files.emplace(entry.hash, File{ size, 0 });
+        if (isNew)
+        {
+            m_totalSize += size;
+        }
+        ++file->second.references;
+
+        m_entries.emplace(key, std::move(entry));
+    }
+
+    // Appending to a truncated line would corrupt the next, so the index is rewritten instead
+    m_indexLines = lines;
+    m_indexCurrent = !truncated;
+    m_dirty = truncated;
+}
+
+void AssetCache::SaveIndex()
+{
+    std::string index;
+    index.reserve(IndexHeader.size() + m_entries.size() * 128);
+    index.append(IndexHeader);
+
+    for (const auto& [key, entry] : m_entries)
+    {
+        AppendLine(index, entry.hash, entry.lastUsed, m_files.at(entry.hash).size, key);
+    }
+
+    FileIO::WriteAtomically(GetIndexPath(), index);
+    m_dirty = false;
+    m_pendingLines.clear();
+    m_indexLines = m_entries.size();
+    m_indexCurrent = true;
+}
+
+void AssetCache::WritePendingLines()
+{
+    size_t pendingLines = static_cast<size_t>(std::count(m_pendingLines.begin(), m_pendingLines.end(), '\n'));
+
+    // Rewrite the index if appending isn't possible, or once most of its lines are outdated
+    if (!m_indexCurrent || m_indexLines + pendingLines > std::max(m_entries.size() * 2, MinimumCompactionLines))
+    {
+        try
+        {
+            SaveIndex();
+        }
+        catch (const std::exception& exception)
+        {
+            obs_log(LOG_WARNING, "Failed to save asset cache index: %s", exception.what());
+            m_pendingLines.clear();
+            m_indexCurrent = false;
+            m_dirty = true;
+        }
+        return;
+    }
+
+    try
+    {
+        FileIO::Append(GetIndexPath(), m_pendingLines);
+        m_indexLines += pendingLines;
+    }
+    catch (const std::exception& exception)
+    {
+        // The index is rewritten by the next store or flush instead
+        obs_log(LOG_WARNING, "Failed to update asset cache index: %s", exception.what());
+        m_indexCurrent = false;
+        m_dirty = true;
+    }
+    m_pendingLines.clear();
+}
+
+void AssetCache::RemoveUnlistedFiles()
+{
+    os_dir_t* directory = os_opendir(m_directory.c_str());
+    if (directory == nullptr)
+    {
+        return;
+    }
+
+    // The files are removed once the directory is closed, as removing them while reading it may skip some
+    const std::string_view extension = FileExtension;
+    std::vector<std::string> unlisted;
+    while (os_dirent* file = os_readdir(directory))
+    {
+        std::string_view name = file->d_name;
+        if (file->directory || name.size() <= extension.size() ||
+            name.substr(name.size() - extension.size()) != extension)
+        {
+            continue;
+        }
+
+        std::string hash(name.substr(0, name.size() - extension.size()));
+        if (m_files.find(hash) == m_files.end())
+        {
+            unlisted.push_back(std::move(hash));
+        }
+    }
+    os_closedir(directory);
+
+    size_t removed = 0;
+    for (const std::string& hash : unlisted)
+    {
+        try
+        {
+            removed += FileIO::Remove(GetFilePath(hash)) ? 1 : 0;
+        }
+        catch (const std::exception& exception)
+        {
+            obs_log(LOG_WARNING, "Failed to remove cached asset: %s", exception.what());
+        }
+    }
+
+    if (removed > 0)
+    {
+        obs_log(LOG_INFO, "Removed %zu cached assets missing from the index", removed);
+    }
+}
+
+void AssetCache::RemoveEntry(std::unordered_map<std::string, Entry>::iterator entry)
+{
+    auto file = m_files.find(entry->second.hash);
+    if (file != m_files.end() && --file->second.references == 0)
+    {
+        try
+        {
+            FileIO::Remove(GetFilePath(file->first));
+        }
+        catch (const std::exception& exception)
+        {
+            obs_log(LOG_WARNING, "Failed to remove cached asset: %s", exception.what());
+        }
+
+        m_totalSize -= file->second.size;
+        m_files.erase(file);
+    }
+
+    AppendLine(m_pendingLines, RemovedHash, 0, 0, entry->first);
+    m_entries.erase(entry);
+}
+
+void AssetCache::Evict()
+{
+    if (m_totalSize <= m_maxSize)
+    {
+        return;
+    }
+
+    // Order the entries from least to most recently used
+    std::vector<std::unordered_map<std::string, Entry>::iterator> entries;
+    entries.reserve(m_entries.size());
+    for (auto entry = m_entries.begin(); entry != m_entries.end(); ++entry)
+    {
+        entries.push_back(entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& first, const auto& second)
+    {
+        return first->second.lastUsed < second->second.lastUsed;
+    });
+
+    // Remove entries until the cache fits, always keeping the most recently used one
+    for (size_t i = 0; m_totalSize > m_maxSize && i + 1 < entries.size(); ++i)
+    {
+        RemoveEntry(entries[i]);
+    }
+}
+
+std::string AssetCache::GetFilePath(std::string_view hash) const
+{
+    return m_directory + "/" + std::string(hash) + FileExtension;
+}
+
+std::string AssetCache::GetIndexPath() const
+{
+    return m_directory + "/" + IndexFileName;
+}
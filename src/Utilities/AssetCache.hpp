@@ -0,0 +1,139 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Project includes
+#include "FileIO.hpp"
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Size-bounded, least recently used cache of files in a directory.
+     *
+     * Files are content-addressed, stored under the SHA-256 hash of their contents,
+     * so identical files stored under different keys (such as the same box art
+     * shared by several hosts) are only stored once. Reads memory-map the file
+     * instead of copying it. An index maps the keys to the files and records when
+     * each key was last used, so the least recently used files are removed first
+     * once the cache grows beyond its maximum size.
+     *
+     * Storing a file appends its changes to the index, rather than rewriting it, and
+     * the index is only rewritten once it holds several times more lines than keys,
+     * so the cost of keeping the index on disk stays proportional to what's stored.
+     *
+     * @note Thread-safe.
+     */
+    class AssetCache
+    {
+    public:
+        /**
+         * @brief Construct a new AssetCache object, loading its index.
+         * @note The directory is created if it doesn't exist.
+         *
+         * @param directory The UTF-8 path of the directory holding the cache.
+         * @param maxSize The maximum total size of the files in the cache, in bytes.
+         */
+        AssetCache(std::string directory, uint64_t maxSize);
+
+        /**
+         * @brief Saves the index, if it has changed.
+         *
+         */
+        ~AssetCache();
+
+        AssetCache(const AssetCache&)               = delete;
+        AssetCache& operator=(const AssetCache&)    = delete;
+
+        /**
+         * @brief Gets the file stored under a key, marking it as the most recently used.
+         *
+         * @param key The key of the file.
+         * @return std::unique_ptr<MappedFile> The mapped file, or null if the cache doesn't hold the key.
+         */
+        std::unique_ptr<MappedFile> Get(std::string_view key);
+
+        /**
+         * @brief Stores a file under a key, replacing any file stored under it,
+         *        and removes the least recently used files if the cache has grown too large.
+         *
+         * @param key The key of the file (which can't contain tabs or line breaks).
+         * @param contents The contents of the file.
+         *
+         * @exception std::invalid_argument If the key is invalid.
+         * @exception std::runtime_error If the file could not be written.
+         */
+        void Put(std::string_view key, std::string_view contents);
+
+        /**
+         * @brief Saves the index, if it has changed since it was last saved.
+         * @note Reads only change the index in memory, so it should be saved before exiting.
+         *
+         */
+        void Flush();
+
+    private:
+        // Entry of the index for a key
+        struct Entry
+        {
+            std::string hash;   // Hash of the file stored under the key
+            uint64_t lastUsed;  // Value of the use counter when the key was last used
+        };
+
+        // A file stored in the cache
+        struct File
+        {
+            uint64_t size;      // Size of the file
+            size_t references;  // Number of keys the file is stored under
+        };
+
+        // Guards the members below
+        std::mutex m_mutex;
+
+        // Directory holding the cache
+        std::string m_directory;
+        // Maximum total size of the files
+        uint64_t m_maxSize;
+
+        // Keys of the cache, and the files they're stored under
+        std::unordered_map<std::string, Entry> m_entries;
+        // Files of the cache, keyed by their hashes
+        std::unordered_map<std::string, File> m_files;
+        // Total size of the files
+        uint64_t m_totalSize;
+        // Counter ordering the uses of the keys
+        uint64_t m_useCounter;
+        // Has the index changed since it was last saved?
+        bool m_dirty;
+        // Lines of the index changed by the current store, which are appended together
+        std::string m_pendingLines;
+        // Number of lines in the index on disk
+        size_t m_indexLines;
+        // Does the index on disk hold every change, other than those pending?
+        bool m_indexCurrent;
+
+        // Loads the index, dropping the entries whose files are missing
+        void LoadIndex();
+        // Saves the index
+        void SaveIndex();
+        // Appends the pending lines to the index, or rewrites it once it has grown too large
+        void WritePendingLines();
+        // Removes the files in the directory which the index doesn't list
+        void RemoveUnlistedFiles();
+        // Removes the entry of a key, and its file if no other key references it
+        void RemoveEntry(std::unordered_map<std::string, Entry>::iterator entry);
+        // Removes the least recently used entries until the cache fits within its maximum size
+        void Evict();
+
+        // Gets the path of the file with the given hash
+        std::string GetFilePath(std::string_view hash) const;
+        // Gets the path of the index
+        std::string GetIndexPath() const;
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,32 @@
+#pragma once
+
+// STL includes
+#include <memory>
+
+// FFmpeg includes
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavutil/frame.h>
+}
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Frees FFmpeg objects with their matching free function.
+     *
+     */
+    struct FFmpegDeleter
+    {
+        inline void operator()(AVCodecContext* context) const { avcodec_free_context(&context); }
+        inline void operator()(AVFrame* frame) const { av_frame_free(&frame); }
+        inline void operator()(AVPacket* packet) const { av_packet_free(&packet); }
+    };
+
+    /**
+     * @brief Owning pointer to an FFmpeg object.
+     *
+     */
+    template <typename T>
+    using FFmpegPointer = std::unique_ptr<T, FFmpegDeleter>;
+} // namespace MoonlightOBS
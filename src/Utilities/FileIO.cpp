@@ -0,0 +1,373 @@
+#include "FileIO.hpp"
+
+// STL includes
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// Platform includes
+// (NOMINMAX is defined first, so the Windows headers don't define min and max as macros)
+#if defined(_WIN32) || defined(_WIN64)
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <cerrno>
+  #include <cstdio>
+  #include <cstring>
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+// OBS Studio includes
+#include <obs-module.h>
+#include <util/bmem.h>
+#include <util/platform.h>
+
+using namespace MoonlightOBS;
+
+namespace
+{
+#if defined(_WIN32) || defined(_WIN64)
+    // Converts a UTF-8 path to the UTF-16 path used by the Windows API
+    std::wstring ToWidePath(const std::string& path)
+    {
+        int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), static_cast<int>(path.size()), nullptr, 0);
+        std::wstring widePath(static_cast<size_t>(length), L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, path.c_str(), static_cast<int>(path.size()), widePath.data(), length);
+
+        return widePath;
+    }
+
+    // Gets a description of the last error
+    std::string GetLastErrorString()
+    {
+        return "error " + std::to_string(GetLastError());
+    }
+#else
+    // Gets a description of the last error
+    std::string GetLastErrorString()
+    {
+        return std::strerror(errno);
+    }
+#endif
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+MappedFile::MappedFile(const std::string& path)
+    : m_data(nullptr), m_size(0), m_exists(false)
+{
+    HANDLE file = CreateFileW(ToWidePath(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        DWORD error = GetLastError();
+        if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND)
+        {
+            return;
+        }
+
+        throw std::runtime_error("Failed to open " + path + ": " + GetLastErrorString());
+    }
+    m_exists = true;
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(file, &size))
+    {
+        std::string error = GetLastErrorString();
+        CloseHandle(file);
+        throw std::runtime_error("Failed to get the size of " + path + ": " + error);
+    }
+
+    // Empty files can't be mapped
+    if (size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return;
+    }
+
+    // The view keeps the mapping (and file) open, so both handles can be closed
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr)
+    {
+        throw std::runtime_error("Failed to map " + path + ": " + GetLastErrorString());
+    }
+
+    m_data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (m_data == nullptr)
+    {
+        throw std::runtime_error("Failed to map " + path + ": " + GetLastErrorString());
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        UnmapViewOfFile(m_data);
+    }
+}
+
+void FileIO::WriteAtomically(const std::string& path, std::string_view contents)
+{
+    std::wstring widePath = ToWidePath(path);
+    std::wstring temporaryPath = widePath + L".tmp";
+
+    HANDLE file = CreateFileW(temporaryPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Failed to create " + path + ".tmp: " + GetLastErrorString());
+    }
+
+    // Write the contents, and flush them to disk before the rename makes them visible
+    bool succeeded = true;
+    size_t written = 0;
+    while (succeeded && written < contents.size())
+    {
+        DWORD chunkWritten = 0;
+        DWORD chunkSize = static_cast<DWORD>(std::min<size_t>(contents.size() - written, MAXDWORD));
+        succeeded = WriteFile(file, contents.data() + written, chunkSize, &chunkWritten, nullptr) != FALSE;
+        written += chunkWritten;
+    }
+    succeeded = succeeded && FlushFileBuffers(file) != FALSE;
+
+    std::string error = succeeded ? std::string() : GetLastErrorString();
+    CloseHandle(file);
+
+    if (succeeded && !MoveFileExW(temporaryPath.c_str(), widePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+    {
+        succeeded = false;
+        error = GetLastErrorString();
+    }
+
+    if (!succeeded)
+    {
+        DeleteFileW(temporaryPath.c_str());
+        throw std::runtime_error("Failed to write " + path + ": " + error);
+    }
+}
+
+void FileIO::Append(const std::string& path, std::string_view contents)
+{
+    HANDLE file = CreateFileW(ToWidePath(path).c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        throw std::runtime_error("Failed to open " + path + ": " + GetLastErrorString());
+    }
+
+    bool succeeded = true;
+    size_t written = 0;
+    while (succeeded && written < contents.size())
+    {
+        DWORD chunkWritten = 0;
+        DWORD chunkSize = static_cast<DWORD>(std::min<size_t>(contents.size() - written, MAXDWORD));
+        succeeded = WriteFile(file, contents.data() + written, chunkSize, &chunkWritten, nullptr) != FALSE;
+        written += chunkWritten;
+    }
+
+    std::string error = succeeded ? std::string() : GetLastErrorString();
+    CloseHandle(file);
+
+    if (!succeeded)
+    {
+        throw std::runtime_error("Failed to append to " + path + ": " + error);
+    }
+}
+
+bool FileIO::Remove(const std::string& path)
+{
+    if (DeleteFileW(ToWidePath(path).c_str()))
+    {
+        return true;
+    }
+
+    DWORD error = GetLastError();
+    if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND)
+    {
+        return false;
+    }
+
+    throw std::runtime_error("Failed to remove " + path + ": " + GetLastErrorString());
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+    : m_data(nullptr), m_size(0), m_exists(false)
+{
+    int file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0)
+    {
+        if (errno == ENOENT)
+        {
+            return;
+        }
+
+        throw std::runtime_error("Failed to open " + path + ": " + GetLastErrorString());
+    }
+    m_exists = true;
+
+    struct stat status = {};
+    if (fstat(file, &status) != 0)
+    {
+        std::string error = GetLastErrorString();
+        close(file);
+        throw std::runtime_error("Failed to get the size of " + path + ": " + error);
+    }
+
+    // Empty files can't be mapped
+    if (status.st_size == 0)
+    {
+        close(file);
+        return;
+    }
+
+    // The mapping keeps the file open, so the descriptor can be closed
+    void* data = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        throw std::runtime_error("Failed to map " + path + ": " + GetLastErrorString());
+    }
+
+    m_data = data;
+    m_size = static_cast<size_t>(status.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<void*>(m_data), m_size);
+    }
+}
+
+void FileIO::WriteAtomically(const std::string& path, std::string_view contents)
+{
+    std::string temporaryPath = path + ".tmp";
+
+    int file = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (file < 0)
+    {
+        throw std::runtime_error("Failed to create " + temporaryPath + ": " + GetLastErrorString());
+    }
+
+    // Write the contents, and flush them to disk before the rename makes them visible
+    bool succeeded = true;
+    size_t written = 0;
+    while (succeeded && written < contents.size())
+    {
+        ssize_t chunkWritten = write(file, contents.data() + written, contents.size() - written);
+        if (chunkWritten < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        succeeded = chunkWritten > 0;
+        written += succeeded ? static_cast<size_t>(chunkWritten) : 0;
+    }
+    succeeded = succeeded && fsync(file) == 0;
+
+    std::string error = succeeded ? std::string() : GetLastErrorString();
+    close(file);
+
+    if (succeeded && rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        succeeded = false;
+        error = GetLastErrorString();
+    }
+
+    if (!succeeded)
+    {
+        unlink(temporaryPath.c_str());
+        throw std::runtime_error("Failed to write " + path + ": " + error);
+    }
+
+    // Flush the directory, so the rename itself survives a crash
+    size_t separator = path.find_last_of('/');
+    std::string directory = separator == std::string::npos ? "." : path.substr(0, separator);
+    int directoryFile = open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (directoryFile >= 0)
+    {
+        fsync(directoryFile);
+        close(directoryFile);
+    }
+}
+
+void FileIO::Append(const std::string& path, std::string_view contents)
+{
+    int file = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (file < 0)
+    {
+        throw std::runtime_error("Failed to open " + path + ": " + GetLastErrorString());
+    }
+
+    bool succeeded = true;
+    size_t written = 0;
+    while (succeeded && written < contents.size())
+    {
+        ssize_t chunkWritten = write(file, contents.data() + written, contents.size() - written);
+        if (chunkWritten < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        succeeded = chunkWritten > 0;
+        written += succeeded ? static_cast<size_t>(chunkWritten) : 0;
+    }
+
+    std::string error = succeeded ? std::string() : GetLastErrorString();
+    close(file);
+
+    if (!succeeded)
+    {
+        throw std::runtime_error("Failed to append to " + path + ": " + error);
+    }
+}
+
+bool FileIO::Remove(const std::string& path)
+{
+    if (unlink(path.c_str()) == 0)
+    {
+        return true;
+    }
+    else if (errno == ENOENT)
+    {
+        return false;
+    }
+
+    throw std::runtime_error("Failed to remove " + path + ": " + GetLastErrorString());
+}
+
+#endif
+
+std::string FileIO::GetConfigPath(const char* fileName)
+{
+    // Ensure the configuration directory exists
+    char* directory = obs_module_config_path("");
+    if (directory != nullptr)
+    {
+        os_mkdirs(directory);
+        bfree(directory);
+    }
+
+    char* path = obs_module_config_path(fileName);
+    if (path == nullptr)
+    {
+        throw std::runtime_error("Failed to get the path of " + std::string(fileName));
+    }
+
+    std::string result(path);
+    bfree(path);
+
+    return result;
+}
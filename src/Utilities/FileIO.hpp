@@ -0,0 +1,130 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Read-only memory mapping of a file.
+     *
+     */
+    class MappedFile
+    {
+    public:
+        /**
+         * @brief Maps a file into memory.
+         * @note A file which doesn't exist is mapped as an empty file.
+         *
+         * @param path The UTF-8 path of the file.
+         *
+         * @exception std::runtime_error If the file exists but could not be mapped.
+         */
+        explicit MappedFile(const std::string& path);
+
+        /**
+         * @brief Unmaps the file.
+         *
+         */
+        ~MappedFile();
+
+        /**
+         * @brief Gets the contents of the file.
+         *
+         * @return std::string_view The contents of the file, which remain valid until the file is unmapped.
+         */
+        inline std::string_view GetView() const
+        {
+            return std::string_view(static_cast<const char*>(m_data), m_size);
+        }
+
+        /**
+         * @brief Checks if the file existed when it was mapped.
+         *
+         * @return true If the file exists.
+         * @return false If the file doesn't exist.
+         */
+        inline bool Exists() const
+        {
+            return m_exists;
+        }
+
+        MappedFile(const MappedFile&)               = delete;
+        MappedFile& operator=(const MappedFile&)    = delete;
+
+    private:
+        // Start of the mapping, or null if the file is empty
+        const void* m_data;
+        // Size of the mapping
+        size_t m_size;
+        // Did the file exist?
+        bool m_exists;
+    };
+
+    /**
+     * @brief Static helper class for reading and writing files.
+     *
+     */
+    class FileIO
+    {
+    public:
+        /**
+         * @brief Replaces the contents of a file, such that the file either holds the old or
+         *        the new contents if the process or system crashes part way through.
+         * @note The contents are written to a temporary file in the same directory, which is
+         *       flushed to disk and then renamed over the file.
+         *
+         * @param path The UTF-8 path of the file.
+         * @param contents The new contents of the file.
+         *
+         * @exception std::runtime_error If the file could not be written.
+         */
+        static void WriteAtomically(const std::string& path, std::string_view contents);
+
+        /**
+         * @brief Appends to a file, creating it if it doesn't exist.
+         * @note The contents aren't flushed to disk, so a crash may lose them or leave
+         *       them partly written; readers of the file must tolerate a truncated end.
+         *
+         * @param path The UTF-8 path of the file.
+         * @param contents The contents to append.
+         *
+         * @exception std::runtime_error If the file could not be written.
+         */
+        static void Append(const std::string& path, std::string_view contents);
+
+        /**
+         * @brief Removes a file.
+         * @note Memory mappings of the file remain valid until they're unmapped.
+         *
+         * @param path The UTF-8 path of the file.
+         * @return true If the file was removed.
+         * @return false If the file doesn't exist.
+         *
+         * @exception std::runtime_error If the file could not be removed.
+         */
+        static bool Remove(const std::string& path);
+
+        /**
+         * @brief Gets the path of a file in the configuration directory of the module,
+         *        creating the directory if it doesn't exist.
+         *
+         * @param fileName The name of the file.
+         * @return std::string The UTF-8 path of the file.
+         *
+         * @exception std::runtime_error If the path could not be determined.
+         */
+        static std::string GetConfigPath(const char* fileName);
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        FileIO()                            = delete;
+        FileIO(const FileIO&)               = delete;
+        FileIO& operator=(const FileIO&)    = delete;
+        ~FileIO()                           = delete;
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,31 @@
+#pragma once
+
+// STL includes
+#include <memory>
+
+// OpenSSL includes
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Frees OpenSSL objects with their matching free function.
+     *
+     */
+    struct OpenSSLDeleter
+    {
+        inline void operator()(BIO* bio) const { BIO_free(bio); }
+        inline void operator()(EVP_PKEY* key) const { EVP_PKEY_free(key); }
+        inline void operator()(EVP_PKEY_CTX* context) const { EVP_PKEY_CTX_free(context); }
+        inline void operator()(X509* certificate) const { X509_free(certificate); }
+    };
+
+    /**
+     * @brief Owning pointer to an OpenSSL object.
+     *
+     */
+    template <typename T>
+    using OpenSSLPointer = std::unique_ptr<T, OpenSSLDeleter>;
+} // namespace MoonlightOBS
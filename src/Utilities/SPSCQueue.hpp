@@ -0,0 +1,94 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief A bounded lock-free queue between one producer thread and one consumer thread.
+     *
+     * The slots form a ring indexed by two ever increasing counters, each written by one side
+     * only, so pushing and popping are a few loads and stores without locks or allocations.
+     * The counters live on separate cache lines so the two threads don't contend for them.
+     *
+     * @tparam T The type of the elements, which must be default constructible and movable.
+     * @tparam Capacity The number of slots, which must be a power of two.
+     */
+    template <typename T, size_t Capacity>
+    class SPSCQueue
+    {
+        static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+    public:
+        SPSCQueue() = default;
+
+        SPSCQueue(const SPSCQueue&)             = delete;
+        SPSCQueue& operator=(const SPSCQueue&)  = delete;
+
+        /**
+         * @brief Adds an element to the back of the queue.
+         * @note Must only be called by the producer.
+         *
+         * @param element The element, which is only moved from if it's added.
+         * @return true If the element was added.
+         * @return false If the queue is full.
+         */
+        bool TryPush(T& element)
+        {
+            size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+            {
+                return false;
+            }
+
+            m_slots[tail & (Capacity - 1)] = std::move(element);
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Removes the element at the front of the queue.
+         * @note Must only be called by the consumer.
+         *
+         * @param element Receives the element.
+         * @return true If an element was removed.
+         * @return false If the queue is empty.
+         */
+        bool TryPop(T& element)
+        {
+            size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_tail.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+
+            element = std::move(m_slots[head & (Capacity - 1)]);
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Gets the number of elements in the queue, which may change as soon as it returns.
+         *
+         * @return size_t The number of elements.
+         */
+        size_t GetSize() const
+        {
+            // The head is read first, as it never passes the tail
+            size_t head = m_head.load(std::memory_order_acquire);
+            return m_tail.load(std::memory_order_acquire) - head;
+        }
+
+    private:
+        // Number of elements popped (written by the consumer)
+        alignas(64) std::atomic<size_t> m_head { 0 };
+        // Number of elements pushed (written by the producer)
+        alignas(64) std::atomic<size_t> m_tail { 0 };
+        // Slots of the ring
+        alignas(64) std::array<T, Capacity> m_slots {};
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,86 @@
+#include "StringInterner.hpp"
+
+// STL includes
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Storage for the interned strings
+    // (a deque never moves its elements, so views into them remain valid)
+    struct InternTable
+    {
+        std::shared_mutex mutex;
+        std::deque<std::string> strings{ std::string() };
+        std::unordered_map<std::string_view, uint32_t> ids{ { std::string_view(), StringInterner::EmptyID } };
+    };
+
+    InternTable& GetTable()
+    {
+        static InternTable table;
+        return table;
+    }
+}
+
+uint32_t StringInterner::Intern(std::string_view str)
+{
+    if (str.empty())
+    {
+        return EmptyID;
+    }
+
+    InternTable& table = GetTable();
+
+    // Most strings will have already been interned, so look them up under a shared lock first
+    {
+        std::shared_lock<std::shared_mutex> lock(table.mutex);
+        auto iterator = table.ids.find(str);
+        if (iterator != table.ids.end())
+        {
+            return iterator->second;
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(table.mutex);
+
+    // Check again, as another thread may have interned the string in the meantime
+    auto iterator = table.ids.find(str);
+    if (iterator != table.ids.end())
+    {
+        return iterator->second;
+    }
+
+    uint32_t id = static_cast<uint32_t>(table.strings.size());
+    const std::string& stored = table.strings.emplace_back(str);
+    try
+    {
+        table.ids.emplace(std::string_view(stored), id);
+    }
+    catch (...)
+    {
+        table.strings.pop_back();
+        throw;
+    }
+
+    return id;
+}
+
+std::string_view StringInterner::Get(uint32_t id)
+{
+    InternTable& table = GetTable();
+
+    std::shared_lock<std::shared_mutex> lock(table.mutex);
+    if (id >= table.strings.size())
+    {
+        throw std::out_of_range("Unknown interned string ID: " + std::to_string(id));
+    }
+
+    return table.strings[id];
+}
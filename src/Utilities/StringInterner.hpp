@@ -0,0 +1,54 @@
+#pragma once
+
+// STL includes
+#include <cstdint>
+#include <string_view>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Static helper class which maps strings to small, stable integer IDs.
+     *
+     * Each distinct string is stored once for the lifetime of the process, so interned
+     * strings can be compared by ID and viewed without copying.
+     *
+     * @note Interned strings are never freed, so this should only be used for strings
+     *       from a small set of values, such as host names and identifiers.
+     */
+    class StringInterner
+    {
+    public:
+        /**
+         * @brief The ID of the empty string.
+         *
+         */
+        static constexpr uint32_t EmptyID = 0;
+
+        /**
+         * @brief Gets the ID of a string, interning it if it hasn't been seen before.
+         * @exception std::bad_alloc If the string could not be stored.
+         *
+         * @param str The string to intern.
+         * @return uint32_t The ID of the string.
+         */
+        static uint32_t Intern(std::string_view str);
+
+        /**
+         * @brief Gets the string with the given ID.
+         * @exception std::out_of_range If the ID wasn't returned by Intern.
+         *
+         * @param id The ID of the string.
+         * @return std::string_view The interned string, which remains valid for the lifetime of the process.
+         */
+        static std::string_view Get(uint32_t id);
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        StringInterner()                                    = delete;
+        StringInterner(const StringInterner&)               = delete;
+        StringInterner& operator=(const StringInterner&)    = delete;
+        ~StringInterner()                                   = delete;
+    };
+} // namespace MoonlightOBS
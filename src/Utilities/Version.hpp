@@ -1,6 +1,8 @@
 #pragma once
 
 // STL includes
+#include <cstdint>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 
@@ -8,45 +10,142 @@ namespace MoonlightOBS
 {
     /**
      * @brief Represents a version using the semantic versioning format.
-     * 
+     *
+     * The version is stored as a single packed 64-bit key, with each component in 16 bits
+     * (offset by one, so a missing component of -1 orders before 0), so comparing two versions
+     * is a single integer comparison. Versions can be parsed and compared at compile time.
+     *
      */
     class Version
     {
     public:
+        /**
+         * @brief The largest value supported for a single component of a version.
+         *
+         */
+        static constexpr int MaxComponent = 0xFFFE;
+
         /**
          * @brief Constructs a new Version object with the specified version numbers.
-         * 
+         * @exception std::invalid_argument If any of the version numbers are negative or too large.
+         *
          * @param major The major version number.
          * @param minor The minor version number.
          * @param build The build number.
          */
-        Version(int major, int minor, int patch);
+        constexpr Version(int major, int minor, int build)
+            : m_key(Pack(major, minor, build, -1))
+        {
+            // Validate the version numbers
+            if (!IsValidComponent(major) || !IsValidComponent(minor) || !IsValidComponent(build))
+            {
+                throw std::invalid_argument("Version numbers must be non-negative.");
+            }
+        }
 
         /**
          * @brief Constructs a new Version object with the specified version numbers.
-         * 
+         * @note A revision number of -1 indicates the version has no revision number,
+         *       which is used by Sunshine hosts.
+         * @exception std::invalid_argument If any of the version numbers are negative or too large.
+         *
          * @param major The major version number.
          * @param minor The minor version number.
          * @param build The build number.
          * @param revision The revision number.
          */
-        Version(int major, int minor, int build, int revision);
+        constexpr Version(int major, int minor, int build, int revision)
+            : m_key(Pack(major, minor, build, revision))
+        {
+            // Special case for unknown version
+            if (major == -1 && minor == -1 && build == -1 && revision == -1)
+            {
+                return;
+            }
+            // Validate the version numbers
+            else if (!IsValidComponent(major) || !IsValidComponent(minor) || !IsValidComponent(build) ||
+                     (revision != -1 && !IsValidComponent(revision)))
+            {
+                throw std::invalid_argument("Version numbers must be non-negative.");
+            }
+        }
 
         /**
          * @brief Creates a version object from a string representation.
-         * 
-         * @param versionString The string representation of the version in the format "major.minor.patch" 
+         * @note When evaluated at compile time, an invalid version string is a compile error.
+         * @exception std::invalid_argument If the version string is empty or invalid.
+         *
+         * @param versionString The string representation of the version in the format "major.minor.patch"
          *                      or "major.minor[.build[.revision]]" formats.
          * @return Version The version object created from the string.
          */
-        static Version FromString(std::string_view versionString);
+        static constexpr Version FromString(std::string_view versionString)
+        {
+            // Check if the version string is empty
+            if (versionString.empty())
+            {
+                throw std::invalid_argument("Version string cannot be empty.");
+            }
+            else if (versionString == "unknown"     ||
+                     versionString == "-1.-1.-1"    ||
+                     versionString == "-1.-1.-1.-1")
+            {
+                // Return an unknown version
+                return GetUnknownVersion();
+            }
+
+            // Parse each of the dot separated components
+            int components[4]       = { -1, -1, -1, -1 };
+            size_t componentCount   = 0;
+            size_t offset           = 0;
+            while (true)
+            {
+                if (componentCount == 4)
+                {
+                    throw std::invalid_argument("Version string must be in the format 'major.minor.patch' or 'major.minor[.build[.revision]]'.");
+                }
+
+                // Only the revision may be -1 (which indicates a Sunshine host)
+                offset = ParseComponent(versionString, offset, componentCount == 3, components[componentCount]);
+                ++componentCount;
+
+                if (offset == versionString.size())
+                {
+                    break;
+                }
+
+                // Skip over the separating dot
+                ++offset;
+            }
+
+            // Ensure the version string is in the correct format
+            if (componentCount < 3)
+            {
+                throw std::invalid_argument("Version string must be in the format 'major.minor.patch' or 'major.minor[.build[.revision]]'.");
+            }
+
+            return Version(components[0], components[1], components[2], components[3]);
+        }
+
+        /**
+         * @brief Creates a version from its packed representation.
+         *
+         * @param key The packed representation of the version, as returned by GetKey.
+         * @return Version The version with the packed representation.
+         */
+        static constexpr Version FromKey(uint64_t key)
+        {
+            Version version = GetUnknownVersion();
+            version.m_key = key;
+            return version;
+        }
 
         /**
          * @brief Gets a version object representing an unknown version.
-         * 
+         *
          * @return Version The version object representing an unknown version.
          */
-        inline static Version GetUnknownVersion()
+        static constexpr Version GetUnknownVersion()
         {
             // Returns a version object representing an unknown version
             return Version(-1, -1, -1, -1);
@@ -54,127 +153,223 @@ namespace MoonlightOBS
 
         /**
          * @brief Gets the major version number.
-         * 
+         *
          * @return int The major version number.
          */
-        inline int GetMajor() const
+        constexpr int GetMajor() const
         {
-            return m_major;
+            return Unpack(48);
         }
 
         /**
          * @brief Gets the minor version number.
-         * 
+         *
          * @return int The minor version number.
          */
-        inline int GetMinor() const
+        constexpr int GetMinor() const
         {
-            return m_minor;
+            return Unpack(32);
         }
 
         /**
          * @brief Gets the build number.
-         * 
+         *
          * @return int The build number.
          */
-        inline int GetBuild() const
+        constexpr int GetBuild() const
         {
-            return m_build;
+            return Unpack(16);
         }
 
         /**
          * @brief Gets the revision number.
-         * 
-         * @return int The revision number.
+         *
+         * @return int The revision number, or -1 if the version has no revision number.
+         */
+        constexpr int GetRevision() const
+        {
+            return Unpack(0);
+        }
+
+        /**
+         * @brief Gets the packed representation of the version,
+         *        which orders the same way as the version itself.
+         *
+         * @return uint64_t The packed representation of the version.
          */
-        inline int GetRevision() const
+        constexpr uint64_t GetKey() const
         {
-            return m_revision;
+            return m_key;
+        }
+
+        /**
+         * @brief Checks if this version is unknown.
+         *
+         * @return true If this version is unknown.
+         * @return false If this version is known.
+         */
+        constexpr bool IsUnknown() const
+        {
+            return m_key == 0;
+        }
+
+        /**
+         * @brief Checks if this version is at least the given major, minor and build numbers,
+         *        ignoring the revision number.
+         * @note This matches how moonlight-common-c compares host versions, as Sunshine
+         *       reports a revision number of -1.
+         *
+         * @param major The minimum major version number.
+         * @param minor The minimum minor version number.
+         * @param build The minimum build number.
+         * @return true If this version is known and at least the given version.
+         * @return false If this version is unknown or older than the given version.
+         */
+        constexpr bool IsAtLeast(int major, int minor, int build) const
+        {
+            return !IsUnknown() && (m_key >> 16) >= (Pack(major, minor, build, -1) >> 16);
         }
 
         /**
          * @brief Converts the version to a string representation.
-         * 
+         *
          * @return std::string The string representation of the version.
          */
         std::string ToString() const;
 
         /**
          * @brief Compares this version with another version for equality.
-         * 
+         *
          * @param other The other version to compare with.
          * @return true This version is equal to the other version.
          * @return false This version is not equal to the other version.
          */
-        inline bool operator==(const Version& other) const
+        constexpr bool operator==(const Version& other) const
         {
-            return (m_major == other.m_major && m_minor == other.m_minor &&
-                    m_build == other.m_build && m_revision == other.m_revision);
+            return m_key == other.m_key;
         }
         /**
          * @brief Compares this version with another version for inequality.
-         * 
+         *
          * @param other The other version to compare with.
          * @return true This version is not equal to the other version.
          * @return false This version is equal to the other version.
          */
-        inline bool operator!=(const Version& other) const
+        constexpr bool operator!=(const Version& other) const
         {
-            return !(*this == other);
+            return m_key != other.m_key;
         }
         /**
          * @brief Compares this version with another version for less than.
-         * 
+         *
          * @param other The other version to compare with.
          * @return true This version is less than the other version.
          * @return false This version is not less than the other version.
          */
-        bool operator<(const Version& other) const;
+        constexpr bool operator<(const Version& other) const
+        {
+            return m_key < other.m_key;
+        }
         /**
          * @brief Compares this version with another version for less than or equal to.
-         * 
+         *
          * @param other The other version to compare with.
          * @return true This version is less than or equal to the other version.
          * @return false This version is greater than the other version.
          */
-        inline bool operator<=(const Version& other) const
+        constexpr bool operator<=(const Version& other) const
         {
-            // If this version is less than the other version, or they are equal
-            return (*this < other) || (*this == other);
+            return m_key <= other.m_key;
         }
         /**
          * @brief Compares this version with another version for greater than.
-         * 
+         *
          * @param other The other version to compare with.
          * @return true This version is greater than the other version.
          * @return false This version is not greater than the other version.
          */
-        inline bool operator>(const Version& other) const
+        constexpr bool operator>(const Version& other) const
         {
-            return !(*this <= other);
+            return m_key > other.m_key;
         }
         /**
          * @brief Compares this version with another version for greater than or equal to.
-         * 
+         *
          * @param other The other version to compare with.
          * @return true This version is greater than or equal to the other version.
          * @return false This version is less than the other version.
          */
-        inline bool operator>=(const Version& other) const
+        constexpr bool operator>=(const Version& other) const
         {
-            return !(*this < other);
+            return m_key >= other.m_key;
         }
-        
+
     private:
-        // Major version number
-        int m_major;
-        // Minor version number
-        int m_minor;
-        // Build version number
-        int m_build;
-        // Revision version number
-        int m_revision;
-
-        static std::string GetComponentName(int component);
+        // Packed version numbers, with 16 bits per component (major, minor, build, revision)
+        // from most to least significant, each offset by one so that -1 is stored as 0
+        uint64_t m_key;
+
+        // Checks if a version number can be stored
+        static constexpr bool IsValidComponent(int component)
+        {
+            return component >= 0 && component <= MaxComponent;
+        }
+
+        // Packs the version numbers into a key (components must be validated separately)
+        static constexpr uint64_t Pack(int major, int minor, int build, int revision)
+        {
+            return (static_cast<uint64_t>(static_cast<uint16_t>(major + 1)) << 48) |
+                   (static_cast<uint64_t>(static_cast<uint16_t>(minor + 1)) << 32) |
+                   (static_cast<uint64_t>(static_cast<uint16_t>(build + 1)) << 16) |
+                    static_cast<uint64_t>(static_cast<uint16_t>(revision + 1));
+        }
+
+        // Unpacks a single version number from the key
+        constexpr int Unpack(int shift) const
+        {
+            return static_cast<int>((m_key >> shift) & 0xFFFF) - 1;
+        }
+
+        // Parses a single version component starting at the given offset,
+        // returning the offset of the character following it
+        // (equivalent to std::from_chars, which isn't constexpr until C++23)
+        static constexpr size_t ParseComponent(std::string_view versionString, size_t offset,
+            bool allowMissing, int& component)
+        {
+            // "-1" indicates a missing component
+            if (allowMissing && versionString.substr(offset, 2) == "-1" &&
+                (offset + 2 == versionString.size() || versionString[offset + 2] == '.'))
+            {
+                component = -1;
+                return offset + 2;
+            }
+
+            size_t start = offset;
+            int value    = 0;
+            while (offset < versionString.size() && versionString[offset] != '.')
+            {
+                char character = versionString[offset];
+                if (character < '0' || character > '9')
+                {
+                    throw std::invalid_argument("Invalid version component.");
+                }
+
+                value = value * 10 + (character - '0');
+                if (value > MaxComponent)
+                {
+                    throw std::invalid_argument("Version component out of range.");
+                }
+
+                ++offset;
+            }
+
+            if (offset == start)
+            {
+                throw std::invalid_argument("Invalid version component.");
+            }
+
+            component = value;
+            return offset;
+        }
     };
 }
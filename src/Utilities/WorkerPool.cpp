@@ -0,0 +1,188 @@
+#include "WorkerPool.hpp"
+
+// STL includes
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// OBS Studio includes
+#include <util/base.h>
+
+// Project includes
+#include "../plugin-support.h"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Most threads to start, past which the work is bound by memory rather than cores
+    constexpr unsigned int MaxWorkers = 8;
+
+    // The ranges of one call to ParallelFor
+    struct Batch
+    {
+        const WorkerPool::Job* job  = nullptr;  // Job the ranges are passed to
+        size_t count                = 0;        // Size of the work
+        size_t rangeSize            = 0;        // Size of each range (but the last)
+        size_t ranges               = 0;        // Number of ranges
+        std::atomic<size_t> next{ 0 };          // Next range to run
+        std::atomic<size_t> remaining{ 0 };     // Ranges yet to finish
+    };
+
+    // The shared threads, and the batches they're working through
+    struct WorkerTable
+    {
+        std::mutex mutex;
+        std::condition_variable workAvailable;
+        std::condition_variable batchDone;
+        std::deque<std::shared_ptr<Batch>> batches;
+        std::vector<std::thread> workers;
+        bool stopping = false;
+    };
+
+    WorkerTable& GetTable()
+    {
+        static WorkerTable table;
+        return table;
+    }
+
+    // Runs ranges of a batch until none are left, returning whether this finished the batch
+    bool RunRanges(Batch& batch)
+    {
+        bool finished = false;
+        for (size_t range = batch.next.fetch_add(1); range < batch.ranges; range = batch.next.fetch_add(1))
+        {
+            size_t begin = range * batch.rangeSize;
+            (*batch.job)(begin, std::min(begin + batch.rangeSize, batch.count));
+            finished = batch.remaining.fetch_sub(1) == 1;
+        }
+        return finished;
+    }
+
+    // Runs the ranges of each batch queued, until the pool is stopped
+    void RunWorker()
+    {
+        WorkerTable& table = GetTable();
+        std::unique_lock<std::mutex> lock(table.mutex);
+        while (true)
+        {
+            table.workAvailable.wait(lock, [&table]() { return table.stopping || !table.batches.empty(); });
+            if (table.stopping)
+            {
+                return;
+            }
+
+            // Every range of the front batch may already have been taken, even if they haven't finished
+            std::shared_ptr<Batch> batch = table.batches.front();
+            if (batch->next.load() >= batch->ranges)
+            {
+                table.batches.pop_front();
+                continue;
+            }
+
+            lock.unlock();
+            bool finished = RunRanges(*batch);
+            lock.lock();
+
+            if (finished)
+            {
+                table.batchDone.notify_all();
+            }
+        }
+    }
+
+    // Starts the threads if they aren't running (the table must be locked)
+    void StartWorkers(WorkerTable& table)
+    {
+        if (!table.workers.empty())
+        {
+            return;
+        }
+
+        unsigned int cores = std::max(std::thread::hardware_concurrency(), 1u);
+        unsigned int count = std::min(cores - 1, MaxWorkers);
+        try
+        {
+            for (unsigned int worker = 0; worker < count; worker++)
+            {
+                table.workers.emplace_back(RunWorker);
+            }
+        }
+        catch (const std::exception& exception)
+        {
+            // The threads which started share the work, and the caller runs it otherwise
+            obs_log(LOG_WARNING, "Failed to start the worker threads: %s", exception.what());
+        }
+    }
+}
+
+void WorkerPool::ParallelFor(size_t count, size_t minimumRange, const Job& job)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    WorkerTable& table = GetTable();
+    std::unique_lock<std::mutex> lock(table.mutex);
+    StartWorkers(table);
+
+    // Give each thread (and the caller) a few ranges, so a slow thread doesn't hold the rest up
+    size_t threads = table.workers.size() + 1;
+    size_t rangeSize = std::max(std::max(minimumRange, size_t(1)), (count + threads * 4 - 1) / (threads * 4));
+    if (table.workers.empty() || rangeSize >= count)
+    {
+        lock.unlock();
+        job(0, count);
+        return;
+    }
+
+    std::shared_ptr<Batch> batch = std::make_shared<Batch>();
+    batch->job          = &job;
+    batch->count        = count;
+    batch->rangeSize    = rangeSize;
+    batch->ranges       = (count + rangeSize - 1) / rangeSize;
+    batch->remaining.store(batch->ranges);
+    table.batches.push_back(batch);
+    table.workAvailable.notify_all();
+    lock.unlock();
+
+    RunRanges(*batch);
+
+    lock.lock();
+    table.batchDone.wait(lock, [&batch]() { return batch->remaining.load() == 0; });
+
+    // The workers only remove a batch when they look for more work
+    auto iterator = std::find(table.batches.begin(), table.batches.end(), batch);
+    if (iterator != table.batches.end())
+    {
+        table.batches.erase(iterator);
+    }
+}
+
+void WorkerPool::Shutdown()
+{
+    WorkerTable& table = GetTable();
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(table.mutex);
+        table.stopping = true;
+        workers.swap(table.workers);
+    }
+    table.workAvailable.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    std::lock_guard<std::mutex> lock(table.mutex);
+    table.stopping = false;
+}
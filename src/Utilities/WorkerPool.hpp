@@ -0,0 +1,51 @@
+#pragma once
+
+// STL includes
+#include <cstddef>
+#include <functional>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Static helper class which runs work split into ranges on threads shared by the whole plugin.
+     *
+     * The threads are started when they're first needed, one fewer than the cores (up to a limit),
+     * and the calling thread works through the ranges alongside them, so a call returns as soon
+     * as the last range is done. Several calls may run at once, each sharing the threads.
+     *
+     */
+    class WorkerPool
+    {
+    public:
+        /**
+         * @brief Receives a range [begin, end) of the work.
+         *
+         */
+        using Job = std::function<void(size_t begin, size_t end)>;
+
+        /**
+         * @brief Runs a job over [0, count) split into ranges, returning once every range is done.
+         * @note The job must not throw, and runs on the calling thread if the threads can't be started.
+         *
+         * @param count The size of the work, such as the rows of a picture.
+         * @param minimumRange The smallest range worth handing to another thread.
+         * @param job Receives each range, on any thread.
+         */
+        static void ParallelFor(size_t count, size_t minimumRange, const Job& job);
+
+        /**
+         * @brief Stops the threads, which are started again if more work is run.
+         *
+         */
+        static void Shutdown();
+
+        /**
+         * @brief Deleted constructors and assignment operators to prevent instantiation.
+         *
+         */
+        WorkerPool()                                = delete;
+        WorkerPool(const WorkerPool&)               = delete;
+        WorkerPool& operator=(const WorkerPool&)    = delete;
+        ~WorkerPool()                               = delete;
+    };
+} // namespace MoonlightOBS
@@ -0,0 +1,628 @@
+#include "XMLStreamReader.hpp"
+
+// STL includes
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Checks if a character is XML whitespace
+    inline bool IsWhitespace(char character)
+    {
+        return character == ' ' || character == '\t' || character == '\n' || character == '\r';
+    }
+}
+
+XMLStreamReader::XMLStreamReader(Handler& handler)
+    : m_handler(handler), m_state(State::Text), m_name(), m_nameLength(0), m_openElements(), m_depth(0),
+      m_rootClosed(false), m_entity(), m_entityLength(0), m_attributeName(), m_attributeNameLength(0),
+      m_attributeValue(), m_attributeValueLength(0), m_quote('\0'), m_markerMatched(0) {}
+
+void XMLStreamReader::Feed(std::string_view chunk)
+{
+    // Offset of the start of the text currently being read within the chunk
+    // (npos if no text is being read)
+    size_t textStart = std::string_view::npos;
+
+    for (size_t i = 0; i < chunk.size(); ++i)
+    {
+        const char character = chunk[i];
+
+        switch (m_state)
+        {
+            case State::Text:
+            {
+                if (character == '<' || character == '&')
+                {
+                    // Report the text read before the markup
+                    if (textStart != std::string_view::npos)
+                    {
+                        EmitText(chunk.substr(textStart, i - textStart));
+                        textStart = std::string_view::npos;
+                    }
+
+                    if (character == '<')
+                    {
+                        m_state = State::TagOpen;
+                    }
+                    else
+                    {
+                        m_entityLength  = 0;
+                        m_state         = State::Entity;
+                    }
+                }
+                else if (textStart == std::string_view::npos)
+                {
+                    // Start reading a new run of text
+                    textStart = i;
+                }
+                break;
+            }
+
+            case State::Entity:
+            {
+                if (character == ';')
+                {
+                    std::array<char, 4> decoded;
+                    EmitText(std::string_view(decoded.data(), DecodeEntity(decoded)));
+                    m_state = State::Text;
+                }
+                else if (m_entityLength < m_entity.size())
+                {
+                    m_entity[m_entityLength++] = character;
+                }
+                else
+                {
+                    throw std::invalid_argument("Invalid XML: Entity is too long");
+                }
+                break;
+            }
+
+            case State::TagOpen:
+            {
+                m_nameLength = 0;
+
+                if (character == '/')
+                {
+                    m_state = State::EndTagName;
+                }
+                else if (character == '!')
+                {
+                    m_markerMatched = 0;
+                    m_state         = State::Bang;
+                }
+                else if (character == '?')
+                {
+                    m_markerMatched = 0;
+                    m_state         = State::ProcessingInstruction;
+                }
+                else if (IsWhitespace(character) || character == '>' || character == '<' || character == '=')
+                {
+                    throw std::invalid_argument("Invalid XML: Malformed tag");
+                }
+                else
+                {
+                    AppendNameCharacter(character);
+                    m_state = State::StartTagName;
+                }
+                break;
+            }
+
+            case State::StartTagName:
+            {
+                if (IsWhitespace(character))
+                {
+                    StartElement();
+                    m_state = State::InStartTag;
+                }
+                else if (character == '/')
+                {
+                    StartElement();
+                    m_state = State::EmptyElementClose;
+                }
+                else if (character == '>')
+                {
+                    StartElement();
+                    m_state = State::Text;
+                }
+                else if (character == '<' || character == '"' || character == '\'' || character == '=')
+                {
+                    throw std::invalid_argument("Invalid XML: Malformed start tag");
+                }
+                else
+                {
+                    AppendNameCharacter(character);
+                }
+                break;
+            }
+
+            case State::InStartTag:
+            {
+                if (character == '/')
+                {
+                    m_state = State::EmptyElementClose;
+                }
+                else if (character == '>')
+                {
+                    m_state = State::Text;
+                }
+                else if (character == '<' || character == '=' || character == '"' || character == '\'')
+                {
+                    throw std::invalid_argument("Invalid XML: Malformed start tag");
+                }
+                else if (!IsWhitespace(character))
+                {
+                    m_attributeName[0]      = character;
+                    m_attributeNameLength   = 1;
+                    m_state                 = State::AttributeName;
+                }
+                break;
+            }
+
+            case State::AttributeName:
+            {
+                if (character == '=')
+                {
+                    m_state = State::BeforeAttributeValue;
+                }
+                else if (IsWhitespace(character))
+                {
+                    m_state = State::AfterAttributeName;
+                }
+                else if (character == '<' || character == '>' || character == '/' || character == '"' || character == '\'')
+                {
+                    throw std::invalid_argument("Invalid XML: Malformed attribute");
+                }
+                else if (m_attributeNameLength < m_attributeName.size())
+                {
+                    m_attributeName[m_attributeNameLength++] = character;
+                }
+                else
+                {
+                    throw std::invalid_argument("Invalid XML: Attribute name is too long");
+                }
+                break;
+            }
+
+            case State::AfterAttributeName:
+            case State::BeforeAttributeValue:
+            {
+                // Whitespace is allowed on either side of the '='
+                if (character == '=' && m_state == State::AfterAttributeName)
+                {
+                    m_state = State::BeforeAttributeValue;
+                }
+                else if ((character == '"' || character == '\'') && m_state == State::BeforeAttributeValue)
+                {
+                    m_quote                 = character;
+                    m_attributeValueLength  = 0;
+                    m_state                 = State::AttributeValue;
+                }
+                else if (!IsWhitespace(character))
+                {
+                    throw std::invalid_argument("Invalid XML: Malformed attribute");
+                }
+                break;
+            }
+
+            case State::AttributeValue:
+            {
+                if (character == m_quote)
+                {
+                    m_handler.OnAttribute(std::string_view(m_attributeName.data(), m_attributeNameLength),
+                        std::string_view(m_attributeValue.data(), m_attributeValueLength), m_depth - 1);
+                    m_state = State::InStartTag;
+                }
+                else if (character == '&')
+                {
+                    m_entityLength  = 0;
+                    m_state         = State::AttributeEntity;
+                }
+                else if (character == '<')
+                {
+                    throw std::invalid_argument("Invalid XML: Malformed attribute value");
+                }
+                else
+                {
+                    AppendAttributeValue(std::string_view(&character, 1));
+                }
+                break;
+            }
+
+            case State::AttributeEntity:
+            {
+                if (character == ';')
+                {
+                    std::array<char, 4> decoded;
+                    AppendAttributeValue(std::string_view(decoded.data(), DecodeEntity(decoded)));
+                    m_state = State::AttributeValue;
+                }
+                else if (m_entityLength < m_entity.size())
+                {
+                    m_entity[m_entityLength++] = character;
+                }
+                else
+                {
+                    throw std::invalid_argument("Invalid XML: Entity is too long");
+                }
+                break;
+            }
+
+            case State::EmptyElementClose:
+            {
+                if (character != '>')
+                {
+                    throw std::invalid_argument("Invalid XML: Malformed empty element tag");
+                }
+
+                EndEmptyElement();
+                m_state = State::Text;
+                break;
+            }
+
+            case State::EndTagName:
+            {
+                if (IsWhitespace(character))
+                {
+                    m_state = State::InEndTag;
+                }
+                else if (character == '>')
+                {
+                    EndElement();
+                    m_state = State::Text;
+                }
+                else if (character == '<' || character == '/')
+                {
+                    throw std::invalid_argument("Invalid XML: Malformed end tag");
+                }
+                else
+                {
+                    AppendNameCharacter(character);
+                }
+                break;
+            }
+
+            case State::InEndTag:
+            {
+                if (character == '>')
+                {
+                    EndElement();
+                    m_state = State::Text;
+                }
+                else if (!IsWhitespace(character))
+                {
+                    throw std::invalid_argument("Invalid XML: Malformed end tag");
+                }
+                break;
+            }
+
+            case State::Bang:
+            {
+                // Determine whether this is a comment ("<!--"), a CDATA section ("<![CDATA[")
+                // or a declaration such as "<!DOCTYPE"
+                if (character == '-')
+                {
+                    if (m_markerMatched == 1)
+                    {
+                        m_markerMatched = 0;
+                        m_state         = State::Comment;
+                    }
+                    else
+                    {
+                        m_markerMatched = 1;
+                    }
+                }
+                else if (m_markerMatched == 1)
+                {
+                    throw std::invalid_argument("Invalid XML: Malformed comment");
+                }
+                else if (character == '[')
+                {
+                    m_markerMatched = 1;
+                    m_state         = State::CDATAOpen;
+                }
+                else
+                {
+                    m_state = character == '>' ? State::Text : State::Declaration;
+                }
+                break;
+            }
+
+            case State::Comment:
+            {
+                // Look for the closing "-->"
+                if (character == '>' && m_markerMatched == 2)
+                {
+                    m_state = State::Text;
+                }
+                else if (character == '-')
+                {
+                    m_markerMatched = m_markerMatched < 2 ? m_markerMatched + 1 : 2;
+                }
+                else
+                {
+                    m_markerMatched = 0;
+                }
+                break;
+            }
+
+            case State::CDATAOpen:
+            {
+                constexpr std::string_view marker = "[CDATA[";
+
+                if (character != marker[m_markerMatched])
+                {
+                    throw std::invalid_argument("Invalid XML: Malformed CDATA section");
+                }
+                else if (++m_markerMatched == marker.size())
+                {
+                    m_markerMatched = 0;
+                    m_state         = State::CDATA;
+                }
+                break;
+            }
+
+            case State::CDATA:
+            {
+                // Closing brackets are held back until it's known whether they close the section
+                if (character == ']')
+                {
+                    if (textStart != std::string_view::npos)
+                    {
+                        EmitText(chunk.substr(textStart, i - textStart));
+                        textStart = std::string_view::npos;
+                    }
+
+                    ++m_markerMatched;
+                }
+                else if (character == '>' && m_markerMatched >= 2)
+                {
+                    // Report any extra brackets before the closing "]]>"
+                    for (size_t bracket = 2; bracket < m_markerMatched; ++bracket)
+                    {
+                        EmitText("]");
+                    }
+
+                    m_markerMatched = 0;
+                    m_state         = State::Text;
+                }
+                else
+                {
+                    // The held back brackets were part of the text
+                    for (; m_markerMatched > 0; --m_markerMatched)
+                    {
+                        EmitText("]");
+                    }
+
+                    if (textStart == std::string_view::npos)
+                    {
+                        textStart = i;
+                    }
+                }
+                break;
+            }
+
+            case State::Declaration:
+            {
+                if (character == '>')
+                {
+                    m_state = State::Text;
+                }
+                break;
+            }
+
+            case State::ProcessingInstruction:
+            {
+                // Look for the closing "?>"
+                if (character == '>' && m_markerMatched == 1)
+                {
+                    m_state = State::Text;
+                }
+                else
+                {
+                    m_markerMatched = character == '?' ? 1 : 0;
+                }
+                break;
+            }
+        }
+    }
+
+    // Report the text read up to the end of the chunk,
+    // the rest will be reported when the next chunk is fed
+    if (textStart != std::string_view::npos)
+    {
+        EmitText(chunk.substr(textStart));
+    }
+}
+
+void XMLStreamReader::Finish()
+{
+    if (!m_rootClosed)
+    {
+        throw std::invalid_argument("Invalid XML: Document does not contain a complete root element");
+    }
+    else if (m_state != State::Text)
+    {
+        throw std::invalid_argument("Invalid XML: Document ends within markup");
+    }
+}
+
+void XMLStreamReader::AppendNameCharacter(char character)
+{
+    if (m_nameLength >= m_name.size())
+    {
+        throw std::invalid_argument("Invalid XML: Element name is too long");
+    }
+
+    m_name[m_nameLength++] = character;
+}
+
+void XMLStreamReader::AppendAttributeValue(std::string_view characters)
+{
+    if (m_attributeValueLength + characters.size() > m_attributeValue.size())
+    {
+        throw std::invalid_argument("Invalid XML: Attribute value is too long");
+    }
+
+    characters.copy(m_attributeValue.data() + m_attributeValueLength, characters.size());
+    m_attributeValueLength += characters.size();
+}
+
+void XMLStreamReader::StartElement()
+{
+    // Ensure there's only a single root element
+    if (m_rootClosed)
+    {
+        throw std::invalid_argument("Invalid XML: Document contains more than one root element");
+    }
+    // Ensure the document isn't nested too deeply
+    else if (m_depth >= MaxDepth)
+    {
+        throw std::invalid_argument("Invalid XML: Elements are nested too deeply");
+    }
+
+    std::string_view name(m_name.data(), m_nameLength);
+
+    // Keep track of the open element, to validate the end tag against
+    m_openElements[m_depth] = HashName(name);
+    m_handler.OnStartElement(name, m_depth);
+    ++m_depth;
+}
+
+void XMLStreamReader::EndEmptyElement()
+{
+    // Empty elements are closed as soon as their start tag is read
+    // (the name of the element is still held, as attribute names are read separately)
+    --m_depth;
+    m_handler.OnEndElement(std::string_view(m_name.data(), m_nameLength), m_depth);
+    m_rootClosed = m_depth == 0;
+}
+
+void XMLStreamReader::EndElement()
+{
+    std::string_view name(m_name.data(), m_nameLength);
+
+    // Ensure the end tag matches the open element
+    if (m_depth == 0)
+    {
+        throw std::invalid_argument("Invalid XML: Unexpected end tag '" + std::string(name) + "'");
+    }
+    else if (m_openElements[m_depth - 1] != HashName(name))
+    {
+        throw std::invalid_argument("Invalid XML: Mismatched end tag '" + std::string(name) + "'");
+    }
+
+    --m_depth;
+    m_handler.OnEndElement(name, m_depth);
+    m_rootClosed = m_depth == 0;
+}
+
+void XMLStreamReader::EmitText(std::string_view text)
+{
+    if (m_depth > 0)
+    {
+        m_handler.OnText(text, m_depth - 1);
+        return;
+    }
+
+    // Only whitespace is allowed outside of the root element
+    for (char character : text)
+    {
+        if (!IsWhitespace(character))
+        {
+            throw std::invalid_argument("Invalid XML: Text outside of the root element");
+        }
+    }
+}
+
+size_t XMLStreamReader::DecodeEntity(std::array<char, 4>& decoded) const
+{
+    std::string_view entity(m_entity.data(), m_entityLength);
+
+    // Predefined entities
+    if (entity == "amp")
+    {
+        decoded[0] = '&';
+        return 1;
+    }
+    else if (entity == "lt")
+    {
+        decoded[0] = '<';
+        return 1;
+    }
+    else if (entity == "gt")
+    {
+        decoded[0] = '>';
+        return 1;
+    }
+    else if (entity == "quot")
+    {
+        decoded[0] = '"';
+        return 1;
+    }
+    else if (entity == "apos")
+    {
+        decoded[0] = '\'';
+        return 1;
+    }
+    // Anything else must be a numeric character reference
+    else if (entity.size() < 2 || entity[0] != '#')
+    {
+        throw std::invalid_argument("Invalid XML: Unknown entity '&" + std::string(entity) + ";'");
+    }
+
+    // Parse the code point as either decimal ("&#65;") or hexadecimal ("&#x41;")
+    bool isHex = entity[1] == 'x' || entity[1] == 'X';
+    std::string_view digits = entity.substr(isHex ? 2 : 1);
+    uint32_t codePoint = 0;
+    auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), codePoint, isHex ? 16 : 10);
+    if (error != std::errc() || end != digits.data() + digits.size() || digits.empty() ||
+        codePoint == 0 || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+    {
+        throw std::invalid_argument("Invalid XML: Invalid character reference '&" + std::string(entity) + ";'");
+    }
+
+    // Encode the code point as UTF-8
+    size_t length = 0;
+    if (codePoint < 0x80)
+    {
+        decoded[length++] = static_cast<char>(codePoint);
+    }
+    else if (codePoint < 0x800)
+    {
+        decoded[length++] = static_cast<char>(0xC0 | (codePoint >> 6));
+        decoded[length++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else if (codePoint < 0x10000)
+    {
+        decoded[length++] = static_cast<char>(0xE0 | (codePoint >> 12));
+        decoded[length++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        decoded[length++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    else
+    {
+        decoded[length++] = static_cast<char>(0xF0 | (codePoint >> 18));
+        decoded[length++] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        decoded[length++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        decoded[length++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+
+    return length;
+}
+
+uint32_t XMLStreamReader::HashName(std::string_view name)
+{
+    // 32-bit FNV-1a
+    uint32_t hash = 2166136261u;
+    for (char character : name)
+    {
+        hash ^= static_cast<uint8_t>(character);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+// STL includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace MoonlightOBS
+{
+    /**
+     * @brief Single-pass, incremental XML tokenizer for the responses of GameStream hosts.
+     *
+     * The document can be fed in arbitrarily sized chunks (e.g. as they're received by libcurl),
+     * and events are reported to a handler as soon as they're complete. No document tree is built,
+     * text is reported as views into the fed chunks, and the reader itself never allocates.
+     *
+     * @note Only the subset of XML used by GameStream hosts is supported: elements, attributes,
+     *       character data, the predefined and numeric entities, CDATA sections, comments,
+     *       processing instructions and DOCTYPE declarations (which are skipped).
+     */
+    class XMLStreamReader
+    {
+    public:
+        /**
+         * @brief Receives the events produced by the XMLStreamReader.
+         *
+         */
+        class Handler
+        {
+        public:
+            virtual ~Handler() = default;
+
+            /**
+             * @brief Called when the start tag of an element has been read.
+             *
+             * @param name The name of the element. (Only valid for the duration of the call)
+             * @param depth The depth of the element, with the root element at depth 0.
+             */
+            virtual void OnStartElement(std::string_view name, size_t depth) = 0;
+
+            /**
+             * @brief Called for each attribute of an element, after its OnStartElement call.
+             * @note Attributes are ignored unless this is overridden.
+             *
+             * @param name The name of the attribute. (Only valid for the duration of the call)
+             * @param value The value of the attribute, with entities decoded. (Only valid for the duration of the call)
+             * @param depth The depth of the element the attribute belongs to.
+             */
+            virtual void OnAttribute(std::string_view name, std::string_view value, size_t depth)
+            {
+                (void)name;
+                (void)value;
+                (void)depth;
+            }
+
+            /**
+             * @brief Called with the character data of an element.
+             * @note The text of a single element may be reported across multiple calls.
+             *
+             * @param text The text, with entities decoded. (Only valid for the duration of the call)
+             * @param depth The depth of the element containing the text.
+             */
+            virtual void OnText(std::string_view text, size_t depth) = 0;
+
+            /**
+             * @brief Called when the end tag of an element has been read.
+             *
+             * @param name The name of the element. (Only valid for the duration of the call)
+             * @param depth The depth of the element, with the root element at depth 0.
+             */
+            virtual void OnEndElement(std::string_view name, size_t depth) = 0;
+        };
+
+        /**
+         * @brief The maximum depth of nested elements supported by the reader.
+         *
+         */
+        static constexpr size_t MaxDepth = 32;
+
+        /**
+         * @brief The maximum length of an element name supported by the reader.
+         *
+         */
+        static constexpr size_t MaxNameLength = 64;
+
+        /**
+         * @brief The maximum length of an attribute value supported by the reader.
+         *
+         */
+        static constexpr size_t MaxAttributeValueLength = 256;
+
+        /**
+         * @brief Construct a new XMLStreamReader object.
+         *
+         * @param handler The handler to receive the events of the reader.
+         */
+        explicit XMLStreamReader(Handler& handler);
+
+        /**
+         * @brief Reads the next chunk of the document.
+         * @exception std::invalid_argument If the document is malformed.
+         *
+         * @param chunk The next chunk of the document.
+         */
+        void Feed(std::string_view chunk);
+
+        /**
+         * @brief Signals the end of the document.
+         * @exception std::invalid_argument If the document is incomplete or has no root element.
+         *
+         */
+        void Finish();
+
+    private:
+        // States of the tokenizer
+        enum class State
+        {
+            Text,
+            Entity,
+            TagOpen,
+            StartTagName,
+            InStartTag,
+            AttributeName,
+            AfterAttributeName,
+            BeforeAttributeValue,
+            AttributeValue,
+            AttributeEntity,
+            EmptyElementClose,
+            EndTagName,
+            InEndTag,
+            Bang,
+            Comment,
+            CDATAOpen,
+            CDATA,
+            Declaration,
+            ProcessingInstruction
+        };
+
+        // Handler receiving the events of the reader
+        Handler& m_handler;
+        // Current state of the tokenizer
+        State m_state;
+
+        // Name of the tag currently being read
+        std::array<char, MaxNameLength> m_name;
+        size_t m_nameLength;
+
+        // Hashes of the names of the currently open elements
+        std::array<uint32_t, MaxDepth> m_openElements;
+        size_t m_depth;
+        // Has the root element been closed?
+        bool m_rootClosed;
+
+        // Entity currently being read (without the leading '&' or the trailing ';')
+        std::array<char, 12> m_entity;
+        size_t m_entityLength;
+
+        // Name and value of the attribute currently being read
+        std::array<char, MaxNameLength> m_attributeName;
+        size_t m_attributeNameLength;
+        std::array<char, MaxAttributeValueLength> m_attributeValue;
+        size_t m_attributeValueLength;
+        // Quote character closing the attribute value currently being read
+        char m_quote;
+        // Number of characters matched of the marker currently being looked for
+        // (e.g. "-->" for comments, or "[CDATA[" for CDATA sections)
+        size_t m_markerMatched;
+
+        // Adds a character to the name of the tag being read
+        void AppendNameCharacter(char character);
+        // Adds characters to the value of the attribute being read
+        void AppendAttributeValue(std::string_view characters);
+        // Reports the start of the element whose name was just read
+        void StartElement();
+        // Reports the end of the empty element whose start tag was just read
+        void EndEmptyElement();
+        // Reports the end of the element whose name was just read
+        void EndElement();
+        // Reports text to the handler if it's within an element
+        void EmitText(std::string_view text);
+        // Decodes the entity which was just read into UTF-8, returning its length
+        size_t DecodeEntity(std::array<char, 4>& decoded) const;
+
+        // Calculates the hash of an element name
+        static uint32_t HashName(std::string_view name);
+    };
+} // namespace MoonlightOBS
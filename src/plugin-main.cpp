@@ -23,6 +23,10 @@ with this program. If not, see <https://www.gnu.org/licenses/>
 #include <plugin-support.h>
 //#include "moonlight-source.hpp"
 #include "OBSSource.hpp"
+#include "Connections/AppCatalogue.hpp"
+#include "Connections/ClientIdentity.hpp"
+#include "Connections/HTTPClient.hpp"
+#include "Utilities/WorkerPool.hpp"
 
 using namespace MoonlightOBS;
 
@@ -42,6 +46,10 @@ bool obs_module_load(void)
 	// Register the source
 	obs_register_source(&moonlight_source_info);
 
+	// Load (or generate) the identity used for pairing in the background,
+	// so pairing never has to wait for key generation
+	ClientIdentity::LoadInBackground();
+
 	obs_log(LOG_INFO, "plugin loaded successfully (version %s)", PLUGIN_VERSION);
 	return true;
 }
@@ -49,6 +57,19 @@ bool obs_module_load(void)
 void obs_module_unload(void)
 {
 	// TODO: Disconnect from any connected paired devices
+
+	// Stop fetching apps and box art, and save the box art cache
+	AppCatalogue::Shutdown();
+
+	// Release the TLS sessions kept for the paired hosts
+	HTTPClient::ReleaseSessions();
+
+	// The identity may still be being generated, which must finish before the module is unloaded
+	ClientIdentity::WaitForBackgroundThread();
+
+	// Stop the threads frames are converted on
+	WorkerPool::Shutdown();
+
 	obs_log(LOG_INFO, "plugin unloaded");
 }
 
@@ -0,0 +1,278 @@
+// Measures the parsers over the captured responses of the corpus: the time and the
+// number of allocations of each parse, with the responses fed whole and in the chunks
+// libcurl typically delivers them in. What each parser makes of its inputs is checked
+// first, so a parser which returns nothing doesn't pass as a fast one.
+//
+// Usage: ParserBenchmark <corpus directory> [iterations]
+
+// STL includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Project includes
+#include "Connections/Address.hpp"
+#include "Connections/HostSettings.hpp"
+#include "Connections/ServerInfoParser.hpp"
+#include "Discovery/mDNSRecordExtractor.hpp"
+#include "Utilities/Version.hpp"
+#include "../Support/TestSupport.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Number of allocations made, counted by the replaced operator new below
+    std::atomic<size_t> g_allocations { 0 };
+
+    // Result of timing a parser over one input
+    struct Measurement
+    {
+        double nanoseconds;     // Mean time of a parse
+        double allocations;     // Mean number of allocations of a parse
+    };
+
+    // Times a parse, counting its allocations
+    template <typename Function>
+    Measurement Measure(size_t iterations, Function&& function)
+    {
+        size_t allocations = g_allocations.load(std::memory_order_relaxed);
+        double nanoseconds = Testing::Time(iterations, function);
+        allocations = g_allocations.load(std::memory_order_relaxed) - allocations;
+        return { nanoseconds, static_cast<double>(allocations) / static_cast<double>(iterations) };
+    }
+
+    // Prints a measurement, with the throughput over the size of the input
+    void Print(const char* parser, const std::string& input, size_t size, const Measurement& measurement)
+    {
+        std::printf("%-28s %-24s %10.0f ns %9.1f MB/s %7.1f allocations\n", parser, input.c_str(),
+            measurement.nanoseconds, static_cast<double>(size) * 1000.0 / measurement.nanoseconds,
+            measurement.allocations);
+    }
+
+    // The fields of the hosts of the /serverinfo responses which report success
+    struct ExpectedHost
+    {
+        const char* file;
+        const char* hostname;
+        const char* uniqueID;
+        Version appVersion;
+        uint16_t httpsPort;
+        const char* localIP;
+        int serverCodecModeSupport;
+        PairStatus pairStatus;
+        HostState state;
+    };
+
+    const ExpectedHost ExpectedHosts[] =
+    {
+        { "gfe.xml", "DESKTOP-GAMING", "FEDCBA9876543210", Version(7, 1, 450, 0), 47984, "10.0.0.5", 259,
+            PairStatus::Unpaired, HostState::SERVER_BUSY },
+        { "sunshine.xml", "LIVING-ROOM-PC", "0123456789ABCDEF", Version(7, 1, 431, -1), 47984, "192.168.1.20", 3843,
+            PairStatus::Paired, HostState::SERVER_FREE },
+    };
+
+    // The versions of the version strings which parse
+    const std::pair<const char*, Version> ExpectedVersions[] =
+    {
+        { "gfe", Version(3, 23, 0, 74) },
+        { "sunshine", Version(7, 1, 431, -1) },
+        { "three-components", Version(7, 1, 450) },
+        { "unknown", Version::GetUnknownVersion() },
+    };
+
+    // Parses a /serverinfo response fed in chunks of a given size
+    std::optional<HostSettings> ParseServerInfo(std::string_view response, size_t chunkSize)
+    {
+        try
+        {
+            ServerInfoParser parser;
+            for (size_t offset = 0; offset < response.size(); offset += chunkSize)
+            {
+                parser.Feed(response.substr(offset, chunkSize));
+            }
+            return parser.Finish();
+        }
+        catch (const std::exception&)
+        {
+            return std::nullopt;
+        }
+    }
+
+    // Checks the host parsed from a /serverinfo response, which fails to parse unless it reports success
+    void CheckServerInfo(const std::string& name, const std::optional<HostSettings>& settings)
+    {
+        for (const ExpectedHost& expected : ExpectedHosts)
+        {
+            if (name != expected.file)
+            {
+                continue;
+            }
+
+            CHECK(settings.has_value());
+            if (settings.has_value())
+            {
+                CHECK(settings->GetHostname() == expected.hostname);
+                CHECK(settings->GetUniqueID() == expected.uniqueID);
+                CHECK(settings->GetAppVersion() == expected.appVersion);
+                CHECK(settings->GetHTTPSPort() == expected.httpsPort);
+                CHECK(settings->GetLocalIP() == expected.localIP);
+                CHECK(settings->GetServerCodecModeSupport() == expected.serverCodecModeSupport);
+                CHECK(settings->GetPairStatus() == expected.pairStatus);
+                CHECK(settings->GetHostState() == expected.state);
+            }
+            return;
+        }
+
+        CHECK(!settings.has_value());
+    }
+
+    // Checks the records extracted from an mDNS packet. Every packet which isn't truncated
+    // announces the same host, and only the announcement adds its IPv6 address and TXT record.
+    void CheckmDNSRecords(const std::string& name, const mDNSRecordExtractor& records)
+    {
+        if (name == "truncated")
+        {
+            CHECK(records.GetResponsesHandled() == 0);
+            CHECK(records.GetPTRRecords().empty());
+            CHECK(records.GetSRVRecords().empty());
+            return;
+        }
+
+        CHECK(records.GetPTRRecords() == std::vector<std::string> { "LIVING-ROOM-PC._nvstream._tcp.local." });
+        CHECK(records.GetSRVRecords().size() == 1);
+        if (records.GetSRVRecords().size() == 1)
+        {
+            CHECK(records.GetSRVRecords()[0].GetPort() == 47989);
+            CHECK(records.GetSRVRecords()[0].GetTarget() == "LIVING-ROOM-PC.local.");
+        }
+
+        // The A record with a 2 byte address is skipped, leaving the valid one after it
+        CHECK(records.GetARecords() == std::vector<Address> { Address("192.168.1.20", 0) });
+
+        bool announcement = name == "announcement";
+        CHECK(records.GetAAAARecords() ==
+            (announcement ? std::vector<Address> { Address("fe80::211:2233:4455:6677", 0) } : std::vector<Address>()));
+        CHECK(records.GetTXTRecords() == (announcement ?
+            std::vector<std::pair<std::string, std::string>> { { "sunshine", "true" } } :
+            std::vector<std::pair<std::string, std::string>>()));
+    }
+
+    // Checks the version parsed from a version string, which fails to parse unless it's expected to
+    void CheckVersion(const std::string& name, const std::string& versionString)
+    {
+        std::optional<Version> version;
+        try
+        {
+            version = Version::FromString(versionString);
+        }
+        catch (const std::invalid_argument&)
+        {
+        }
+
+        for (const auto& [file, expected] : ExpectedVersions)
+        {
+            if (name == file)
+            {
+                CHECK(version == expected);
+                return;
+            }
+        }
+
+        CHECK(!version.has_value());
+    }
+}
+
+void* operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size != 0 ? size : 1))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "Usage: %s <corpus directory> [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path corpus = argv[1];
+    size_t iterations = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000;
+    if (iterations == 0)
+    {
+        iterations = 1;
+    }
+
+    // libcurl delivers responses in chunks of up to CURL_MAX_WRITE_SIZE (16 KiB), although
+    // smaller chunks are common as they follow the packets they were received in
+    constexpr size_t ChunkSizes[] = { 16384, 1460, 64 };
+
+    for (const std::filesystem::path& path : Testing::ListFiles(corpus / "serverinfo"))
+    {
+        std::string response = Testing::ReadFile(path);
+        std::string name = path.filename().string();
+
+        // Responses which report a failure are still measured, as hosts send them to unpaired clients
+        std::optional<HostSettings> parsed = ParseServerInfo(response, response.size());
+        CHECK(parsed.has_value() == (response.find("status_code=\"200\"") != std::string::npos));
+        CheckServerInfo(name, parsed);
+        for (size_t chunkSize : ChunkSizes)
+        {
+            CheckServerInfo(name, ParseServerInfo(response, chunkSize));
+            std::string parser = "ServerInfoParser/" + std::to_string(chunkSize);
+            Print(parser.c_str(), name, response.size(),
+                Measure(iterations, [&]() { ParseServerInfo(response, chunkSize); }));
+        }
+    }
+
+    for (const std::filesystem::path& path : Testing::ListFiles(corpus / "mdns"))
+    {
+        std::string packet = Testing::ReadFile(path);
+        CheckmDNSRecords(path.filename().string(), mDNSRecordExtractor::Parse(packet.data(), packet.size()));
+        Print("mDNSRecordExtractor", path.filename().string(), packet.size(),
+            Measure(iterations, [&]() { mDNSRecordExtractor::Parse(packet.data(), packet.size()); }));
+    }
+
+    for (const std::filesystem::path& path : Testing::ListFiles(corpus / "version"))
+    {
+        std::string versionString = Testing::ReadFile(path);
+        CheckVersion(path.filename().string(), versionString);
+        Print("Version::FromString", path.filename().string(), versionString.size(),
+            Measure(iterations, [&]()
+            {
+                try
+                {
+                    Version::FromString(versionString);
+                }
+                catch (const std::invalid_argument&)
+                {
+                }
+            }));
+    }
+
+    return Testing::Finish();
+}
@@ -0,0 +1,251 @@
+// Checks that every version of the pixel kernels the CPU runs matches the scalar version
+// bit for bit, over rows of random samples of many widths and samples which round halfway,
+// then times each version over rows of a 1080p frame.
+//
+// Usage: PixelKernelsBenchmark [iterations]
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+// Project includes
+#include "Decoding/PixelKernels.hpp"
+#include "../Support/TestSupport.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Instruction sets the kernels may have versions for
+    constexpr InstructionSet InstructionSets[] =
+    {
+        InstructionSet::Scalar, InstructionSet::SSE41, InstructionSet::AVX2, InstructionSet::NEON
+    };
+
+    // Widths covering the rows shorter than a vector, the ends vectors leave, and odd widths
+    constexpr size_t Widths[] = { 1, 2, 3, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 1279, 1920 };
+
+    // Width of the rows timed
+    constexpr size_t BenchmarkWidth = 1920;
+
+    // The samples and outputs of every kernel, for a row width
+    struct Rows
+    {
+        std::vector<uint8_t> uv8;
+        std::vector<uint16_t> u16;
+        std::vector<uint16_t> v16;
+        std::vector<uint16_t> luma[2];
+        std::vector<uint16_t> chroma[2];
+
+        std::vector<uint8_t> uOut8;
+        std::vector<uint8_t> vOut8;
+        std::vector<uint16_t> shiftOut;
+        std::vector<uint16_t> uvOut16;
+        std::vector<uint8_t> lumaOut[2];
+        std::vector<uint8_t> cbOut;
+        std::vector<uint8_t> crOut;
+
+        Rows(size_t width, std::mt19937& random)
+        {
+            // 10 bit samples, with some outside of the limited range so the clamps are exercised
+            std::uniform_int_distribution<unsigned int> byte(0, 255);
+            std::uniform_int_distribution<unsigned int> sample(0, 1023);
+            size_t chromaWidth = (width + 1) / 2;
+
+            uv8.resize(width * 2);
+            for (uint8_t& value : uv8)
+            {
+                value = static_cast<uint8_t>(byte(random));
+            }
+            for (std::vector<uint16_t>* samples : { &u16, &v16, &luma[0], &luma[1], &chroma[0], &chroma[1] })
+            {
+                samples->resize(samples == &chroma[0] ? chromaWidth * 2 : width);
+                for (uint16_t& value : *samples)
+                {
+                    value = static_cast<uint16_t>(sample(random));
+                }
+            }
+
+            uOut8.resize(width);
+            vOut8.resize(width);
+            shiftOut.resize(width);
+            uvOut16.resize(width * 2);
+            lumaOut[0].resize(width);
+            lumaOut[1].resize(width);
+            cbOut.resize(chromaWidth);
+            crOut.resize(chromaWidth);
+        }
+
+        // Runs every kernel over the rows
+        void Convert(const ToneMapParameters& parameters)
+        {
+            size_t width = u16.size();
+            PixelKernels::DeinterleaveChroma8(uv8.data(), uOut8.data(), vOut8.data(), width);
+            PixelKernels::Shift16(u16.data(), shiftOut.data(), width, 6);
+            PixelKernels::InterleaveChroma16(u16.data(), v16.data(), uvOut16.data(), width, 6);
+            PixelKernels::ToneMap(parameters, GetToneMapRows(parameters));
+        }
+
+        // Gets the rows to tone map, with the chroma samples laid out as the parameters expect
+        ToneMapRows GetToneMapRows(const ToneMapParameters& parameters)
+        {
+            ToneMapRows rows;
+            rows.luma[0]    = luma[0].data();
+            rows.luma[1]    = luma[1].data();
+            rows.chroma[0]  = chroma[0].data();
+            rows.chroma[1]  = parameters.semiPlanar ? nullptr : chroma[1].data();
+            rows.lumaOut[0] = lumaOut[0].data();
+            rows.lumaOut[1] = lumaOut[1].data();
+            rows.cbOut      = cbOut.data();
+            rows.crOut      = crOut.data();
+            rows.width      = u16.size();
+            return rows;
+        }
+
+        // Checks the outputs match those of another run
+        bool Matches(const Rows& other) const
+        {
+            return uOut8 == other.uOut8 && vOut8 == other.vOut8 && shiftOut == other.shiftOut &&
+                uvOut16 == other.uvOut16 && lumaOut[0] == other.lumaOut[0] && lumaOut[1] == other.lumaOut[1] &&
+                cbOut == other.cbOut && crOut == other.crOut;
+        }
+    };
+
+    // Tables shaped like those of ToneMapper, as only their shape matters to the kernels
+    struct Tables
+    {
+        std::vector<float> pqToLinear;
+        std::vector<float> sqrtToGamma;
+
+        Tables() : pqToLinear(ToneMapParameters::TableSize), sqrtToGamma(ToneMapParameters::TableSize)
+        {
+            for (size_t i = 0; i < ToneMapParameters::TableSize; i++)
+            {
+                float value = static_cast<float>(i) / static_cast<float>(ToneMapParameters::TableSize - 1);
+                pqToLinear[i] = std::pow(value, 2.4f) * 1.5f;
+                sqrtToGamma[i] = std::pow(value, 2.0f / 2.4f);
+            }
+        }
+    };
+
+    // Checks the versions of the kernels for every other instruction set the CPU runs match
+    // the scalar version over some rows
+    void CheckMatchesScalar(const Rows& rows, const ToneMapParameters& parameters, const char* description)
+    {
+        Rows expected = rows;
+        PixelKernels::SetInstructionSet(InstructionSet::Scalar);
+        expected.Convert(parameters);
+
+        for (InstructionSet instructionSet : InstructionSets)
+        {
+            if (instructionSet == InstructionSet::Scalar || !PixelKernels::IsSupported(instructionSet))
+            {
+                continue;
+            }
+
+            Rows actual = rows;
+            PixelKernels::SetInstructionSet(instructionSet);
+            actual.Convert(parameters);
+            if (!actual.Matches(expected))
+            {
+                std::fprintf(stderr, "%s kernels differ from scalar over %s\n", PixelKernels::GetName(instructionSet),
+                    description);
+            }
+            CHECK(actual.Matches(expected));
+        }
+    }
+
+    // Gets the tone map parameters of 10 bit limited range samples
+    ToneMapParameters GetParameters(const Tables& tables, bool semiPlanar)
+    {
+        ToneMapParameters parameters;
+        parameters.pqToLinear   = tables.pqToLinear.data();
+        parameters.sqrtToGamma  = tables.sqrtToGamma.data();
+        parameters.lumaScale    = 1.0f / 876.0f;
+        parameters.chromaScale  = 1.0f / 896.0f;
+        parameters.semiPlanar   = semiPlanar;
+        return parameters;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    if (iterations == 0)
+    {
+        iterations = 1;
+    }
+
+    Tables tables;
+    for (bool semiPlanar : { false, true })
+    {
+        ToneMapParameters parameters = GetParameters(tables, semiPlanar);
+        for (size_t width : Widths)
+        {
+            std::mt19937 random(static_cast<std::mt19937::result_type>(width));
+            std::string description = std::to_string(width) + (semiPlanar ? " wide P010 rows" : " wide I010 rows");
+            CheckMatchesScalar(Rows(width, random), parameters, description.c_str());
+        }
+    }
+
+    // Neutral chroma, and luma scaled so every other sample lands halfway between two entries
+    // of the tables, where rounding to even looks up another entry than rounding halves up
+    {
+        ToneMapParameters parameters = GetParameters(tables, false);
+        parameters.lumaScale = 0.5f / static_cast<float>(ToneMapParameters::TableSize - 1);
+
+        std::mt19937 random(0);
+        Rows rows(BenchmarkWidth, random);
+        for (size_t row = 0; row < 2; row++)
+        {
+            for (size_t column = 0; column < BenchmarkWidth; column++)
+            {
+                rows.luma[row][column] = static_cast<uint16_t>(64 + (column + row * BenchmarkWidth) % 960);
+            }
+        }
+        for (size_t plane = 0; plane < 2; plane++)
+        {
+            std::fill(rows.chroma[plane].begin(), rows.chroma[plane].end(), static_cast<uint16_t>(512));
+        }
+        CheckMatchesScalar(rows, parameters, "samples between table entries");
+    }
+
+    std::mt19937 random(BenchmarkWidth);
+    Rows rows(BenchmarkWidth, random);
+    ToneMapParameters parameters = GetParameters(tables, true);
+    for (InstructionSet instructionSet : InstructionSets)
+    {
+        if (!PixelKernels::IsSupported(instructionSet))
+        {
+            continue;
+        }
+
+        PixelKernels::SetInstructionSet(instructionSet);
+        const char* name = PixelKernels::GetName(instructionSet);
+        std::printf("%-8s DeinterleaveChroma8 %10.0f ns\n", name, Testing::Time(iterations, [&]()
+        {
+            PixelKernels::DeinterleaveChroma8(rows.uv8.data(), rows.uOut8.data(), rows.vOut8.data(), BenchmarkWidth);
+        }));
+        std::printf("%-8s Shift16             %10.0f ns\n", name, Testing::Time(iterations, [&]()
+        {
+            PixelKernels::Shift16(rows.u16.data(), rows.shiftOut.data(), BenchmarkWidth, 6);
+        }));
+        std::printf("%-8s InterleaveChroma16  %10.0f ns\n", name, Testing::Time(iterations, [&]()
+        {
+            PixelKernels::InterleaveChroma16(rows.u16.data(), rows.v16.data(), rows.uvOut16.data(), BenchmarkWidth, 6);
+        }));
+        std::printf("%-8s ToneMap             %10.0f ns\n", name, Testing::Time(iterations, [&]()
+        {
+            PixelKernels::ToneMap(parameters, rows.GetToneMapRows(parameters));
+        }));
+    }
+
+    return Testing::Finish();
+}
@@ -0,0 +1,36 @@
+// Replays a corpus through a fuzz harness, for compilers without libFuzzer.
+// Accepts the same arguments as a libFuzzer binary run over its corpus
+// (files and directories, with any "-flag=value" options ignored).
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Project includes
+#include "../Support/TestSupport.hpp"
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size);
+
+int main(int argc, char** argv)
+{
+    size_t inputs = 0;
+    for (int argument = 1; argument < argc; argument++)
+    {
+        if (argv[argument][0] == '-')
+        {
+            continue;
+        }
+
+        for (const std::filesystem::path& path : MoonlightOBS::Testing::ListFiles(argv[argument]))
+        {
+            std::string input = MoonlightOBS::Testing::ReadFile(path);
+            LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+            inputs++;
+        }
+    }
+
+    std::printf("Replayed %zu input(s)\n", inputs);
+    return inputs > 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
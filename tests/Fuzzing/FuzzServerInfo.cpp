@@ -0,0 +1,48 @@
+// Fuzzes the streaming /serverinfo parser, and the XMLStreamReader beneath it.
+// The input is fed in chunks whose size follows from its length, so elements split
+// across chunks are exercised as they are on the network, while the corpus stays
+// plain responses (shared with the parser benchmark).
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string_view>
+
+// Project includes
+#include "Connections/HostSettings.hpp"
+#include "Connections/ServerInfoParser.hpp"
+
+using namespace MoonlightOBS;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    size_t chunkSize = size % 61 + 1;
+    std::string_view response(reinterpret_cast<const char*>(data), size);
+
+    try
+    {
+        ServerInfoParser parser;
+        for (size_t offset = 0; offset < response.size(); offset += chunkSize)
+        {
+            parser.Feed(response.substr(offset, chunkSize));
+        }
+        HostSettings settings = parser.Finish();
+
+        // Parsing must not depend on how the response was split
+        HostSettings whole(response);
+        if (whole.GetHostname() != settings.GetHostname() || whole.GetAppVersion() != settings.GetAppVersion())
+        {
+            std::abort();
+        }
+    }
+    catch (const std::invalid_argument&)
+    {
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+
+    return 0;
+}
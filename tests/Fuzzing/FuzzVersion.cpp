@@ -0,0 +1,36 @@
+// Fuzzes the parsing of version strings, checking that parsed versions round trip.
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <string_view>
+
+// Project includes
+#include "Utilities/Version.hpp"
+
+using namespace MoonlightOBS;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    std::string_view versionString(reinterpret_cast<const char*>(data), size);
+
+    Version version = Version::GetUnknownVersion();
+    try
+    {
+        version = Version::FromString(versionString);
+    }
+    catch (const std::invalid_argument&)
+    {
+        return 0;
+    }
+
+    // A parsed version must format to a string which parses back to the same version
+    if (Version::FromString(version.ToString()) != version || Version::FromKey(version.GetKey()) != version)
+    {
+        std::abort();
+    }
+
+    return 0;
+}
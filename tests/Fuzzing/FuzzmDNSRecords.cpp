@@ -0,0 +1,19 @@
+// Fuzzes the extraction of records from mDNS response packets, which any device
+// on the network can send.
+
+// STL includes
+#include <cstddef>
+#include <cstdint>
+
+// Project includes
+#include "Discovery/mDNSRecordExtractor.hpp"
+
+using namespace MoonlightOBS;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    // Records which fail to parse are skipped, so the extraction itself must never throw
+    mDNSRecordExtractor::Parse(data, size);
+    mDNSRecordExtractor::Parse(data, size, 0, "_nvstream._tcp.local.", MDNS_ENTRYTYPE_ANSWER | MDNS_ENTRYTYPE_ADDITIONAL);
+    return 0;
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+// STL includes
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Minimal helpers shared by the tests, benchmarks and fuzzers, so they don't
+ *        need a test framework beyond CTest (a test fails by exiting with a non-zero code).
+ *
+ */
+namespace MoonlightOBS::Testing
+{
+    /**
+     * @brief Number of checks which failed, reported by Finish.
+     *
+     */
+    inline int g_failures = 0;
+
+    /**
+     * @brief Records the outcome of a check, printing it if it failed.
+     *
+     * @param passed Did the check pass?
+     * @param expression The text of the checked expression.
+     * @param file The file of the check.
+     * @param line The line of the check.
+     */
+    inline void Check(bool passed, const char* expression, const char* file, int line)
+    {
+        if (!passed)
+        {
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+            g_failures++;
+        }
+    }
+
+    /**
+     * @brief Reports the number of failed checks.
+     *
+     * @return int The exit code of the test: 0 if every check passed.
+     */
+    inline int Finish()
+    {
+        if (g_failures > 0)
+        {
+            std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    /**
+     * @brief Reads a whole file.
+     *
+     * @param path The path of the file.
+     * @return std::string The contents of the file, or an empty string if it's unable to be read.
+     */
+    inline std::string ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    /**
+     * @brief Lists the files of a corpus directory (or the file itself, if a file is given).
+     *
+     * @param path The path of the directory or file.
+     * @return std::vector<std::filesystem::path> The files, sorted so runs are repeatable.
+     */
+    inline std::vector<std::filesystem::path> ListFiles(const std::filesystem::path& path)
+    {
+        std::vector<std::filesystem::path> files;
+        std::error_code error;
+        if (std::filesystem::is_directory(path, error))
+        {
+            for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(path, error))
+            {
+                if (entry.is_regular_file())
+                {
+                    files.push_back(entry.path());
+                }
+            }
+            std::sort(files.begin(), files.end());
+        }
+        else if (std::filesystem::is_regular_file(path, error))
+        {
+            files.push_back(path);
+        }
+        return files;
+    }
+
+    /**
+     * @brief Times a function over a number of iterations.
+     *
+     * @param iterations The number of times to call the function.
+     * @param function The function to time.
+     * @return double The mean time of a call in nanoseconds.
+     */
+    template <typename Function>
+    double Time(size_t iterations, Function&& function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t iteration = 0; iteration < iterations; iteration++)
+        {
+            function();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return iterations > 0 ? elapsed.count() / static_cast<double>(iterations) : 0.0;
+    }
+} // namespace MoonlightOBS::Testing
+
+/**
+ * @brief Checks that an expression is true, continuing the test either way.
+ *
+ */
+#define CHECK(expression) \
+    ::MoonlightOBS::Testing::Check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
@@ -0,0 +1,178 @@
+// Checks the accounting of the smooth frame pacing: how many frames are output, dropped and
+// duplicated for streams of many frame rates on canvases of many frame rates, and how the
+// target depth of the buffer grows when it runs dry and shrinks once it's steady.
+//
+// Usage: FrameCadenceTest
+
+// STL includes
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// Project includes
+#include "Streaming/FrameCadence.hpp"
+#include "../Support/TestSupport.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Time between ticks of a 60 fps canvas in nanoseconds
+    constexpr uint64_t TickInterval = 1000000000ULL / 60;
+
+    // Counts of a paced stream
+    struct Counts
+    {
+        uint64_t arrived    = 0;
+        uint64_t output     = 0;
+        uint64_t dropped    = 0;
+        uint64_t duplicated = 0;
+        size_t depth        = 0;
+    };
+
+    // Applies a tick to the counts
+    void Apply(const FrameCadenceTick& tick, Counts& counts)
+    {
+        counts.output += tick.output ? 1 : 0;
+        counts.dropped += tick.skipped + tick.caughtUp;
+        counts.duplicated += tick.duplicated ? 1 : 0;
+        counts.depth -= tick.skipped + (tick.output ? 1 : 0) + tick.caughtUp;
+    }
+
+    // Paces a stream for a number of ticks of a canvas, with the stream's frames arriving
+    // steadily just before the ticks they're due at
+    Counts Pace(uint32_t fps, uint64_t tickNumerator, uint64_t tickDenominator, uint64_t ticks)
+    {
+        const uint64_t tickInterval = 1000000000ULL * tickDenominator / tickNumerator;
+        FrameCadence cadence(fps, tickNumerator, tickDenominator, 0);
+
+        Counts counts;
+        for (uint64_t tick = 1; tick <= ticks; tick++)
+        {
+            uint64_t arrived = tick * fps * tickDenominator / tickNumerator;
+            counts.depth += static_cast<size_t>(arrived - counts.arrived);
+            counts.arrived = arrived;
+
+            Apply(cadence.Tick(tick * tickInterval, counts.depth, false), counts);
+        }
+
+        // Every frame which arrived was output, dropped, or is still buffered
+        CHECK(counts.output + counts.dropped + counts.depth == counts.arrived);
+        CHECK(cadence.GetTargetDepth() == 1);
+        return counts;
+    }
+
+    // Checks the accounting of steady streams
+    void CheckSteadyStreams()
+    {
+        // As many frames as ticks: each is output at its tick
+        Counts same = Pace(60, 60, 1, 600);
+        CHECK(same.output == 600);
+        CHECK(same.dropped == 0);
+        CHECK(same.duplicated == 0);
+
+        // Half as many frames as ticks: the ticks without a frame due aren't duplicates
+        Counts half = Pace(30, 60, 1, 600);
+        CHECK(half.output == 300);
+        CHECK(half.dropped == 0);
+        CHECK(half.duplicated == 0);
+
+        // 24 fps on 60 ticks a second: 2:3 pulldown
+        Counts film = Pace(24, 60, 1, 600);
+        CHECK(film.output == 240);
+        CHECK(film.dropped == 0);
+        CHECK(film.duplicated == 0);
+
+        // Twice as many frames as ticks: only the newer of the two due at each tick is output
+        Counts twice = Pace(60, 30, 1, 300);
+        CHECK(twice.output == 300);
+        CHECK(twice.dropped == 300);
+        CHECK(twice.duplicated == 0);
+
+        // 60 fps on a 59.94 fps canvas: a frame is dropped every 1000 ticks, and no more
+        Counts fractional = Pace(60, 60000, 1001, 60000);
+        CHECK(fractional.output == 60000);
+        CHECK(fractional.dropped == 60);
+        CHECK(fractional.duplicated == 0);
+    }
+
+    // Checks running dry grows the target depth, up to its limit, and it shrinks again once steady
+    void CheckTargetDepth()
+    {
+        FrameCadence cadence(60, 60, 1, 0);
+        uint64_t now = 0;
+
+        // Each tick a frame is due but none is buffered is a duplicate
+        for (size_t underflow = 1; underflow <= FrameCadence::MaxTargetDepth + 2; underflow++)
+        {
+            now += TickInterval;
+            FrameCadenceTick tick = cadence.Tick(now, 0, false);
+            CHECK(tick.duplicated);
+            CHECK(!tick.output);
+            CHECK(cadence.GetTargetDepth() == std::min(underflow + 1, FrameCadence::MaxTargetDepth));
+        }
+
+        // A stalled stream isn't running dry
+        now += TickInterval;
+        FrameCadenceTick stalled = cadence.Tick(now, 0, true);
+        CHECK(!stalled.duplicated);
+        CHECK(!stalled.output);
+        CHECK(cadence.GetTargetDepth() == FrameCadence::MaxTargetDepth);
+
+        // Up to the target depth is kept buffered after the output frame, and beyond it is caught up
+        now += TickInterval;
+        FrameCadenceTick full = cadence.Tick(now, FrameCadence::MaxTargetDepth + 1, false);
+        CHECK(full.output);
+        CHECK(full.skipped == 0);
+        CHECK(full.caughtUp == 0);
+
+        now += TickInterval;
+        FrameCadenceTick burst = cadence.Tick(now, FrameCadence::MaxTargetDepth + 4, false);
+        CHECK(burst.output);
+        CHECK(burst.skipped == 0);
+        CHECK(burst.caughtUp == 3);
+
+        // The target shrinks by a frame each time the stream stays steady for the shrink interval
+        uint64_t underflowed = now - 3 * TickInterval;
+        for (size_t shrunk = 1; shrunk < FrameCadence::MaxTargetDepth; shrunk++)
+        {
+            now = underflowed + shrunk * (FrameCadence::ShrinkInterval + TickInterval);
+            CHECK(cadence.Tick(now, 1, false).output);
+            CHECK(cadence.GetTargetDepth() == FrameCadence::MaxTargetDepth - shrunk);
+        }
+
+        now += FrameCadence::ShrinkInterval + TickInterval;
+        CHECK(cadence.Tick(now, 1, false).output);
+        CHECK(cadence.GetTargetDepth() == 1);
+    }
+
+    // Checks missed frames don't add up to be burst out once frames arrive again
+    void CheckMissedFramesAreForgotten()
+    {
+        // Half as many frames as ticks: the first tick owes half a frame, which isn't a duplicate
+        FrameCadence cadence(30, 60, 1, 0);
+        FrameCadenceTick first = cadence.Tick(TickInterval, 0, false);
+        CHECK(!first.duplicated);
+        CHECK(!first.output);
+
+        // The second owes a frame which hasn't arrived
+        FrameCadenceTick second = cadence.Tick(2 * TickInterval, 0, false);
+        CHECK(second.duplicated);
+
+        // With the owed frame forgotten, the next is due a whole frame interval later
+        CHECK(!cadence.Tick(3 * TickInterval, 2, false).output);
+        FrameCadenceTick fourth = cadence.Tick(4 * TickInterval, 2, false);
+        CHECK(fourth.output);
+        CHECK(fourth.skipped == 0);
+        CHECK(fourth.caughtUp == 0);
+    }
+}
+
+int main()
+{
+    CheckSteadyStreams();
+    CheckTargetDepth();
+    CheckMissedFramesAreForgotten();
+
+    return Testing::Finish();
+}
@@ -0,0 +1,154 @@
+// Checks the SPSC queue: popping an empty queue and pushing to a full one fail without touching
+// the element, elements come out in order as the counters wrap around the ring many times, and
+// a producer and a consumer on two threads pass every element through in order.
+//
+// Usage: SPSCQueueTest
+
+// STL includes
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+// Project includes
+#include "Utilities/SPSCQueue.hpp"
+#include "../Support/TestSupport.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Number of slots of the queues checked
+    constexpr size_t Capacity = 8;
+
+    // Number of elements passed between the threads
+    constexpr size_t ThreadedElements = 1000000;
+
+    // Checks an empty queue, and one which was filled and emptied again
+    void CheckEmpty()
+    {
+        SPSCQueue<std::unique_ptr<size_t>, Capacity> queue;
+        CHECK(queue.GetSize() == 0);
+
+        std::unique_ptr<size_t> element = std::make_unique<size_t>(1);
+        CHECK(!queue.TryPop(element));
+        CHECK(element != nullptr && *element == 1);
+
+        CHECK(queue.TryPush(element));
+        CHECK(element == nullptr);
+        CHECK(queue.TryPop(element));
+        CHECK(element != nullptr && *element == 1);
+        CHECK(queue.GetSize() == 0);
+        CHECK(!queue.TryPop(element));
+        CHECK(element != nullptr && *element == 1);
+    }
+
+    // Checks a full queue refuses elements without moving from them, until one is popped
+    void CheckFull()
+    {
+        SPSCQueue<std::unique_ptr<size_t>, Capacity> queue;
+        for (size_t i = 0; i < Capacity; i++)
+        {
+            std::unique_ptr<size_t> element = std::make_unique<size_t>(i);
+            CHECK(queue.TryPush(element));
+            CHECK(queue.GetSize() == i + 1);
+        }
+
+        std::unique_ptr<size_t> rejected = std::make_unique<size_t>(Capacity);
+        CHECK(!queue.TryPush(rejected));
+        CHECK(rejected != nullptr && *rejected == Capacity);
+        CHECK(queue.GetSize() == Capacity);
+
+        std::unique_ptr<size_t> popped;
+        CHECK(queue.TryPop(popped));
+        CHECK(popped != nullptr && *popped == 0);
+        CHECK(queue.TryPush(rejected));
+        CHECK(queue.GetSize() == Capacity);
+
+        for (size_t i = 1; i <= Capacity; i++)
+        {
+            CHECK(queue.TryPop(popped));
+            CHECK(popped != nullptr && *popped == i);
+        }
+        CHECK(queue.GetSize() == 0);
+    }
+
+    // Checks elements come out in order over many laps of the ring, at every fill level
+    void CheckWraparound()
+    {
+        SPSCQueue<size_t, Capacity> queue;
+        size_t pushed = 0;
+        size_t popped = 0;
+
+        for (size_t lap = 0; lap < Capacity * 16; lap++)
+        {
+            // Fill to a level which changes each lap, so the ends of the ring move around it
+            size_t level = lap % Capacity + 1;
+            while (queue.GetSize() < level)
+            {
+                size_t element = pushed;
+                CHECK(queue.TryPush(element));
+                pushed++;
+            }
+
+            while (queue.GetSize() > level / 2)
+            {
+                size_t element = 0;
+                CHECK(queue.TryPop(element));
+                CHECK(element == popped);
+                popped++;
+            }
+        }
+
+        size_t element = 0;
+        while (queue.TryPop(element))
+        {
+            CHECK(element == popped);
+            popped++;
+        }
+        CHECK(popped == pushed);
+        CHECK(pushed > Capacity * 8);
+    }
+
+    // Checks a producer and a consumer thread pass every element in order
+    void CheckThreaded()
+    {
+        SPSCQueue<size_t, Capacity> queue;
+
+        std::thread producer([&queue]()
+        {
+            for (size_t i = 0; i < ThreadedElements; i++)
+            {
+                size_t element = i;
+                while (!queue.TryPush(element))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        size_t outOfOrder = 0;
+        for (size_t expected = 0; expected < ThreadedElements; expected++)
+        {
+            size_t element = 0;
+            while (!queue.TryPop(element))
+            {
+                std::this_thread::yield();
+            }
+            outOfOrder += element == expected ? 0 : 1;
+        }
+
+        producer.join();
+        CHECK(outOfOrder == 0);
+        CHECK(queue.GetSize() == 0);
+    }
+}
+
+int main()
+{
+    CheckEmpty();
+    CheckFull();
+    CheckWraparound();
+    CheckThreaded();
+
+    return Testing::Finish();
+}
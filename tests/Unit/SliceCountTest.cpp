@@ -0,0 +1,79 @@
+// Checks the number of slices the host is asked to split each frame into: a slice per thread,
+// but never slices of fewer rows than are worth one, nor more slices than the most threads.
+//
+// Usage: SliceCountTest
+
+// STL includes
+#include <cstdint>
+
+// Project includes
+#include "Decoding/SliceCount.hpp"
+#include "../Support/TestSupport.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Heights of common stream resolutions, from smaller than a slice to 8K
+    constexpr uint32_t Heights[] = { 0, 144, 269, 270, 360, 480, 539, 540, 720, 1080, 1440, 2160, 4320 };
+
+    // The most threads checked, beyond the most slice threads
+    constexpr unsigned int MaxThreads = SliceCount::MaxThreads * 2;
+
+    // Checks the slice counts of common resolutions
+    void CheckResolutions()
+    {
+        // 1080p is split into a slice per thread up to 4 slices
+        CHECK(SliceCount::Get(1080, 1) == 1);
+        CHECK(SliceCount::Get(1080, 2) == 2);
+        CHECK(SliceCount::Get(1080, 4) == 4);
+        CHECK(SliceCount::Get(1080, 8) == 4);
+        CHECK(SliceCount::Get(1080, 16) == 4);
+
+        // 720p into up to 2, 1440p up to 5, 4K up to 8, and 8K up to the most slice threads
+        CHECK(SliceCount::Get(720, 16) == 2);
+        CHECK(SliceCount::Get(1440, 16) == 5);
+        CHECK(SliceCount::Get(2160, 6) == 6);
+        CHECK(SliceCount::Get(2160, 16) == 8);
+        CHECK(SliceCount::Get(4320, 16) == 16);
+        CHECK(SliceCount::Get(4320, MaxThreads) == SliceCount::MaxThreads);
+
+        // Resolutions smaller than two slices' worth of rows, and no threads, are a single slice
+        CHECK(SliceCount::Get(480, 16) == 1);
+        CHECK(SliceCount::Get(0, 16) == 1);
+        CHECK(SliceCount::Get(1080, 0) == 1);
+    }
+
+    // Checks the bounds of every slice count, and that more rows or threads never mean fewer slices
+    void CheckBounds()
+    {
+        for (uint32_t height : Heights)
+        {
+            for (unsigned int threads = 0; threads <= MaxThreads; threads++)
+            {
+                unsigned int slices = SliceCount::Get(height, threads);
+                CHECK(slices >= 1);
+                CHECK(slices <= SliceCount::MaxThreads);
+                CHECK(slices == 1 || slices <= threads);
+                CHECK(slices == 1 || height / slices >= SliceCount::MinimumRows);
+
+                if (threads > 0)
+                {
+                    CHECK(slices >= SliceCount::Get(height, threads - 1));
+                }
+                if (height > 0)
+                {
+                    CHECK(slices >= SliceCount::Get(height - 1, threads));
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    CheckResolutions();
+    CheckBounds();
+
+    return Testing::Finish();
+}
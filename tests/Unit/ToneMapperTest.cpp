@@ -0,0 +1,124 @@
+// Checks the tables of the tone mapper: the BT.2390 EETF folded with the PQ EOTF keeps its
+// endpoints, never decreases and never brightens, and the sRGB table is the sRGB OETF.
+//
+// Usage: ToneMapperTest
+
+// STL includes
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Project includes
+#include "Decoding/PixelKernels.hpp"
+#include "Decoding/ToneMapper.hpp"
+#include "../Support/TestSupport.hpp"
+
+using namespace MoonlightOBS;
+
+namespace
+{
+    // Relative error allowed between the tables and the reference, as the tables are floats
+    constexpr double Tolerance = 1e-4;
+
+    // Peak luminances in nits to check the PQ table for, from below SDR white to the PQ peak
+    constexpr uint16_t PeakLuminances[] = { 100, 203, 400, 1000, 4000, 10000 };
+
+    // Decodes a PQ signal to a luminance in nits (SMPTE ST 2084)
+    double DecodePQ(double signal)
+    {
+        const double m1 = 2610.0 / 16384.0;
+        const double m2 = 2523.0 / 4096.0 * 128.0;
+        const double c1 = 3424.0 / 4096.0;
+        const double c2 = 2413.0 / 4096.0 * 32.0;
+        const double c3 = 2392.0 / 4096.0 * 32.0;
+
+        double power = std::pow(signal, 1.0 / m2);
+        return 10000.0 * std::pow(std::max(power - c1, 0.0) / (c2 - c3 * power), 1.0 / m1);
+    }
+
+    // Gets the value a table entry is for
+    double GetEntryValue(size_t entry)
+    {
+        return static_cast<double>(entry) / (ToneMapParameters::TableSize - 1);
+    }
+
+    // Does a table value match a reference value?
+    bool IsClose(double value, double reference)
+    {
+        return std::fabs(value - reference) <= Tolerance * std::max(std::fabs(reference), 1.0);
+    }
+
+    // Checks the PQ table for a peak luminance
+    void CheckPQTable(const std::vector<float>& table, uint16_t peakLuminance)
+    {
+        CHECK(table.size() == ToneMapParameters::TableSize);
+        if (table.size() != ToneMapParameters::TableSize)
+        {
+            return;
+        }
+
+        // Black stays black, and the peak of the stream becomes SDR white, or stays where it
+        // is when it's below SDR white
+        const double peak = std::min(peakLuminance / ToneMapper::SDRPeakLuminance, 1.0f);
+        CHECK(table.front() == 0.0f);
+        CHECK(IsClose(table.back(), peak));
+
+        for (size_t entry = 0; entry < table.size(); entry++)
+        {
+            // The EETF only ever compresses, so it never maps a component brighter
+            double luminance = std::min(DecodePQ(GetEntryValue(entry)), static_cast<double>(peakLuminance));
+            CHECK(table[entry] <= luminance / ToneMapper::SDRPeakLuminance + Tolerance);
+            CHECK(table[entry] <= 1.0f);
+
+            // A brighter component never maps darker
+            if (entry > 0)
+            {
+                CHECK(table[entry] >= table[entry - 1]);
+            }
+        }
+    }
+}
+
+int main()
+{
+    ToneMapper toneMapper;
+
+    // The gamma table is the sRGB OETF of the squares of its entries
+    const std::vector<float>& gammaTable = toneMapper.GetGammaTable();
+    CHECK(gammaTable.size() == ToneMapParameters::TableSize);
+    CHECK(gammaTable.front() == 0.0f);
+    CHECK(IsClose(gammaTable.back(), 1.0));
+    for (size_t entry = 1; entry < gammaTable.size(); entry++)
+    {
+        double linear = GetEntryValue(entry) * GetEntryValue(entry);
+        double gamma = linear <= 0.0031308 ? 12.92 * linear : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+        CHECK(IsClose(gammaTable[entry], gamma));
+        CHECK(gammaTable[entry] > gammaTable[entry - 1]);
+    }
+
+    // The default peak, then every other peak
+    const std::vector<float> defaultTable = toneMapper.GetPQTable();
+    CheckPQTable(defaultTable, ToneMapper::DefaultPeakLuminance);
+    for (uint16_t peakLuminance : PeakLuminances)
+    {
+        toneMapper.SetPeakLuminance(peakLuminance);
+        CheckPQTable(toneMapper.GetPQTable(), peakLuminance);
+    }
+
+    // Up to SDR white there's nothing to compress, so the table is only the PQ EOTF
+    toneMapper.SetPeakLuminance(static_cast<uint16_t>(ToneMapper::SDRPeakLuminance));
+    const std::vector<float>& sdrTable = toneMapper.GetPQTable();
+    for (size_t entry = 0; entry < sdrTable.size(); entry++)
+    {
+        double luminance = std::min(DecodePQ(GetEntryValue(entry)), static_cast<double>(ToneMapper::SDRPeakLuminance));
+        CHECK(IsClose(sdrTable[entry], luminance / ToneMapper::SDRPeakLuminance));
+    }
+
+    // An unknown peak is the default one
+    toneMapper.SetPeakLuminance(0);
+    CHECK(toneMapper.GetPQTable() == defaultTable);
+
+    return Testing::Finish();
+}